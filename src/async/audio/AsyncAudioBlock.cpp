@@ -0,0 +1,237 @@
+/**
+@file	 AsyncAudioBlock.cpp
+@brief   A reference counted block of audio samples
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+This file contains a class for passing blocks of audio samples between the
+stages of an audio pipe without copying them.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstring>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncMetrics.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioBlock.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+static vector<AudioBlock*>& freeBlocks(void);
+static Metrics::Gauge& inUseGauge(void);
+static Metrics::Histogram& copiesHistogram(void);
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+  // The maximum number of free blocks to keep in the pool
+static const size_t MAX_FREE_BLOCKS = 256;
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioBlock::Ptr AudioBlock::create(int size)
+{
+  vector<AudioBlock*>& free_blocks = freeBlocks();
+  AudioBlock *blk = nullptr;
+  if (free_blocks.empty())
+  {
+    blk = new AudioBlock;
+  }
+  else
+  {
+    blk = free_blocks.back();
+    free_blocks.pop_back();
+  }
+  blk->setSize(size);
+  blk->m_refcnt = 1;
+  blk->m_copies = 0;
+  inUseGauge().inc();
+  return Ptr(blk);
+} /* AudioBlock::create */
+
+
+AudioBlock::Ptr AudioBlock::copy(const float *samples, int count)
+{
+  Ptr blk = create(count);
+  memcpy(blk->m_samples, samples, count * sizeof(*samples));
+  blk->m_copies = 1;
+  return blk;
+} /* AudioBlock::copy */
+
+
+AudioBlock::Ptr AudioBlock::makeWritable(Ptr block)
+{
+  if (!block->isShared())
+  {
+    return block;
+  }
+  Ptr blk = copy(block->data(), block->size());
+  blk->m_copies = block->m_copies + 1;
+  return blk;
+} /* AudioBlock::makeWritable */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void AudioBlock::release(AudioBlock *blk)
+{
+  copiesHistogram().observe(blk->m_copies);
+  inUseGauge().dec();
+  vector<AudioBlock*>& free_blocks = freeBlocks();
+  if (free_blocks.size() < MAX_FREE_BLOCKS)
+  {
+    free_blocks.push_back(blk);
+  }
+  else
+  {
+    delete blk;
+  }
+} /* AudioBlock::release */
+
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+static vector<AudioBlock*>& freeBlocks(void)
+{
+    // Never destroyed since blocks may be released by static objects
+  static vector<AudioBlock*>* free_blocks = new vector<AudioBlock*>;
+  return *free_blocks;
+} /* freeBlocks */
+
+
+static Metrics::Gauge& inUseGauge(void)
+{
+  static Metrics::Gauge& gauge = Metrics::instance().gauge(
+      "async_audio_blocks_in_use",
+      "Number of audio blocks currently allocated from the pool");
+  return gauge;
+} /* inUseGauge */
+
+
+static Metrics::Histogram& copiesHistogram(void)
+{
+  static Metrics::Histogram& hist = Metrics::instance().histogram(
+      "async_audio_block_copies",
+      "Number of times the samples of an audio block were copied, or passed "
+      "to a sink only supporting the pointer API, before the block was "
+      "released",
+      {0, 1, 2, 3, 4, 6, 8, 12, 16});
+  return hist;
+} /* copiesHistogram */
+
+
+
+/*
+ * This file has not been truncated
+ */
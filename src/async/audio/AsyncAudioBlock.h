@@ -0,0 +1,293 @@
+/**
+@file	 AsyncAudioBlock.h
+@brief   A reference counted block of audio samples
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+This file contains a class for passing blocks of audio samples between the
+stages of an audio pipe without copying them.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_BLOCK_INCLUDED
+#define ASYNC_AUDIO_BLOCK_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cassert>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A reference counted block of audio samples
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-19
+
+This class hold a fixed size block of audio samples. Blocks are allocated
+from a pool and are handled through the AudioBlock::Ptr class which keep a
+reference count. When the last reference is released, the block is returned
+to the pool.
+
+Audio blocks are used by the optional block API in Async::AudioSource and
+Async::AudioSink. A source that know that its sink accept blocks may write a
+block handle to the sink instead of a pointer to its own buffer. The sink may
+then keep a reference to the block, or pass it on, instead of copying the
+samples. A block may be shared by many sinks, e.g. by all branches of an
+Async::AudioSplitter, so the samples in a block must not be modified after
+the block has been written to a sink.
+
+Each block keep track of the number of times its samples have been copied or
+passed on to a sink that only support the pointer API. When the block is
+released, that count is recorded in the async_audio_block_copies histogram in
+the Async::Metrics registry so that the number of copies per block can be
+followed end to end.
+
+The pool is not thread safe so blocks may only be used from the main thread.
+*/
+class AudioBlock
+{
+  public:
+      /// The maximum number of samples in a block
+    static constexpr int CAPACITY = 1024;
+
+    /**
+     * @brief   A handle to a reference counted audio block
+     */
+    class Ptr
+    {
+      public:
+        Ptr(void) : m_blk(nullptr) {}
+        Ptr(const Ptr& other) : m_blk(other.m_blk)
+        {
+          if (m_blk != nullptr)
+          {
+            m_blk->m_refcnt += 1;
+          }
+        }
+        Ptr(Ptr&& other) : m_blk(other.m_blk) { other.m_blk = nullptr; }
+        ~Ptr(void) { reset(); }
+
+        Ptr& operator=(Ptr other)
+        {
+          AudioBlock *blk = m_blk;
+          m_blk = other.m_blk;
+          other.m_blk = blk;
+          return *this;
+        }
+
+        void reset(void)
+        {
+          if ((m_blk != nullptr) && (--m_blk->m_refcnt == 0))
+          {
+            AudioBlock::release(m_blk);
+          }
+          m_blk = nullptr;
+        }
+
+        AudioBlock* get(void) const { return m_blk; }
+        AudioBlock* operator->(void) const { return m_blk; }
+        AudioBlock& operator*(void) const { return *m_blk; }
+        explicit operator bool(void) const { return m_blk != nullptr; }
+
+      private:
+        AudioBlock* m_blk;
+
+        explicit Ptr(AudioBlock* blk) : m_blk(blk) {}
+
+        friend class AudioBlock;
+    };
+
+    /**
+     * @brief   Allocate a block from the pool
+     * @param   size The number of valid samples in the block
+     * @return  Returns a handle to the new block
+     *
+     * The samples in the new block are not initialized.
+     */
+    static Ptr create(int size=0);
+
+    /**
+     * @brief   Allocate a block and copy samples into it
+     * @param   samples The samples to copy
+     * @param   count   The number of samples to copy, at most CAPACITY
+     * @return  Returns a handle to the new block
+     */
+    static Ptr copy(const float *samples, int count);
+
+    /**
+     * @brief   Make sure that a block is not shared before modifying it
+     * @param   block The block to make writable
+     * @return  Returns the block itself or a copy if the block is shared
+     */
+    static Ptr makeWritable(Ptr block);
+
+    /**
+     * @brief   Get a pointer to the samples
+     * @return  Returns a pointer to the first sample in the block
+     */
+    float *data(void) { return m_samples; }
+
+    /**
+     * @brief   Get a pointer to the samples
+     * @return  Returns a pointer to the first sample in the block
+     */
+    const float *data(void) const { return m_samples; }
+
+    /**
+     * @brief   Get the number of valid samples in the block
+     * @return  Returns the number of samples in the block
+     */
+    int size(void) const { return m_size; }
+
+    /**
+     * @brief   Set the number of valid samples in the block
+     * @param   size The number of samples, at most CAPACITY
+     */
+    void setSize(int size)
+    {
+      assert((size >= 0) && (size <= CAPACITY));
+      m_size = size;
+    }
+
+    /**
+     * @brief   Check if more than one handle refer to this block
+     * @return  Returns \em true if the block is shared
+     */
+    bool isShared(void) const { return m_refcnt > 1; }
+
+    /**
+     * @brief   Get the number of times the samples have been copied
+     * @return  Returns the copy count
+     */
+    unsigned copies(void) const { return m_copies; }
+
+    /**
+     * @brief   Set the number of times the samples have been copied
+     * @param   copies The copy count
+     *
+     * This function is used by processing stages that produce a new block
+     * from an input block, to carry the copy count over to the new block.
+     */
+    void setCopies(unsigned copies) { m_copies = copies; }
+
+    /**
+     * @brief   Count one more copy of the samples
+     */
+    void addCopy(void) { m_copies += 1; }
+
+  private:
+    alignas(64) float m_samples[CAPACITY];
+    int               m_size;
+    unsigned          m_refcnt;
+    unsigned          m_copies;
+
+    AudioBlock(void) : m_size(0), m_refcnt(0), m_copies(0) {}
+    AudioBlock(const AudioBlock&);
+    AudioBlock& operator=(const AudioBlock&);
+
+    static void release(AudioBlock *blk);
+
+};  /* class AudioBlock */
+
+
+/**
+ * @brief   A handle to a reference counted audio block
+ */
+typedef AudioBlock::Ptr AudioBlockPtr;
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_BLOCK_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
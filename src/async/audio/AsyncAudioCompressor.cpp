@@ -33,6 +33,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 
 
 /****************************************************************************
@@ -50,6 +52,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioCompressor.h"
+#include "AsyncAudioVectorOps.h"
 
 
 
@@ -73,6 +76,9 @@ using namespace Async;
 // DC offset to prevent denormal
 static const double DC_OFFSET = 1.0E-25;
 
+// log2 -> dB conversion, 20 * log10( 2 )
+static const double LOG2_2_DB = 6.0205999132796239042747778944899;
+
 
 
 
@@ -134,7 +140,7 @@ static inline double dB2lin( double dB )
 
 AudioCompressor::AudioCompressor(void)
   : threshdB_(0.0), ratio_(1.0), output_gain(1.0),att_(10.0), rel_(100.0),
-    envdB_(DC_OFFSET)
+    envdB_(DC_OFFSET), gr_(1.0f), delay_(GAIN_BLOCK_SIZE), lookahead_(0)
 {
 } /* AudioCompressor::AudioCompressor */
 
@@ -182,9 +188,19 @@ void AudioCompressor::setOutputGain(float gain)
 } /* AudioCompressor::setOutputGain */
 
 
+void AudioCompressor::setLookahead(double lookahead_ms)
+{
+  lookahead_ = static_cast<size_t>(
+      std::max(0.0, lookahead_ms) * INTERNAL_SAMPLE_RATE / 1000.0 + 0.5);
+  delay_.assign(lookahead_ + GAIN_BLOCK_SIZE, 0.0f);
+} /* AudioCompressor::setLookahead */
+
+
 void AudioCompressor::reset(void)
 {
   envdB_ = DC_OFFSET;
+  gr_ = 1.0f;
+  std::fill(delay_.begin(), delay_.end(), 0.0f);
 } /* AudioCompressor::reset */
 
 
@@ -197,60 +213,68 @@ void AudioCompressor::reset(void)
 
 void AudioCompressor::processSamples(float *dest, const float *src, int count)
 {
-  //double max_sample = 0.0;
-  for (int i=0; i<count; ++i)
+  const double att_coef = att_.getCoef();
+  const double rel_coef = rel_.getCoef();
+  float keylog2[GAIN_BLOCK_SIZE];
+  while (count > 0)
   {
-    double rect = fabs(src[i]);	// rectify input
+    int n = std::min<int>(count, +GAIN_BLOCK_SIZE);
 
-    /* if desired, one could use another EnvelopeDetector to smooth
-     * the rectified signal.
-     */
+      // rectify input and convert linear -> log2. A DC offset is added to
+      // avoid log( 0 ).
+    absLog2(keylog2, src, n, DC_OFFSET);
+
+    // attack/release, selecting the coefficient without branching since
+    // the choice is unpredictable for audio signals
+    double envdB = envdB_;
+    for (int i=0; i<n; ++i)
+    {
+      double keydB = keylog2[i] * LOG2_2_DB;   // convert log2 -> dB
+
+      // threshold
+      double overdB = keydB - threshdB_;	// delta over threshold
+      overdB = std::max(overdB, 0.0);
 
-    rect += DC_OFFSET;			// add DC offset to avoid log( 0 )
-    double keydB = lin2dB( rect );	// convert linear -> dB
+      overdB += DC_OFFSET;		// add DC offset to avoid denormal
 
-    // threshold
-    double overdB = keydB - threshdB_;	// delta over threshold
-    if ( overdB < 0.0 )
-	    overdB = 0.0;
+      double coef = (overdB > envdB) ? att_coef : rel_coef;
+      envdB = overdB + coef * (envdB - overdB);
+    }
+    envdB_ = envdB;
 
-    // attack/release
+    /* Regarding the DC offset: In this case, since the offset is added before
+     * the attack/release processes, the envelope will never fall below the
+     * offset, thereby avoiding denormals. However, to prevent the offset from
+     * causing constant gain reduction, we must subtract it from the envelope,
+     * yielding a minimum value of 0dB.
+     */
+    double overdB = envdB_ - DC_OFFSET;
 
-    overdB += DC_OFFSET;		// add DC offset to avoid denormal
+    // transfer function, calculated once per block
+    double gr = overdB * ( ratio_ - 1.0 );    // gain reduction (dB)
+    float gain = dB2lin( gr );
+    float step = (gain - gr_) / n;
+    float og = output_gain;
 
-    if ( overdB > envdB_ )
+    // apply gain reduction and output gain to the, possibly delayed, input
+    if (lookahead_ > 0)
     {
-      att_.run( overdB, envdB_ );		// attack
+      float *delayed = &delay_[0];
+      std::memcpy(delayed + lookahead_, src, n * sizeof(*src));
+      applyGainRamp(dest, delayed, n, og * (gr_ + step), og * step);
+      std::memmove(delayed, delayed + n, lookahead_ * sizeof(*delayed));
     }
     else
     {
-      rel_.run( overdB, envdB_ );		// release
+      applyGainRamp(dest, src, n, og * (gr_ + step), og * step);
     }
+    gr_ = gain;
 
-    overdB = envdB_ - DC_OFFSET;		// subtract DC offset
-    //cout << overdB << endl;
-
-    /* Regarding the DC offset: In this case, since the offset is added before 
-     * the attack/release processes, the envelope will never fall below the offset,
-     * thereby avoiding denormals. However, to prevent the offset from causing
-     * constant gain reduction, we must subtract it from the envelope, yielding
-     * a minimum value of 0dB.
-     */
-
-    // transfer function
-    double gr = overdB * ( ratio_ - 1.0 );    // gain reduction (dB)
-    gr = dB2lin( gr );			      // convert dB -> linear
-
-    // output gain
-    dest[i] = output_gain * src[i] * gr;      // apply gain reduction to input
-    
-    //if (fabs(dest[i]) > max_sample)
-    //  max_sample = dest[i];
+    src += n;
+    dest += n;
+    count -= n;
   }
-  
-  //cout << "max_sample=" << max_sample << endl;
-  
-} /* AudioCompressor::writeSamples */
+} /* AudioCompressor::processSamples */
 
 
 
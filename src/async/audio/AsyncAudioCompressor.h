@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <cmath>
+#include <vector>
 
 
 /****************************************************************************
@@ -132,6 +133,9 @@ class EnvelopeDetector
 
     virtual double getSampleRate( void ) { return sampleRate_; }
 
+    // runtime coefficient
+    double getCoef( void ) const { return coef_; }
+
     // runtime function
     inline void run( double in, double &state )
     {
@@ -163,12 +167,25 @@ Use this audio pipe class to do compression on an audio stream. Compression
 is a method to reduce the dynamic range of an audio signal. After it has been
 compressed it can be amplified to get a more audible end result.
 
-This audio pipe component is mostly untested and is based on some ripped off
-code which I really have not checked how it performs or if it works at all...
+The signal level is tracked for every sample but the gain is only calculated
+once every GAIN_BLOCK_SIZE samples. Between those points the gain is changed
+linearly from one value to the next. The level detector use a polynomial
+approximation of the logarithm so that no transcendental functions have to be
+called per sample.
+
+If a look-ahead time is set, the audio is delayed by that time while the gain
+is calculated from the undelayed signal. The compressor can then react on a
+transient before it reach the output, which is useful when the compressor is
+used as a limiter.
 */
 class AudioCompressor : public AudioProcessor
 {
   public:
+    /**
+     * @brief   The number of samples between gain calculations
+     */
+    static constexpr int GAIN_BLOCK_SIZE = 16;
+
     /**
      * @brief 	Default constuctor
      */
@@ -215,6 +232,16 @@ class AudioCompressor : public AudioProcessor
      * If gain < 1 the signal is attenuated.
      */
     void setOutputGain(float gain);
+
+    /**
+     * @brief 	Set the look-ahead time
+     * @param 	lookahead_ms The look-ahead time in milliseconds
+     *
+     * The audio passing through the compressor is delayed by the given time
+     * so that the gain can be reduced before a transient reach the output.
+     * The default is zero, no look-ahead and no added delay.
+     */
+    void setLookahead(double lookahead_ms);
   
     /**
      * @brief 	Reset the compressor
@@ -238,6 +265,11 @@ class AudioCompressor : public AudioProcessor
 
     // runtime variables
     double envdB_;			// over-threshold envelope (dB)
+    float gr_;				// gain reduction of the last sample
+
+    // look-ahead
+    std::vector<float> delay_;		// delay line + one gain block
+    size_t lookahead_;			// look-ahead time in samples
     
     AudioCompressor(const AudioCompressor&);
     AudioCompressor& operator=(const AudioCompressor&);
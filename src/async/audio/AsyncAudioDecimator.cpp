@@ -27,7 +27,8 @@ ANY KIND. See http://www.dspguru.com/wol.htm for more information.
  *
  ****************************************************************************/
 
-#include <cstring>
+#include <cassert>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -45,6 +46,7 @@ ANY KIND. See http://www.dspguru.com/wol.htm for more information.
  ****************************************************************************/
 
 #include "AsyncAudioDecimator.h"
+#include "AsyncAudioVectorOps.h"
 
 
 
@@ -108,17 +110,19 @@ using namespace Async;
 
 AudioDecimator::AudioDecimator(int decimation_factor,
       	      	      	       const float *filter_coeff, int taps)
-  : factor_M(decimation_factor), H_size(taps), p_H(filter_coeff)
+  : factor_M(decimation_factor), H_size(taps),
+    H_rev(filter_coeff, filter_coeff + taps), Z(2 * taps, 0.0f), Z_pos(0)
 {
   setInputOutputSampleRate(factor_M, 1);
-  p_Z = new float[H_size];
-  memset(p_Z, 0, H_size * sizeof(*p_Z));
+
+    // The delay line is stored oldest sample first so the coefficients
+    // are reversed to get the same result as a standard FIR filter
+  std::reverse(H_rev.begin(), H_rev.end());
 } /* AudioDecimator::AudioDecimator */
 
 
 AudioDecimator::~AudioDecimator(void)
 {
-  delete [] p_Z;
 } /* AudioDecimator::~AudioDecimator */
 
 
@@ -142,23 +146,21 @@ void AudioDecimator::processSamples(float *dest, const float *src, int count)
   int num_out = 0;
   while (count >= factor_M)
   {
-      // shift Z delay line up to make room for next samples
-    memmove(p_Z + factor_M, p_Z, (H_size - factor_M) * sizeof(float));
-
-      // copy next samples from input buffer to bottom of Z delay line
-    for (int tap = factor_M - 1; tap >= 0; tap--)
+      // copy next samples from input buffer into both halves of the
+      // mirrored Z delay line
+    for (int i = 0; i < factor_M; ++i)
     {
-      p_Z[tap] = *src++;
+      Z[Z_pos] = Z[Z_pos + H_size] = *src++;
+      if (++Z_pos >= H_size)
+      {
+        Z_pos = 0;
+      }
     }
     count -= factor_M;
 
-      // calculate FIR sum
-    float sum = 0.0;
-    for (int tap = 0; tap < H_size; tap++)
-    {
-      sum += p_H[tap] * p_Z[tap];
-    }
-    *dest++ = sum;     /* store sum and point to next output */
+      // calculate FIR sum. The last H_size samples, oldest first, are
+      // found contiguously starting at Z_pos.
+    *dest++ = dotProduct(H_rev.data(), Z.data() + Z_pos, H_size);
     num_out++;
   }
 
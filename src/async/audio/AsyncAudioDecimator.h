@@ -29,6 +29,7 @@ ANY KIND. See http://www.dspguru.com/wol.htm for more information.
  *
  ****************************************************************************/
 
+#include <vector>
 
 
 /****************************************************************************
@@ -112,6 +113,12 @@ http://www.dsptutor.freeuk.com/remez/RemezFIRFilterDesign.html
 
 This implementation is based on the multirate FAQ at dspguru.com:
 http://dspguru.com/info/faqs/mrfaq.htm
+
+The delay line is a circular buffer that is stored twice in a row (mirrored)
+so that the last "taps" samples always are available as one contiguous block
+of memory. No samples have to be moved when a new sample arrive and the FIR
+sum is only calculated for the samples that are actually output, which is the
+polyphase decomposition of the decimating filter.
 */
 class AudioDecimator : public AudioProcessor
 {
@@ -147,10 +154,11 @@ class AudioDecimator : public AudioProcessor
 
     
   private:
-    const int 	factor_M;
-    float     	*p_Z;
-    int       	H_size;
-    const float *p_H;
+    const int           factor_M;
+    const int           H_size;
+    std::vector<float>  H_rev;
+    std::vector<float>  Z;
+    int                 Z_pos;
     
     AudioDecimator(const AudioDecimator&);
     AudioDecimator& operator=(const AudioDecimator&);
@@ -159,7 +159,27 @@ class AudioDecoder : public AudioSource, public sigc::trackable
      * @param 	size The size of the buffer
      */
     virtual void writeEncodedSamples(void *buf, int size) = 0;
-    
+
+    /**
+     * @brief   Generate audio for a frame that was lost in transmission
+     * @param   next_buf  The frame following the lost one, if available
+     * @param   next_size The size of the next_buf buffer
+     * @return  Returns \em true if audio was generated for the lost frame
+     *
+     * Decoders that support packet loss concealment (PLC) will output an
+     * estimation of the lost audio frame. If the frame following the lost one
+     * is given, decoders supporting in-band forward error correction (FEC)
+     * will try to use the redundancy information in that frame to
+     * reconstruct the lost frame. The next frame is not decoded by this
+     * function. It still must be written using writeEncodedSamples.
+     * The default implementation does nothing and return \em false.
+     */
+    virtual bool concealLostFrame(const void *next_buf=nullptr,
+                                  int next_size=0)
+    {
+      return false;
+    }
+
     /**
      * @brief Call this function when all encoded samples have been received
      */
@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iostream>
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -251,6 +252,7 @@ void AudioDecoderOpus::writeEncodedSamples(void *buf, int size)
                                                 MAX_DECODED_SAMPLES, 0);
   if (decoded_samples > 0)
   {
+    m_last_frame_size = decoded_samples;
     sinkWriteSamples(samples, decoded_samples);
   }
   else if (decoded_samples < 0)
@@ -262,6 +264,44 @@ void AudioDecoderOpus::writeEncodedSamples(void *buf, int size)
 } /* AudioDecoderOpus::writeEncodedSamples */
 
 
+bool AudioDecoderOpus::concealLostFrame(const void *next_buf, int next_size)
+{
+  float samples[MAX_DECODED_SAMPLES];
+  int decoded_samples = -1;
+
+    // The frame size must be a multiple of 2.5ms when decoding FEC data or
+    // when doing PLC so use the size of the last decoded frame
+  const int frame_size = std::min<int>(m_last_frame_size, +MAX_DECODED_SAMPLES);
+  const unsigned char* const next_packet =
+    reinterpret_cast<const unsigned char*>(next_buf);
+  if ((next_packet != nullptr) && (next_size > 0) &&
+      (next_size <= AudioEncoderOpus::MAX_ENCODED_FRAME_SIZE) &&
+      (opus_packet_get_nb_channels(next_packet) == 1))
+  {
+    decoded_samples = opus_decode_float(m_dec, next_packet, next_size,
+                                        samples, frame_size, 1);
+  }
+  if (decoded_samples <= 0)
+  {
+    decoded_samples = opus_decode_float(m_dec, nullptr, 0, samples,
+                                        frame_size, 0);
+  }
+
+  if (decoded_samples > 0)
+  {
+    sinkWriteSamples(samples, decoded_samples);
+    return true;
+  }
+  else if (decoded_samples < 0)
+  {
+    std::cerr << "**** ERROR: Opus decoder error: "
+              << opus_strerror(decoded_samples)
+              << std::endl;
+  }
+  return false;
+} /* AudioDecoderOpus::concealLostFrame */
+
+
 
 /****************************************************************************
  *
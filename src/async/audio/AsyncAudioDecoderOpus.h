@@ -179,8 +179,23 @@ class AudioDecoderOpus : public AudioDecoder
      */
     virtual void writeEncodedSamples(void *buf, int size) override;
 
+    /**
+     * @brief   Generate audio for a frame that was lost in transmission
+     * @param   next_buf  The frame following the lost one, if available
+     * @param   next_size The size of the next_buf buffer
+     * @return  Returns \em true if audio was generated for the lost frame
+     *
+     * If the next frame is given, its in-band FEC data is used to reconstruct
+     * the lost frame. If there is no FEC data in the next frame or if no next
+     * frame is given, the Opus packet loss concealment is used to extrapolate
+     * the audio from the last frame.
+     */
+    virtual bool concealLostFrame(const void *next_buf=nullptr,
+                                  int next_size=0) override;
+
   private:
-    OpusDecoder* m_dec {nullptr};
+    OpusDecoder* m_dec              {nullptr};
+    int          m_last_frame_size  {20 * INTERNAL_SAMPLE_RATE / 1000};
 
     AudioDecoderOpus(const AudioDecoderOpus&);
     AudioDecoderOpus& operator=(const AudioDecoderOpus&);
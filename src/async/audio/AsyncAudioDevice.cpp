@@ -58,6 +58,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "AsyncFdWatch.h"
 #include "AsyncAudioIO.h"
 #include "AsyncAudioDevice.h"
+#include "AsyncAudioVectorOps.h"
 #include "AsyncAudioDeviceFactory.h"
 
 
@@ -268,32 +269,128 @@ AudioDevice::~AudioDevice(void)
 
 void AudioDevice::putBlocks(int16_t *buf, size_t frame_cnt)
 {
-  //printf("putBlocks: frame_cnt=%zu\n", frame_cnt);
-  float samples[frame_cnt];
   for (size_t ch=0; ch<channels; ch++)
   {
-    for (size_t i=0; i<frame_cnt; i++)
+    for (size_t pos=0; pos<frame_cnt; pos+=AudioBlock::CAPACITY)
     {
-        // no divisions in index calculation (embedded system performance !!!)
-      samples[i] = static_cast<float>(buf[i * channels + ch]) / 32768.0;
+      size_t cnt = std::min(frame_cnt - pos,
+                            static_cast<size_t>(AudioBlock::CAPACITY));
+      AudioBlockPtr block = AudioBlock::create(cnt);
+      convertS16ToFloat(block->data(), buf + pos * channels + ch, channels,
+                        cnt);
+      distributeSamples(ch, block);
     }
-    list<AudioIO*>::iterator it;
-    for (it=aios.begin(); it!=aios.end(); ++it)
+  }
+} /* AudioDevice::putBlocks */
+
+
+void AudioDevice::putBlocks(int32_t *buf, size_t frame_cnt)
+{
+  for (size_t ch=0; ch<channels; ch++)
+  {
+    for (size_t pos=0; pos<frame_cnt; pos+=AudioBlock::CAPACITY)
     {
-      if ((*it)->channel() == ch)
-      {
-        (*it)->audioRead(samples, frame_cnt);
-      }
+      size_t cnt = std::min(frame_cnt - pos,
+                            static_cast<size_t>(AudioBlock::CAPACITY));
+      AudioBlockPtr block = AudioBlock::create(cnt);
+      convertS32ToFloat(block->data(), buf + pos * channels + ch, channels,
+                        cnt);
+      distributeSamples(ch, block);
+    }
+  }
+} /* AudioDevice::putBlocks */
+
+
+void AudioDevice::putBlocks(float *buf, size_t frame_cnt)
+{
+  for (size_t ch=0; ch<channels; ch++)
+  {
+    for (size_t pos=0; pos<frame_cnt; pos+=AudioBlock::CAPACITY)
+    {
+      size_t cnt = std::min(frame_cnt - pos,
+                            static_cast<size_t>(AudioBlock::CAPACITY));
+      AudioBlockPtr block = AudioBlock::create(cnt);
+      deinterleaveFloat(block->data(), buf + pos * channels + ch, channels,
+                        cnt);
+      distributeSamples(ch, block);
     }
   }
 } /* AudioDevice::putBlocks */
 
 
 size_t AudioDevice::getBlocks(int16_t *buf, size_t block_cnt)
+{
+  size_t blocks = mixBlocks(block_cnt);
+  convertFloatToS16(buf, mix_buf.data(),
+                    blocks * writeBlocksize() * channels);
+  return blocks;
+} /* AudioDevice::getBlocks */
+
+
+size_t AudioDevice::getBlocks(int32_t *buf, size_t block_cnt)
+{
+  size_t blocks = mixBlocks(block_cnt);
+  convertFloatToS32(buf, mix_buf.data(),
+                    blocks * writeBlocksize() * channels);
+  return blocks;
+} /* AudioDevice::getBlocks */
+
+
+size_t AudioDevice::getBlocks(float *buf, size_t block_cnt)
+{
+  size_t blocks = mixBlocks(block_cnt);
+  clipFloat(buf, mix_buf.data(), blocks * writeBlocksize() * channels);
+  return blocks;
+} /* AudioDevice::getBlocks */
+
+
+void AudioDevice::setDeviceError(void)
+{
+  if (!reopen_timer.isEnabled())
+  {
+    std::cerr << "*** ERROR: Audio device failed. Trying to reopen..."
+              << std::endl;
+    reopen_timer.setEnable(true);
+  }
+} /* AudioDevice::setDeviceError */
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void AudioDevice::reopenDevice(void)
+{
+  //std::cout << "### AudioDevice::reopenDevice" << std::endl;
+  closeDevice();
+  if ((current_mode == MODE_NONE) || openDevice(current_mode))
+  {
+    reopen_timer.setEnable(false);
+  }
+} /* AudioDevice::reopenDevice */
+
+
+void AudioDevice::distributeSamples(size_t ch, const AudioBlockPtr& block)
+{
+    // The same block is shared by all AudioIO objects using the channel
+  list<AudioIO*>::iterator it;
+  for (it=aios.begin(); it!=aios.end(); ++it)
+  {
+    if ((*it)->channel() == ch)
+    {
+      (*it)->audioRead(block);
+    }
+  }
+} /* AudioDevice::distributeSamples */
+
+
+size_t AudioDevice::mixBlocks(size_t block_cnt)
 {
   size_t block_size = writeBlocksize();
   size_t frames_to_write = block_cnt * block_size;
-  memset(buf, 0, channels * frames_to_write * sizeof(*buf));
+  mix_buf.assign(channels * frames_to_write, 0.0f);
   
     // Loop through all AudioIO objects and find out if they have any
     // samples to write and how many. The non-flushing AudioIO object with
@@ -348,7 +445,9 @@ size_t AudioDevice::getBlocks(int16_t *buf, size_t block_cnt)
     return 0;
   }
   
-    // Fill the sample buffer with samples from the non-idle AudioIO objects.
+    // Mix the samples from the non-idle AudioIO objects into the
+    // interleaved sample buffer. Clipping is done when the samples are
+    // converted to the device sample format.
   for (it=aios.begin(); it!=aios.end(); ++it)
   {
     if (!(*it)->isIdle())
@@ -357,26 +456,10 @@ size_t AudioDevice::getBlocks(int16_t *buf, size_t block_cnt)
       float tmp[frames_to_write];
       int samples_read = (*it)->readSamples(tmp, frames_to_write);
       assert(samples_read >= 0);
-      for (size_t i=0; i<static_cast<size_t>(samples_read); ++i)
-      {
-	int buf_pos = i * channels + channel;
-	float sample = 32767.0 * tmp[i] + buf[buf_pos];
-	if (sample > 32767)
-	{
-	  buf[buf_pos] = 32767;
-	}
-	else if (sample < -32767)
-	{
-	  buf[buf_pos] = -32767;
-	}
-	else
-	{
-	  buf[buf_pos] = static_cast<int16_t>(sample);
-	}
-      }
+      mixInterleaved(&mix_buf[channel], channels, tmp, samples_read);
     }
-  }  
-      
+  }
+
     // If flushing and the number of frames to write is not an even
     // multiple of the frag size, round the number of frags to write
     // up. The end of the buffer is already zeroed out.
@@ -388,35 +471,7 @@ size_t AudioDevice::getBlocks(int16_t *buf, size_t block_cnt)
   
   return frames_to_write / block_size;
   
-} /* AudioDevice::getBlocks */
-
-
-void AudioDevice::setDeviceError(void)
-{
-  if (!reopen_timer.isEnabled())
-  {
-    std::cerr << "*** ERROR: Audio device failed. Trying to reopen..."
-              << std::endl;
-    reopen_timer.setEnable(true);
-  }
-} /* AudioDevice::setDeviceError */
-
-
-/****************************************************************************
- *
- * Private member functions
- *
- ****************************************************************************/
-
-void AudioDevice::reopenDevice(void)
-{
-  //std::cout << "### AudioDevice::reopenDevice" << std::endl;
-  closeDevice();
-  if ((current_mode == MODE_NONE) || openDevice(current_mode))
-  {
-    reopen_timer.setEnable(false);
-  }
-} /* AudioDevice::reopenDevice */
+} /* AudioDevice::mixBlocks */
 
 /*
  * This file has not been truncated
@@ -41,6 +41,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
 
 
 /****************************************************************************
@@ -50,6 +51,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncTimer.h>
+#include <AsyncAudioBlock.h>
 
 
 /****************************************************************************
@@ -340,6 +342,25 @@ class AudioDevice : public sigc::trackable
      */
     void putBlocks(int16_t *buf, size_t frame_cnt);
 
+    /**
+     * @brief   Write 32 bit samples read from audio device to upper layers
+     * @param   buf       Buffer containing frames of samples to write
+     * @param   frame_cnt The number of frames of samples in the buffer
+     *
+     * Same as above but for devices delivering 32 bit integer samples.
+     */
+    void putBlocks(int32_t *buf, size_t frame_cnt);
+
+    /**
+     * @brief   Write float samples read from audio device to upper layers
+     * @param   buf       Buffer containing frames of samples to write
+     * @param   frame_cnt The number of frames of samples in the buffer
+     *
+     * Same as above but for devices delivering float samples in the range
+     * -1.0 to 1.0.
+     */
+    void putBlocks(float *buf, size_t frame_cnt);
+
     /**
      * @brief   Read samples from upper layers to write to audio device
      * @brief   buf       Buffer which will be filled with frames of samples
@@ -355,6 +376,27 @@ class AudioDevice : public sigc::trackable
      */
     size_t getBlocks(int16_t *buf, size_t block_cnt);
 
+    /**
+     * @brief   Read 32 bit samples from upper layers to write to audio device
+     * @brief   buf       Buffer which will be filled with frames of samples
+     * @brief   block_cnt The size of the buffer counted in blocks
+     * @return  The number of blocks actually stored in the buffer
+     *
+     * Same as above but for devices using 32 bit integer samples.
+     */
+    size_t getBlocks(int32_t *buf, size_t block_cnt);
+
+    /**
+     * @brief   Read float samples from upper layers to write to audio device
+     * @brief   buf       Buffer which will be filled with frames of samples
+     * @brief   block_cnt The size of the buffer counted in blocks
+     * @return  The number of blocks actually stored in the buffer
+     *
+     * Same as above but for devices using float samples. The samples are
+     * clipped to the range -1.0 to 1.0.
+     */
+    size_t getBlocks(float *buf, size_t block_cnt);
+
     /**
      * @brief   Called by the device object to indicate an error condition
      */
@@ -372,8 +414,11 @@ class AudioDevice : public sigc::trackable
     size_t              use_count;
     std::list<AudioIO*> aios;
     Async::Timer        reopen_timer  {1000, Async::Timer::TYPE_PERIODIC};
+    std::vector<float>  mix_buf;
 
     void reopenDevice(void);
+    void distributeSamples(size_t ch, const AudioBlockPtr& block);
+    size_t mixBlocks(size_t block_cnt);
 
 };  /* class AudioDevice */
 
@@ -49,6 +49,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncFdWatch.h>
+#include <AsyncMetrics.h>
 
 
 /****************************************************************************
@@ -195,7 +196,8 @@ AudioDeviceAlsa::AudioDeviceAlsa(const std::string& dev_name)
   : AudioDevice(dev_name), play_block_size(0), play_block_count(0),
     rec_block_size(0), rec_block_count(0), play_handle(0), 
     rec_handle(0), play_watch(0), rec_watch(0), duplex(false),
-    zerofill_on_underflow(true)
+    zerofill_on_underflow(true), play_format(SND_PCM_FORMAT_S16_LE),
+    rec_format(SND_PCM_FORMAT_S16_LE)
 {
   assert(AudioDeviceAlsa_creator_registered);
 
@@ -315,7 +317,7 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
       return false;
     }
 
-    if (!initParams(play_handle))
+    if (!initParams(play_handle, play_format))
     {
       closeDevice();
       return false;
@@ -352,7 +354,7 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
       return false;
     }
 
-    if (!initParams(rec_handle))
+    if (!initParams(rec_handle, rec_format))
     {
       closeDevice();
       return false;
@@ -447,12 +449,24 @@ void AudioDeviceAlsa::audioReadHandler(FdWatch *watch, unsigned short revents)
     frames_avail /= rec_block_size;
     frames_avail *= rec_block_size;
 
-    int16_t buf[frames_avail * channels];
-    memset(buf, 0, sizeof(buf));
-
-    const auto frames_read = snd_pcm_readi(rec_handle, buf, frames_avail);
+    snd_pcm_sframes_t frames_read;
+    switch (rec_format)
+    {
+      case SND_PCM_FORMAT_FLOAT:
+        frames_read = readFrames<float>(frames_avail);
+        break;
+      case SND_PCM_FORMAT_S32:
+        frames_read = readFrames<int32_t>(frames_avail);
+        break;
+      default:
+        frames_read = readFrames<int16_t>(frames_avail);
+        break;
+    }
     if (frames_read < 0)
     {
+      Metrics::instance().counter("async_audio_device_overruns_total",
+          "Number of capture overruns reported by the sound card driver",
+          Metrics::label("device", devName())).inc();
       if (!startCapture(rec_handle))
       {
         setDeviceError();
@@ -460,9 +474,6 @@ void AudioDeviceAlsa::audioReadHandler(FdWatch *watch, unsigned short revents)
       }
       return;
     }
-    assert(frames_read <= frames_avail);
-
-    putBlocks(buf, frames_read);
   }
 } /* AudioDeviceAlsa::audioReadHandler */
 
@@ -511,30 +522,33 @@ void AudioDeviceAlsa::writeSpaceAvailable(FdWatch *watch, unsigned short revents
       return;
     }
 
-    int16_t buf[space_avail * channels];
-        
-    int blocks_avail = getBlocks(buf, blocks_to_read);
-    if (blocks_avail == 0) 
+    size_t frames_to_write = 0;
+    snd_pcm_sframes_t frames_written;
+    switch (play_format)
     {
-      if (zerofill_on_underflow)
-      {
-        blocks_avail = 1;
-        memset(buf, 0, blocks_avail * play_block_size);
-      }
-      else
-      {
-        watch->setEnabled(false);
-        return;
-      }
+      case SND_PCM_FORMAT_FLOAT:
+        frames_written = writeBlocks<float>(blocks_to_read, frames_to_write);
+        break;
+      case SND_PCM_FORMAT_S32:
+        frames_written = writeBlocks<int32_t>(blocks_to_read, frames_to_write);
+        break;
+      default:
+        frames_written = writeBlocks<int16_t>(blocks_to_read, frames_to_write);
+        break;
+    }
+    if (frames_to_write == 0)
+    {
+      watch->setEnabled(false);
+      return;
     }
-    
-    int frames_to_write = blocks_avail * play_block_size;
-    int frames_written = snd_pcm_writei(play_handle, buf, frames_to_write);
     //printf("frames_avail=%d  blocks_avail=%d  blocks_gotten=%d "
     //       "frames_written=%d\n", (int)frames_avail, blocks_avail,
     //       blocks_gotten, (int)frames_written);
     if (frames_written < 0)
     {
+      Metrics::instance().counter("async_audio_device_underruns_total",
+          "Number of playback underruns reported by the sound card driver",
+          Metrics::label("device", devName())).inc();
       if (!startPlayback(play_handle))
       {
         setDeviceError();
@@ -544,7 +558,7 @@ void AudioDeviceAlsa::writeSpaceAvailable(FdWatch *watch, unsigned short revents
       continue;
     }
 
-    if (frames_written != frames_to_write)
+    if (static_cast<size_t>(frames_written) != frames_to_write)
     {
       cerr << "*** WARNING: Number of frames written to sound device "
            << devName()
@@ -553,7 +567,7 @@ void AudioDeviceAlsa::writeSpaceAvailable(FdWatch *watch, unsigned short revents
       return;
     }
     
-    if (frames_to_write != space_avail)
+    if (frames_to_write != static_cast<size_t>(space_avail))
     {
       return;
     }
@@ -561,7 +575,8 @@ void AudioDeviceAlsa::writeSpaceAvailable(FdWatch *watch, unsigned short revents
 } /* AudioDeviceAlsa::writeSpaceAvailable */
 
 
-bool AudioDeviceAlsa::initParams(snd_pcm_t *pcm_handle)
+bool AudioDeviceAlsa::initParams(snd_pcm_t *pcm_handle,
+                                 snd_pcm_format_t &format)
 {
   snd_pcm_hw_params_t* hw_params = nullptr;
 
@@ -595,8 +610,28 @@ bool AudioDeviceAlsa::initParams(snd_pcm_t *pcm_handle)
     return false;
   }
 
-  err = snd_pcm_hw_params_set_format(pcm_handle, hw_params,
-				     SND_PCM_FORMAT_S16_LE);
+    // Select the sample format. A hardware device is used in one of its
+    // native formats to avoid a conversion in the ALSA plug layer, with
+    // the widest format preferred. Other devices use 16 bit samples if
+    // possible since that is what most software mixers work with.
+  static const snd_pcm_format_t hw_formats[] = {
+    SND_PCM_FORMAT_FLOAT, SND_PCM_FORMAT_S32, SND_PCM_FORMAT_S16_LE
+  };
+  static const snd_pcm_format_t sw_formats[] = {
+    SND_PCM_FORMAT_S16_LE, SND_PCM_FORMAT_S32, SND_PCM_FORMAT_FLOAT
+  };
+  const snd_pcm_format_t *formats =
+    (snd_pcm_type(pcm_handle) == SND_PCM_TYPE_HW) ? hw_formats : sw_formats;
+  format = formats[0];
+  for (size_t i=0; i<sizeof(hw_formats)/sizeof(*hw_formats); ++i)
+  {
+    if (snd_pcm_hw_params_test_format(pcm_handle, hw_params, formats[i]) == 0)
+    {
+      format = formats[i];
+      break;
+    }
+  }
+  err = snd_pcm_hw_params_set_format(pcm_handle, hw_params, format);
   if (err < 0)
   {
     cerr << "*** ERROR: Set sample format failed: "
@@ -737,6 +772,44 @@ bool AudioDeviceAlsa::initParams(snd_pcm_t *pcm_handle)
 } /* AudioDeviceAlsa::initParams */
 
 
+template <typename T>
+snd_pcm_sframes_t AudioDeviceAlsa::readFrames(snd_pcm_sframes_t frame_cnt)
+{
+  T buf[frame_cnt * channels];
+  memset(buf, 0, sizeof(buf));
+
+  const auto frames_read = snd_pcm_readi(rec_handle, buf, frame_cnt);
+  if (frames_read > 0)
+  {
+    assert(frames_read <= frame_cnt);
+    putBlocks(buf, frames_read);
+  }
+  return frames_read;
+} /* AudioDeviceAlsa::readFrames */
+
+
+template <typename T>
+snd_pcm_sframes_t AudioDeviceAlsa::writeBlocks(size_t block_cnt,
+                                               size_t &frames_to_write)
+{
+  T buf[block_cnt * play_block_size * channels];
+
+  size_t blocks_avail = getBlocks(buf, block_cnt);
+  if ((blocks_avail == 0) && zerofill_on_underflow)
+  {
+    blocks_avail = 1;
+    memset(buf, 0, play_block_size * channels * sizeof(*buf));
+  }
+
+  frames_to_write = blocks_avail * play_block_size;
+  if (frames_to_write == 0)
+  {
+    return 0;
+  }
+  return snd_pcm_writei(play_handle, buf, frames_to_write);
+} /* AudioDeviceAlsa::writeBlocks */
+
+
 bool AudioDeviceAlsa::getBlockAttributes(snd_pcm_t *pcm_handle,
                                          size_t &block_size,
                                          size_t &block_count)
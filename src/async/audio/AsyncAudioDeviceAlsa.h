@@ -197,12 +197,18 @@ class AudioDeviceAlsa : public AudioDevice
     AlsaWatch   *rec_watch;
     bool        duplex;
     bool        zerofill_on_underflow;
+    snd_pcm_format_t  play_format;
+    snd_pcm_format_t  rec_format;
 
     AudioDeviceAlsa(const AudioDeviceAlsa&);
     AudioDeviceAlsa& operator=(const AudioDeviceAlsa&);
     void audioReadHandler(FdWatch *watch, unsigned short revents);
     void writeSpaceAvailable(FdWatch *watch, unsigned short revents);
-    bool initParams(snd_pcm_t *pcm_handle);
+    bool initParams(snd_pcm_t *pcm_handle, snd_pcm_format_t &format);
+    template <typename T>
+    snd_pcm_sframes_t readFrames(snd_pcm_sframes_t frame_cnt);
+    template <typename T>
+    snd_pcm_sframes_t writeBlocks(size_t block_cnt, size_t &frames_to_write);
     bool getBlockAttributes(snd_pcm_t *pcm_handle, size_t &block_size,
                             size_t &period_size);
     bool startPlayback(snd_pcm_t *pcm_handle);
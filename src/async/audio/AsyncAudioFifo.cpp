@@ -55,6 +55,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioFifo.h"
+#include "AsyncMetrics.h"
 
 
 
@@ -90,6 +91,8 @@ using namespace Async;
  *
  ****************************************************************************/
 
+static Metrics::Counter& overrunCounter(void);
+static Metrics::Counter& underrunCounter(void);
 
 
 /****************************************************************************
@@ -181,6 +184,32 @@ void AudioFifo::clear(void)
 } /* AudioFifo::clear */
 
 
+unsigned AudioFifo::skipSamples(unsigned count)
+{
+  count = min(count, samplesInFifo(true));
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  tail = (tail + count) % fifo_size;
+  is_full = false;
+
+  if (input_stopped)
+  {
+    input_stopped = false;
+    sourceResumeOutput();
+  }
+
+  if (is_flushing && empty())
+  {
+    sinkFlushSamples();
+  }
+
+  return count;
+} /* AudioFifo::skipSamples */
+
+
 void AudioFifo::setPrebufSamples(unsigned prebuf_samples)
 {
   this->prebuf_samples = min(prebuf_samples, fifo_size-1);
@@ -241,6 +270,7 @@ int AudioFifo::writeSamples(const float *samples, int count)
   }
   
   int samples_written = 0;
+  bool overwritten = false;
   if (empty() && !prebuf)
   {
     samples_written = sinkWriteSamples(samples, count);
@@ -263,10 +293,12 @@ int AudioFifo::writeSamples(const float *samples, int count)
 	  if (do_overwrite)
 	  {
       	    tail = (tail < fifo_size-1) ? tail + 1 : 0;
+            overwritten = true;
 	  }
 	  else
 	  {
 	    is_full = true;
+            overrunCounter().inc();
 	  }
 	}
       }
@@ -284,6 +316,11 @@ int AudioFifo::writeSamples(const float *samples, int count)
     output_stopped = (samples_written == 0);
   }
 
+  if (overwritten)
+  {
+    overrunCounter().inc();
+  }
+
   input_stopped = (samples_written == 0);
   
   return samples_written;
@@ -314,6 +351,12 @@ void AudioFifo::resumeOutput(void)
     output_stopped = false;
     if (buffering_enabled)
     {
+        // The sink want more samples but we have none even though the
+        // stream is neither idle nor being flushed
+      if (empty() && !is_idle && !is_flushing && !prebuf)
+      {
+        underrunCounter().inc();
+      }
       writeSamplesFromFifo();
     }
     else if (input_stopped)
@@ -409,6 +452,32 @@ void AudioFifo::writeSamplesFromFifo(void)
 
 
 
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+static Metrics::Counter& overrunCounter(void)
+{
+  static Metrics::Counter& counter = Metrics::instance().counter(
+      "async_audio_fifo_overruns_total",
+      "Number of times samples were dropped or rejected by a full audio FIFO");
+  return counter;
+} /* overrunCounter */
+
+
+static Metrics::Counter& underrunCounter(void)
+{
+  static Metrics::Counter& counter = Metrics::instance().counter(
+      "async_audio_fifo_underruns_total",
+      "Number of times an audio FIFO ran empty while its sink wanted more "
+      "samples");
+  return counter;
+} /* underrunCounter */
+
+
+
 /*
  * This file has not been truncated
  */
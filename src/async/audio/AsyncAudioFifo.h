@@ -200,6 +200,16 @@ class AudioFifo : public AudioSink, public AudioSource
      */
     void clear(void);
 
+    /**
+     * @brief   Throw away the oldest samples in the FIFO
+     * @param   count The number of samples to throw away
+     * @return  Returns the number of samples that was thrown away
+     *
+     * This function can be used to skip forward in the buffered audio, e.g.
+     * to time align two audio streams.
+     */
+    unsigned skipSamples(unsigned count);
+
     /**
      * @brief	Set the number of samples that must be in the fifo before
      *		any samples are written out from it.
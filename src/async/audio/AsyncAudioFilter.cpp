@@ -38,6 +38,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cstdlib>
 #include <cmath>
 #include <locale>
+#include <vector>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -99,6 +101,34 @@ namespace Async
 
       FidVars(void) : ff(0), run(0), func(0), buf(0) {}
   };
+
+
+  class AudioFilter::BiquadCascade
+  {
+    public:
+      static BiquadCascade *create(FidFilter *ff);
+
+      void reset(void);
+      void process(float *dest, const float *src, size_t count,
+                   float out_gain);
+
+    private:
+      double              gain;
+      std::vector<size_t> group_lanes;
+      std::vector<double> b0;
+      std::vector<double> b1;
+      std::vector<double> b2;
+      std::vector<double> a1;
+      std::vector<double> a2;
+      std::vector<double> s1;
+      std::vector<double> s2;
+      std::vector<double> work;
+
+      BiquadCascade(void) : gain(1.0) {}
+      void addSection(const double *b, size_t b_len, const double *a,
+                      size_t a_len);
+
+  }; /* AudioFilter::BiquadCascade */
 };
 
 
@@ -108,6 +138,16 @@ namespace Async
  *
  ****************************************************************************/
 
+namespace {
+  const size_t MAX_LANES = 8;
+
+  template <size_t L>
+  void runBiquadGroup(double *buf, size_t count,
+                      const double *b0, const double *b1, const double *b2,
+                      const double *a1, const double *a2, double *s1,
+                      double *s2);
+};
+
 
 
 /****************************************************************************
@@ -134,14 +174,17 @@ namespace Async
  ****************************************************************************/
 
 AudioFilter::AudioFilter(int sample_rate)
-  : sample_rate(sample_rate), fv(0), output_gain(1.0f)
+  : sample_rate(sample_rate), fv(0), biquads(0), req_backend(BACKEND_FIDLIB),
+    output_gain(1.0f)
 {
 
 } /* AudioFilter::AudioFilter */
 
 
-AudioFilter::AudioFilter(const string &filter_spec, int sample_rate)
-  : sample_rate(sample_rate), fv(0), output_gain(1.0f)
+AudioFilter::AudioFilter(const string &filter_spec, int sample_rate,
+                         Backend backend)
+  : sample_rate(sample_rate), fv(0), biquads(0), req_backend(backend),
+    output_gain(1.0f)
 {
   if (!parseFilterSpec(filter_spec))
   {
@@ -179,6 +222,7 @@ bool AudioFilter::parseFilterSpec(const std::string &filter_spec)
   }
   fv->run = fid_run_new(fv->ff, &fv->func);
   fv->buf = fid_run_newbuf(fv->run);
+  setupRunner();
   return true;
 } /* AudioFilter::parseFilterSpec */
 
@@ -192,9 +236,30 @@ void AudioFilter::setOutputGain(float gain_db)
 void AudioFilter::reset(void)
 {
   fid_run_zapbuf(fv->buf);
+  if (biquads != 0)
+  {
+    biquads->reset();
+  }
 } /* AudioFilter::reset */
 
 
+void AudioFilter::setBackend(Backend backend)
+{
+  req_backend = backend;
+  if (fv != 0)
+  {
+    reset();
+    setupRunner();
+  }
+} /* AudioFilter::setBackend */
+
+
+AudioFilter::Backend AudioFilter::backend(void) const
+{
+  return (biquads != 0) ? BACKEND_BIQUAD : BACKEND_FIDLIB;
+} /* AudioFilter::backend */
+
+
 
 /****************************************************************************
  *
@@ -207,6 +272,12 @@ void AudioFilter::processSamples(float *dest, const float *src, int count)
 {
   //cout << "AudioFilter::processSamples: len=" << len << endl;
   
+  if (biquads != 0)
+  {
+    biquads->process(dest, src, count, output_gain);
+    return;
+  }
+
   for (int i=0; i<count; ++i)
   {
     dest[i] = output_gain * fv->func(fv->buf, src[i]);
@@ -224,6 +295,8 @@ void AudioFilter::processSamples(float *dest, const float *src, int count)
 
 void AudioFilter::deleteFilter(void)
 {
+  delete biquads;
+  biquads = 0;
   if (fv != 0)
   {
     if (fv->ff != 0)
@@ -238,6 +311,251 @@ void AudioFilter::deleteFilter(void)
 } /* AudioFilter::deleteFilter */
 
 
+void AudioFilter::setupRunner(void)
+{
+  delete biquads;
+  biquads = 0;
+  if (req_backend == BACKEND_BIQUAD)
+  {
+    biquads = BiquadCascade::create(fv->ff);
+  }
+} /* AudioFilter::setupRunner */
+
+
+AudioFilter::BiquadCascade *AudioFilter::BiquadCascade::create(FidFilter *ff)
+{
+    // Pair up the sub-filters in the same way as fid_run_new does. Single
+    // coefficient FIR filters are merged into the gain and IIR filters are
+    // normalized so that their first coefficient is one.
+  BiquadCascade *bc = new BiquadCascade;
+  double gain = 1.0;
+  while (ff->len != 0)
+  {
+    if ((ff->typ == 'F') && (ff->len == 1))
+    {
+      gain *= ff->val[0];
+      ff = FFNEXT(ff);
+      continue;
+    }
+
+    const double *iir = 0;
+    size_t n_iir = 0;
+    const double *fir = 0;
+    size_t n_fir = 0;
+    if (ff->typ == 'I')
+    {
+      iir = ff->val;
+      n_iir = ff->len;
+      ff = FFNEXT(ff);
+      while ((ff->typ == 'F') && (ff->len == 1))
+      {
+        gain *= ff->val[0];
+        ff = FFNEXT(ff);
+      }
+      if (ff->typ == 'F')
+      {
+        fir = ff->val;
+        n_fir = ff->len;
+        ff = FFNEXT(ff);
+      }
+    }
+    else if (ff->typ == 'F')
+    {
+      fir = ff->val;
+      n_fir = ff->len;
+      ff = FFNEXT(ff);
+    }
+
+    if ((iir == 0) && (fir == 0))
+    {
+      delete bc;
+      return 0;
+    }
+    if ((n_iir > 3) || (n_fir > 3))
+    {
+      delete bc;
+      return 0;
+    }
+    if (n_iir > 0)
+    {
+      gain /= iir[0];
+    }
+    bc->addSection(fir, n_fir, iir, n_iir);
+  }
+  bc->gain = gain;
+
+    // Split the cascade into groups of MAX_LANES sections. The last group
+    // is rounded up to a power of two lanes using pass through sections.
+  size_t section_cnt = bc->b0.size();
+  while (section_cnt >= MAX_LANES)
+  {
+    bc->group_lanes.push_back(MAX_LANES);
+    section_cnt -= MAX_LANES;
+  }
+  if (section_cnt > 0)
+  {
+    size_t lanes = 1;
+    while (lanes < section_cnt)
+    {
+      lanes *= 2;
+    }
+    bc->group_lanes.push_back(lanes);
+    const double unity = 1.0;
+    for (; section_cnt < lanes; ++section_cnt)
+    {
+      bc->addSection(&unity, 1, 0, 0);
+    }
+  }
+  bc->s1.assign(bc->b0.size(), 0.0);
+  bc->s2.assign(bc->b0.size(), 0.0);
+
+  return bc;
+} /* AudioFilter::BiquadCascade::create */
+
+
+void AudioFilter::BiquadCascade::reset(void)
+{
+  std::fill(s1.begin(), s1.end(), 0.0);
+  std::fill(s2.begin(), s2.end(), 0.0);
+} /* AudioFilter::BiquadCascade::reset */
+
+
+void AudioFilter::BiquadCascade::process(float *dest, const float *src,
+                                         size_t count, float out_gain)
+{
+  if (work.size() < count)
+  {
+    work.resize(count);
+  }
+  std::copy(src, src + count, work.begin());
+  size_t ofs = 0;
+  for (size_t g=0; g<group_lanes.size(); ++g)
+  {
+    void (*run)(double*, size_t, const double*, const double*,
+                const double*, const double*, const double*, double*,
+                double*) = 0;
+    switch (group_lanes[g])
+    {
+      case 1: run = runBiquadGroup<1>; break;
+      case 2: run = runBiquadGroup<2>; break;
+      case 4: run = runBiquadGroup<4>; break;
+      default: run = runBiquadGroup<MAX_LANES>; break;
+    }
+    run(&work[0], count, &b0[ofs], &b1[ofs], &b2[ofs], &a1[ofs], &a2[ofs],
+        &s1[ofs], &s2[ofs]);
+    ofs += group_lanes[g];
+  }
+  const double total_gain = gain * out_gain;
+  for (size_t i=0; i<count; ++i)
+  {
+    dest[i] = total_gain * work[i];
+  }
+} /* AudioFilter::BiquadCascade::process */
+
+
+void AudioFilter::BiquadCascade::addSection(const double *b, size_t b_len,
+                                            const double *a, size_t a_len)
+{
+  const double adj = (a_len > 0) ? 1.0 / a[0] : 1.0;
+  b0.push_back((b_len > 0) ? b[0] : 1.0);
+  b1.push_back((b_len > 1) ? b[1] : 0.0);
+  b2.push_back((b_len > 2) ? b[2] : 0.0);
+  a1.push_back((a_len > 1) ? a[1] * adj : 0.0);
+  a2.push_back((a_len > 2) ? a[2] * adj : 0.0);
+} /* AudioFilter::BiquadCascade::addSection */
+
+
+namespace {
+  /*
+   * Run a group of L biquad sections in cascade over a block of samples.
+   * The sections are pipelined so that at step t, section j process sample
+   * t-j. All sections can then be updated at the same time and the output
+   * of each section is shifted into the next one for the following step.
+   * The first and last L-1 steps fill and drain the pipeline so no samples
+   * are left in it between blocks. The samples are filtered in place.
+   * State values that have decayed to almost zero are flushed at the end
+   * of the block so that the sections do not get stuck on denormal numbers
+   * when the input is silent.
+   */
+  template <size_t L>
+  void runBiquadGroup(double *buf, size_t count,
+                      const double *b0, const double *b1, const double *b2,
+                      const double *a1, const double *a2, double *s1,
+                      double *s2)
+  {
+    double B0[L], B1[L], B2[L], A1[L], A2[L], S1[L], S2[L], in[L], y[L];
+    for (size_t j=0; j<L; ++j)
+    {
+      B0[j] = b0[j];
+      B1[j] = b1[j];
+      B2[j] = b2[j];
+      A1[j] = a1[j];
+      A2[j] = a2[j];
+      S1[j] = s1[j];
+      S2[j] = s2[j];
+      in[j] = 0.0;
+    }
+
+      // Step t where section j only is updated if it has a valid sample
+    auto partial_step = [&](size_t t)
+    {
+      in[0] = (t < count) ? buf[t] : 0.0;
+      for (size_t j=0; j<L; ++j)
+      {
+        if ((t >= j) && (t - j < count))
+        {
+          y[j] = B0[j] * in[j] + S1[j];
+          S1[j] = B1[j] * in[j] - A1[j] * y[j] + S2[j];
+          S2[j] = B2[j] * in[j] - A2[j] * y[j];
+        }
+        else
+        {
+          y[j] = 0.0;
+        }
+      }
+      if ((t >= L - 1) && (t - (L - 1) < count))
+      {
+        buf[t - (L - 1)] = y[L - 1];
+      }
+      for (size_t j=L-1; j>0; --j)
+      {
+        in[j] = y[j - 1];
+      }
+    };
+
+    for (size_t t=0; t<L-1; ++t)
+    {
+      partial_step(t);
+    }
+    for (size_t t=L-1; t<count; ++t)
+    {
+      in[0] = buf[t];
+      for (size_t j=0; j<L; ++j)
+      {
+        y[j] = B0[j] * in[j] + S1[j];
+        S1[j] = B1[j] * in[j] - A1[j] * y[j] + S2[j];
+        S2[j] = B2[j] * in[j] - A2[j] * y[j];
+      }
+      buf[t - (L - 1)] = y[L - 1];
+      for (size_t j=L-1; j>0; --j)
+      {
+        in[j] = y[j - 1];
+      }
+    }
+    for (size_t t=std::max(L - 1, count); t<count+L-1; ++t)
+    {
+      partial_step(t);
+    }
+
+    for (size_t j=0; j<L; ++j)
+    {
+      s1[j] = (fabs(S1[j]) < 1.0e-30) ? 0.0 : S1[j];
+      s2[j] = (fabs(S2[j]) < 1.0e-30) ? 0.0 : S2[j];
+    }
+  }
+};
+
+
 
 /*
  * This file has not been truncated
@@ -113,6 +113,25 @@ class FidVars;
 class AudioFilter : public AudioProcessor
 {
   public:
+    /**
+     * @brief The implementation used to run the filter
+     *
+     * BACKEND_FIDLIB run the filter using the fidlib command list
+     * interpreter, in double precision, one sample at a time.
+     * BACKEND_BIQUAD convert the filter to a cascade of second order
+     * sections that are run in double precision, transposed direct form
+     * II, on a whole block of samples at a time. The sections are pipelined
+     * so that up to eight of them are updated at once using SIMD
+     * instructions.
+     * Filters that cannot be split into second order sections, like long
+     * FIR filters, are always run by fidlib.
+     */
+    typedef enum
+    {
+      BACKEND_FIDLIB, ///< The fidlib command list interpreter
+      BACKEND_BIQUAD  ///< A cascade of second order sections
+    } Backend;
+
     /**
      * @brief 	Constuctor
      * @param 	sample_rate The sampling rate
@@ -123,13 +142,15 @@ class AudioFilter : public AudioProcessor
      * @brief 	Constuctor
      * @param 	filter_spec The filter specification
      * @param 	sample_rate The sampling rate
+     * @param   backend     The implementation used to run the filter
      *
      * Use this constructor to set up at filter and call parseFilterSpec on
      * the given filter specification. If the filter creation fails, this
      * function will do an "exit(1)".
      */
     explicit AudioFilter(const std::string &filter_spec,
-      	      	      	 int sample_rate = INTERNAL_SAMPLE_RATE);
+      	      	      	 int sample_rate = INTERNAL_SAMPLE_RATE,
+                         Backend backend = BACKEND_FIDLIB);
   
     /**
      * @brief 	Destructor
@@ -171,6 +192,25 @@ class AudioFilter : public AudioProcessor
      * @brief Reset the filter state
      */
     void reset(void);
+
+    /**
+     * @brief   Choose the implementation used to run the filter
+     * @param   backend The backend to use
+     *
+     * If a filter has already been created it is set up again using the
+     * new backend and the filter state is reset.
+     */
+    void setBackend(Backend backend);
+
+    /**
+     * @brief   Get the implementation used to run the filter
+     * @return  Returns the backend that is running the current filter
+     *
+     * This is the backend chosen using setBackend unless the filter could
+     * not be converted to second order sections, in which case
+     * BACKEND_FIDLIB is returned.
+     */
+    Backend backend(void) const;
     
     
   protected:
@@ -189,14 +229,19 @@ class AudioFilter : public AudioProcessor
 
 
   private:
-    int         sample_rate;
-    FidVars   	*fv;
-    float     	output_gain;
-    std::string error_str;
+    class BiquadCascade;
+
+    int             sample_rate;
+    FidVars         *fv;
+    BiquadCascade   *biquads;
+    Backend         req_backend;
+    float           output_gain;
+    std::string     error_str;
     
     AudioFilter(const AudioFilter&);
     AudioFilter& operator=(const AudioFilter&);
     void deleteFilter(void);
+    void setupRunner(void);
 
 };  /* class AudioFilter */
 
@@ -34,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cstring>
 #include <cassert>
 #include <iostream>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -116,44 +117,6 @@ namespace Async
       CombFilter& operator=(const CombFilter&);
   
   }; /* AudioFsf::CombFilter */
-
-
-  class AudioFsf::Resonator
-  {
-    public:
-      Resonator(const size_t N, const size_t k, const float r, const float H)
-        : gain(H), coeff1(2.0*r*cos(2.0*M_PI*k/N)), coeff2(-r*r),
-          z1(0.0), z2(0.0)
-      {
-        gain /= N;
-        if ((k == 0) || (k == N/2))
-        {
-          gain /= 2.0;
-        }
-        if (k % 2 == 1)
-        {
-          gain = -gain;
-        }
-        //std::cout << "### Resonator: N=" << N << " k=" << k << " r=" << r
-        //          << " H=" << H << " gain=" << gain
-        //          << " coeff1=" << coeff1 << " coeff2=" << coeff2 << std::endl;
-      }
-
-      inline float processSample(const float& src)
-      {
-        float dest = src + z1*coeff1 + z2*coeff2;
-        z2 = z1;
-        z1 = dest;
-        return dest * gain;
-      }
-
-    private:
-      float       gain;
-      const float coeff1;
-      const float coeff2;
-      float       z1;
-      float       z2;
-  };
 };
 
 
@@ -163,6 +126,15 @@ namespace Async
  *
  ****************************************************************************/
 
+namespace {
+  void updateResonators(float* __restrict out, float* __restrict z1,
+                        float* __restrict z2, const float* __restrict coeff1,
+                        const float* __restrict coeff2,
+                        const float* __restrict gain,
+                        const float* __restrict src, size_t len,
+                        size_t stride);
+};
+
 
 
 /****************************************************************************
@@ -188,6 +160,7 @@ namespace Async
  ****************************************************************************/
 
 AudioFsf::AudioFsf(const size_t N, const float *coeff, const float r)
+  : m_res_cnt(0), m_lanes(0)
 {
   assert(N % 2 == 0);
   assert((r >= 0.0) && (r <= 1.0));
@@ -198,22 +171,35 @@ AudioFsf::AudioFsf(const size_t N, const float *coeff, const float r)
     float H = coeff[k];
     if (H > 0.0f)
     {
-      Resonator *res = new Resonator(N, k, r, H);
-      m_resonators.push_back(res);
+      float gain = H;
+      gain /= N;
+      if ((k == 0) || (k == N/2))
+      {
+        gain /= 2.0;
+      }
+      if (k % 2 == 1)
+      {
+        gain = -gain;
+      }
+      m_gain.push_back(gain);
+      m_coeff1.push_back(2.0*r*cos(2.0*M_PI*k/N));
+      m_coeff2.push_back(-r*r);
     }
   }
+  m_res_cnt = m_gain.size();
+  m_lanes = (m_res_cnt + LANE_ALIGN - 1) / LANE_ALIGN * LANE_ALIGN;
+  m_gain.resize(m_lanes, 0.0f);
+  m_coeff1.resize(m_lanes, 0.0f);
+  m_coeff2.resize(m_lanes, 0.0f);
+  m_z1.assign(m_lanes, 0.0f);
+  m_z2.assign(m_lanes, 0.0f);
+  m_comb_out.resize(CHUNK_SIZE);
+  m_res_out.resize(CHUNK_SIZE * m_lanes);
 } /* AudioFsf::AudioFsf */
 
 
 AudioFsf::~AudioFsf(void)
 {
-  for (std::vector<Resonator*>::iterator it=m_resonators.begin();
-       it!=m_resonators.end();
-       ++it)
-  {
-    delete *it;
-  }
-  m_resonators.clear();
   delete m_comb2;
   m_comb2 = 0;
   delete m_combN;
@@ -221,6 +207,42 @@ AudioFsf::~AudioFsf(void)
 } /* AudioFsf::~AudioFsf */
 
 
+void AudioFsf::processBlock(float *dest, const float *src, size_t count)
+{
+  for (size_t pos=0; pos<count; pos+=CHUNK_SIZE)
+  {
+    const size_t len = std::min<size_t>(+CHUNK_SIZE, count - pos);
+
+      // Run the comb filters over the whole chunk
+    for (size_t i=0; i<len; ++i)
+    {
+      float destN = m_combN->processSample(src[pos+i]);
+      m_comb_out[i] = m_comb2->processSample(destN);
+    }
+
+      // Update the resonators, LANE_ALIGN at a time, for the whole chunk
+    for (size_t j=0; j<m_lanes; j+=LANE_ALIGN)
+    {
+      updateResonators(&m_res_out[j], &m_z1[j], &m_z2[j], &m_coeff1[j],
+                       &m_coeff2[j], &m_gain[j], &m_comb_out[0], len,
+                       m_lanes);
+    }
+
+      // Sum the resonator outputs in resonator order
+    for (size_t i=0; i<len; ++i)
+    {
+      const float *res_out = &m_res_out[i*m_lanes];
+      float sum = 0.0f;
+      for (size_t j=0; j<m_res_cnt; ++j)
+      {
+        sum += res_out[j];
+      }
+      dest[pos+i] = sum;
+    }
+  }
+} /* AudioFsf::processBlock */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -229,18 +251,7 @@ AudioFsf::~AudioFsf(void)
 
 void AudioFsf::processSamples(float *dest, const float *src, int count)
 {
-  for (int i=0; i<count; ++i)
-  {
-    float destN = m_combN->processSample(src[i]);
-    float dest2 = m_comb2->processSample(destN);
-    dest[i] = 0.0f;
-    for (std::vector<Resonator*>::iterator it=m_resonators.begin();
-         it!=m_resonators.end();
-         ++it)
-    {
-      dest[i] += (*it)->processSample(dest2);
-    }
-  }
+  processBlock(dest, src, count);
 } /* AudioFsf::processSamples */
 
 
@@ -250,6 +261,46 @@ void AudioFsf::processSamples(float *dest, const float *src, int count)
  *
  ****************************************************************************/
 
+namespace {
+  void updateResonators(float* __restrict out, float* __restrict z1,
+                        float* __restrict z2, const float* __restrict coeff1,
+                        const float* __restrict coeff2,
+                        const float* __restrict gain,
+                        const float* __restrict src, size_t len,
+                        size_t stride)
+  {
+      // The number of lanes must be the same as AudioFsf::LANE_ALIGN. The
+      // fixed lane count keep the resonator state in registers for the
+      // whole chunk.
+    const size_t L = 8;
+    float s1[L], s2[L], c1[L], c2[L], g[L];
+    for (size_t j=0; j<L; ++j)
+    {
+      s1[j] = z1[j];
+      s2[j] = z2[j];
+      c1[j] = coeff1[j];
+      c2[j] = coeff2[j];
+      g[j] = gain[j];
+    }
+    for (size_t i=0; i<len; ++i)
+    {
+      float *o = out + i*stride;
+      for (size_t j=0; j<L; ++j)
+      {
+        float dest = src[i] + s1[j]*c1[j] + s2[j]*c2[j];
+        s2[j] = s1[j];
+        s1[j] = dest;
+        o[j] = dest * g[j];
+      }
+    }
+    for (size_t j=0; j<L; ++j)
+    {
+      z1[j] = s1[j];
+      z2[j] = s2[j];
+    }
+  }
+};
+
 
 
 /*
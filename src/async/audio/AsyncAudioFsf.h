@@ -165,6 +165,12 @@ That value has been looked up in the table mentioned above. All other positions
 must be set to 0 to form the stop band. The dampening factor 'r' should be left
 at its default unless there is a good reason to change it.
 
+The samples are processed in blocks. The comb filters are run over the whole
+block first. The resonator bank is then updated over the whole block, eight
+resonators at a time, so that the compiler can use SIMD instructions.
+The resonator outputs are summed in the same order for every sample, so
+the result is the same as updating the resonators one at a time.
+
 \image html AsyncAudioFsfExample.png "Example filter frequency response (blue) and phase response (red)"
 
 \include AsyncAudioFsf_demo.cpp
@@ -191,6 +197,19 @@ class AudioFsf : public Async::AudioProcessor
      */
     ~AudioFsf(void);
 
+    /**
+     * @brief   Filter a block of samples
+     * @param   dest  Destination buffer
+     * @param   src   Source buffer
+     * @param   count Number of samples in the source buffer
+     *
+     * Use this function to run the filter on a block of samples without
+     * connecting it to an audio pipe. The filter state is shared with the
+     * audio pipe so the two ways of feeding the filter should not be mixed.
+     * The destination and source buffers may be the same.
+     */
+    void processBlock(float *dest, const float *src, size_t count);
+
   protected:
     /**
      * @brief Process incoming samples and put them into the output buffer
@@ -204,11 +223,25 @@ class AudioFsf : public Async::AudioProcessor
 
   private:
     class CombFilter;
-    class Resonator;
+
+    static const size_t CHUNK_SIZE = 64;
+    static const size_t LANE_ALIGN = 8;
 
     CombFilter *            m_combN;
     CombFilter *            m_comb2;
-    std::vector<Resonator*> m_resonators;
+
+      // The resonator bank stored as one array per resonator parameter. The
+      // arrays are padded to a multiple of LANE_ALIGN with resonators that
+      // have zero gain.
+    size_t                  m_res_cnt;
+    size_t                  m_lanes;
+    std::vector<float>      m_gain;
+    std::vector<float>      m_coeff1;
+    std::vector<float>      m_coeff2;
+    std::vector<float>      m_z1;
+    std::vector<float>      m_z2;
+    std::vector<float>      m_comb_out;
+    std::vector<float>      m_res_out;
 
     AudioFsf(const AudioFsf&);
     AudioFsf& operator=(const AudioFsf&);
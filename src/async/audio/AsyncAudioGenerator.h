@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <cmath>
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -46,6 +47,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncAudioSource.h>
+#include <AsyncAudioNco.h>
 
 
 /****************************************************************************
@@ -115,6 +117,8 @@ This means that a sink have to be connected before enabling the generator or
 the application will get stuck. There also must be some form of flow control
 downstream in the audio pipe. One way to get flow control, if there are none
 naturally, is to use an Async::AudioPacer.
+
+Sine waves are generated using an Async::AudioNco.
 */
 class AudioGenerator : public Async::AudioSource
 {
@@ -165,6 +169,7 @@ class AudioGenerator : public Async::AudioSource
     {
       m_arginc = 2.0f * M_PI * tone_fq / m_sample_rate;
       assert(m_arginc <= M_PI);
+      m_nco.setTone(tone_fq, m_peak);
     }
 
     /**
@@ -191,6 +196,7 @@ class AudioGenerator : public Async::AudioSource
       if (enable)
       {
         m_arg = 0.0f;
+        m_nco.reset();
         writeSamples();
       }
       else
@@ -231,6 +237,7 @@ class AudioGenerator : public Async::AudioSource
     Waveform  m_waveform;
     float     m_power;
     bool      m_enabled;
+    AudioNco  m_nco;
 
     AudioGenerator(const AudioGenerator&);
     AudioGenerator& operator=(const AudioGenerator&);
@@ -256,6 +263,7 @@ class AudioGenerator : public Async::AudioSource
           m_peak = 0.0f;
           break;
       }
+      m_nco.setAmplitude(m_peak);
     }
 
     /**
@@ -267,14 +275,21 @@ class AudioGenerator : public Async::AudioSource
       do
       {
         float buf[BLOCK_SIZE];
+        if (m_waveform == SIN)
+        {
+          m_nco.generate(buf, BLOCK_SIZE);
+          written = sinkWriteSamples(buf, BLOCK_SIZE);
+          if (written < BLOCK_SIZE)
+          {
+            m_nco.seek(std::max(written, 0) - BLOCK_SIZE);
+          }
+          continue;
+        }
         float arg = m_arg;
         for (int i=0; i<BLOCK_SIZE; ++i)
         {
           switch (m_waveform)
           {
-            case SIN:
-              buf[i] = m_peak * sinf(arg);
-              break;
             case SQUARE:
               buf[i] = (arg < M_PI) ? m_peak : -m_peak;
               break;
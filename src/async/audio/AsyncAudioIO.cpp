@@ -385,6 +385,23 @@ void AudioIO::close(void)
 } /* AudioIO::close */
 
 
+int AudioIO::samplesToWrite(void) const
+{
+  if ((io_mode != MODE_WR) && (io_mode != MODE_RDWR))
+  {
+    return -1;
+  }
+
+  int dev_samples = audio_dev->samplesToWrite();
+  if (dev_samples < 0)
+  {
+    return -1;
+  }
+
+  return dev_samples + input_fifo->samplesInFifo(true);
+} /* AudioIO::samplesToWrite */
+
+
 
 /****************************************************************************
  *
@@ -459,9 +476,9 @@ bool AudioIO::isIdle(void) const
 } /* AudioIO::isIdle */
 
 
-int AudioIO::audioRead(float *samples, int count)
+int AudioIO::audioRead(const AudioBlockPtr& block)
 {
-  return sinkWriteSamples(samples, count);
+  return sinkWriteAudioBlock(block);
 } /* AudioIO::audioRead */
 
 
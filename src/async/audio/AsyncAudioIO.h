@@ -248,9 +248,11 @@ class AudioIO : public Async::AudioSource, public Async::AudioSink
      * This function can be used to find out how many samples there are
      * in the output buffer at the moment. This can for example be used
      * to find out how long it will take before the output buffer has
-     * been flushed.
+     * been flushed. It can also be used to lock the pace of an audio source
+     * to the sound card clock (see Async::AudioPacer::setClockSource).
+     * The count is given in the sample rate of the audio device.
      */
-    //int samplesToWrite(void) const;
+    int samplesToWrite(void) const;
     
     /*
      * @brief 	Call this method to clear all samples in the buffer
@@ -362,7 +364,7 @@ class AudioIO : public Async::AudioSource, public Async::AudioSink
     int readSamples(float *samples, int count);
     bool doFlush(void) const;
     bool isIdle(void) const;
-    int audioRead(float *samples, int count);
+    int audioRead(const AudioBlockPtr& block);
     unsigned samplesAvailable(void);
 
 };  /* class AudioIO */
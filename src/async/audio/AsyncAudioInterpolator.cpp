@@ -27,7 +27,7 @@ ANY KIND. See http://www.dspguru.com/wol.htm for more information.
  *
  ****************************************************************************/
 
-#include <cstring>
+#include <cassert>
 
 
 /****************************************************************************
@@ -45,6 +45,7 @@ ANY KIND. See http://www.dspguru.com/wol.htm for more information.
  ****************************************************************************/
 
 #include "AsyncAudioInterpolator.h"
+#include "AsyncAudioVectorOps.h"
 
 
 
@@ -108,23 +109,30 @@ using namespace Async;
 
 AudioInterpolator::AudioInterpolator(int interpolation_factor,
       	      	      	      	     const float *filter_coeff, int taps)
-  : factor_L(interpolation_factor), L_size(taps), p_H(filter_coeff)
+  : factor_L(interpolation_factor), taps_per_phase(taps / factor_L),
+    H_phase(factor_L * taps_per_phase), Z(2 * taps_per_phase, 0.0f), Z_pos(0)
 {
-  //p_H = new float[taps];
-  //memcpy(p_H, filter_coeff, taps * sizeof(*p_H));
-  
   setInputOutputSampleRate(1, factor_L);
 
-    // FIXME: What if L_size does not divide evenly with factor_L?
-  size_t p_Z_size = L_size / factor_L;
-  p_Z = new float[p_Z_size];
-  memset(p_Z, 0, sizeof(*p_Z) * p_Z_size);
+    // FIXME: What if taps does not divide evenly with factor_L?
+    // Split the filter into one subfilter per phase. Since the delay line is
+    // stored oldest sample first, the coefficients are stored in reverse
+    // order. The gain loss caused by the zero stuffing is compensated for by
+    // prescaling the coefficients.
+  for (int phase_num = 0; phase_num < factor_L; phase_num++)
+  {
+    float *p_phase = H_phase.data() + phase_num * taps_per_phase;
+    for (int tap = 0; tap < taps_per_phase; tap++)
+    {
+      p_phase[taps_per_phase - 1 - tap] =
+        filter_coeff[tap * factor_L + phase_num] * factor_L;
+    }
+  }
 } /* AudioInterpolator::AudioInterpolator */
 
 
 AudioInterpolator::~AudioInterpolator(void)
 {
-  delete [] p_Z;
 } /* AudioInterpolator::~AudioInterpolator */
 
 
@@ -139,31 +147,25 @@ AudioInterpolator::~AudioInterpolator(void)
 void AudioInterpolator::processSamples(float *dest, const float *src, int count)
 {
   int orig_count = count;
-  int num_taps_per_phase = L_size / factor_L;
-  
+
   int num_out = 0;
   while (count-- > 0)
   {
-      // shift Z delay line up to make room for next sample
-    memmove(p_Z + 1, p_Z, (num_taps_per_phase - 1) * sizeof(float));
-
-      // copy next sample from input buffer to bottom of Z delay line
-    p_Z[0] = *src++;
+      // copy next sample from input buffer into both halves of the
+      // mirrored Z delay line
+    Z[Z_pos] = Z[Z_pos + taps_per_phase] = *src++;
+    if (++Z_pos >= taps_per_phase)
+    {
+      Z_pos = 0;
+    }
 
-      // calculate outputs
+      // calculate outputs. The last taps_per_phase samples, oldest first,
+      // are found contiguously starting at Z_pos.
+    const float *p_Z = Z.data() + Z_pos;
     for (int phase_num = 0; phase_num < factor_L; phase_num++)
     {
-      	// point to the current polyphase filter
-      const float *p_coeff = p_H + phase_num;
-
-      	// calculate FIR sum
-      float sum = 0.0;
-      for (int tap = 0; tap < num_taps_per_phase; tap++)
-      {
-        sum += *p_coeff * p_Z[tap];
-        p_coeff += factor_L;          /* point to next coefficient */
-      }
-      *dest++ = sum * factor_L; /* store scaled sum and point to next output */
+      *dest++ = dotProduct(H_phase.data() + phase_num * taps_per_phase, p_Z,
+                           taps_per_phase);
       num_out++;
     }
   }
@@ -29,6 +29,7 @@ ANY KIND. See http://www.dspguru.com/wol.htm for more information.
  *
  ****************************************************************************/
 
+#include <vector>
 
 
 /****************************************************************************
@@ -113,6 +114,12 @@ http://www.dsptutor.freeuk.com/remez/RemezFIRFilterDesign.html
 
 This implementation is based on the multirate FAQ at dspguru.com:
 http://dspguru.com/info/faqs/mrfaq.htm
+
+The filter is split up into one polyphase subfilter per output phase. The
+coefficients for each subfilter are stored contiguously, in reversed order and
+prescaled with the interpolation factor. The delay line is a mirrored circular
+buffer so that each output sample is calculated as one contiguous dot product
+without moving any samples.
 */
 class AudioInterpolator : public Async::AudioProcessor
 {
@@ -148,10 +155,11 @@ class AudioInterpolator : public Async::AudioProcessor
 
     
   private:
-    const int 	factor_L;
-    float     	*p_Z;
-    int       	L_size;
-    const float *p_H;
+    const int           factor_L;
+    const int           taps_per_phase;
+    std::vector<float>  H_phase;
+    std::vector<float>  Z;
+    int                 Z_pos;
 
     AudioInterpolator(const AudioInterpolator&);
     AudioInterpolator& operator=(const AudioInterpolator&);
@@ -0,0 +1,311 @@
+/**
+@file	 AsyncAudioNco.cpp
+@brief   A numerically controlled oscillator for generating tones
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+This file contains a numerically controlled oscillator that is used by the
+tone generators to synthesize sine waves without calling sin() per sample.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cmath>
+#include <cstring>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioNco.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // Build an AVX2 variant of the synthesis loop in addition to the default
+  // one, just like in AsyncAudioVectorOps.cpp.
+#if defined(__x86_64__) && defined(__linux__) && defined(__has_attribute)
+#  if __has_attribute(target_clones)
+#    define TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+#  endif
+#endif
+#ifndef TARGET_CLONES
+#  define TARGET_CLONES
+#endif
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+    // The upper TABLE_BITS bits of the phase select a table entry and the
+    // rest of the bits are used to interpolate to the next entry
+  const unsigned TABLE_BITS = 10;
+  const size_t   TABLE_SIZE = 1 << TABLE_BITS;
+  const unsigned FRAC_BITS = 32 - TABLE_BITS;
+  const uint32_t FRAC_MASK = (1U << FRAC_BITS) - 1;
+  const float    FRAC_SCALE = 1.0f / (1U << FRAC_BITS);
+
+  struct SineTable
+  {
+    float value[TABLE_SIZE];
+    float slope[TABLE_SIZE];
+
+    SineTable(void)
+    {
+      for (size_t i=0; i<TABLE_SIZE; ++i)
+      {
+        double v0 = sin(2.0 * M_PI * i / TABLE_SIZE);
+        double v1 = sin(2.0 * M_PI * (i + 1) / TABLE_SIZE);
+        value[i] = v0;
+        slope[i] = v1 - v0;
+      }
+    }
+  };
+}; /* End of anonymous namespace */
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+static const SineTable& sineTable(void);
+static void synthTone(float* dest, size_t count, uint32_t phase,
+                      uint32_t phase_inc, float amp, bool add);
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioNco::AudioNco(unsigned sample_rate)
+  : m_sample_rate(sample_rate), m_tone_cnt(0)
+{
+  sineTable();
+} /* AudioNco::AudioNco */
+
+
+void AudioNco::setSampleRate(unsigned sample_rate)
+{
+  m_sample_rate = sample_rate;
+  for (size_t i=0; i<m_tone_cnt; ++i)
+  {
+    m_tones[i].phase_inc = phaseIncrement(m_tones[i].fq);
+  }
+} /* AudioNco::setSampleRate */
+
+
+void AudioNco::setTone(double fq, float amp)
+{
+  clearTones();
+  addTone(fq, amp);
+} /* AudioNco::setTone */
+
+
+bool AudioNco::addTone(double fq, float amp)
+{
+  if (m_tone_cnt >= MAX_TONES)
+  {
+    return false;
+  }
+  Tone& tone = m_tones[m_tone_cnt++];
+  tone.fq = fq;
+  tone.amp = amp;
+  tone.phase = 0;
+  tone.phase_inc = phaseIncrement(fq);
+  return true;
+} /* AudioNco::addTone */
+
+
+void AudioNco::setAmplitude(float amp)
+{
+  for (size_t i=0; i<m_tone_cnt; ++i)
+  {
+    m_tones[i].amp = amp;
+  }
+} /* AudioNco::setAmplitude */
+
+
+void AudioNco::reset(void)
+{
+  for (size_t i=0; i<m_tone_cnt; ++i)
+  {
+    m_tones[i].phase = 0;
+  }
+} /* AudioNco::reset */
+
+
+void AudioNco::seek(long offset)
+{
+    // The phase wrap around modulo 2^32 so a negative offset work as well
+  for (size_t i=0; i<m_tone_cnt; ++i)
+  {
+    m_tones[i].phase += static_cast<uint32_t>(offset) * m_tones[i].phase_inc;
+  }
+} /* AudioNco::seek */
+
+
+void AudioNco::generate(float *dest, size_t count)
+{
+  if (m_tone_cnt == 0)
+  {
+    memset(dest, 0, count * sizeof(*dest));
+    return;
+  }
+
+  for (size_t i=0; i<m_tone_cnt; ++i)
+  {
+    Tone& tone = m_tones[i];
+    synthTone(dest, count, tone.phase, tone.phase_inc, tone.amp, i > 0);
+    tone.phase += static_cast<uint32_t>(count) * tone.phase_inc;
+  }
+} /* AudioNco::generate */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+uint32_t AudioNco::phaseIncrement(double fq) const
+{
+  double cycles = fq / m_sample_rate;
+  cycles -= floor(cycles);
+  return static_cast<uint32_t>(llround(cycles * 4294967296.0));
+} /* AudioNco::phaseIncrement */
+
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+static const SineTable& sineTable(void)
+{
+  static const SineTable table;
+  return table;
+} /* sineTable */
+
+
+TARGET_CLONES
+static void synthTone(float* dest, size_t count, uint32_t phase,
+                      uint32_t phase_inc, float amp, bool add)
+{
+  const SineTable& tab = sineTable();
+  if (add)
+  {
+    for (size_t i=0; i<count; ++i)
+    {
+      uint32_t ph = phase + static_cast<uint32_t>(i) * phase_inc;
+      uint32_t idx = ph >> FRAC_BITS;
+      float frac = static_cast<float>(ph & FRAC_MASK) * FRAC_SCALE;
+      dest[i] += amp * (tab.value[idx] + frac * tab.slope[idx]);
+    }
+  }
+  else
+  {
+    for (size_t i=0; i<count; ++i)
+    {
+      uint32_t ph = phase + static_cast<uint32_t>(i) * phase_inc;
+      uint32_t idx = ph >> FRAC_BITS;
+      float frac = static_cast<float>(ph & FRAC_MASK) * FRAC_SCALE;
+      dest[i] = amp * (tab.value[idx] + frac * tab.slope[idx]);
+    }
+  }
+} /* synthTone */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,243 @@
+/**
+@file	 AsyncAudioNco.h
+@brief   A numerically controlled oscillator for generating tones
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+This file contains a numerically controlled oscillator that is used by the
+tone generators to synthesize sine waves without calling sin() per sample.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_NCO_INCLUDED
+#define ASYNC_AUDIO_NCO_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstddef>
+#include <stdint.h>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A numerically controlled oscillator
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-19
+
+This class generate the sum of one or more sine waves. Each tone has a 32 bit
+phase accumulator, which give a frequency resolution of a few micro Hz and no
+phase drift no matter how long the tone is played. The sine value is looked
+up in a table with linear interpolation between the table entries. The error
+is less than 5e-6 of the amplitude, which put all spurious tones more than
+100 dB below the carrier.
+
+Samples are generated a block at a time in a loop that the compiler can
+vectorize. Since the phase of each tone is a simple function of the sample
+position, the oscillator can be moved backwards or forwards in time using
+the seek function, e.g. when a sink did not accept all generated samples.
+
+\code
+Async::AudioNco nco(16000);
+nco.addTone(697, 0.5f);
+nco.addTone(1209, 0.5f);
+float buf[160];
+nco.generate(buf, 160);
+\endcode
+*/
+class AudioNco
+{
+  public:
+      /// The maximum number of simultaneous tones
+    static constexpr size_t MAX_TONES = 4;
+
+    /**
+     * @brief 	Constuctor
+     * @param 	sample_rate The sample rate of the generated signal
+     */
+    explicit AudioNco(unsigned sample_rate=INTERNAL_SAMPLE_RATE);
+
+    /**
+     * @brief 	Set the sample rate
+     * @param 	sample_rate The sample rate of the generated signal
+     *
+     * The frequency of all tones are kept.
+     */
+    void setSampleRate(unsigned sample_rate);
+
+    /**
+     * @brief 	Get the sample rate
+     * @return	Returns the sample rate of the generated signal
+     */
+    unsigned sampleRate(void) const { return m_sample_rate; }
+
+    /**
+     * @brief 	Set a single tone
+     * @param 	fq  The frequency of the tone in Hz
+     * @param 	amp The peak amplitude of the tone
+     *
+     * All previously added tones are removed. The phase of the tone is set
+     * to zero.
+     */
+    void setTone(double fq, float amp);
+
+    /**
+     * @brief 	Add a tone
+     * @param 	fq  The frequency of the tone in Hz
+     * @param 	amp The peak amplitude of the tone
+     * @return	Returns \em false if the maximum number of tones is reached
+     *
+     * The phase of the new tone is set to zero.
+     */
+    bool addTone(double fq, float amp);
+
+    /**
+     * @brief 	Change the amplitude of all tones
+     * @param 	amp The peak amplitude of each tone
+     */
+    void setAmplitude(float amp);
+
+    /**
+     * @brief 	Remove all tones
+     */
+    void clearTones(void) { m_tone_cnt = 0; }
+
+    /**
+     * @brief 	Get the number of tones
+     * @return	Returns the number of tones that are generated
+     */
+    size_t toneCount(void) const { return m_tone_cnt; }
+
+    /**
+     * @brief 	Set the phase of all tones to zero
+     */
+    void reset(void);
+
+    /**
+     * @brief 	Move the oscillator in time
+     * @param 	offset The number of samples to move, negative to go back
+     */
+    void seek(long offset);
+
+    /**
+     * @brief 	Generate samples
+     * @param 	dest  The buffer to write the samples to
+     * @param 	count The number of samples to generate
+     *
+     * The sum of all tones are written to the buffer. If there are no
+     * tones, the buffer is filled with zeros.
+     */
+    void generate(float *dest, size_t count);
+
+  private:
+    struct Tone
+    {
+      double    fq;
+      float     amp;
+      uint32_t  phase;
+      uint32_t  phase_inc;
+    };
+
+    unsigned  m_sample_rate;
+    Tone      m_tones[MAX_TONES];
+    size_t    m_tone_cnt;
+
+    uint32_t phaseIncrement(double fq) const;
+
+};  /* class AudioNco */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_NCO_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
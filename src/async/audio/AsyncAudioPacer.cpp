@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2008 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -33,6 +33,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <stdio.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
 
 #include <algorithm>
 #include <cstring>
@@ -45,7 +47,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncApplication.h>
 #include <AsyncTimer.h>
+#include <AsyncFdWatch.h>
+#include <AsyncAudioIO.h>
 
 
 /****************************************************************************
@@ -75,6 +80,17 @@ using namespace Async;
  *
  ****************************************************************************/
 
+#define NSEC_PER_SEC  1000000000LL
+
+  // Resynchronize the clock if this many blocks late
+#define MAX_BLOCKS_LATE 4
+
+  // Time to let the clock source settle before recording the fill level (ms)
+#define CLOCK_SRC_SETTLE_TIME 500
+
+  // Max adjustment of the pace when following a clock source (ppm)
+#define CLOCK_SRC_MAX_PPM 1000
+
 
 
 /****************************************************************************
@@ -119,7 +135,10 @@ using namespace Async;
 
 AudioPacer::AudioPacer(int sample_rate, int block_size, int prebuf_time)
   : sample_rate(sample_rate), buf_size(block_size), prebuf_time(prebuf_time),
-    buf_pos(0), pace_timer(0), do_flush(false), input_stopped(false)
+    buf_pos(0), pace_timer(0), timer_fd(-1), timer_watch(0),
+    clock_running(false), use_timer_fd(false), clock_samples(0),
+    clock_adjust_ns(0), clock_src(0), clock_src_cnt(0), clock_src_fill(0.0),
+    clock_src_target(0.0), do_flush(false), input_stopped(false)
 {
   assert(sample_rate > 0);
   assert(block_size > 0);
@@ -128,20 +147,29 @@ AudioPacer::AudioPacer(int sample_rate, int block_size, int prebuf_time)
   buf = new float[buf_size];
   prebuf_samples = prebuf_time * sample_rate / 1000;
   
-  pace_timer = new Timer(buf_size * 1000 / sample_rate,
-       	      	      	 Timer::TYPE_PERIODIC);
-  pace_timer->expired.connect(mem_fun(*this, &AudioPacer::outputNextBlock));
-  
-  if (prebuf_samples > 0)
+  clock_start.tv_sec = 0;
+  clock_start.tv_nsec = 0;
+
+  pace_timer = new Timer(0, Timer::TYPE_ONESHOT, false);
+  pace_timer->expired.connect(mem_fun(*this, &AudioPacer::paceTimerExpired));
+
+  timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timer_fd >= 0)
   {
-    pace_timer->setEnable(false);
+    timer_watch = new FdWatch(timer_fd, FdWatch::FD_WATCH_RD);
+    timer_watch->activity.connect(
+        mem_fun(*this, &AudioPacer::timerFdActivity));
   }
-  
 } /* AudioPacer::AudioPacer */
 
 
 AudioPacer::~AudioPacer(void)
 {
+  delete timer_watch;
+  if (timer_fd >= 0)
+  {
+    close(timer_fd);
+  }
   delete pace_timer;
   delete [] buf;
 } /* AudioPacer::~AudioPacer */
@@ -175,7 +203,7 @@ int AudioPacer::writeSamples(const float *samples, int count)
 	samples_written += writeSamples(samples + samples_written,
 	      	      	      	      	samples_left);
       }
-      pace_timer->setEnable(true);
+      startClock();
     }
     else
     {
@@ -192,10 +220,7 @@ int AudioPacer::writeSamples(const float *samples, int count)
     memcpy(buf + buf_pos, samples, samples_written * sizeof(*buf));
     buf_pos += samples_written;
     
-    if (!pace_timer->isEnabled())
-    {
-      pace_timer->setEnable(true);
-    }
+    startClock();
   }
   
   if (samples_written == 0)
@@ -224,10 +249,17 @@ void AudioPacer::resumeOutput(void)
 {
   if (prebuf_samples <= 0)
   {
-    pace_timer->setEnable(true);
+    startClock();
     outputNextBlock();
   }
 } /* AudioPacer::resumeOutput */
+
+
+void AudioPacer::setClockSource(const AudioIO *io)
+{
+  clock_src = io;
+  clock_src_cnt = 0;
+} /* AudioPacer::setClockSource */
     
 
 
@@ -254,12 +286,200 @@ void AudioPacer::allSamplesFlushed(void)
  *
  ****************************************************************************/
 
+void AudioPacer::startClock(void)
+{
+  if (clock_running)
+  {
+    return;
+  }
+  clock_running = true;
+  use_timer_fd = (timer_fd >= 0) && !Application::app().virtualTime();
+  Application::app().getMonotonicTime(clock_start);
+  clock_samples = 0;
+  clock_adjust_ns = 0;
+  clock_src_cnt = 0;
+  scheduleNextBlock();
+} /* AudioPacer::startClock */
+
+
+void AudioPacer::stopClock(void)
+{
+  if (!clock_running)
+  {
+    return;
+  }
+  clock_running = false;
+  pace_timer->setEnable(false);
+  if (timer_fd >= 0)
+  {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    timerfd_settime(timer_fd, 0, &its, 0);
+  }
+} /* AudioPacer::stopClock */
+
+
+void AudioPacer::nextDeadline(struct timespec& ts) const
+{
+    // Calculate the deadline from the sample count to not accumulate
+    // rounding errors
+  int64_t ns = static_cast<int64_t>(clock_samples + buf_size) *
+               NSEC_PER_SEC / sample_rate + clock_adjust_ns;
+  ts.tv_sec = clock_start.tv_sec + ns / NSEC_PER_SEC;
+  ts.tv_nsec = clock_start.tv_nsec + ns % NSEC_PER_SEC;
+  if (ts.tv_nsec >= NSEC_PER_SEC)
+  {
+    ts.tv_sec += 1;
+    ts.tv_nsec -= NSEC_PER_SEC;
+  }
+  else if (ts.tv_nsec < 0)
+  {
+    ts.tv_sec -= 1;
+    ts.tv_nsec += NSEC_PER_SEC;
+  }
+} /* AudioPacer::nextDeadline */
+
+
+void AudioPacer::scheduleNextBlock(void)
+{
+  struct timespec deadline;
+  nextDeadline(deadline);
+
+  if (use_timer_fd)
+  {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value = deadline;
+    if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, 0) == 0)
+    {
+      return;
+    }
+    perror("timerfd_settime in AudioPacer::scheduleNextBlock");
+    use_timer_fd = false;
+  }
+
+  struct timespec now;
+  Application::app().getMonotonicTime(now);
+  int64_t ns = (deadline.tv_sec - now.tv_sec) * NSEC_PER_SEC +
+               (deadline.tv_nsec - now.tv_nsec);
+  int timeout_ms = (ns > 0) ? (ns + 999999) / 1000000 : 0;
+  pace_timer->setEnable(false);
+  pace_timer->setTimeout(timeout_ms);
+  pace_timer->setEnable(true);
+} /* AudioPacer::scheduleNextBlock */
+
+
+void AudioPacer::followClockSource(void)
+{
+  int fill = clock_src->samplesToWrite();
+  if ((fill < 0) || (clock_src->sampleRate() <= 0))
+  {
+    clock_src_cnt = 0;
+    return;
+  }
+
+  double fill_time = static_cast<double>(fill) / clock_src->sampleRate();
+  if (clock_src_cnt == 0)
+  {
+    clock_src_fill = fill_time;
+  }
+  else
+  {
+    clock_src_fill += (fill_time - clock_src_fill) / 16.0;
+  }
+  clock_src_cnt += 1;
+
+  const unsigned settle_blocks =
+      CLOCK_SRC_SETTLE_TIME * sample_rate / (1000 * buf_size) + 1;
+  if (clock_src_cnt <= settle_blocks)
+  {
+    clock_src_target = clock_src_fill;
+    return;
+  }
+
+    // If the fill level grow, the sound card is slower than the system
+    // clock so the next deadline is moved forward a bit, and vice versa.
+  const double max_adjust =
+      static_cast<double>(buf_size) * NSEC_PER_SEC / sample_rate *
+      CLOCK_SRC_MAX_PPM / 1000000.0;
+  double adjust = (clock_src_fill - clock_src_target) * NSEC_PER_SEC / 64.0;
+  adjust = min(max(adjust, -max_adjust), max_adjust);
+  clock_adjust_ns += static_cast<int64_t>(adjust);
+} /* AudioPacer::followClockSource */
+
+
+void AudioPacer::paceTimerExpired(Timer *t)
+{
+  if (!use_timer_fd)
+  {
+    clockTick();
+  }
+} /* AudioPacer::paceTimerExpired */
+
+
+void AudioPacer::timerFdActivity(FdWatch *w)
+{
+  uint64_t expirations;
+  if (read(timer_fd, &expirations, sizeof(expirations)) < 0)
+  {
+    return;
+  }
+  if (use_timer_fd)
+  {
+    clockTick();
+  }
+} /* AudioPacer::timerFdActivity */
+
+
+void AudioPacer::clockTick(void)
+{
+  if (!clock_running)
+  {
+    return;
+  }
+
+  struct timespec deadline, now;
+  nextDeadline(deadline);
+  Application::app().getMonotonicTime(now);
+  int64_t late_ns = (now.tv_sec - deadline.tv_sec) * NSEC_PER_SEC +
+                    (now.tv_nsec - deadline.tv_nsec);
+  if (late_ns > MAX_BLOCKS_LATE * buf_size * NSEC_PER_SEC / sample_rate)
+  {
+      // We have been blocked for a long time so start over instead of
+      // trying to catch up
+    clock_start = now;
+    clock_samples = 0;
+    clock_adjust_ns = 0;
+  }
+  else
+  {
+    clock_samples += buf_size;
+    if (clock_samples >= static_cast<uint64_t>(sample_rate))
+    {
+      clock_samples -= sample_rate;
+      clock_start.tv_sec += 1;
+    }
+  }
+
+  if (clock_src != 0)
+  {
+    followClockSource();
+  }
+
+  outputNextBlock();
+
+  if (clock_running)
+  {
+    scheduleNextBlock();
+  }
+} /* AudioPacer::clockTick */
+
 
-void AudioPacer::outputNextBlock(Timer *t)
+void AudioPacer::outputNextBlock(void)
 {
   if (buf_pos < buf_size)
   {
-    pace_timer->setEnable(false);
+    stopClock();
     prebuf_samples = prebuf_time * sample_rate / 1000;
   }
   
@@ -291,7 +511,7 @@ void AudioPacer::outputNextBlock(Timer *t)
   
   if (samples_written == 0)
   {
-    pace_timer->setEnable(false);
+    stopClock();
   }
   
   if (input_stopped && (buf_pos < buf_size))
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2008 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -37,6 +37,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sigc++/sigc++.h>
 
+#include <stdint.h>
+#include <time.h>
+
 
 /****************************************************************************
  *
@@ -81,6 +84,8 @@ namespace Async
  ****************************************************************************/
 
 class Timer;
+class FdWatch;
+class AudioIO;
   
 
 /****************************************************************************
@@ -111,6 +116,21 @@ class Timer;
 @date   2007-11-17
 
 This class is used in an audio pipe chain to pace audio output.
+
+Blocks are output at absolute deadlines on the monotonic clock. The deadline
+for each block is calculated from the number of samples that have been output
+since the pacer was started so the output rate is exactly the sample rate,
+even if the block time is not a whole number of milliseconds. On Linux the
+deadlines are kept using a timerfd. If that is not available, or if the
+application run on a virtual clock (see Async::Application::virtualTime), an
+Async::Timer is used instead. The pace is still drift free in that case but
+each block may be output up to a millisecond late.
+
+The sound card clock is never exactly the same as the system clock. If the
+paced audio is played on a sound card, the pacer can be locked to the sound
+card clock using the setClockSource function. This make it possible to use
+small buffers in the audio pipe without getting over- or underruns in long
+transmissions.
 */
 class AudioPacer : public AudioSink, public AudioSource, public sigc::trackable
 {
@@ -159,6 +179,20 @@ class AudioPacer : public AudioSink, public AudioSource, public sigc::trackable
      * This function is normally only called from a connected sink object.
      */
     virtual void resumeOutput(void);
+
+    /**
+     * @brief   Lock the pace to the clock of an audio device
+     * @param   io The audio object to follow or 0 to use the system clock
+     *
+     * When a clock source is set, the pacer will watch the number of samples
+     * buffered for the given audio object. The fill level is recorded half a
+     * second after the pacer has been started. After that, the pace is
+     * adjusted slightly, at most 1000ppm, to keep the fill level constant.
+     * The audio object must be opened for writing for the adjustment to take
+     * place. It is only meaningful to use this function if the audio from
+     * the pacer end up in the given audio object.
+     */
+    void setClockSource(const AudioIO *io);
     
 
   protected:
@@ -181,10 +215,29 @@ class AudioPacer : public AudioSink, public AudioSource, public sigc::trackable
     int       	  buf_pos;
     int       	  prebuf_samples;
     Async::Timer  *pace_timer;
+    int           timer_fd;
+    FdWatch       *timer_watch;
+    bool          clock_running;
+    bool          use_timer_fd;
+    struct timespec clock_start;
+    uint64_t      clock_samples;
+    int64_t       clock_adjust_ns;
+    const AudioIO *clock_src;
+    unsigned      clock_src_cnt;
+    double        clock_src_fill;
+    double        clock_src_target;
     bool      	  do_flush;
     bool      	  input_stopped;
     
-    void outputNextBlock(Async::Timer *t=0);
+    void startClock(void);
+    void stopClock(void);
+    void nextDeadline(struct timespec& ts) const;
+    void scheduleNextBlock(void);
+    void followClockSource(void);
+    void paceTimerExpired(Async::Timer *t);
+    void timerFdActivity(FdWatch *w);
+    void clockTick(void);
+    void outputNextBlock(void);
 
 };  /* class AudioPacer */
 
@@ -118,7 +118,7 @@ using namespace Async;
 AudioProcessor::AudioProcessor(void)
   : buf_cnt(0), do_flush(false), input_stopped(false),
     output_stopped(false), input_rate(1), output_rate(1), input_buf(0),
-    input_buf_cnt(0), input_buf_size(0)
+    input_buf_cnt(0), input_buf_size(0), out_block_pos(0)
 {
   
 } /* AudioProcessor::AudioProcessor */
@@ -141,6 +141,12 @@ int AudioProcessor::writeSamples(const float *samples, int len)
   
   writeFromBuf();
 
+  if (out_block)
+  {
+    input_stopped = true;
+    return 0;
+  }
+
     // Calculate the maximum number of samples we are able to process
   int max_proc = (BUFSIZE - buf_cnt) * input_rate / output_rate;
   if (max_proc == 0)
@@ -201,13 +207,49 @@ int AudioProcessor::writeSamples(const float *samples, int len)
 } /* AudioProcessor::writeSamples */
 
 
+bool AudioProcessor::acceptsBlocks(void) const
+{
+  return sinkAcceptsBlocks();
+} /* AudioProcessor::acceptsBlocks */
+
+
+int AudioProcessor::writeAudioBlock(const AudioBlockPtr& block)
+{
+  const int len = block->size();
+  const int out_len = len * output_rate / input_rate;
+  if ((buf_cnt > 0) || (input_buf_cnt > 0) || out_block || output_stopped ||
+      ((input_buf_size > 0) && (len % input_buf_size != 0)) ||
+      (out_len > AudioBlock::CAPACITY) || !sinkAcceptsBlocks())
+  {
+    return writeSamples(block->data(), len);
+  }
+
+  do_flush = false;
+  AudioBlockPtr out = AudioBlock::create(out_len);
+  out->setCopies(block->copies());
+  processSamples(out->data(), block->data(), len);
+  int written = sinkWriteAudioBlock(out);
+  assert((written >= 0) && (written <= out_len));
+  if (written < out_len)
+  {
+      // Keep the block until the sink have taken care of the rest of it
+    out_block = out;
+    out_block_pos = written;
+    output_stopped = (written == 0);
+    writeFromBuf();
+  }
+
+  return len;
+} /* AudioProcessor::writeAudioBlock */
+
+
 void AudioProcessor::flushSamples(void)
 {
   //cout << "AudioProcessor::flushSamples" << endl;
   
   do_flush = true;
   input_stopped = false;
-  if (buf_cnt == 0)
+  if ((buf_cnt == 0) && !out_block)
   {
     if (input_buf_cnt > 0)
     {
@@ -310,6 +352,12 @@ void AudioProcessor::setInputOutputSampleRate(int input_rate, int output_rate)
  */
 void AudioProcessor::writeFromBuf(void)
 {
+  if (out_block)
+  {
+    writeFromBlock();
+    return;
+  }
+
   if ((buf_cnt == 0) || output_stopped)
   {
     return;
@@ -360,6 +408,58 @@ void AudioProcessor::writeFromBuf(void)
 } /* AudioProcessor::writeFromBuf */
 
 
+/*
+ *----------------------------------------------------------------------------
+ * Method:    AudioProcessor::writeFromBlock
+ * Purpose:   Write the samples left in the output block to the connected
+ *            sink. The input buffer and the output buffer are always empty
+ *            while there is an output block.
+ * Input:     None
+ * Output:    None
+ * Author:    Tobias Blomberg / SM0SVX
+ * Created:   2026-10-19
+ * Remarks:   
+ * Bugs:      
+ *----------------------------------------------------------------------------
+ */
+void AudioProcessor::writeFromBlock(void)
+{
+  if (output_stopped)
+  {
+    return;
+  }
+
+  int written;
+  do
+  {
+    written = sinkWriteSamples(out_block->data() + out_block_pos,
+                               out_block->size() - out_block_pos);
+    out_block_pos += written;
+  } while ((written > 0) && (out_block_pos < out_block->size()));
+
+  if (out_block_pos < out_block->size())
+  {
+    output_stopped = true;
+    return;
+  }
+  out_block.reset();
+
+  if (do_flush)
+  {
+    do_flush = false;
+    Application::app().runTask(
+        mem_fun(*this, &AudioProcessor::sinkFlushSamples));
+  }
+
+  if (input_stopped)
+  {
+    input_stopped = false;
+    Application::app().runTask(
+		    mem_fun(*this, &AudioProcessor::sourceResumeOutput));
+  }
+} /* AudioProcessor::writeFromBlock */
+
+
 /*
  * This file has not been truncated
  */
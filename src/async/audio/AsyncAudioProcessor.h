@@ -135,6 +135,24 @@ class AudioProcessor : public AudioSink, public AudioSource, public sigc::tracka
      * @return	Return the number of samples processed
      */
     int writeSamples(const float *samples, int len);
+
+    /**
+     * @brief 	Check if the processor accept audio blocks
+     * @return	Returns \em true if the connected sink accept audio blocks
+     */
+    bool acceptsBlocks(void) const;
+
+    /**
+     * @brief 	Write a block of audio to the filter
+     * @param 	block The block containing the samples
+     * @return	Return the number of samples processed
+     *
+     * If nothing is buffered in the processor and the output fit in one
+     * audio block, the samples are processed directly into a new block which
+     * is written to the sink. Otherwise the samples are handled by the
+     * writeSamples function.
+     */
+    int writeAudioBlock(const AudioBlockPtr& block);
     
     /**
      * @brief Order a flush of all samples
@@ -187,10 +205,13 @@ class AudioProcessor : public AudioSink, public AudioSource, public sigc::tracka
     float     	*input_buf;
     int       	input_buf_cnt;
     int       	input_buf_size;
+    AudioBlockPtr out_block;
+    int         out_block_pos;
     
     AudioProcessor(const AudioProcessor&);
     AudioProcessor& operator=(const AudioProcessor&);
     void writeFromBuf(void);
+    void writeFromBlock(void);
 
 };  /* class AudioProcessor */
 
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2004-2009 Tobias Blomberg / SM0SVX
+Copyright (C) 2004-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -32,12 +32,22 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+
 #include <cassert>
 #include <cstdio>
 #include <cstring>
 #include <cerrno>
 #include <algorithm>
 #include <sstream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <map>
 #include <sys/time.h>
 
 
@@ -47,6 +57,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncFdWatch.h>
+#include <AsyncMetrics.h>
+
 
 
 /****************************************************************************
@@ -56,6 +69,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioRecorder.h"
+#include "AsyncAudioContainer.h"
+#include "AsyncAudioVectorOps.h"
 
 
 
@@ -79,12 +94,519 @@ using namespace Async;
 #define WAVE_HEADER_SIZE  44
 
 
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+namespace {
+  int monitorNotifyFd(void)
+  {
+    static const int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    return fd;
+  }
+
+  void notifyMonitor(void)
+  {
+    uint64_t one = 1;
+    ssize_t ret = ::write(monitorNotifyFd(), &one, sizeof(one));
+    (void)ret;
+  }
+} /* anonymous namespace */
+
+
 /****************************************************************************
  *
  * Local class definitions
  *
  ****************************************************************************/
 
+/*
+ * The writer is shared between the main thread and the writer thread. The
+ * main thread put samples into a single producer, single consumer ring of
+ * fixed size chunks and the writer thread take them out, encode them and
+ * write them to the file in large blocks. The blocks are aligned both in
+ * memory and in the file to make the writes as efficient as possible.
+ */
+class AudioRecorder::Writer
+{
+  public:
+    static const size_t CHUNK_SIZE      = 1024;       // Samples
+    static const size_t OUT_BLOCK_SIZE  = 64 * 1024;  // Bytes
+    static const size_t OUT_ALIGNMENT   = 4096;
+
+    Writer(int fd, Format format, int sample_rate, AudioContainer *container,
+           size_t chunk_cnt)
+      : fd(fd), format(format), sample_rate(sample_rate),
+        container(container), chunks(chunk_cnt)
+    {
+      wake_fd = eventfd(0, EFD_CLOEXEC);
+      void *buf = nullptr;
+      if (posix_memalign(&buf, OUT_ALIGNMENT, OUT_BLOCK_SIZE) != 0)
+      {
+        buf = nullptr;
+      }
+      out_buf = reinterpret_cast<char*>(buf);
+
+        // Reserve room for the header in the first block so that all
+        // blocks written are aligned in the file.
+      if (container != nullptr)
+      {
+        header_size = container->headerSize();
+        container->writeBlock.connect(
+            sigc::mem_fun(*this, &Writer::appendData));
+      }
+      else if (format == FMT_WAV)
+      {
+        header_size = WAVE_HEADER_SIZE;
+      }
+      assert(header_size <= OUT_BLOCK_SIZE);
+      if (out_buf != nullptr)
+      {
+        memset(out_buf, 0, header_size);
+        out_len = header_size;
+      }
+    }
+
+    ~Writer(void)
+    {
+      delete container;
+      free(out_buf);
+      if (wake_fd >= 0)
+      {
+        ::close(wake_fd);
+      }
+      if (fd >= 0)
+      {
+        ::close(fd);
+      }
+    }
+
+    bool isValid(void) const { return (wake_fd >= 0) && (out_buf != nullptr); }
+    bool isDone(void) const { return done; }
+    bool hasFailed(void) const { return failed; }
+
+    std::string errorMsg(void)
+    {
+      std::lock_guard<std::mutex> lk(err_mutex);
+      return errmsg;
+    }
+
+      // Called from the main thread. Returns the number of samples queued.
+    size_t queueSamples(const float *samples, size_t count)
+    {
+      size_t queued = 0;
+      while (queued < count)
+      {
+        size_t h = head.load(std::memory_order_relaxed);
+        if ((fill == 0) &&
+            (h - tail.load(std::memory_order_acquire) >= chunks.size()))
+        {
+          break;
+        }
+        Chunk &chunk = chunks[h % chunks.size()];
+        size_t cnt = std::min(count - queued, CHUNK_SIZE - fill);
+        memcpy(chunk.samples + fill, samples + queued, cnt * sizeof(*samples));
+        fill += cnt;
+        queued += cnt;
+        if (fill == CHUNK_SIZE)
+        {
+          publishChunk();
+        }
+      }
+      return queued;
+    }
+
+      // Called from the main thread when no more samples will be written
+    void close(void)
+    {
+      if (fill > 0)
+      {
+        publishChunk();
+      }
+      closing.store(true, std::memory_order_release);
+      wake();
+    }
+
+      // The writer thread function
+    static void run(std::shared_ptr<Writer> writer)
+    {
+      writer->process();
+      writer.reset();
+      notifyMonitor();
+    }
+
+  private:
+    struct Chunk
+    {
+      float   samples[CHUNK_SIZE];
+      size_t  count;
+    };
+
+    int                   fd;
+    Format                format;
+    int                   sample_rate;
+    AudioContainer*       container;
+    std::vector<Chunk>    chunks;
+    std::atomic<size_t>   head        {0};
+    std::atomic<size_t>   tail        {0};
+    std::atomic<bool>     closing     {false};
+    std::atomic<bool>     done        {false};
+    std::atomic<bool>     failed      {false};
+    size_t                fill        = 0;
+    int                   wake_fd     = -1;
+    char*                 out_buf     = nullptr;
+    size_t                out_len     = 0;
+    size_t                header_size = 0;
+    uint64_t              samples_out = 0;
+    std::mutex            err_mutex;
+    std::string           errmsg;
+
+    Writer(const Writer&);
+    Writer& operator=(const Writer&);
+
+    void publishChunk(void)
+    {
+      size_t h = head.load(std::memory_order_relaxed);
+      chunks[h % chunks.size()].count = fill;
+      fill = 0;
+      head.store(h + 1, std::memory_order_release);
+      wake();
+    }
+
+    void wake(void)
+    {
+      uint64_t one = 1;
+      ssize_t ret = ::write(wake_fd, &one, sizeof(one));
+      (void)ret;
+    }
+
+    void process(void)
+    {
+      for (;;)
+      {
+        uint64_t cnt;
+        if ((::read(wake_fd, &cnt, sizeof(cnt)) < 0) && (errno != EINTR))
+        {
+          setError("read");
+          finish();
+          return;
+        }
+        bool is_closing = closing.load(std::memory_order_acquire);
+        drain();
+        if (is_closing)
+        {
+          finish();
+          return;
+        }
+      }
+    }
+
+    void drain(void)
+    {
+      size_t t = tail.load(std::memory_order_relaxed);
+      while (t != head.load(std::memory_order_acquire))
+      {
+        const Chunk &chunk = chunks[t % chunks.size()];
+        if (!failed)
+        {
+          if (container != nullptr)
+          {
+            container->writeSamples(chunk.samples, chunk.count);
+          }
+          else
+          {
+            int16_t pcm[CHUNK_SIZE];
+            convertFloatToS16(pcm, chunk.samples, chunk.count);
+            appendData(reinterpret_cast<const char*>(pcm),
+                       chunk.count * sizeof(*pcm));
+          }
+          samples_out += chunk.count;
+        }
+        tail.store(++t, std::memory_order_release);
+      }
+    }
+
+    void appendData(const char *buf, size_t len)
+    {
+      while ((len > 0) && !failed)
+      {
+        size_t cnt = std::min(len, OUT_BLOCK_SIZE - out_len);
+        memcpy(out_buf + out_len, buf, cnt);
+        out_len += cnt;
+        buf += cnt;
+        len -= cnt;
+        if (out_len == OUT_BLOCK_SIZE)
+        {
+          writeAll(out_buf, out_len);
+          out_len = 0;
+        }
+      }
+    }
+
+    void finish(void)
+    {
+      if (container != nullptr)
+      {
+        container->endStream();
+      }
+      if (!failed && (out_len > 0))
+      {
+        writeAll(out_buf, out_len);
+        out_len = 0;
+      }
+      if (!failed && (header_size > 0))
+      {
+        const char *header = nullptr;
+        char wave_header[WAVE_HEADER_SIZE];
+        if (container != nullptr)
+        {
+          header = container->header();
+        }
+        else
+        {
+          buildWaveHeader(wave_header);
+          header = wave_header;
+        }
+        if (::pwrite(fd, header, header_size, 0) !=
+            static_cast<ssize_t>(header_size))
+        {
+          setError("pwrite");
+        }
+      }
+      int ret = ::close(fd);
+      fd = -1;
+      if ((ret != 0) && !failed)
+      {
+        setError("close");
+      }
+      done = true;
+    }
+
+    void writeAll(const char *buf, size_t len)
+    {
+      while (len > 0)
+      {
+        ssize_t cnt = ::write(fd, buf, len);
+        if (cnt < 0)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          setError("write");
+          return;
+        }
+        buf += cnt;
+        len -= cnt;
+      }
+    }
+
+    void setError(const char *fname)
+    {
+      std::ostringstream ss;
+      ss << fname << ": " << strerror(errno);
+      {
+        std::lock_guard<std::mutex> lk(err_mutex);
+        errmsg = ss.str();
+      }
+      failed = true;
+      notifyMonitor();
+    }
+
+    void buildWaveHeader(char *buf)
+    {
+      char *ptr = buf;
+
+        // ChunkID
+      memcpy(ptr, "RIFF", 4);
+      ptr += 4;
+
+        // ChunkSize
+      ptr += store32bitValue(ptr, 36 + samples_out * sizeof(short));
+
+        // Format
+      memcpy(ptr, "WAVE", 4);
+      ptr += 4;
+
+        // Subchunk1ID
+      memcpy(ptr, "fmt ", 4);
+      ptr += 4;
+
+        // Subchunk1Size
+      ptr += store32bitValue(ptr, 16);
+
+        // AudioFormat (PCM)
+      ptr += store16bitValue(ptr, 1);
+
+        // NumChannels
+      ptr += store16bitValue(ptr, 1);
+
+        // SampleRate
+      ptr += store32bitValue(ptr, sample_rate);
+
+        // ByteRate (sample rate * num channels * bytes per sample)
+      ptr += store32bitValue(ptr, sample_rate * 1 * sizeof(short));
+
+        // BlockAlign (num channels * bytes per sample)
+      ptr += store16bitValue(ptr, 1 * sizeof(short));
+
+        // BitsPerSample
+      ptr += store16bitValue(ptr, 16);
+
+        // Subchunk2ID
+      memcpy(ptr, "data", 4);
+      ptr += 4;
+
+        // Subchunk2Size (num samples * num channels * bytes per sample)
+      ptr += store32bitValue(ptr, samples_out * 1 * sizeof(short));
+
+      assert(ptr - buf == WAVE_HEADER_SIZE);
+    }
+
+    static int store32bitValue(char *ptr, uint32_t val)
+    {
+      *ptr++ = val & 0xff;
+      val >>= 8;
+      *ptr++ = val & 0xff;
+      val >>= 8;
+      *ptr++ = val & 0xff;
+      val >>= 8;
+      *ptr++ = val & 0xff;
+      return 4;
+    }
+
+    static int store16bitValue(char *ptr, uint16_t val)
+    {
+      *ptr++ = val & 0xff;
+      val >>= 8;
+      *ptr++ = val & 0xff;
+      return 2;
+    }
+};
+
+
+/*
+ * The writer monitor live in the main thread. It keep track of all active
+ * writers and call the error and done handlers when a writer thread report
+ * that something has happened. All writer threads share one eventfd for
+ * notifications.
+ */
+class AudioRecorder::WriterMonitor : public sigc::trackable
+{
+  public:
+    static WriterMonitor& instance(void)
+    {
+        // Never destroyed since the FdWatch must not outlive the application
+        // object during static destruction
+      static WriterMonitor *monitor = new WriterMonitor;
+      return *monitor;
+    }
+
+    void add(std::shared_ptr<Writer> writer,
+             const sigc::slot<void()>& error_handler)
+    {
+      Pending &pending = writers[writer.get()];
+      pending.writer = writer;
+      pending.error_handler = error_handler;
+    }
+
+    void setDoneHandler(Writer *writer,
+                        const sigc::slot<void(bool)>& done_handler)
+    {
+      Writers::iterator it = writers.find(writer);
+      assert(it != writers.end());
+      it->second.error_handler = sigc::slot<void()>();
+      it->second.done_handler = done_handler;
+      it->second.closing = true;
+    }
+
+      // Attach a done handler to a writer that has already been closed.
+      // Returns false if the writer has already been reported as done.
+    bool attachDoneHandler(Writer *writer,
+                           const sigc::slot<void(bool)>& done_handler)
+    {
+      Writers::iterator it = writers.find(writer);
+      if (it == writers.end())
+      {
+        return false;
+      }
+      it->second.done_handler = done_handler;
+      return true;
+    }
+
+  private:
+    struct Pending
+    {
+      std::shared_ptr<Writer>   writer;
+      sigc::slot<void()>        error_handler;
+      sigc::slot<void(bool)>    done_handler;
+      bool                      error_reported  = false;
+      bool                      closing         = false;
+    };
+    typedef std::map<Writer*, Pending> Writers;
+
+    Writers writers;
+    FdWatch watch;
+
+    WriterMonitor(void) : watch(monitorNotifyFd(), FdWatch::FD_WATCH_RD)
+    {
+      watch.activity.connect(
+          sigc::hide(sigc::mem_fun(*this, &WriterMonitor::onActivity)));
+    }
+
+    void onActivity(void)
+    {
+      uint64_t cnt;
+      ssize_t ret = ::read(monitorNotifyFd(), &cnt, sizeof(cnt));
+      (void)ret;
+
+        // The handlers may add or remove writers so the list of writers to
+        // check is copied first
+      std::vector<Writer*> to_check;
+      for (const auto& item : writers)
+      {
+        to_check.push_back(item.first);
+      }
+      for (Writer *writer : to_check)
+      {
+        Writers::iterator it = writers.find(writer);
+        if (it == writers.end())
+        {
+          continue;
+        }
+        Pending &pending = it->second;
+        if (writer->hasFailed() && !pending.error_reported &&
+            !pending.closing)
+        {
+          pending.error_reported = true;
+          sigc::slot<void()> handler = pending.error_handler;
+          if (handler)
+          {
+            handler();
+          }
+          it = writers.find(writer);
+          if (it == writers.end())
+          {
+            continue;
+          }
+        }
+        if (it->second.closing && writer->isDone())
+        {
+          bool success = !writer->hasFailed();
+          sigc::slot<void(bool)> handler = it->second.done_handler;
+          writers.erase(it);
+          if (handler)
+          {
+            handler(success);
+          }
+        }
+      }
+    }
+};
+
 
 
 /****************************************************************************
@@ -121,7 +643,8 @@ using namespace Async;
 AudioRecorder::AudioRecorder(const string& filename,
       	      	      	     AudioRecorder::Format fmt,
 			     int sample_rate)
-  : filename(filename), file(NULL), samples_written(0), format(fmt),
+  : filename(filename), last_writer_handled(false), samples_written(0),
+    dropped_blocks(0), format(fmt),
     sample_rate(sample_rate), max_samples(0), high_water_mark(0),
     high_water_mark_reached(false)
 {
@@ -140,6 +663,10 @@ AudioRecorder::AudioRecorder(const string& filename,
       {
         format = FMT_WAV;
       }
+      else if ((ext == "opus") || (ext == "ogg"))
+      {
+        format = FMT_OPUS;
+      }
     }
   }
 } /* AudioRecorder::AudioRecorder */
@@ -153,28 +680,46 @@ AudioRecorder::~AudioRecorder(void)
 
 bool AudioRecorder::initialize(void)
 {
-  assert(file == NULL);
+  assert(writer == nullptr);
   
-  file = fopen(filename.c_str(), "w");
-  if (file == NULL)
+  AudioContainer *container = nullptr;
+  if (format == FMT_OPUS)
   {
-    setErrMsgFromErrno("fopen");
+    container = createAudioContainer("opus");
+    if (container == nullptr)
+    {
+      errmsg = "Opus/Ogg support not available";
+      return false;
+    }
+  }
+
+  int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0666);
+  if (fd < 0)
+  {
+    setErrMsgFromErrno("open");
+    delete container;
     return false;
   }
   
-  if (format == FMT_WAV)
+  size_t chunk_cnt = (static_cast<size_t>(sample_rate) * BUFFER_TIME / 1000 +
+                      Writer::CHUNK_SIZE - 1) / Writer::CHUNK_SIZE;
+  writer = std::make_shared<Writer>(fd, format, sample_rate, container,
+                                    chunk_cnt);
+  if (!writer->isValid())
   {
-      // Leave room for the wave file header
-    if (fseek(file, WAVE_HEADER_SIZE, SEEK_SET) != 0)
-    {
-      setErrMsgFromErrno("fseek");
-      fclose(file);
-      file = NULL;
-      return false;
-    }
+    setErrMsgFromErrno("Writer");
+    writer.reset();
+    return false;
   }
+  WriterMonitor::instance().add(writer,
+      sigc::mem_fun(*this, &AudioRecorder::writerFailed));
+  last_writer.reset();
+  last_writer_handled = false;
+  std::thread(&Writer::run, writer).detach();
   
   samples_written = 0;
+  dropped_blocks = 0;
   high_water_mark_reached = false;
   timerclear(&begin_timestamp);
   timerclear(&end_timestamp);
@@ -193,20 +738,36 @@ void AudioRecorder::setMaxRecordingTime(unsigned time_ms, unsigned hw_time_ms)
 
 
 bool AudioRecorder::closeFile(void)
+{
+  return closeFile(sigc::slot<void(bool)>());
+} /* AudioRecorder::closeFile */
+
+
+bool AudioRecorder::closeFile(const sigc::slot<void(bool)>& done_handler)
 {
   bool success = true;
-  if (file != NULL)
+  if (writer != nullptr)
   {
-    if (format == FMT_WAV)
-    {
-      success = writeWaveHeader();
-    }
-    if (fclose(file) != 0)
+    success = !writer->hasFailed();
+    WriterMonitor::instance().setDoneHandler(writer.get(), done_handler);
+    writer->close();
+    last_writer = writer;
+    last_writer_handled = static_cast<bool>(done_handler);
+    writer.reset();
+  }
+  else if ((last_writer != nullptr) && !last_writer_handled &&
+           done_handler)
+  {
+      // The file was closed without a done handler, e.g. when the maximum
+      // recording time was reached. Attach the handler to that file or call
+      // it directly if the file has already been written.
+    success = !last_writer->hasFailed();
+    last_writer_handled = true;
+    if (!WriterMonitor::instance().attachDoneHandler(last_writer.get(),
+                                                     done_handler))
     {
-      setErrMsgFromErrno("fclose");
-      success = false;
+      done_handler(success);
     }
-    file = NULL;
   }
   return success;
 } /* AudioRecorder::closeFile */
@@ -216,7 +777,7 @@ int AudioRecorder::writeSamples(const float *samples, int count)
 {
   assert(count > 0);
 
-  if (file == NULL)
+  if (writer == nullptr)
   {
     return count;
   }
@@ -238,34 +799,18 @@ int AudioRecorder::writeSamples(const float *samples, int count)
     timersub(&end_timestamp, &block_time, &begin_timestamp);
   }
   
-  short buf[count];
-  for (int i=0; i<count; ++i)
-  {
-    float sample = samples[i];
-    if (sample > 1)
-    {
-      buf[i] = 32767;
-    }
-    else if (sample < -1)
-    {
-      buf[i] = -32767;
-    }
-    else
-    {
-      buf[i] = static_cast<short>(32767.0 * sample);
-    }
-  }
-  
-  int written = fwrite(buf, sizeof(*buf), count, file);
-  if ((written != count) && ferror(file))
+    // Never block the audio path. If the writer thread cannot keep up, the
+    // samples are thrown away.
+  if (writer->queueSamples(samples, count) < static_cast<size_t>(count))
   {
-    setErrMsgFromErrno("fwrite");
-    errorOccurred();
-    closeFile();
-    return count;
+    dropped_blocks += 1;
+    static Metrics::Counter& dropped_counter = Metrics::instance().counter(
+        "async_audio_recorder_dropped_blocks_total",
+        "Number of audio blocks dropped since the disk could not keep up");
+    dropped_counter.inc();
   }
   
-  samples_written += written;
+  samples_written += count;
   
   if ((high_water_mark > 0) && (samples_written >= high_water_mark))
   {
@@ -279,7 +824,7 @@ int AudioRecorder::writeSamples(const float *samples, int count)
     maxRecordingTimeReached();
   }
 
-  return written;
+  return count;
 
 } /* AudioRecorder::writeSamples */
 
@@ -317,89 +862,6 @@ void AudioRecorder::flushSamples(void)
  *
  ****************************************************************************/
 
-bool AudioRecorder::writeWaveHeader(void)
-{
-  rewind(file);
- 
-  char buf[WAVE_HEADER_SIZE];
-  char *ptr = buf;
-  
-    // ChunkID
-  memcpy(ptr, "RIFF", 4);
-  ptr += 4;
-  
-    // ChunkSize
-  ptr += store32bitValue(ptr, 36 + samples_written * sizeof(short));
-  
-    // Format
-  memcpy(ptr, "WAVE", 4);
-  ptr += 4;
-    
-    // Subchunk1ID
-  memcpy(ptr, "fmt ", 4);
-  ptr += 4;
-  
-    // Subchunk1Size
-  ptr += store32bitValue(ptr, 16);
-  
-    // AudioFormat (PCM)
-  ptr += store16bitValue(ptr, 1);
-  
-    // NumChannels
-  ptr += store16bitValue(ptr, 1);
-  
-    // SampleRate
-  ptr += store32bitValue(ptr, sample_rate);
-  
-    // ByteRate (sample rate * num channels * bytes per sample)
-  ptr += store32bitValue(ptr, sample_rate * 1 * sizeof(short));
-  
-    // BlockAlign (num channels * bytes per sample)
-  ptr += store16bitValue(ptr, 1 * sizeof(short));
-  
-    // BitsPerSample
-  ptr += store16bitValue(ptr, 16);
-  
-    // Subchunk2ID
-  memcpy(ptr, "data", 4);
-  ptr += 4;
-  
-    // Subchunk2Size (num samples * num channels * bytes per sample)
-  ptr += store32bitValue(ptr, samples_written * 1 * sizeof(short));
-  
-  assert(ptr - buf == WAVE_HEADER_SIZE);
-
-  if (fwrite(buf, 1, WAVE_HEADER_SIZE, file) != WAVE_HEADER_SIZE)
-  {
-    setErrMsgFromErrno("fwrite");
-    return false;
-  }
-  return true;
-} /* AudioRecorder::writeWaveHeader */
-
-
-int AudioRecorder::store32bitValue(char *ptr, uint32_t val)
-{
-  *ptr++ = val & 0xff;
-  val >>= 8;
-  *ptr++ = val & 0xff;
-  val >>= 8;
-  *ptr++ = val & 0xff;
-  val >>= 8;
-  *ptr++ = val & 0xff;
-  return 4;
-} /* AudioRecorder::store32bitValue */
-
-
-int AudioRecorder::store16bitValue(char *ptr, uint16_t val)
-{
-  *ptr++ = val & 0xff;
-  val >>= 8;
-  *ptr++ = val & 0xff;
-  return 2;
-} /* AudioRecorder::store32bitValue */
-
-
 void AudioRecorder::setErrMsgFromErrno(const std::string &fname)
 {
   ostringstream ss;
@@ -408,8 +870,15 @@ void AudioRecorder::setErrMsgFromErrno(const std::string &fname)
 } /* AudioRecorder::setErrMsgFromErrno */
 
 
+void AudioRecorder::writerFailed(void)
+{
+  errmsg = writer->errorMsg();
+  errorOccurred();
+  closeFile();
+} /* AudioRecorder::writerFailed */
+
+
 
 /*
  * This file has not been truncated
  */
-
@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sys/time.h>
 
 #include <string>
+#include <memory>
 
 #include <AsyncAudioSink.h>
 
@@ -114,12 +115,25 @@ namespace Async
 @date   2005-08-29
 
 Use this class to stream audio into a file. The audio is stored in raw format,
-(only samples no header) or WAV format.
+(only samples no header), WAV format or, if compiled with Opus and Ogg
+support, as an Ogg/Opus file.
+
+The file is written by a separate thread so that a slow disk never block the
+audio path. Samples are passed to the writer thread through a bounded queue
+which hold BUFFER_TIME milliseconds of audio. If the disk cannot keep up and
+the queue is full, the incoming audio is thrown away and the number of dropped
+blocks is counted. Since the writing is asynchronous, the file is not
+complete until the writer thread has closed it, which may be some time after
+closeFile has returned. Use the closeFile function that take a done handler
+to be notified when the file is complete.
 */
-class AudioRecorder : public Async::AudioSink
+class AudioRecorder : public Async::AudioSink, public sigc::trackable
 {
   public:
-    typedef enum { FMT_AUTO, FMT_RAW, FMT_WAV } Format;
+    typedef enum { FMT_AUTO, FMT_RAW, FMT_WAV, FMT_OPUS } Format;
+
+      /// The amount of audio, in milliseconds, that the write queue can hold
+    static const unsigned BUFFER_TIME = 5000;
     
     /**
      * @brief 	Default constuctor
@@ -174,12 +188,36 @@ class AudioRecorder : public Async::AudioSink
      */
     bool closeFile(void);
 
+    /**
+     * @brief   Close the file and get notified when it has been written
+     * @param   done_handler Called when the file is complete
+     * @returns Return \em true if closing went well or \em false otherwise
+     *
+     * Same as above but the given handler is called, with an argument that
+     * tell if all data was successfully written, when the writer thread has
+     * written all data and closed the file. The handler will be called even
+     * if the recorder object is deleted before the file is complete.
+     * If the file has already been closed without a done handler, for
+     * example when the maximum recording time was reached, the handler is
+     * attached to that file instead.
+     */
+    bool closeFile(const sigc::slot<void(bool)>& done_handler);
+
     /**
      * @brief   Find out how many samples that have been written so far
      * @return  Returns the number of samples written so far
      */
     unsigned samplesWritten(void) const { return samples_written; }
 
+    /**
+     * @brief   Find out how many blocks that have been dropped
+     * @return  Returns the number of dropped blocks
+     *
+     * A block is dropped if the write queue is full when it is written to
+     * the recorder, which happen when the disk is too slow.
+     */
+    unsigned droppedBlocks(void) const { return dropped_blocks; }
+
     /**
      * @brief   The timestamp of the first stored sample
      * @returns Returns the timestamp
@@ -246,9 +284,15 @@ class AudioRecorder : public Async::AudioSink
     sigc::signal<void()> errorOccurred;
 
   private:
+    class Writer;
+    class WriterMonitor;
+
     std::string     filename;
-    FILE      	    *file;
+    std::shared_ptr<Writer> writer;
+    std::shared_ptr<Writer> last_writer;
+    bool            last_writer_handled;
     unsigned        samples_written;
+    unsigned        dropped_blocks;
     Format    	    format;
     int       	    sample_rate;
     unsigned        max_samples;
@@ -260,10 +304,8 @@ class AudioRecorder : public Async::AudioSink
     
     AudioRecorder(const AudioRecorder&);
     AudioRecorder& operator=(const AudioRecorder&);
-    bool writeWaveHeader(void);
-    int store32bitValue(char *ptr, uint32_t val);
-    int store16bitValue(char *ptr, uint16_t val);
     void setErrMsgFromErrno(const std::string &fname);
+    void writerFailed(void);
 
 };  /* class AudioRecorder */
 
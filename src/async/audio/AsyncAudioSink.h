@@ -45,6 +45,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncAudioBlock.h>
 
 
 /****************************************************************************
@@ -180,6 +181,35 @@ class AudioSink
       assert(m_handler != 0);
       m_handler->flushSamples();    
     }
+
+    /**
+     * @brief 	Check if this sink accept audio blocks
+     * @return	Returns \em true if blocks should be written using
+     *          writeAudioBlock
+     *
+     * A sink that can make use of reference counted audio blocks, e.g. by
+     * passing them on or by keeping a reference instead of copying the
+     * samples, should reimplement this function and the writeAudioBlock
+     * function. The default implementation return \em false.
+     * This function is normally only called from a connected source object.
+     */
+    virtual bool acceptsBlocks(void) const { return false; }
+
+    /**
+     * @brief 	Write a block of samples into this audio sink
+     * @param 	block The block containing the samples
+     * @return	Returns the number of samples that has been taken care of
+     *
+     * This function work like writeSamples but the samples are given as a
+     * reference counted block. The sink may keep a reference to the block
+     * but it must not modify the samples. The default implementation call
+     * writeSamples.
+     * This function is normally only called from a connected source object.
+     */
+    virtual int writeAudioBlock(const AudioBlockPtr& block)
+    {
+      return writeSamples(block->data(), block->size());
+    }
     
     
   protected:
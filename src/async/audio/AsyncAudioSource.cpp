@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncMetrics.h>
 
 
 /****************************************************************************
@@ -85,6 +86,9 @@ using namespace Async;
  *
  ****************************************************************************/
 
+static Metrics::Counter& pointerSamplesCounter(void);
+static Metrics::Counter& blockSamplesCounter(void);
+
 
 
 /****************************************************************************
@@ -171,6 +175,7 @@ int AudioSource::sinkWriteSamples(const float *samples, int len)
   
   if (m_sink != 0)
   {
+    pointerSamplesCounter().inc(len);
     len = m_sink->writeSamples(samples, len);
   }
   
@@ -179,6 +184,32 @@ int AudioSource::sinkWriteSamples(const float *samples, int len)
 } /* AudioSource::sinkWriteSamples */
 
 
+bool AudioSource::sinkAcceptsBlocks(void) const
+{
+  return (m_sink != 0) && m_sink->acceptsBlocks();
+} /* AudioSource::sinkAcceptsBlocks */
+
+
+int AudioSource::sinkWriteAudioBlock(const AudioBlockPtr& block)
+{
+  int len = block->size();
+  assert(len > 0);
+
+  if ((m_sink != 0) && m_sink->acceptsBlocks())
+  {
+    is_flushing = false;
+    blockSamplesCounter().inc(len);
+    return m_sink->writeAudioBlock(block);
+  }
+
+    // The sink only support the pointer API so it will probably have to
+    // copy the samples
+  block->addCopy();
+  return sinkWriteSamples(block->data(), len);
+
+} /* AudioSource::sinkWriteAudioBlock */
+
+
 void AudioSource::sinkFlushSamples(void)
 {
   if (m_sink != 0)
@@ -332,6 +363,30 @@ void AudioSource::unregisterSinkInternal(bool is_being_destroyed)
 
 
 
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+static Metrics::Counter& pointerSamplesCounter(void)
+{
+  static Metrics::Counter& counter = Metrics::instance().counter(
+      "async_audio_pointer_samples_total",
+      "Number of samples passed between audio pipe stages using a pointer "
+      "to the buffer of the source");
+  return counter;
+} /* pointerSamplesCounter */
+
+
+static Metrics::Counter& blockSamplesCounter(void)
+{
+  static Metrics::Counter& counter = Metrics::instance().counter(
+      "async_audio_block_samples_total",
+      "Number of samples passed between audio pipe stages as shared "
+      "audio blocks");
+  return counter;
+} /* blockSamplesCounter */
 
 
 
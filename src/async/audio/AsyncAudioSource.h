@@ -44,6 +44,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncAudioBlock.h>
 
 
 /****************************************************************************
@@ -222,6 +223,30 @@ class AudioSource
      * normally be written again to the sink.
      */
     int sinkWriteSamples(const float *samples, int len);
+
+    /**
+     * @brief 	Check if the connected sink accept audio blocks
+     * @return	Returns \em true if the sink accept blocks
+     *
+     * This function is used by the inheriting class to find out if it is
+     * worth producing its output in reference counted audio blocks. If it
+     * is, the blocks are written using the sinkWriteAudioBlock function.
+     */
+    bool sinkAcceptsBlocks(void) const;
+
+    /**
+     * @brief 	Write a block of samples to the connected sink
+     * @param 	block The block containing the samples to write
+     * @return	Return the number of samples that was taken care of
+     *
+     * This function work like sinkWriteSamples but the samples are given as
+     * a reference counted block that is passed on without copying the
+     * samples. The block must not be modified after it has been written. If
+     * the sink does not accept blocks, the samples are written using the
+     * writeSamples function of the sink. Samples that was not taken care of
+     * should normally be written again, possibly using sinkWriteSamples.
+     */
+    int sinkWriteAudioBlock(const AudioBlockPtr& block);
     
     /*
      * @brief 	Tell the sink to flush any buffered samples
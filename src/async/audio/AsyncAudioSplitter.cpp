@@ -149,6 +149,29 @@ class Async::AudioSplitter::Branch : public AudioSource
       return len;
       
     } /* sinkWriteSamples */
+
+    int sinkWriteAudioBlock(const AudioBlockPtr& block)
+    {
+      is_flushed = false;
+      is_flushing = false;
+
+      int len = block->size();
+      if (is_enabled)
+      {
+        if (is_stopped)
+        {
+          return 0;
+        }
+
+        len = AudioSource::sinkWriteAudioBlock(block);
+        is_stopped = (len == 0);
+      }
+
+      current_buf_pos += len;
+
+      return len;
+
+    } /* sinkWriteAudioBlock */
     
     void sinkFlushSamples(void)
     {
@@ -367,6 +390,37 @@ int AudioSplitter::writeSamples(const float *samples, int len)
 } /* AudioSplitter::writeSamples */
 
 
+int AudioSplitter::writeAudioBlock(const AudioBlockPtr& block)
+{
+  do_flush = false;
+
+  if (buf_len > 0)
+  {
+    input_stopped = true;
+    return 0;
+  }
+
+  const int len = block->size();
+  list<Branch *>::iterator it;
+  for (it = branches.begin(); it != branches.end(); ++it)
+  {
+    (*it)->current_buf_pos = 0;
+    int written = (*it)->sinkWriteAudioBlock(block);
+    if ((written != len) && (buf_len == 0))
+    {
+        // Keep a reference to the block instead of copying the samples
+      buf_block = block;
+      buf_len = len;
+    }
+  }
+
+  writeFromBuffer();
+
+  return len;
+
+} /* AudioSplitter::writeAudioBlock */
+
+
 void AudioSplitter::flushSamples(void)
 {
   if (do_flush)
@@ -458,7 +512,8 @@ void AudioSplitter::writeFromBuffer(void)
 	//   << "  buf_len=" << buf_len << endl;
       if ((*it)->current_buf_pos < buf_len)
       {
-	int written = (*it)->sinkWriteSamples(buf+(*it)->current_buf_pos,
+        const float *samples = buf_block ? buf_block->data() : buf;
+	int written = (*it)->sinkWriteSamples(samples+(*it)->current_buf_pos,
 	      	      	      	      	      buf_len-(*it)->current_buf_pos);
 	//cout << "written=" << written << endl;
 	samples_written |= (written > 0);
@@ -469,6 +524,7 @@ void AudioSplitter::writeFromBuffer(void)
     if (all_written)
     {
       buf_len = 0;
+      buf_block.reset();
       if (do_flush)
       {
 	flushAllBranches();
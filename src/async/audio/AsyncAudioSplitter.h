@@ -168,6 +168,23 @@ class AudioSplitter : public Async::AudioSink, public Async::AudioSource,
      */
     int writeSamples(const float *samples, int len) override;
 
+    /**
+     * @brief 	Check if this sink accept audio blocks
+     * @return	Always returns \em true
+     *
+     * The splitter always accept audio blocks. The same block is written to
+     * all branches and if a branch cannot take care of all samples, a
+     * reference to the block is kept instead of copying the samples.
+     */
+    bool acceptsBlocks(void) const override { return true; }
+
+    /**
+     * @brief 	Write a block of samples into this audio sink
+     * @param 	block The block containing the samples
+     * @return	Returns the number of samples that has been taken care of
+     */
+    int writeAudioBlock(const AudioBlockPtr& block) override;
+
     /**
      * @brief 	Tell the sink to flush the previously written samples
      *
@@ -187,6 +204,7 @@ class AudioSplitter : public Async::AudioSink, public Async::AudioSource,
     float     	      	*buf;
     int       	      	buf_size;
     int       	      	buf_len;
+    AudioBlockPtr       buf_block;
     bool      	      	do_flush;
     bool      	      	input_stopped;
     int       	      	flushed_branches;
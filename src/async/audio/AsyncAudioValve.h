@@ -252,6 +252,50 @@ class AudioValve : public Async::AudioSink, public Async::AudioSource
       return ret;
     }
     
+    /**
+     * @brief 	Check if the valve accept audio blocks
+     * @return	Returns \em true if the valve accept audio blocks
+     *
+     * The valve accept audio blocks if it is closed or if the connected sink
+     * accept blocks.
+     * This function is normally only called from a connected source object.
+     */
+    bool acceptsBlocks(void) const
+    {
+      return !is_open || sinkAcceptsBlocks();
+    }
+
+    /**
+     * @brief 	Write a block of samples into the valve
+     * @param 	block The block containing the samples
+     * @return	Returns the number of samples that has been taken care of
+     *
+     * This function work like writeSamples but the block is passed on to the
+     * connected sink without copying the samples.
+     * This function is normally only called from a connected source object.
+     */
+    int writeAudioBlock(const AudioBlockPtr& block)
+    {
+      int ret = 0;
+      is_idle = false;
+      is_flushing = false;
+      if (is_open)
+      {
+        ret = sinkWriteAudioBlock(block);
+      }
+      else
+      {
+        ret = (block_when_closed ? 0 : block->size());
+      }
+
+      if (ret == 0)
+      {
+        input_stopped = true;
+      }
+
+      return ret;
+    }
+    
     /**
      * @brief 	Tell the valve to flush the previously written samples
      *
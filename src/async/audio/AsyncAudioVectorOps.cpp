@@ -0,0 +1,296 @@
+/**
+@file	 AsyncAudioVectorOps.cpp
+@brief   Vectorizable helper functions for audio processing
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-18
+
+This file contain small helper functions used in the inner loops of the
+audio processing classes. They are written so that the compiler can vectorize
+them using the SIMD instructions available on the target (SSE/AVX on x86, NEON
+on ARM) without relying on -ffast-math. The sample format conversion functions
+are compiled in several variants on x86_64 where the best one for the CPU is
+selected at runtime.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cmath>
+#include <cstring>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioVectorOps.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // Compile an AVX2 variant in addition to the baseline one on x86_64. The
+  // dynamic linker selects the variant to use based on the CPU features.
+#if defined(__x86_64__) && defined(__linux__) && defined(__has_attribute)
+#  if __has_attribute(target_clones)
+#    define TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+#  endif
+#endif
+#ifndef TARGET_CLONES
+#  define TARGET_CLONES
+#endif
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+  /*
+   * The loops are specialized for the most common strides so that the
+   * compiler can generate vectorized code for them.
+   */
+  template <typename T>
+  inline void toFloat(float* __restrict dest, const T* __restrict src,
+                      size_t stride, size_t cnt, float scale)
+  {
+    switch (stride)
+    {
+      case 1:
+        for (size_t i=0; i<cnt; ++i)
+        {
+          dest[i] = static_cast<float>(src[i]) * scale;
+        }
+        break;
+      case 2:
+        for (size_t i=0; i<cnt; ++i)
+        {
+          dest[i] = static_cast<float>(src[2*i]) * scale;
+        }
+        break;
+      default:
+        for (size_t i=0; i<cnt; ++i)
+        {
+          dest[i] = static_cast<float>(src[i*stride]) * scale;
+        }
+        break;
+    }
+  }
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public functions
+ *
+ ****************************************************************************/
+
+TARGET_CLONES
+void Async::convertS16ToFloat(float* dest, const int16_t* src, size_t stride,
+                              size_t cnt)
+{
+  toFloat(dest, src, stride, cnt, 1.0f / 32768.0f);
+} /* convertS16ToFloat */
+
+
+TARGET_CLONES
+void Async::convertS32ToFloat(float* dest, const int32_t* src, size_t stride,
+                              size_t cnt)
+{
+  toFloat(dest, src, stride, cnt, 1.0f / 2147483648.0f);
+} /* convertS32ToFloat */
+
+
+TARGET_CLONES
+void Async::deinterleaveFloat(float* dest, const float* src, size_t stride,
+                              size_t cnt)
+{
+  toFloat(dest, src, stride, cnt, 1.0f);
+} /* deinterleaveFloat */
+
+
+TARGET_CLONES
+void Async::mixInterleaved(float* __restrict dest, size_t stride,
+                           const float* __restrict src, size_t cnt)
+{
+  switch (stride)
+  {
+    case 1:
+      for (size_t i=0; i<cnt; ++i)
+      {
+        dest[i] += src[i];
+      }
+      break;
+    case 2:
+      for (size_t i=0; i<cnt; ++i)
+      {
+        dest[2*i] += src[i];
+      }
+      break;
+    default:
+      for (size_t i=0; i<cnt; ++i)
+      {
+        dest[i*stride] += src[i];
+      }
+      break;
+  }
+} /* mixInterleaved */
+
+
+TARGET_CLONES
+void Async::convertFloatToS16(int16_t* __restrict dest,
+                              const float* __restrict src, size_t cnt)
+{
+  for (size_t i=0; i<cnt; ++i)
+  {
+    float sample = 32767.0f * src[i];
+    sample = (sample > 32767.0f) ? 32767.0f : sample;
+    sample = (sample < -32767.0f) ? -32767.0f : sample;
+    dest[i] = static_cast<int16_t>(sample);
+  }
+} /* convertFloatToS16 */
+
+
+TARGET_CLONES
+void Async::convertFloatToS32(int32_t* __restrict dest,
+                              const float* __restrict src, size_t cnt)
+{
+    // 2147483520 is the largest float that fit in an int32_t
+  for (size_t i=0; i<cnt; ++i)
+  {
+    float sample = 2147483648.0f * src[i];
+    sample = (sample > 2147483520.0f) ? 2147483520.0f : sample;
+    sample = (sample < -2147483648.0f) ? -2147483648.0f : sample;
+    dest[i] = static_cast<int32_t>(sample);
+  }
+} /* convertFloatToS32 */
+
+
+TARGET_CLONES
+void Async::clipFloat(float* __restrict dest, const float* __restrict src,
+                      size_t cnt)
+{
+  for (size_t i=0; i<cnt; ++i)
+  {
+    float sample = src[i];
+    sample = (sample > 1.0f) ? 1.0f : sample;
+    sample = (sample < -1.0f) ? -1.0f : sample;
+    dest[i] = sample;
+  }
+} /* clipFloat */
+
+
+TARGET_CLONES
+void Async::absLog2(float* __restrict dest, const float* __restrict src,
+                    size_t cnt, float offset)
+{
+    // Least squares fit of log2(1 + t) for t in [0, 1)
+  static const float C0 =  1.4390930e-05f;
+  static const float C1 =  1.4415921e+00f;
+  static const float C2 = -7.0725343e-01f;
+  static const float C3 =  4.1156148e-01f;
+  static const float C4 = -1.8983245e-01f;
+  static const float C5 =  4.3928628e-02f;
+  for (size_t i=0; i<cnt; ++i)
+  {
+    float x = std::fabs(src[i]) + offset;
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    float e = static_cast<float>(static_cast<int32_t>(bits >> 23) - 127);
+    bits = (bits & 0x007fffff) | 0x3f800000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    float t = m - 1.0f;
+    dest[i] = e + (C0 + t*(C1 + t*(C2 + t*(C3 + t*(C4 + t*C5)))));
+  }
+} /* absLog2 */
+
+
+TARGET_CLONES
+void Async::applyGainRamp(float* dest, const float* src, size_t cnt,
+                          float gain, float step)
+{
+  for (size_t i=0; i<cnt; ++i)
+  {
+    dest[i] = src[i] * (gain + static_cast<float>(i) * step);
+  }
+} /* applyGainRamp */
+
+
+
+/*
+ * This file has not been truncated
+ */
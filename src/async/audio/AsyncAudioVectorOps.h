@@ -0,0 +1,243 @@
+/**
+@file	 AsyncAudioVectorOps.h
+@brief   Vectorizable helper functions for audio processing
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-18
+
+This file contain small helper functions used in the inner loops of the
+audio processing classes. They are written so that the compiler can vectorize
+them using the SIMD instructions available on the target (SSE/AVX on x86, NEON
+on ARM) without relying on -ffast-math. The sample format conversion functions
+are compiled in several variants on x86_64 where the best one for the CPU is
+selected at runtime.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_VECTOR_OPS_INCLUDED
+#define ASYNC_AUDIO_VECTOR_OPS_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstddef>
+#include <stdint.h>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Functions
+ *
+ ****************************************************************************/
+
+/**
+ * @brief   Calculate the dot product of two float vectors
+ * @param   a The first vector
+ * @param   b The second vector
+ * @param   len The length of the vectors
+ * @return  Returns the sum of a[i] * b[i] for all i
+ *
+ * The sum is accumulated in eight independent lanes which are added together
+ * at the end. Since the order of the additions is explicit, the compiler is
+ * free to map the lanes onto SIMD registers.
+ */
+inline float dotProduct(const float* __restrict a, const float* __restrict b,
+                        size_t len)
+{
+  static const size_t LANES = 8;
+  float acc[LANES] = {0.0f};
+  size_t i = 0;
+  for (; i + LANES <= len; i += LANES)
+  {
+    for (size_t j = 0; j < LANES; ++j)
+    {
+      acc[j] += a[i + j] * b[i + j];
+    }
+  }
+  float sum = ((acc[0] + acc[4]) + (acc[1] + acc[5])) +
+              ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+  for (; i < len; ++i)
+  {
+    sum += a[i] * b[i];
+  }
+  return sum;
+} /* dotProduct */
+
+
+/**
+ * @brief   Convert signed 16 bit samples to float
+ * @param   dest    The destination buffer
+ * @param   src     The first source sample
+ * @param   stride  The distance between source samples, e.g. channel count
+ * @param   cnt     The number of samples to convert
+ *
+ * The samples are scaled to the range [-1.0, 1.0). Use the stride argument to
+ * pick out one channel from a buffer of interleaved frames.
+ */
+void convertS16ToFloat(float* dest, const int16_t* src, size_t stride,
+                       size_t cnt);
+
+/**
+ * @brief   Convert signed 32 bit samples to float
+ * @param   dest    The destination buffer
+ * @param   src     The first source sample
+ * @param   stride  The distance between source samples, e.g. channel count
+ * @param   cnt     The number of samples to convert
+ */
+void convertS32ToFloat(float* dest, const int32_t* src, size_t stride,
+                       size_t cnt);
+
+/**
+ * @brief   Copy float samples from an interleaved buffer
+ * @param   dest    The destination buffer
+ * @param   src     The first source sample
+ * @param   stride  The distance between source samples, e.g. channel count
+ * @param   cnt     The number of samples to copy
+ */
+void deinterleaveFloat(float* dest, const float* src, size_t stride,
+                       size_t cnt);
+
+/**
+ * @brief   Add samples to one channel of an interleaved buffer
+ * @param   dest    The first destination sample
+ * @param   stride  The distance between destination samples
+ * @param   src     The samples to add
+ * @param   cnt     The number of samples to add
+ */
+void mixInterleaved(float* dest, size_t stride, const float* src, size_t cnt);
+
+/**
+ * @brief   Convert float samples to signed 16 bit with saturation
+ * @param   dest    The destination buffer
+ * @param   src     The source buffer
+ * @param   cnt     The number of samples to convert
+ *
+ * The samples are scaled by 32767 and clipped to [-32767, 32767].
+ */
+void convertFloatToS16(int16_t* dest, const float* src, size_t cnt);
+
+/**
+ * @brief   Convert float samples to signed 32 bit with saturation
+ * @param   dest    The destination buffer
+ * @param   src     The source buffer
+ * @param   cnt     The number of samples to convert
+ */
+void convertFloatToS32(int32_t* dest, const float* src, size_t cnt);
+
+/**
+ * @brief   Clip float samples to the range [-1.0, 1.0]
+ * @param   dest    The destination buffer
+ * @param   src     The source buffer
+ * @param   cnt     The number of samples to clip
+ */
+void clipFloat(float* dest, const float* src, size_t cnt);
+
+/**
+ * @brief   Calculate an approximation of log2(|x| + offset)
+ * @param   dest    The destination buffer
+ * @param   src     The source buffer
+ * @param   cnt     The number of samples to process
+ * @param   offset  A small positive value added to avoid log2(0)
+ *
+ * The exponent is taken directly from the float representation and the
+ * logarithm of the mantissa is approximated by a fifth order polynomial. The
+ * absolute error is less than 1.5e-5, which is less than 1e-4 dB when the
+ * result is converted to decibels.
+ */
+void absLog2(float* dest, const float* src, size_t cnt, float offset);
+
+/**
+ * @brief   Multiply samples by a linearly changing gain
+ * @param   dest    The destination buffer
+ * @param   src     The source buffer
+ * @param   cnt     The number of samples to process
+ * @param   gain    The gain to apply to the first sample
+ * @param   step    The gain increment between two samples
+ *
+ * Sample i is multiplied by gain + i * step. The source and destination
+ * buffers may be the same.
+ */
+void applyGainRamp(float* dest, const float* src, size_t cnt, float gain,
+                   float step);
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_VECTOR_OPS_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -165,6 +165,18 @@ void Application::runTask(sigc::slot<void()> task)
 } /* Application::runTask */
 
 
+void Application::getTimeOfDay(struct timeval& tv) const
+{
+  gettimeofday(&tv, 0);
+} /* Application::getTimeOfDay */
+
+
+void Application::getMonotonicTime(struct timespec& ts) const
+{
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+} /* Application::getMonotonicTime */
+
+
 
 /****************************************************************************
  *
@@ -38,6 +38,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <sigc++/sigc++.h>
+#include <sys/time.h>
+#include <time.h>
 
 #include <string>
 
@@ -177,6 +179,37 @@ class Application : public sigc::trackable
      * and the second is an integer.
      */
     void runTask(sigc::slot<void()> task);
+
+    /**
+     * @brief   Get the current time of day
+     * @param   tv Where to store the time
+     *
+     * Use this function instead of gettimeofday() when the time is compared
+     * to timer timeouts, e.g. for time stamps or when calculating when an
+     * event should occur. If the application run on a virtual clock (see
+     * Async::CppApplication::setVirtualTime) the returned time will follow
+     * the virtual clock.
+     */
+    virtual void getTimeOfDay(struct timeval& tv) const;
+
+    /**
+     * @brief   Get the current time of the monotonic clock
+     * @param   ts Where to store the time
+     *
+     * This function works like clock_gettime(CLOCK_MONOTONIC) but it follow
+     * the virtual clock if one is used.
+     */
+    virtual void getMonotonicTime(struct timespec& ts) const;
+
+    /**
+     * @brief   Check if the application run on a virtual clock
+     * @return  Returns \em true if a virtual clock is used
+     *
+     * Code that wait for time to pass in some other way than by using an
+     * Async::Timer, e.g. using a timerfd, must use a timer instead when this
+     * function return \em true.
+     */
+    virtual bool virtualTime(void) const { return false; }
     
   protected:
     void clearTasks(void);
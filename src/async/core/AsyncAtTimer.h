@@ -122,9 +122,10 @@ This class is used to get a timeout at a specified absolute time. That is,
 you can specify a time of day, like 2013-04-06 12:43:00, when you would
 like the timer to expire.
 
-This class use the gettimeofday() function as its time reference. If reading
-time using another function, like time(), in the expire callback, you can
-not be sure to get the same time value. The gettimeofday() and time()
+This class use the Async::Application::getTimeOfDay() function as its time
+reference, which normally is the same as gettimeofday(). If reading time using
+another function, like time(), in the expire callback, you can not be sure to
+get the same time value. The gettimeofday() and time()
 functions may return different values for the second. The offset usually seem
 to be small (~10ms) but this has not been tested very much. One way to get
 around the problem, if it's not possible to use the gettimeofday() function,
@@ -143,7 +143,10 @@ bool EncryptedUdpSocket::randomBytes(std::vector<uint8_t>& bytes)
 
 EncryptedUdpSocket::EncryptedUdpSocket(uint16_t local_port,
     const IpAddress &bind_ip)
-  : UdpSocket(local_port, bind_ip)
+  : UdpSocket(local_port, bind_ip),
+    m_encrypt_hist(Metrics::instance().histogram(
+          "async_udp_encrypt_seconds",
+          "Time spent encrypting and sending one UDP datagram"))
 {
   m_cipher_ctx = EVP_CIPHER_CTX_new();
 } /* EncryptedUdpSocket::EncryptedUdpSocket */
@@ -151,6 +154,7 @@ EncryptedUdpSocket::EncryptedUdpSocket(uint16_t local_port,
 
 EncryptedUdpSocket::~EncryptedUdpSocket(void)
 {
+  clearPeerCtx();
   EVP_CIPHER_CTX_free(m_cipher_ctx);
   m_cipher_ctx = nullptr;
 } /* EncryptedUdpSocket::~EncryptedUdpSocket */
@@ -165,6 +169,10 @@ bool EncryptedUdpSocket::setCipher(const std::string& type)
 
 bool EncryptedUdpSocket::setCipher(const EncryptedUdpSocket::Cipher* cipher)
 {
+    // The cached per peer contexts are keyed for the old cipher
+  clearPeerCtx();
+  m_cipher = nullptr;
+
     // Clean up the context, free all memory except the context itself
   if (!EVP_CIPHER_CTX_reset(m_cipher_ctx))
   {
@@ -184,6 +192,7 @@ bool EncryptedUdpSocket::setCipher(const EncryptedUdpSocket::Cipher* cipher)
     std::cout << "### EVP_EncryptInit_ex failed" << std::endl;
     return false;
   }
+  m_cipher = cipher;
 
   return true;
 } /* EncryptedUdpSocket::setCipher */
@@ -253,82 +262,71 @@ bool EncryptedUdpSocket::write(const IpAddress& remote_ip, int remote_port,
   //std::cout << std::dec << std::endl;
 
   assert(m_cipher_ctx != nullptr);
-  assert((aad == nullptr) == (aadlen <= 0));
-
-  auto inbuf = static_cast<const uint8_t*>(buf);
-  auto aadbuf = static_cast<const uint8_t*>(aad);
-
-  auto key_length = EVP_CIPHER_CTX_key_length(m_cipher_ctx);
-  //auto iv_length = EVP_CIPHER_CTX_iv_length(m_cipher_ctx);
-  //std::cout << "### key_length=" << key_length << std::endl;
-  //std::cout << "### iv_length=" << iv_length << std::endl;
-  if (key_length > 0)
-  {
-    //OPENSSL_assert(key_length == m_cipher_key.size());
-    //OPENSSL_assert(iv_length == m_cipher_iv.size());
-
-      // Set key and IV in the cipher context
-    EVP_EncryptInit_ex(m_cipher_ctx, NULL, NULL, m_cipher_key.data(),
-                       m_cipher_iv.data());
-  }
-
-  //auto taglen = EVP_CIPHER_CTX_get_tag_length(m_cipher_ctx);
-  //std::cout << "### taglen=" << m_taglen << std::endl;
 
-    // Allow enough space in output buffer for AAD, tag, encrypted plaintext
-    // and one additional block
-  uint8_t outbuf[aadlen + m_taglen + cnt + EVP_MAX_BLOCK_LENGTH];
-  auto outbufp = outbuf;
-  int outlen = 0;
-  int totoutlen = aadlen + m_taglen;
-  if (aadlen > 0)
+  EVP_CIPHER_CTX* ctx = m_cipher_ctx;
+  const uint8_t* iv = nullptr;
+  if (EVP_CIPHER_CTX_key_length(m_cipher_ctx) > 0)
   {
-    std::memcpy(outbufp, aadbuf, aadlen);
-    if(!EVP_EncryptUpdate(m_cipher_ctx, nullptr, &outlen, aadbuf, aadlen))
+    ctx = peerEncryptCtx(Peer(remote_ip, remote_port), m_cipher_key);
+    if (ctx == nullptr)
     {
-      std::cout << "### EVP_EncryptUpdate with AAD failed" << std::endl;
-      ERR_print_errors_fp(stderr);
       return false;
     }
+    iv = m_cipher_iv.data();
   }
-  outbufp += aadlen + m_taglen;
 
-  if(!EVP_EncryptUpdate(m_cipher_ctx, outbufp, &outlen, inbuf, cnt))
-  {
-    std::cout << "### EVP_EncryptUpdate failed" << std::endl;
-    return false;
-  }
-  outbufp += outlen;
-  totoutlen += outlen;
+  return encrypt(ctx, remote_ip, remote_port, iv, aad, aadlen, buf, cnt);
+} /* EncryptedUdpSocket::write */
 
-  if(!EVP_EncryptFinal_ex(m_cipher_ctx, outbufp, &outlen))
-  {
-    std::cout << "### EVP_EncryptFinal failed" << std::endl;
-    return false;
-  }
-  totoutlen += outlen;
 
-  if (m_taglen > 0)
+size_t EncryptedUdpSocket::writeBatch(const std::vector<Datagram>& datagrams)
+{
+  assert(m_cipher_ctx != nullptr);
+
+  const bool use_key = (EVP_CIPHER_CTX_key_length(m_cipher_ctx) > 0);
+  const size_t iv_length = EVP_CIPHER_CTX_iv_length(m_cipher_ctx);
+  size_t sent = 0;
+  for (const auto& dg : datagrams)
   {
-    outbufp = outbuf + aadlen;
-    if (!EVP_CIPHER_CTX_ctrl(m_cipher_ctx, EVP_CTRL_AEAD_GET_TAG,
-          m_taglen, outbufp))
+    EVP_CIPHER_CTX* ctx = m_cipher_ctx;
+    const uint8_t* iv = nullptr;
+    if (use_key)
     {
-      std::cout << "### EVP_CIPHER_CTX_ctrl(EVP_CTRL_AEAD_GET_TAG) failed"
-                << std::endl;
-      return false;
+      if (dg.iv.size() != iv_length)
+      {
+        std::cout << "### EncryptedUdpSocket::writeBatch: Bad IV length "
+                  << dg.iv.size() << " for " << dg.remote_ip << ":"
+                  << dg.remote_port << std::endl;
+        continue;
+      }
+      ctx = peerEncryptCtx(Peer(dg.remote_ip, dg.remote_port), dg.key);
+      if (ctx == nullptr)
+      {
+        continue;
+      }
+      iv = dg.iv.data();
+    }
+    if (encrypt(ctx, dg.remote_ip, dg.remote_port, iv,
+                dg.aad, dg.aadlen, dg.buf, dg.count))
+    {
+      ++sent;
     }
   }
+  return sent;
+} /* EncryptedUdpSocket::writeBatch */
 
-  //std::cout << "### EncryptedUdpSocket::write: totoutlen=" << totoutlen
-  //          << " data=";
-  //std::copy(outbuf, outbuf+totoutlen,
-  //    std::ostream_iterator<int>(std::cout << std::hex, " "));
-  //std::cout << std::dec << std::endl;
-
-  return UdpSocket::write(remote_ip, remote_port, outbuf, totoutlen);
 
-} /* EncryptedUdpSocket::write */
+void EncryptedUdpSocket::forgetPeer(const IpAddress& remote_ip,
+                                    uint16_t remote_port)
+{
+  auto it = m_peer_ctx.find(Peer(remote_ip, remote_port));
+  if (it != m_peer_ctx.end())
+  {
+    EVP_CIPHER_CTX_free(it->second.enc_ctx);
+    EVP_CIPHER_CTX_free(it->second.dec_ctx);
+    m_peer_ctx.erase(it);
+  }
+} /* EncryptedUdpSocket::forgetPeer */
 
 
 /****************************************************************************
@@ -357,18 +355,34 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
   /* Allow enough space in output buffer for additional block */
   unsigned char outbuf[count + EVP_MAX_BLOCK_LENGTH];
 
-  auto key_length = EVP_CIPHER_CTX_key_length(m_cipher_ctx);
-  //auto iv_length = EVP_CIPHER_CTX_iv_length(m_cipher_ctx);
-  //std::cout << "### key_length=" << key_length << std::endl;
-  //std::cout << "### iv_length=" << iv_length << std::endl;
-  if (key_length > 0)
+  EVP_CIPHER_CTX* ctx = m_cipher_ctx;
+  if (EVP_CIPHER_CTX_key_length(m_cipher_ctx) > 0)
   {
-    //OPENSSL_assert(key_length == m_cipher_key.size());
-    //OPENSSL_assert(iv_length == m_cipher_iv.size());
-
-      // Set key and IV in the cipher context
-    EVP_DecryptInit_ex(m_cipher_ctx, NULL, NULL, m_cipher_key.data(),
-                      m_cipher_iv.data());
+      // A cached context is only used for peers that data has been sent
+      // to. Datagrams from any other peer, which may be spoofed, are
+      // decrypted using the shared context that is keyed per datagram so
+      // that they cannot make the cache grow.
+    bool ok = false;
+    const Peer peer(ip, port);
+    if (m_peer_ctx.find(peer) != m_peer_ctx.end())
+    {
+        // Only set the IV since the per peer context is already keyed
+      ctx = peerDecryptCtx(peer, m_cipher_key);
+      ok = (ctx != nullptr) &&
+           EVP_DecryptInit_ex(ctx, NULL, NULL, NULL, m_cipher_iv.data());
+    }
+    else if (m_cipher_key.size() ==
+             static_cast<size_t>(EVP_CIPHER_CTX_key_length(ctx)))
+    {
+      ok = EVP_DecryptInit_ex(ctx, NULL, NULL, m_cipher_key.data(),
+                              m_cipher_iv.data());
+    }
+    if (!ok)
+    {
+      std::cout << "### EncryptedUdpSocket::onDataReceived: "
+                   "Could not set up cipher context" << std::endl;
+      return;
+    }
   }
 
   int outlen = 0;
@@ -381,7 +395,7 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
                 << " m_aadlen=" << m_aadlen << std::endl;
       return;
     }
-    if(!EVP_DecryptUpdate(m_cipher_ctx, nullptr, &outlen, inbuf, m_aadlen))
+    if(!EVP_DecryptUpdate(ctx, nullptr, &outlen, inbuf, m_aadlen))
     {
       std::cout << "### : EVP_DecryptUpdate AAD failed" << std::endl;
       return;
@@ -392,7 +406,7 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
     count -= m_aadlen;
   }
 
-  //auto taglen = EVP_CIPHER_CTX_get_tag_length(m_cipher_ctx);
+  //auto taglen = EVP_CIPHER_CTX_get_tag_length(ctx);
   //std::cout << "### taglen=" << m_taglen << std::endl;
   if (m_taglen > 0)
   {
@@ -403,7 +417,7 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
       return;
     }
     if (!EVP_CIPHER_CTX_ctrl(
-          m_cipher_ctx, EVP_CTRL_AEAD_SET_TAG, m_taglen, inbuf))
+          ctx, EVP_CTRL_AEAD_SET_TAG, m_taglen, inbuf))
     {
       std::cout << "### EVP_CIPHER_CTX_ctrl(EVP_CTRL_AEAD_SET_TAG) failed"
                 << std::endl;
@@ -413,14 +427,14 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
     count -= m_taglen;
   }
 
-  if(!EVP_DecryptUpdate(m_cipher_ctx, outbuf, &outlen, inbuf, count))
+  if(!EVP_DecryptUpdate(ctx, outbuf, &outlen, inbuf, count))
   {
     std::cout << "### EVP_DecryptUpdate failed" << std::endl;
     return;
   }
 
   int totoutlen = outlen;
-  if(!EVP_DecryptFinal_ex(m_cipher_ctx, outbuf+outlen, &outlen))
+  if(!EVP_DecryptFinal_ex(ctx, outbuf+outlen, &outlen))
   {
     std::cout << "### EVP_DecryptFinal_ex failed" << std::endl;
     return;
@@ -440,6 +454,175 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
  *
  ****************************************************************************/
 
+EVP_CIPHER_CTX* EncryptedUdpSocket::peerEncryptCtx(const Peer& peer,
+                                                   const std::vector<uint8_t>& key)
+{
+  if (key.size() != static_cast<size_t>(EVP_CIPHER_key_length(m_cipher)))
+  {
+    std::cout << "### EncryptedUdpSocket::peerEncryptCtx: Bad key length "
+              << key.size() << std::endl;
+    return nullptr;
+  }
+
+  auto& pctx = m_peer_ctx[peer];
+  if (pctx.enc_ctx == nullptr)
+  {
+    pctx.enc_ctx = EVP_CIPHER_CTX_new();
+    if ((pctx.enc_ctx == nullptr) ||
+        !EVP_EncryptInit_ex(pctx.enc_ctx, m_cipher, NULL, NULL, NULL))
+    {
+      std::cout << "### EVP_EncryptInit_ex failed" << std::endl;
+      EVP_CIPHER_CTX_free(pctx.enc_ctx);
+      pctx.enc_ctx = nullptr;
+      return nullptr;
+    }
+    pctx.enc_key.clear();
+  }
+
+    // Rekey only when the key for the peer has changed. The key schedule is
+    // then kept in the context and only the IV need to be set per datagram.
+  if (pctx.enc_key != key)
+  {
+    pctx.enc_key.clear();
+    if (!EVP_EncryptInit_ex(pctx.enc_ctx, NULL, NULL, key.data(), NULL))
+    {
+      std::cout << "### EVP_EncryptInit_ex failed" << std::endl;
+      return nullptr;
+    }
+    pctx.enc_key = key;
+  }
+
+  return pctx.enc_ctx;
+} /* EncryptedUdpSocket::peerEncryptCtx */
+
+
+EVP_CIPHER_CTX* EncryptedUdpSocket::peerDecryptCtx(const Peer& peer,
+                                                   const std::vector<uint8_t>& key)
+{
+  if (key.size() != static_cast<size_t>(EVP_CIPHER_key_length(m_cipher)))
+  {
+    std::cout << "### EncryptedUdpSocket::peerDecryptCtx: Bad key length "
+              << key.size() << std::endl;
+    return nullptr;
+  }
+
+  auto& pctx = m_peer_ctx[peer];
+  if (pctx.dec_ctx == nullptr)
+  {
+    pctx.dec_ctx = EVP_CIPHER_CTX_new();
+    if ((pctx.dec_ctx == nullptr) ||
+        !EVP_DecryptInit_ex(pctx.dec_ctx, m_cipher, NULL, NULL, NULL))
+    {
+      std::cout << "### EVP_DecryptInit_ex failed" << std::endl;
+      EVP_CIPHER_CTX_free(pctx.dec_ctx);
+      pctx.dec_ctx = nullptr;
+      return nullptr;
+    }
+    pctx.dec_key.clear();
+  }
+
+  if (pctx.dec_key != key)
+  {
+    pctx.dec_key.clear();
+    if (!EVP_DecryptInit_ex(pctx.dec_ctx, NULL, NULL, key.data(), NULL))
+    {
+      std::cout << "### EVP_DecryptInit_ex failed" << std::endl;
+      return nullptr;
+    }
+    pctx.dec_key = key;
+  }
+
+  return pctx.dec_ctx;
+} /* EncryptedUdpSocket::peerDecryptCtx */
+
+
+void EncryptedUdpSocket::clearPeerCtx(void)
+{
+  for (auto& item : m_peer_ctx)
+  {
+    EVP_CIPHER_CTX_free(item.second.enc_ctx);
+    EVP_CIPHER_CTX_free(item.second.dec_ctx);
+  }
+  m_peer_ctx.clear();
+} /* EncryptedUdpSocket::clearPeerCtx */
+
+
+bool EncryptedUdpSocket::encrypt(EVP_CIPHER_CTX* ctx,
+                                 const IpAddress& remote_ip, int remote_port,
+                                 const uint8_t* iv,
+                                 const void *aad, int aadlen,
+                                 const void *buf, int cnt)
+{
+  assert(ctx != nullptr);
+  assert((aad == nullptr) == (aadlen <= 0));
+
+  Metrics::ScopedTimer encrypt_timer(m_encrypt_hist);
+
+  auto inbuf = static_cast<const uint8_t*>(buf);
+  auto aadbuf = static_cast<const uint8_t*>(aad);
+
+  if ((iv != nullptr) && !EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, iv))
+  {
+    std::cout << "### EVP_EncryptInit_ex failed" << std::endl;
+    return false;
+  }
+
+  //auto taglen = EVP_CIPHER_CTX_get_tag_length(ctx);
+  //std::cout << "### taglen=" << m_taglen << std::endl;
+
+    // Allow enough space in output buffer for AAD, tag, encrypted plaintext
+    // and one additional block
+  uint8_t outbuf[aadlen + m_taglen + cnt + EVP_MAX_BLOCK_LENGTH];
+  auto outbufp = outbuf;
+  int outlen = 0;
+  int totoutlen = aadlen + m_taglen;
+  if (aadlen > 0)
+  {
+    std::memcpy(outbufp, aadbuf, aadlen);
+    if(!EVP_EncryptUpdate(ctx, nullptr, &outlen, aadbuf, aadlen))
+    {
+      std::cout << "### EVP_EncryptUpdate with AAD failed" << std::endl;
+      ERR_print_errors_fp(stderr);
+      return false;
+    }
+  }
+  outbufp += aadlen + m_taglen;
+
+  if(!EVP_EncryptUpdate(ctx, outbufp, &outlen, inbuf, cnt))
+  {
+    std::cout << "### EVP_EncryptUpdate failed" << std::endl;
+    return false;
+  }
+  outbufp += outlen;
+  totoutlen += outlen;
+
+  if(!EVP_EncryptFinal_ex(ctx, outbufp, &outlen))
+  {
+    std::cout << "### EVP_EncryptFinal failed" << std::endl;
+    return false;
+  }
+  totoutlen += outlen;
+
+  if (m_taglen > 0)
+  {
+    outbufp = outbuf + aadlen;
+    if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, m_taglen, outbufp))
+    {
+      std::cout << "### EVP_CIPHER_CTX_ctrl(EVP_CTRL_AEAD_GET_TAG) failed"
+                << std::endl;
+      return false;
+    }
+  }
+
+  //std::cout << "### EncryptedUdpSocket::encrypt: totoutlen=" << totoutlen
+  //          << " data=";
+  //std::copy(outbuf, outbuf+totoutlen,
+  //    std::ostream_iterator<int>(std::cout << std::hex, " "));
+  //std::cout << std::dec << std::endl;
+
+  return UdpSocket::write(remote_ip, remote_port, outbuf, totoutlen);
+} /* EncryptedUdpSocket::encrypt */
+
 
 
 /*
@@ -40,6 +40,8 @@ An example of how to use the Async::EncryptedUdpSocket class
 
 #include <openssl/evp.h>
 #include <vector>
+#include <map>
+#include <utility>
 
 
 /****************************************************************************
@@ -49,6 +51,7 @@ An example of how to use the Async::EncryptedUdpSocket class
  ****************************************************************************/
 
 #include <AsyncUdpSocket.h>
+#include <AsyncMetrics.h>
 
 
 /****************************************************************************
@@ -123,6 +126,25 @@ class EncryptedUdpSocket : public UdpSocket
   public:
     using Cipher = EVP_CIPHER;
 
+    /**
+     * @brief   A datagram to send using the writeBatch function
+     *
+     * Each datagram carry its own destination, cipher key and IV. The AAD and
+     * plaintext buffers are not copied so they must be valid until the call
+     * to writeBatch returns.
+     */
+    struct Datagram
+    {
+      IpAddress             remote_ip;
+      int                   remote_port = 0;
+      std::vector<uint8_t>  key;
+      std::vector<uint8_t>  iv;
+      const void*           aad         = nullptr;
+      int                   aadlen      = 0;
+      const void*           buf         = nullptr;
+      int                   count       = 0;
+    };
+
     /**
      * @brief   Fetch a named cipher object
      * @param   name The name of the cipher
@@ -324,6 +346,39 @@ class EncryptedUdpSocket : public UdpSocket
     bool write(const IpAddress& remote_ip, int remote_port,
                const void *aad, int aadlen, const void *buf, int cnt);
 
+    /**
+     * @brief   Encrypt and send a number of datagrams in one go
+     * @param   datagrams The datagrams to send
+     * @return  Returns the number of datagrams successfully sent
+     *
+     * Use this function to send many datagrams, possibly to different peers
+     * using different keys, in one call. The key and IV in each datagram
+     * will be used instead of the ones set using setCipherKey and
+     * setCipherIV. A pre-keyed cipher context is cached for each peer so the
+     * only per datagram cost is the encryption itself.
+     */
+    size_t writeBatch(const std::vector<Datagram>& datagrams);
+
+    /**
+     * @brief   Forget the cached cipher contexts for a peer
+     * @param   remote_ip   The IP-address of the remote host
+     * @param   remote_port The remote port
+     *
+     * A pre-keyed cipher context is cached for each peer that data has been
+     * sent to. Data received from such a peer is then also decrypted using a
+     * cached context. Data received from other peers never create a cache
+     * entry. Call this function when a peer is known to be gone to free the
+     * resources associated with it. The cached contexts are automatically
+     * rekeyed if the key for a peer is changed.
+     */
+    void forgetPeer(const IpAddress& remote_ip, uint16_t remote_port);
+
+    /**
+     * @brief   Get the number of peers that have a cached cipher context
+     * @return  Returns the number of cached peers
+     */
+    size_t cachedPeerCount(void) const { return m_peer_ctx.size(); }
+
     /**
      * @brief   A signal that is emitted when cipher data has been received
      * @param   ip    The IP-address the data was received from
@@ -350,11 +405,33 @@ class EncryptedUdpSocket : public UdpSocket
         int count) override;
 
   private:
+    using Peer = std::pair<IpAddress, uint16_t>;
+    struct PeerCipherCtx
+    {
+      std::vector<uint8_t>  enc_key;
+      EVP_CIPHER_CTX*       enc_ctx = nullptr;
+      std::vector<uint8_t>  dec_key;
+      EVP_CIPHER_CTX*       dec_ctx = nullptr;
+    };
+    using PeerCipherCtxMap = std::map<Peer, PeerCipherCtx>;
+
     EVP_CIPHER_CTX*       m_cipher_ctx  = nullptr;
+    const Cipher*         m_cipher      = nullptr;
+    PeerCipherCtxMap      m_peer_ctx;
     std::vector<uint8_t>  m_cipher_iv;
     std::vector<uint8_t>  m_cipher_key;
     size_t                m_taglen      = 0;
     size_t                m_aadlen      = 0;
+    Metrics::Histogram&   m_encrypt_hist;
+
+    EVP_CIPHER_CTX* peerEncryptCtx(const Peer& peer,
+                                   const std::vector<uint8_t>& key);
+    EVP_CIPHER_CTX* peerDecryptCtx(const Peer& peer,
+                                   const std::vector<uint8_t>& key);
+    void clearPeerCtx(void);
+    bool encrypt(EVP_CIPHER_CTX* ctx, const IpAddress& remote_ip,
+                 int remote_port, const uint8_t* iv,
+                 const void *aad, int aadlen, const void *buf, int cnt);
 
 };  /* class EncryptedUdpSocket */
 
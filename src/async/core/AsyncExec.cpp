@@ -38,7 +38,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/resource.h>
-#include <sys/types.h>
+#include <sys/syscall.h>
+#include <spawn.h>
 
 #include <cstring>
 #include <cassert>
@@ -54,6 +55,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncTimer.h>
+#include <AsyncApplication.h>
 
 
 /****************************************************************************
@@ -99,6 +101,8 @@ using namespace Async;
  *
  ****************************************************************************/
 
+static int pidfdOpen(pid_t pid);
+static bool createPipe(int fds[2], const char *name, const std::string& cmd);
 
 
 /****************************************************************************
@@ -128,42 +132,10 @@ struct sigaction  Exec::old_sigact;
  ****************************************************************************/
 
 Exec::Exec(const std::string &cmd)
-  : pid(-1), stdout_watch(0), stderr_watch(0), stdin_fd(-1),
+  : pid(-1), stdout_watch(0), stderr_watch(0), pid_watch(0), stdin_fd(-1),
     status(0), nice_value(0), timeout_timer(0), pending_term(false)
 {
   setCommandLine(cmd);
-
-    // Set up SIGCHLD signal handling on first usage of the class
-  if (sigchld_watch == 0)
-  {
-    int ret = pipe(sigchld_pipe);
-    if (ret == -1)
-    {
-      cerr << "*** ERROR: Could not set up SIGCHLD pipe for Async::Exec: "
-        << strerror(errno) << endl;
-      exit(1);
-    }
-    sigchld_watch = new FdWatch(sigchld_pipe[0], FdWatch::FD_WATCH_RD);
-    sigchld_watch->activity.connect(
-        sigc::hide(sigc::ptr_fun(Exec::sigchldReceived)));
-
-    struct sigaction act;
-    memset(&act, 0, sizeof(act));
-    act.sa_sigaction = &handleSigChld;
-    act.sa_flags = SA_RESTART|SA_NOCLDSTOP|SA_SIGINFO;
-    if (sigaction(SIGCHLD, &act, &old_sigact) == -1)
-    {
-      cout << "*** ERROR: Could not set up SIGCHLD signal handler\n";
-      exit(1);
-    }
-    /*
-    cout << "### handler=" << old_sigact.sa_handler
-        //<< " mask=" << old_sigact.sa_mask
-      << " flags=" << old_sigact.sa_flags
-      << " sigaction=" << old_sigact.sa_sigaction
-      << endl;
-    */
-  }
 } /* Exec::Exec */
 
 
@@ -192,6 +164,12 @@ Exec::~Exec(void)
     delete stderr_watch;
   }
 
+  if (pid_watch != 0)
+  {
+    close(pid_watch->fd());
+    delete pid_watch;
+  }
+
   delete timeout_timer;
 } /* Exec::~Exec */
 
@@ -263,118 +241,176 @@ void Exec::setTimeout(int time_s)
 
 bool Exec::run(void)
 {
-    // Create pipe file descriptor pair for handling stdin to subprocess
-  int in_filedes[2];
-  int ret = pipe(in_filedes);
-  if (ret == -1)
+  if (args.empty())
   {
-    cerr << "*** ERROR: Could not set up stdin pipe for subprocess "
-         << args[0] << ": " << strerror(errno) << endl;
+    cerr << "*** ERROR: No command specified for Async::Exec" << endl;
     return false;
   }
 
-    // Create pipe file descriptor pair for handling stdout from subprocess
+    // Create pipe file descriptor pairs for handling stdin, stdout and stderr
+    // for the subprocess. All file descriptors are created with the
+    // close-on-exec flag set so that they do not leak into other
+    // subprocesses. The flag is cleared on the descriptors that are
+    // duplicated to stdin, stdout and stderr in the subprocess.
+  int in_filedes[2];
+  if (!createPipe(in_filedes, "stdin", args[0]))
+  {
+    return false;
+  }
   int out_filedes[2];
-  ret = pipe(out_filedes);
-  if (ret == -1)
+  if (!createPipe(out_filedes, "stdout", args[0]))
   {
-    cerr << "*** ERROR: Could not set up stdout pipe for subprocess "
-         << args[0] << ": " << strerror(errno) << endl;
+    close(in_filedes[0]);
+    close(in_filedes[1]);
     return false;
   }
-
-    // Create pipe file descriptor pair for handling stderr from subprocess
   int err_filedes[2];
-  ret = pipe(err_filedes);
-  if (ret == -1)
+  if (!createPipe(err_filedes, "stderr", args[0]))
   {
-    cerr << "*** ERROR: Could not set up stderr pipe for subprocess "
-         << args[0] << ": " << strerror(errno) << endl;
+    close(in_filedes[0]);
+    close(in_filedes[1]);
+    close(out_filedes[0]);
+    close(out_filedes[1]);
     return false;
   }
 
-  pid = fork();
-  if (pid == -1)
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, in_filedes[0], STDIN_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, out_filedes[1], STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, err_filedes[1], STDERR_FILENO);
+
+  posix_spawnattr_t attr;
+  posix_spawnattr_init(&attr);
+#ifdef POSIX_SPAWN_USEVFORK
+    // Only needed for glibc < 2.24. Later versions always use vfork semantics.
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_USEVFORK);
+#endif
+
+  vector<char*> argv;
+  for (const auto& arg : args)
   {
-    cerr << "*** ERROR: The fork system call failed for subprocess "
-         << args[0] << ": " << strerror(errno) << endl;
-    return false;
+    argv.push_back(const_cast<char*>(arg.c_str()));
   }
+  argv.push_back(0);
 
-    // If pid is non-zero we're in the parent process
-  if (pid != 0)
+    // Set up the environment. Variables added using addEnvironmentVar
+    // override inherited variables with the same name.
+  vector<string> env_strs;
+  if (!clear_env)
   {
-      // Set up priority for child if specified
-    if (nice_value != 0)
+    for (char **e = environ; *e != 0; ++e)
     {
-      nice(0);
+      env_strs.push_back(*e);
     }
+  }
+  for (const auto& var : env)
+  {
+    string name = var.substr(0, var.find('='));
+    for (auto it = env_strs.begin(); it != env_strs.end(); )
+    {
+      if ((it->compare(0, name.size(), name) == 0) &&
+          (it->size() > name.size()) && ((*it)[name.size()] == '='))
+      {
+        it = env_strs.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+    env_strs.push_back(var);
+  }
+  vector<char*> envp;
+  for (const auto& var : env_strs)
+  {
+    envp.push_back(const_cast<char*>(var.c_str()));
+  }
+  envp.push_back(0);
 
-      // Add the new child to the global map
-    execs[pid] = this;
-
-      // Set up handling for subprocess stdin
-    close(in_filedes[0]);
-    stdin_fd = in_filedes[1];
-
-      // Set up handling for subprocess stdout
-    close(out_filedes[1]);
-    stdout_watch = new FdWatch(out_filedes[0], FdWatch::FD_WATCH_RD);
-    stdout_watch->activity.connect(mem_fun(*this, &Exec::stdoutActivity));
-
-      // Set up handling for subprocess stderr
-    close(err_filedes[1]);
-    stderr_watch = new FdWatch(err_filedes[0], FdWatch::FD_WATCH_RD);
-    stderr_watch->activity.connect(mem_fun(*this, &Exec::stderrActivity));
+  pid_t child_pid = -1;
+  int ret = posix_spawn(&child_pid, argv[0], &actions, &attr, argv.data(),
+                        envp.data());
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
 
-    if (timeout_timer != 0)
+  if (ret != 0)
+  {
+      // Report the error in the same way as if the subprocess had failed
+      // to execute the command
+    stringstream ss;
+    ss << "*** ERROR: Failed to exec " << args[0] << ": " << strerror(ret)
+       << endl;
+    const string& errmsg = ss.str();
+    if (write(err_filedes[1], errmsg.c_str(), errmsg.size()) == -1)
     {
-      timeout_timer->setEnable(true);
+      cerr << errmsg;
     }
-
-    return true;
+    status = 255 << 8;
   }
 
-  /* From this point we are in the child process */
-
-    // Set up stdin pipe
-  close(in_filedes[1]);
-  dup2(in_filedes[0], STDIN_FILENO);
+    // Close the subprocess ends of the pipes
   close(in_filedes[0]);
-
-    // Set up stdout pipe
-  close(out_filedes[0]);
-  dup2(out_filedes[1], STDOUT_FILENO);
   close(out_filedes[1]);
-
-    // Set up stderr pipe
-  close(err_filedes[0]);
-  dup2(err_filedes[1], STDERR_FILENO);
   close(err_filedes[1]);
 
-  char *cmd[args.size()+1];
-  for (size_t i=0; i<args.size(); ++i)
+    // Set up handling for subprocess stdin, stdout and stderr
+  stdin_fd = in_filedes[1];
+  stdout_watch = new FdWatch(out_filedes[0], FdWatch::FD_WATCH_RD);
+  stdout_watch->activity.connect(mem_fun(*this, &Exec::stdoutActivity));
+  stderr_watch = new FdWatch(err_filedes[0], FdWatch::FD_WATCH_RD);
+  stderr_watch->activity.connect(mem_fun(*this, &Exec::stderrActivity));
+
+  if (ret != 0)
   {
-    cmd[i] = strdup(args[i].c_str());
+    Application::app().runTask(mem_fun(*this, &Exec::spawnFailed));
+    return true;
   }
-  cmd[args.size()] = 0;
 
-  if (clear_env)
+  pid = child_pid;
+
+    // Set up priority for child if specified
+  if (nice_value != 0)
   {
-    clearenv();
+    nice(0);
   }
-  for (size_t i=0; i<env.size(); ++i)
+
+    // Set up reaping of the subprocess. Use a process file descriptor if
+    // supported by the kernel or else fall back to using SIGCHLD.
+  int pidfd = pidfdOpen(pid);
+  if (pidfd >= 0)
   {
-    putenv(strdup(env[i].c_str()));
+    if (pid_watch != 0)
+    {
+      close(pid_watch->fd());
+    }
+    else
+    {
+      pid_watch = new FdWatch;
+      pid_watch->activity.connect(mem_fun(*this, &Exec::pidfdActivity));
+    }
+    pid_watch->setFd(pidfd, FdWatch::FD_WATCH_RD);
+    pid_watch->setEnabled(true);
   }
+  else
+  {
+    setupSigChld();
+    execs[pid] = this;
 
-  ret = execv(cmd[0], cmd);
-  assert (ret == -1);
+      // The subprocess may already have exited before it was added to the
+      // map so trigger a check of all subprocesses
+    if (write(sigchld_pipe[1], "C", 1) == -1)
+    {
+      cerr << "*** ERROR: Could not write SIGCHLD notification to pipe\n";
+    }
+  }
 
-  cerr << "*** ERROR: Failed to exec " << args[0]
-       << ": " << strerror(errno) << endl;
+  if (timeout_timer != 0)
+  {
+    timeout_timer->setEnable(true);
+  }
 
-  exit(255);
+  return true;
 } /* Exec::run */
 
 
@@ -525,6 +561,37 @@ void Exec::handleSigChld(int signal_number, siginfo_t *info, void *context)
 } /* Exec::handleSigChld */
 
 
+void Exec::setupSigChld(void)
+{
+    // Set up SIGCHLD signal handling on first need
+  if (sigchld_watch != 0)
+  {
+    return;
+  }
+
+  int ret = pipe2(sigchld_pipe, O_CLOEXEC);
+  if (ret == -1)
+  {
+    cerr << "*** ERROR: Could not set up SIGCHLD pipe for Async::Exec: "
+      << strerror(errno) << endl;
+    exit(1);
+  }
+  sigchld_watch = new FdWatch(sigchld_pipe[0], FdWatch::FD_WATCH_RD);
+  sigchld_watch->activity.connect(
+      sigc::hide(sigc::ptr_fun(Exec::sigchldReceived)));
+
+  struct sigaction act;
+  memset(&act, 0, sizeof(act));
+  act.sa_sigaction = &handleSigChld;
+  act.sa_flags = SA_RESTART|SA_NOCLDSTOP|SA_SIGINFO;
+  if (sigaction(SIGCHLD, &act, &old_sigact) == -1)
+  {
+    cout << "*** ERROR: Could not set up SIGCHLD signal handler\n";
+    exit(1);
+  }
+} /* Exec::setupSigChld */
+
+
 void Exec::subprocessExited(void)
 {
   execs.erase(pid);
@@ -535,6 +602,34 @@ void Exec::subprocessExited(void)
 } /* Exec::subprocessExited */
 
 
+void Exec::pidfdActivity(Async::FdWatch *w)
+{
+  int wstatus = 0;
+  pid_t ret = waitpid(pid, &wstatus, WNOHANG);
+  if (ret == -1)
+  {
+    cerr << "*** ERROR: Could not poll status of process " << command()
+         << ": " << strerror(errno) << endl;
+    w->setEnabled(false);
+    return;
+  }
+  if (ret == pid)
+  {
+    w->setEnabled(false);
+    status = wstatus;
+    subprocessExited();
+  }
+} /* Exec::pidfdActivity */
+
+
+void Exec::spawnFailed(void)
+{
+  delete timeout_timer;
+  timeout_timer = 0;
+  exited();
+} /* Exec::spawnFailed */
+
+
 void Exec::handleTimeout(void)
 {
   if (!pending_term)
@@ -597,6 +692,44 @@ void Exec::sigchldReceived(void)
 
 
 
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+/**
+ * @brief   Open a process file descriptor for the given process
+ * @param   pid The process id
+ * @return  Returns the file descriptor or -1 if not supported
+ *
+ * A process file descriptor become readable when the process exit.
+ * It is supported by Linux 5.3 and later.
+ */
+static int pidfdOpen(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    // The close-on-exec flag is always set on a new process file descriptor
+  return syscall(SYS_pidfd_open, pid, 0);
+#else
+  return -1;
+#endif
+} /* pidfdOpen */
+
+
+static bool createPipe(int fds[2], const char *name, const std::string& cmd)
+{
+  if (pipe2(fds, O_CLOEXEC) == -1)
+  {
+    cerr << "*** ERROR: Could not set up " << name << " pipe for subprocess "
+         << cmd << ": " << strerror(errno) << endl;
+    return false;
+  }
+  return true;
+} /* createPipe */
+
+
+
 /*
  * This file has not been truncated
  */
@@ -123,8 +123,15 @@ This class is used to execute external commands. It essentially wraps the
 exec system call together with commonly used infrastructure in a convenient
 class.
 
-This class depends on the SIGCHLD UNIX signal so it must not be used by
-another part of the application.
+The subprocess is started using posix_spawn which, unlike fork, do not copy
+the page tables of the calling process. That keep the cost of starting a
+subprocess low even when the application use a lot of memory. On Linux 5.3
+and later, each subprocess is reaped using a process file descriptor that is
+watched like any other file descriptor.
+
+On systems that do not support process file descriptors, this class depend
+on the SIGCHLD UNIX signal so it must not be used by another part of the
+application.
 
 \include AsyncExec_demo.cpp
 */
@@ -224,10 +231,10 @@ class Exec : public sigc::trackable
      *
      * This method is used to run the command specified using the constructor,
      * setCommandLine and appendArgument. This function will return success as
-     * long as the fork call succeeds. If the command cannot be run for some
-     * reason, this function will still return success. Errors that occurr
-     * after the fork call will be handled through the "exited" signal. If the
-     * command cannot run for some reason, the exit code will be 255.
+     * long as the pipes to the subprocess could be set up. If the command
+     * cannot be run for some reason, this function will still return
+     * success. The error will then be written to the stderr pipe and the
+     * "exited" signal will be emitted with an exit code of 255.
      */
     bool run(void);
 
@@ -357,6 +364,7 @@ class Exec : public sigc::trackable
     pid_t                     pid;
     Async::FdWatch            *stdout_watch;
     Async::FdWatch            *stderr_watch;
+    Async::FdWatch            *pid_watch;
     int                       stdin_fd;
     int                       status;
     int                       nice_value;
@@ -367,12 +375,15 @@ class Exec : public sigc::trackable
     static void handleSigChld(int signal_number, siginfo_t *info,
                               void *context);
     static void sigchldReceived(void);
+    static void setupSigChld(void);
 
     Exec(const Exec&);
     Exec& operator=(const Exec&);
     void stdoutActivity(Async::FdWatch *w);
     void stderrActivity(Async::FdWatch *w);
     void subprocessExited(void);
+    void pidfdActivity(Async::FdWatch *w);
+    void spawnFailed(void);
     void handleTimeout(void);
     
 };  /* class Exec */
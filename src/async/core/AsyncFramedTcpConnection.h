@@ -219,6 +219,12 @@ class FramedTcpConnection : public TcpConnection
      */
     virtual int write(const void *buf, int count) override;
 
+    /**
+     * @brief   Get the number of frames waiting to be sent
+     * @return  Returns the number of queued frames
+     */
+    size_t txQueueSize(void) const { return m_txq.size(); }
+
     /**
      * @brief 	A signal that is emitted when a connection has been terminated
      * @param 	con   	The connection object
@@ -30,10 +30,24 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
+
 #include <cstring>
 #include <cerrno>
 #include <sstream>
 #include <cassert>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -142,6 +156,66 @@ namespace
 
     return row.size() <= MAX_HTTP_LINE_LEN;
   } /* appendHttpLine */
+
+
+  /**
+   * @brief   Check if a comma separated header value contain a token
+   * @param   value The header value
+   * @param   token The token to look for (case insensitive)
+   * @return  Returns \em true if the token was found
+   */
+  bool headerHasToken(const std::string& value, const char* token)
+  {
+    size_t token_len = strlen(token);
+    size_t pos = 0;
+    while (pos < value.size())
+    {
+      size_t end = value.find(',', pos);
+      if (end == std::string::npos)
+      {
+        end = value.size();
+      }
+      size_t begin = value.find_first_not_of(" \t", pos);
+      size_t last = value.find_first_of(" \t;", begin);
+      if ((last == std::string::npos) || (last > end))
+      {
+        last = end;
+      }
+      if ((begin < last) && (last - begin == token_len) &&
+          (strncasecmp(value.c_str() + begin, token, token_len) == 0))
+      {
+        return true;
+      }
+      pos = end + 1;
+    }
+    return false;
+  } /* headerHasToken */
+
+
+  /**
+   * @brief   Call sendfile without getting a SIGPIPE
+   *
+   * There is no flag for sendfile, like MSG_NOSIGNAL for send, so SIGPIPE
+   * is blocked during the call. A SIGPIPE generated by the call is consumed
+   * before the signal mask is restored.
+   */
+  ssize_t sendfileNoSignal(int sock, int fd, off_t* offset, size_t count)
+  {
+    sigset_t pipe_set, old_set;
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+    ssize_t ret = ::sendfile(sock, fd, offset, count);
+    int saved_errno = errno;
+    if ((ret < 0) && (errno == EPIPE) && !sigismember(&old_set, SIGPIPE))
+    {
+      struct timespec zero = {0, 0};
+      sigtimedwait(&pipe_set, NULL, &zero);
+    }
+    pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+    errno = saved_errno;
+    return ret;
+  } /* sendfileNoSignal */
 } /* anonymous namespace */
 
 
@@ -176,14 +250,80 @@ namespace
  *
  ****************************************************************************/
 
+const std::string* HttpServerConnection::Content::gzipped(void) const
+{
+  if (m_gzip_done)
+  {
+    return m_gzipped.get();
+  }
+  m_gzip_done = true;
+
+#ifdef HAS_ZLIB
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+    // Window bits 15 + 16 give a gzip header and trailer
+  if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    return nullptr;
+  }
+  std::unique_ptr<std::string> out(new std::string);
+  out->resize(deflateBound(&strm, m_data.size()));
+  strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(m_data.data()));
+  strm.avail_in = m_data.size();
+  strm.next_out = reinterpret_cast<Bytef*>(&(*out)[0]);
+  strm.avail_out = out->size();
+  int ret = deflate(&strm, Z_FINISH);
+  size_t out_len = strm.total_out;
+  deflateEnd(&strm);
+  if ((ret == Z_STREAM_END) && (out_len < m_data.size()))
+  {
+    out->resize(out_len);
+    out->shrink_to_fit();
+    m_gzipped = std::move(out);
+  }
+#endif
+
+  return m_gzipped.get();
+} /* HttpServerConnection::Content::gzipped */
+
+
+HttpServerConnection::FileContent::~FileContent(void)
+{
+  ::close(m_fd);
+} /* HttpServerConnection::FileContent::~FileContent */
+
+
+bool HttpServerConnection::Response::setContentFile(
+    const std::string& content_type, const std::string& path)
+{
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    return false;
+  }
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode))
+  {
+    ::close(fd);
+    return false;
+  }
+  m_file = std::make_shared<const FileContent>(fd, st.st_size);
+  m_content.reset();
+  m_compress = false;
+  setHeader("Content-type", content_type);
+  setHeader("Content-length", m_file->size());
+  setSendContent(true);
+  return true;
+} /* HttpServerConnection::Response::setContentFile */
+
+
 HttpServerConnection::HttpServerConnection(size_t recv_buf_len)
   : TcpConnection(recv_buf_len), m_state(STATE_DISCONNECTED),
-    m_chunked(false)
+    m_chunked(false),
+    m_idle_timer(DEFAULT_IDLE_TIMEOUT, Timer::TYPE_ONESHOT, false)
 {
-#if 0
-  TcpConnection::sendBufferFull.connect(
-      sigc::mem_fun(*this, &HttpServerConnection::onSendBufferFull));
-#endif
+  init();
 } /* HttpServerConnection::HttpServerConnection */
 
 
@@ -191,12 +331,12 @@ HttpServerConnection::HttpServerConnection(
     int sock, const IpAddress& remote_addr, uint16_t remote_port,
     size_t recv_buf_len)
   : TcpConnection(sock, remote_addr, remote_port, recv_buf_len),
-    m_state(STATE_EXPECT_START_LINE), m_chunked(false)
+    m_state(STATE_EXPECT_START_LINE), m_chunked(false),
+    m_idle_timer(DEFAULT_IDLE_TIMEOUT, Timer::TYPE_ONESHOT, false)
 {
-#if 0
-  TcpConnection::sendBufferFull.connect(
-      sigc::mem_fun(*this, &HttpServerConnection::onSendBufferFull));
-#endif
+  init();
+  m_tx_watch.setFd(sock, FdWatch::FD_WATCH_WR);
+  m_idle_timer.setEnable(true);
 } /* HttpServerConnection::HttpServerConnection */
 
 
@@ -224,72 +364,170 @@ TcpConnection& HttpServerConnection::operator=(TcpConnection&& other_base)
   m_chunked = other.m_chunked;
   other.m_chunked = false;
 
+  m_content_left = other.m_content_left;
+  other.m_content_left = 0;
+
+  m_pending = std::move(other.m_pending);
+  other.m_pending.clear();
+
+  m_txq = std::move(other.m_txq);
+  other.m_txq.clear();
+
+  m_tx_watch = std::move(other.m_tx_watch);
+
+  m_close_after_flush = other.m_close_after_flush;
+  other.m_close_after_flush = false;
+
+  m_idle_timer.setEnable(isConnected() && (m_idle_timeout > 0));
+  other.m_idle_timer.setEnable(false);
+
   return *this;
 } /* HttpServerConnection::operator=(TcpConnection&&) */
 
 
-//int HttpServerConnection::write(const void *buf, int count)
-//{
-//  cout << "### HttpServerConnection::write: count=" << count << "\n";
-//  if (count < 0)
-//  {
-//    return 0;
-//  }
-//
-//  //QueueItem *qi = new QueueItem(buf, count);
-//  //if (m_txq.empty())
-//  //{
-//  //  int ret = TcpConnection::write(qi->m_buf, qi->m_size);
-//  //  //cout << "###   count=" << (qi->m_size-qi->m_pos) << " ret=" << ret << endl;
-//  //  if (ret < 0)
-//  //  {
-//  //    delete qi;
-//  //    qi = 0;
-//  //    return -1;
-//  //  }
-//  //  if (ret >= qi->m_size)
-//  //  {
-//  //    delete qi;
-//  //    qi = 0;
-//  //  }
-//  //  else
-//  //  {
-//  //    //cout << "### Not all bytes were sent: count=" << count
-//  //    //     << " ret=" << ret << endl;
-//  //    qi->m_pos += ret;
-//  //  }
-//  //}
-//
-//  //if (qi != 0)
-//  //{
-//  //  m_txq.push_back(qi);
-//  //}
-//
-//  return count;
-//} /* HttpServerConnection::write */
+void HttpServerConnection::setIdleTimeout(unsigned timeout_ms)
+{
+  m_idle_timeout = timeout_ms;
+  if (m_idle_timeout > 0)
+  {
+    m_idle_timer.setTimeout(m_idle_timeout);
+  }
+  m_idle_timer.setEnable(isConnected() && (m_idle_timeout > 0));
+} /* HttpServerConnection::setIdleTimeout */
 
 
 bool HttpServerConnection::write(const Response& res)
 {
+  PendingRequest req = { true, false, false };
+  if (!m_pending.empty())
+  {
+    req = m_pending.front();
+    m_pending.pop_front();
+  }
+
+  bool close = !req.keep_alive;
+  auto conn_it = res.headers().find("Connection");
+  if ((conn_it != res.headers().end()) &&
+      headerHasToken(conn_it->second, "close"))
+  {
+    close = true;
+  }
+
+    // Select what to send as body. Shared content is sent compressed if
+    // the client accept it.
+  std::shared_ptr<const void> owner;
+  const char* body = nullptr;
+  size_t body_len = 0;
+  bool gzip = false;
+  if (res.fileContent() != nullptr)
+  {
+    body_len = res.fileContent()->size();
+  }
+  else if (res.sharedContent() != nullptr)
+  {
+    const ContentPtr& content = res.sharedContent();
+    owner = content;
+    body = content->data().data();
+    body_len = content->data().size();
+    if (res.compress() && req.accept_gzip && (body_len >= MIN_GZIP_SIZE))
+    {
+      const std::string* gz = content->gzipped();
+      if (gz != nullptr)
+      {
+        body = gz->data();
+        body_len = gz->size();
+        gzip = true;
+      }
+    }
+  }
+
   std::ostringstream os;
   os << "HTTP/1.1 " << res.code() << " " << codeToString(res.code()) << "\r\n";
   for (const auto& header : res.headers())
   {
-    os << header.first << ": " << header.second << "\r\n";
+    if ((strcasecmp(header.first.c_str(), "Content-length") != 0) &&
+        (strcasecmp(header.first.c_str(), "Connection") != 0))
+    {
+      os << header.first << ": " << header.second << "\r\n";
+    }
+  }
+  if (gzip)
+  {
+    os << "Content-encoding: gzip\r\n";
+  }
+  if (res.compress())
+  {
+    os << "Vary: Accept-Encoding\r\n";
   }
   if (m_chunked)
   {
     os << "Transfer-encoding: chunked\r\n";
   }
-  os << "\r\n";
-  if (res.sendContent())
+  else if ((res.code() >= 200) && (res.code() != 204) && (res.code() != 304))
+  {
+    os << "Content-length: " << body_len << "\r\n";
+  }
+  if (close)
+  {
+    os << "Connection: close\r\n";
+  }
+  else if (req.http10)
   {
-    os << res.content();
+    os << "Connection: keep-alive\r\n";
   }
+  os << "\r\n";
   //std::cout << "### HttpServerConnection::write:" << std::endl;
   //std::cout << os.str() << std::endl;
-  int len = os.str().size();
-  return TcpConnection::write(os.str().c_str(), len) == len;
+
+  auto header = std::make_shared<const std::string>(os.str());
+  if (sslIsEnabled())
+  {
+      // No zero-copy when the data have to be encrypted
+    std::string data(*header);
+    if (res.sendContent())
+    {
+      if (res.fileContent() != nullptr)
+      {
+        data.resize(header->size() + body_len);
+        ssize_t ret = ::pread(res.fileContent()->fd(), &data[header->size()],
+                              body_len, 0);
+        if (ret != static_cast<ssize_t>(body_len))
+        {
+          return false;
+        }
+      }
+      else
+      {
+        data.append(body, body_len);
+      }
+    }
+    int len = data.size();
+    return TcpConnection::write(data.c_str(), len) == len;
+  }
+
+  queueData(header, header->data(), header->size());
+  if (res.sendContent())
+  {
+    if (res.fileContent() != nullptr)
+    {
+      queueFile(res.fileContent());
+    }
+    else if (body_len > 0)
+    {
+      queueData(owner, body, body_len);
+    }
+  }
+
+  if (close && !m_chunked)
+  {
+      // Requests that are already received after this one are ignored
+    m_close_after_flush = true;
+    m_pending.clear();
+  }
+
+  sendQueued();
+
+  return isConnected();
 } /* HttpServerConnection::write */
 
 
@@ -303,20 +541,35 @@ bool HttpServerConnection::write(const char* buf, int len)
     std::ostringstream os;
     //os << hex << len << ";tg=240;talker=SM0SVX\r\n";
     os << hex << len << "\r\n";
-    ret = TcpConnection::write(os.str().c_str(), os.str().size());
-    ret += TcpConnection::write(buf, len);
-    ret += TcpConnection::write("\r\n", 2);
+    ret = write(static_cast<const void*>(os.str().c_str()), os.str().size());
+    ret += write(static_cast<const void*>(buf), len);
+    ret += write(static_cast<const void*>("\r\n"), 2);
     len += os.str().size() + 2;
   }
   else
   {
-    ret = TcpConnection::write(buf, len);
+    ret = write(static_cast<const void*>(buf), len);
   }
 
   return ret == len;
 } /* HttpServerConnection::write */
 
 
+int HttpServerConnection::write(const void *buf, int count)
+{
+  assert(count >= 0);
+  if (sslIsEnabled())
+  {
+    return TcpConnection::write(buf, count);
+  }
+  auto data = std::make_shared<const std::string>(
+      reinterpret_cast<const char*>(buf), count);
+  queueData(data, data->data(), data->size());
+  sendQueued();
+  return isConnected() ? count : -1;
+} /* HttpServerConnection::write */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -339,13 +592,22 @@ void HttpServerConnection::onDisconnected(DisconnectReason reason)
 
 int HttpServerConnection::onDataReceived(void *buf, int count)
 {
+  m_idle_timer.reset();
+
+    // Everything received after a request to close the connection is
+    // thrown away
+  if (m_close_after_flush)
+  {
+    return count;
+  }
+
   std::string data(reinterpret_cast<char*>(buf), count);
   size_t data_pos = 0;
 
   //std::cout << "### HttpServerConnection::onDataReceived: "
   //         << data << std::endl;
 
-  while (data.size() > data_pos)
+  while ((data.size() > data_pos) && !m_close_after_flush)
   {
     if (m_state == STATE_EXPECT_START_LINE)
     {
@@ -377,18 +639,26 @@ int HttpServerConnection::onDataReceived(void *buf, int count)
         m_row.clear();
       }
     }
+    else if (m_state == STATE_EXPECT_PAYLOAD)
+    {
+      size_t len = std::min(m_content_left, data.size() - data_pos);
+      m_req.content.append(data, data_pos, len);
+      data_pos += len;
+      m_content_left -= len;
+      if (m_content_left == 0)
+      {
+        m_state = STATE_REQ_COMPLETE;
+      }
+    }
     else
     {
-      data_pos = std::string::npos;
-      //m_req.content.append(data);
+      break;
     }
-  }
 
-  if (m_state == STATE_REQ_COMPLETE)
-  {
-    requestReceived(this, m_req);
-    m_req.clear();
-    m_state = STATE_EXPECT_START_LINE;
+    if (m_state == STATE_REQ_COMPLETE)
+    {
+      handleRequest();
+    }
   }
 
   return count;
@@ -448,7 +718,28 @@ void HttpServerConnection::handleHeader(void)
 
   if (m_row.empty())
   {
-    m_state = STATE_REQ_COMPLETE;
+    if (m_req.headers.count("Transfer-encoding") > 0)
+    {
+      std::cerr << "*** ERROR: HTTP request transfer encoding not supported"
+                << std::endl;
+      disconnect();
+      return;
+    }
+    m_content_left = 0;
+    auto it = m_req.headers.find("Content-length");
+    if (it != m_req.headers.end())
+    {
+      std::istringstream is(it->second);
+      if (!(is >> m_content_left) || !is.eof() ||
+          (m_content_left > MAX_REQUEST_CONTENT_LEN))
+      {
+        std::cerr << "*** ERROR: Illegal or too large HTTP request "
+                     "Content-length" << std::endl;
+        disconnect();
+        return;
+      }
+    }
+    m_state = (m_content_left > 0) ? STATE_EXPECT_PAYLOAD : STATE_REQ_COMPLETE;
     return;
   }
 
@@ -484,6 +775,182 @@ void HttpServerConnection::handleHeader(void)
 } /* HttpServerConnection::handleHeader */
 
 
+void HttpServerConnection::handleRequest(void)
+{
+  if (m_pending.size() >= MAX_PENDING_REQUESTS)
+  {
+    std::cerr << "*** ERROR: Too many unanswered HTTP requests" << std::endl;
+    disconnect();
+    return;
+  }
+
+  PendingRequest pending;
+  pending.http10 = (m_req.ver_major == 1) && (m_req.ver_minor == 0);
+  auto it = m_req.headers.find("Connection");
+  if (pending.http10 || (m_req.ver_major < 1))
+  {
+    pending.keep_alive = (it != m_req.headers.end()) &&
+                         headerHasToken(it->second, "keep-alive");
+  }
+  else
+  {
+    pending.keep_alive = (it == m_req.headers.end()) ||
+                         !headerHasToken(it->second, "close");
+  }
+  it = m_req.headers.find("Accept-encoding");
+  pending.accept_gzip = (it != m_req.headers.end()) &&
+                        headerHasToken(it->second, "gzip");
+  m_pending.push_back(pending);
+
+  m_state = STATE_EXPECT_START_LINE;
+  Request req;
+  req = std::move(m_req);
+  requestReceived(this, req);
+} /* HttpServerConnection::handleRequest */
+
+
+void HttpServerConnection::init(void)
+{
+  m_tx_watch.activity.connect(sigc::hide(
+      sigc::mem_fun(*this, &HttpServerConnection::sendQueued)));
+  m_idle_timer.expired.connect(sigc::hide(
+      sigc::mem_fun(*this, &HttpServerConnection::onIdleTimeout)));
+} /* HttpServerConnection::init */
+
+
+void HttpServerConnection::queueData(std::shared_ptr<const void> owner,
+                                     const char* data, size_t len)
+{
+  TxItem item;
+  item.owner = std::move(owner);
+  item.data = data;
+  item.len = len;
+  item.offset = 0;
+  m_txq.push_back(std::move(item));
+} /* HttpServerConnection::queueData */
+
+
+void HttpServerConnection::queueFile(const FileContentPtr& file)
+{
+  if (file->size() == 0)
+  {
+    return;
+  }
+  TxItem item;
+  item.data = nullptr;
+  item.len = file->size();
+  item.file = file;
+  item.offset = 0;
+  m_txq.push_back(std::move(item));
+} /* HttpServerConnection::queueFile */
+
+
+void HttpServerConnection::sendQueued(void)
+{
+  if (!isConnected())
+  {
+    return;
+  }
+
+  if (m_tx_watch.fd() != socket())
+  {
+    m_tx_watch.setFd(socket(), FdWatch::FD_WATCH_WR);
+  }
+
+  while (!m_txq.empty())
+  {
+    ssize_t ret = 0;
+    TxItem& front = m_txq.front();
+    if (front.data == nullptr)
+    {
+      off_t offset = front.offset;
+      ret = sendfileNoSignal(socket(), front.file->fd(), &offset, front.len);
+      if (ret == 0)
+      {
+          // The file has been truncated so the response cannot be completed
+        errno = EIO;
+        ret = -1;
+      }
+    }
+    else
+    {
+        // Send as many memory buffers as possible in one system call
+      struct iovec iov[16];
+      size_t iovcnt = 0;
+      for (auto it = m_txq.begin();
+           (it != m_txq.end()) && (it->data != nullptr) && (iovcnt < 16);
+           ++it)
+      {
+        iov[iovcnt].iov_base = const_cast<char*>(it->data);
+        iov[iovcnt].iov_len = it->len;
+        ++iovcnt;
+      }
+      struct msghdr msg;
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov = iov;
+      msg.msg_iovlen = iovcnt;
+      ret = ::sendmsg(socket(), &msg, MSG_NOSIGNAL);
+    }
+
+    if (ret < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+      {
+        m_tx_watch.setEnabled(true);
+        return;
+      }
+      closeConnection();
+      onDisconnected(DR_SYSTEM_ERROR);
+      return;
+    }
+
+    m_idle_timer.reset();
+
+    size_t sent = ret;
+    while (sent > 0)
+    {
+      TxItem& item = m_txq.front();
+      size_t len = std::min(sent, item.len);
+      item.len -= len;
+      if (item.data != nullptr)
+      {
+        item.data += len;
+      }
+      else
+      {
+        item.offset += len;
+      }
+      sent -= len;
+      if (item.len == 0)
+      {
+        m_txq.pop_front();
+      }
+    }
+  }
+
+  m_tx_watch.setEnabled(false);
+
+  if (m_close_after_flush)
+  {
+      // Only close our side so that the client will get the complete
+      // response. The connection is closed when the client close its side
+      // or when the idle timer expire.
+    ::shutdown(socket(), SHUT_WR);
+  }
+} /* HttpServerConnection::sendQueued */
+
+
+void HttpServerConnection::onIdleTimeout(void)
+{
+  //std::cout << "### HttpServerConnection::onIdleTimeout" << std::endl;
+  disconnect();
+} /* HttpServerConnection::onIdleTimeout */
+
+
 #if 0
 void HttpServerConnection::onSendBufferFull(bool is_full)
 {
@@ -520,6 +987,12 @@ void HttpServerConnection::disconnectCleanup(void)
   m_state = STATE_DISCONNECTED;
   m_row.clear();
   m_req.clear();
+  m_content_left = 0;
+  m_pending.clear();
+  m_txq.clear();
+  m_tx_watch.setEnabled(false);
+  m_idle_timer.setEnable(false);
+  m_close_after_flush = false;
 } /* HttpServerConnection::disconnectCleanup */
 
 
@@ -529,12 +1002,24 @@ const char* HttpServerConnection::codeToString(unsigned code)
   {
     case 200:
       return "OK";
+    case 204:
+      return "No Content";
+    case 304:
+      return "Not Modified";
+    case 400:
+      return "Bad Request";
     case 404:
       return "Not Found";
     case 406:
       return "Not Acceptable";
+    case 413:
+      return "Payload Too Large";
+    case 500:
+      return "Internal Server Error";
     case 501:
       return "Not Implemented";
+    case 503:
+      return "Service Unavailable";
     default:
       return "?";
   }
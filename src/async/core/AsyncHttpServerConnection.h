@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -39,12 +39,14 @@ An example of how to use the HttpServerConnection class in a client
  ****************************************************************************/
 
 #include <stdint.h>
+#include <strings.h>
 #include <vector>
 #include <deque>
 #include <cstring>
 #include <map>
 #include <string>
 #include <sstream>
+#include <memory>
 
 
 /****************************************************************************
@@ -54,6 +56,8 @@ An example of how to use the HttpServerConnection class in a client
  ****************************************************************************/
 
 #include <AsyncTcpConnection.h>
+#include <AsyncFdWatch.h>
+#include <AsyncTimer.h>
 
 
 /****************************************************************************
@@ -117,9 +121,27 @@ namespace Async
 @author Tobias Blomberg / SM0SVX
 @date   2019-08-26
 
-This class implement a VERY simple HTTP server side connection. It can be used
+This class implement a simple HTTP/1.1 server side connection. It can be used
 together with the Async::TcpServer class to build a HTTP server.
 
+Connections are persistent (keep-alive) unless the client ask for the
+connection to be closed or is using HTTP/1.0 without asking for keep-alive.
+Multiple requests may be sent by the client without waiting for the responses
+(pipelining). The requestReceived signal is emitted once for each request, in
+the order they were received, and the responses must be written in the same
+order.
+
+The response content may be given as a shared immutable Content object or as
+a file. Neither of them is copied when the response is sent. File content is
+sent using sendfile(2). A Content object also cache a gzip compressed version
+of itself that is sent to clients that accept gzip encoding, so a response
+that is sent many times only need to be compressed once. The zero-copy path
+is not used when TLS is enabled for the connection.
+
+A connection that has been idle for longer than the idle timeout is closed.
+Use the TcpServerBase::setMaxConnections function to put a limit on the
+number of simultaneous connections.
+
 WARNING: This implementation is not suitable to be exposed to the public
 Internet. It contains a number of security flaws and probably also
 incompatibilities. Only use this class with known clients.
@@ -129,7 +151,33 @@ incompatibilities. Only use this class with known clients.
 class HttpServerConnection : public TcpConnection
 {
   public:
-    typedef std::map<std::string, std::string> Headers;
+    /**
+     * @brief   The default time before closing an idle connection
+     */
+    static constexpr unsigned DEFAULT_IDLE_TIMEOUT  = 60000;
+
+    /**
+     * @brief   Content smaller than this is never compressed
+     */
+    static constexpr size_t MIN_GZIP_SIZE           = 256;
+
+    /**
+     * @brief   The maximum size of a request body
+     */
+    static constexpr size_t MAX_REQUEST_CONTENT_LEN = 65536;
+
+    /**
+     * @brief   Case insensitive ordering of header field names
+     */
+    struct HeaderLess
+    {
+      bool operator()(const std::string& a, const std::string& b) const
+      {
+        return strcasecmp(a.c_str(), b.c_str()) < 0;
+      }
+    };
+    typedef std::map<std::string, std::string, HeaderLess> Headers;
+
     struct Request
     {
       std::string method;
@@ -137,6 +185,7 @@ class HttpServerConnection : public TcpConnection
       unsigned ver_major;
       unsigned ver_minor;
       Headers headers;
+      std::string content;
 
       Request(void)
       {
@@ -151,6 +200,7 @@ class HttpServerConnection : public TcpConnection
         ver_major = 0;
         ver_minor = 0;
         headers.clear();
+        content.clear();
       }
 
       Request& operator=(Request&& other)
@@ -160,15 +210,68 @@ class HttpServerConnection : public TcpConnection
         ver_major = other.ver_major;
         ver_minor = other.ver_minor;
         headers = std::move(other.headers);
+        content = std::move(other.content);
         other.clear();
         return *this;
       }
     };
 
+    /**
+     * @brief   An immutable response body that can be shared
+     *
+     * A content object can be used for any number of responses, on any
+     * number of connections, without being copied. The first time the
+     * content is sent to a client that accept gzip encoding, a compressed
+     * version is created and cached in the object.
+     */
+    class Content
+    {
+      public:
+        explicit Content(std::string data) : m_data(std::move(data)) {}
+
+        const std::string& data(void) const { return m_data; }
+
+        /**
+         * @brief   Get the gzip compressed version of the content
+         * @return  Returns the compressed data or nullptr if not available
+         *
+         * Compression is not available if Async was built without zlib or
+         * if the compressed data would not be smaller than the original.
+         */
+        const std::string* gzipped(void) const;
+
+      private:
+        std::string                           m_data;
+        mutable std::unique_ptr<std::string>  m_gzipped;
+        mutable bool                          m_gzip_done = false;
+    };
+    typedef std::shared_ptr<const Content> ContentPtr;
+
+    /**
+     * @brief   A file used as response body
+     */
+    class FileContent
+    {
+      public:
+        FileContent(int fd, size_t size) : m_fd(fd), m_size(size) {}
+        ~FileContent(void);
+
+        int fd(void) const { return m_fd; }
+        size_t size(void) const { return m_size; }
+
+      private:
+        int     m_fd;
+        size_t  m_size;
+
+        FileContent(const FileContent&);
+        FileContent& operator=(const FileContent&);
+    };
+    typedef std::shared_ptr<const FileContent> FileContentPtr;
+
     class Response
     {
       public:
-        Response(void) : m_code(0), m_send_content(false) {}
+        Response(void) : m_code(0), m_send_content(false), m_compress(false) {}
 
         unsigned code(void) const { return m_code; }
         void setCode(unsigned code) { m_code = code; }
@@ -182,33 +285,76 @@ class HttpServerConnection : public TcpConnection
           m_headers[key] = os.str();
         }
 
-        const std::string& content(void) const { return m_content; }
+        const std::string& content(void) const
+        {
+          static const std::string empty;
+          return (m_content != nullptr) ? m_content->data() : empty;
+        }
         void setContent(const std::string& content_type,
                         const std::string& content)
+        {
+          setContent(content_type, std::make_shared<const Content>(content));
+          m_compress = false;
+        }
+
+        /**
+         * @brief   Set shared content for the response
+         * @param   content_type  The MIME type of the content
+         * @param   content       The content object
+         *
+         * Shared content is sent without being copied. If the client accept
+         * gzip encoding, the cached compressed version of the content will
+         * be sent.
+         */
+        void setContent(const std::string& content_type,
+                        const ContentPtr& content)
         {
           m_content = content;
+          m_file.reset();
+          m_compress = true;
           setHeader("Content-type", content_type);
-          setHeader("Content-length", m_content.size());
+          setHeader("Content-length", m_content->data().size());
           setSendContent(true);
         }
+        const ContentPtr& sharedContent(void) const { return m_content; }
+
+        /**
+         * @brief   Use the content of a file for the response
+         * @param   content_type  The MIME type of the content
+         * @param   path          The path to the file
+         * @return  Returns \em true on success or else \em false
+         *
+         * The file is opened directly and is sent using sendfile(2) when the
+         * response is written.
+         */
+        bool setContentFile(const std::string& content_type,
+                            const std::string& path);
+        const FileContentPtr& fileContent(void) const { return m_file; }
+
         bool sendContent(void) const { return m_send_content; }
         void setSendContent(bool send_content)
         {
           m_send_content = send_content;
         }
 
+        bool compress(void) const { return m_compress; }
+
         void clear(void)
         {
           m_code = 0;
           m_headers.clear();
-          m_content.clear();
+          m_content.reset();
+          m_file.reset();
+          m_compress = false;
         }
 
       private:
-        unsigned    m_code;
-        Headers     m_headers;
-        std::string m_content;
-        bool        m_send_content;
+        unsigned        m_code;
+        Headers         m_headers;
+        ContentPtr      m_content;
+        FileContentPtr  m_file;
+        bool            m_send_content;
+        bool            m_compress;
     };
 
     /**
@@ -253,6 +399,16 @@ class HttpServerConnection : public TcpConnection
      */
     void setChunked(void) { m_chunked = true; }
 
+    /**
+     * @brief   Set the time before closing an idle connection
+     * @param   timeout_ms The timeout in milliseconds (0=never close)
+     *
+     * The connection is closed if nothing has been received or sent during
+     * the given time. Set the timeout to zero for connections that are used
+     * for long lived streams with long periods of silence.
+     */
+    void setIdleTimeout(unsigned timeout_ms);
+
     /**
      * @brief   Send a HTTP response
      * @param   res The response (@see Response)
@@ -272,6 +428,16 @@ class HttpServerConnection : public TcpConnection
      */
     virtual bool write(const char* buf, int len);
 
+    /**
+     * @brief   Write data to the socket
+     * @param   buf   The buffer containing the data to write
+     * @param   count The number of bytes in the buffer
+     * @return  Returns the number of bytes written or -1 on failure
+     *
+     * The data is queued after any response data that has not been sent yet.
+     */
+    virtual int write(const void *buf, int count) override;
+
     /**
      * @brief   A signal that is emitted when a connection has been terminated
      * @param   con     The connection object
@@ -338,17 +504,46 @@ class HttpServerConnection : public TcpConnection
       STATE_DISCONNECTED, STATE_EXPECT_START_LINE, STATE_EXPECT_HEADER,
       STATE_EXPECT_PAYLOAD, STATE_REQ_COMPLETE
     };
+    struct PendingRequest
+    {
+      bool keep_alive;
+      bool http10;
+      bool accept_gzip;
+    };
+    struct TxItem
+    {
+      std::shared_ptr<const void> owner;
+      const char*                 data;
+      size_t                      len;
+      FileContentPtr              file;
+      off_t                       offset;
+    };
+
+    static constexpr size_t MAX_PENDING_REQUESTS = 64;
 
-    State                   m_state;
-    std::string             m_row;
-    Request                 m_req;
-    bool                    m_chunked;
+    State                       m_state;
+    std::string                 m_row;
+    Request                     m_req;
+    bool                        m_chunked;
+    size_t                      m_content_left        = 0;
+    std::deque<PendingRequest>  m_pending;
+    std::deque<TxItem>          m_txq;
+    FdWatch                     m_tx_watch;
+    Timer                       m_idle_timer;
+    unsigned                    m_idle_timeout        = DEFAULT_IDLE_TIMEOUT;
+    bool                        m_close_after_flush   = false;
 
     HttpServerConnection(const HttpServerConnection&);
     HttpServerConnection& operator=(const HttpServerConnection&);
-    using TcpConnection::write;
+    void init(void);
     void handleStartLine(void);
     void handleHeader(void);
+    void handleRequest(void);
+    void queueData(std::shared_ptr<const void> owner, const char* data,
+                   size_t len);
+    void queueFile(const FileContentPtr& file);
+    void sendQueued(void);
+    void onIdleTimeout(void);
     //void onSendBufferFull(bool is_full);
     void disconnectCleanup(void);
     const char* codeToString(unsigned code);
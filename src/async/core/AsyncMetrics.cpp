@@ -0,0 +1,359 @@
+/**
+@file   AsyncMetrics.cpp
+@brief  A registry of counters, gauges and histograms for monitoring
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-18
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cassert>
+#include <algorithm>
+#include <sstream>
+#include <limits>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncMetrics.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Static class variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+void writeName(std::ostream& os, const std::string& name,
+               const std::string& suffix, const std::string& labels,
+               const std::string& extra_label="")
+{
+  os << name << suffix;
+  if (!labels.empty() || !extra_label.empty())
+  {
+    os << "{" << labels;
+    if (!labels.empty() && !extra_label.empty())
+    {
+      os << ",";
+    }
+    os << extra_label << "}";
+  }
+  os << " ";
+} /* writeName */
+
+
+std::string formatValue(double value)
+{
+  if (value == std::numeric_limits<double>::infinity())
+  {
+    return "+Inf";
+  }
+  std::ostringstream ss;
+  ss.precision(10);
+  ss << value;
+  return ss.str();
+} /* formatValue */
+
+
+}; /* End of anonymous namespace */
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+Metrics& Metrics::instance(void)
+{
+  static Metrics metrics;
+  return metrics;
+} /* Metrics::instance */
+
+
+const std::vector<double>& Metrics::latencyBuckets(void)
+{
+  static const std::vector<double> buckets{
+    0.00001, 0.00005, 0.0001, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+    0.05, 0.1, 0.25, 0.5, 1.0
+  };
+  return buckets;
+} /* Metrics::latencyBuckets */
+
+
+std::string Metrics::label(const std::string& name, const std::string& value)
+{
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char ch : value)
+  {
+    switch (ch)
+    {
+      case '\\': escaped += "\\\\"; break;
+      case '"':  escaped += "\\\""; break;
+      case '\n': escaped += "\\n";  break;
+      default:   escaped += ch;     break;
+    }
+  }
+  return name + "=\"" + escaped + "\"";
+} /* Metrics::label */
+
+
+Metrics::Counter& Metrics::counter(const std::string& name,
+                                   const std::string& help,
+                                   const std::string& labels)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  Metric* metric = find(name, "counter", help, labels);
+  if (metric == nullptr)
+  {
+    metric = new Counter;
+    m_families[name].metrics[labels].reset(metric);
+  }
+  return *static_cast<Counter*>(metric);
+} /* Metrics::counter */
+
+
+Metrics::Gauge& Metrics::gauge(const std::string& name,
+                               const std::string& help,
+                               const std::string& labels)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  Metric* metric = find(name, "gauge", help, labels);
+  if (metric == nullptr)
+  {
+    metric = new Gauge;
+    m_families[name].metrics[labels].reset(metric);
+  }
+  return *static_cast<Gauge*>(metric);
+} /* Metrics::gauge */
+
+
+Metrics::Histogram& Metrics::histogram(const std::string& name,
+                                       const std::string& help,
+                                       const std::vector<double>& bounds,
+                                       const std::string& labels)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  Metric* metric = find(name, "histogram", help, labels);
+  if (metric == nullptr)
+  {
+    metric = new Histogram(bounds);
+    m_families[name].metrics[labels].reset(metric);
+  }
+  return *static_cast<Histogram*>(metric);
+} /* Metrics::histogram */
+
+
+void Metrics::remove(const std::string& name, const std::string& labels)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  auto fit = m_families.find(name);
+  if (fit == m_families.end())
+  {
+    return;
+  }
+  fit->second.metrics.erase(labels);
+  if (fit->second.metrics.empty())
+  {
+    m_families.erase(fit);
+  }
+} /* Metrics::remove */
+
+
+void Metrics::write(std::ostream& os) const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  for (const auto& fitem : m_families)
+  {
+    const auto& name = fitem.first;
+    const auto& family = fitem.second;
+    os << "# HELP " << name << " " << family.help << "\n";
+    os << "# TYPE " << name << " " << family.type << "\n";
+    for (const auto& mitem : family.metrics)
+    {
+      mitem.second->write(os, name, mitem.first);
+    }
+  }
+} /* Metrics::write */
+
+
+std::string Metrics::toString(void) const
+{
+  std::ostringstream ss;
+  write(ss);
+  return ss.str();
+} /* Metrics::toString */
+
+
+void Metrics::Counter::write(std::ostream& os, const std::string& name,
+                             const std::string& labels) const
+{
+  writeName(os, name, "", labels);
+  os << value() << "\n";
+} /* Metrics::Counter::write */
+
+
+void Metrics::Gauge::write(std::ostream& os, const std::string& name,
+                           const std::string& labels) const
+{
+  writeName(os, name, "", labels);
+  os << value() << "\n";
+} /* Metrics::Gauge::write */
+
+
+Metrics::Histogram::Histogram(const std::vector<double>& bounds)
+  : m_bounds(bounds), m_buckets(new std::atomic<uint64_t>[bounds.size()+1])
+{
+  assert(std::is_sorted(m_bounds.begin(), m_bounds.end()));
+  for (size_t i=0; i<m_bounds.size()+1; ++i)
+  {
+    m_buckets[i].store(0, std::memory_order_relaxed);
+  }
+} /* Metrics::Histogram::Histogram */
+
+
+void Metrics::Histogram::observe(double value)
+{
+    // The number of buckets is small so a linear search is fastest
+  size_t idx = 0;
+  while ((idx < m_bounds.size()) && (value > m_bounds[idx]))
+  {
+    ++idx;
+  }
+  m_buckets[idx].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  double sum = m_sum.load(std::memory_order_relaxed);
+  while (!m_sum.compare_exchange_weak(sum, sum + value,
+                                      std::memory_order_relaxed))
+  {
+  }
+} /* Metrics::Histogram::observe */
+
+
+void Metrics::Histogram::write(std::ostream& os, const std::string& name,
+                               const std::string& labels) const
+{
+  uint64_t cumulative = 0;
+  for (size_t i=0; i<m_bounds.size()+1; ++i)
+  {
+    cumulative += bucketCount(i);
+    double le = (i < m_bounds.size())
+      ? m_bounds[i] : std::numeric_limits<double>::infinity();
+    writeName(os, name, "_bucket", labels,
+              "le=\"" + formatValue(le) + "\"");
+    os << cumulative << "\n";
+  }
+  writeName(os, name, "_sum", labels);
+  os << formatValue(sum()) << "\n";
+  writeName(os, name, "_count", labels);
+  os << cumulative << "\n";
+} /* Metrics::Histogram::write */
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+Metrics::Metric* Metrics::find(const std::string& name,
+                               const std::string& type,
+                               const std::string& help,
+                               const std::string& labels)
+{
+  auto& family = m_families[name];
+  if (family.type.empty())
+  {
+    family.type = type;
+    family.help = help;
+  }
+  assert(family.type == type);
+  auto it = family.metrics.find(labels);
+  if (it != family.metrics.end())
+  {
+    return it->second.get();
+  }
+  return nullptr;
+} /* Metrics::find */
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,389 @@
+/**
+@file   AsyncMetrics.h
+@brief  A registry of counters, gauges and histograms for monitoring
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-18
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_METRICS_INCLUDED
+#define ASYNC_METRICS_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A registry of counters, gauges and histograms for monitoring
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-18
+
+This class is used to keep track of metrics that is interesting when
+monitoring a running application, like the number of frames sent or how long
+time a callback took to execute. The metrics can be written in the
+Prometheus/OpenMetrics text exposition format so that they can be scraped by
+a monitoring system, e.g. using an Async::HttpServerConnection.
+
+A metric is registered once, typically when an object is created, and a
+reference to it is then kept. Updating a metric is lock-free so it can be
+done on hot paths and from other threads than the main thread. The
+registration and the output functions are protected by a mutex.
+
+\code
+auto& frames = Async::Metrics::instance().counter(
+    "myapp_frames_total", "The number of frames processed");
+frames.inc();
+\endcode
+*/
+class Metrics
+{
+  public:
+    /**
+     * @brief   The content type to use when serving the metrics over HTTP
+     */
+    static constexpr const char* CONTENT_TYPE =
+      "text/plain; version=0.0.4; charset=utf-8";
+
+    /**
+     * @brief   The base class for all metric types
+     */
+    class Metric
+    {
+      public:
+        virtual ~Metric(void) {}
+        virtual void write(std::ostream& os, const std::string& name,
+                           const std::string& labels) const = 0;
+    };
+
+    /**
+     * @brief   A monotonically increasing counter
+     */
+    class Counter : public Metric
+    {
+      public:
+        void inc(uint64_t n=1)
+        {
+          m_value.fetch_add(n, std::memory_order_relaxed);
+        }
+        uint64_t value(void) const
+        {
+          return m_value.load(std::memory_order_relaxed);
+        }
+        void write(std::ostream& os, const std::string& name,
+                   const std::string& labels) const override;
+
+      private:
+        std::atomic<uint64_t> m_value {0};
+    };
+
+    /**
+     * @brief   A value that can go up and down
+     */
+    class Gauge : public Metric
+    {
+      public:
+        void set(int64_t value)
+        {
+          m_value.store(value, std::memory_order_relaxed);
+        }
+        void inc(int64_t n=1)
+        {
+          m_value.fetch_add(n, std::memory_order_relaxed);
+        }
+        void dec(int64_t n=1)
+        {
+          m_value.fetch_sub(n, std::memory_order_relaxed);
+        }
+        int64_t value(void) const
+        {
+          return m_value.load(std::memory_order_relaxed);
+        }
+        void write(std::ostream& os, const std::string& name,
+                   const std::string& labels) const override;
+
+      private:
+        std::atomic<int64_t> m_value {0};
+    };
+
+    /**
+     * @brief   A histogram with fixed bucket upper bounds
+     */
+    class Histogram : public Metric
+    {
+      public:
+        explicit Histogram(const std::vector<double>& bounds);
+        void observe(double value);
+        const std::vector<double>& bounds(void) const { return m_bounds; }
+        uint64_t bucketCount(size_t idx) const
+        {
+          return m_buckets[idx].load(std::memory_order_relaxed);
+        }
+        uint64_t count(void) const
+        {
+          return m_count.load(std::memory_order_relaxed);
+        }
+        double sum(void) const
+        {
+          return m_sum.load(std::memory_order_relaxed);
+        }
+        void write(std::ostream& os, const std::string& name,
+                   const std::string& labels) const override;
+
+      private:
+        std::vector<double>                     m_bounds;
+        std::unique_ptr<std::atomic<uint64_t>[]> m_buckets;
+        std::atomic<uint64_t>                   m_count {0};
+        std::atomic<double>                     m_sum   {0.0};
+    };
+
+    /**
+     * @brief   Measure the lifetime of a scope into a histogram
+     *
+     * The elapsed time, in seconds, from construction to destruction of an
+     * object of this class is recorded in the given histogram.
+     */
+    class ScopedTimer
+    {
+      public:
+        explicit ScopedTimer(Histogram& hist)
+          : m_hist(hist), m_start(std::chrono::steady_clock::now()) {}
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+        ~ScopedTimer(void)
+        {
+          std::chrono::duration<double> dur =
+            std::chrono::steady_clock::now() - m_start;
+          m_hist.observe(dur.count());
+        }
+
+      private:
+        Histogram&                            m_hist;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    /**
+     * @brief   Get the global metrics registry
+     * @return  Returns the process wide metrics registry
+     */
+    static Metrics& instance(void);
+
+    /**
+     * @brief   Default histogram buckets for latency measurements
+     * @return  Returns bucket upper bounds from 10us to 1s
+     */
+    static const std::vector<double>& latencyBuckets(void);
+
+    /**
+     * @brief   Create a label string
+     * @param   name  The name of the label
+     * @param   value The value of the label
+     * @return  Returns a label on the form name="value"
+     *
+     * The value will be escaped according to the exposition format. Many
+     * labels can be combined by separating them with a comma.
+     */
+    static std::string label(const std::string& name,
+                             const std::string& value);
+
+    /**
+     * @brief   Default constructor
+     */
+    Metrics(void) {}
+
+    /**
+     * @brief   Disallow copy construction
+     */
+    Metrics(const Metrics&) = delete;
+
+    /**
+     * @brief   Disallow copy assignment
+     */
+    Metrics& operator=(const Metrics&) = delete;
+
+    /**
+     * @brief   Destructor
+     */
+    ~Metrics(void) {}
+
+    /**
+     * @brief   Get or create a counter
+     * @param   name    The name of the metric
+     * @param   help    A help text describing the metric
+     * @param   labels  Optional labels, e.g. created using the label function
+     * @return  Returns a reference to the counter
+     *
+     * If a counter with the given name and labels already exist, that
+     * counter is returned. The reference is valid until the metric is
+     * removed using the remove function.
+     */
+    Counter& counter(const std::string& name, const std::string& help,
+                     const std::string& labels="");
+
+    /**
+     * @brief   Get or create a gauge
+     * @param   name    The name of the metric
+     * @param   help    A help text describing the metric
+     * @param   labels  Optional labels, e.g. created using the label function
+     * @return  Returns a reference to the gauge
+     */
+    Gauge& gauge(const std::string& name, const std::string& help,
+                 const std::string& labels="");
+
+    /**
+     * @brief   Get or create a histogram
+     * @param   name    The name of the metric
+     * @param   help    A help text describing the metric
+     * @param   bounds  The upper bounds of the buckets in increasing order
+     * @param   labels  Optional labels, e.g. created using the label function
+     * @return  Returns a reference to the histogram
+     *
+     * The bounds are only used when the histogram is created.
+     */
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         const std::vector<double>& bounds=latencyBuckets(),
+                         const std::string& labels="");
+
+    /**
+     * @brief   Remove a metric
+     * @param   name    The name of the metric
+     * @param   labels  The labels of the metric
+     *
+     * Use this function to remove metrics that is not valid anymore, like
+     * one labeled with the name of a disconnected client. Any references to
+     * the metric will be invalid after this call.
+     */
+    void remove(const std::string& name, const std::string& labels="");
+
+    /**
+     * @brief   Write all metrics in the text exposition format
+     * @param   os The stream to write to
+     */
+    void write(std::ostream& os) const;
+
+    /**
+     * @brief   Get all metrics in the text exposition format
+     * @return  Returns a string containing all metrics
+     */
+    std::string toString(void) const;
+
+  private:
+    using MetricMap = std::map<std::string, std::unique_ptr<Metric>>;
+    struct Family
+    {
+      std::string type;
+      std::string help;
+      MetricMap   metrics;
+    };
+    using FamilyMap = std::map<std::string, Family>;
+
+    mutable std::mutex  m_mutex;
+    FamilyMap           m_families;
+
+    Metric* find(const std::string& name, const std::string& type,
+                 const std::string& help, const std::string& labels);
+
+};  /* class Metrics */
+
+
+} /* namespace Async */
+
+#endif /* ASYNC_METRICS_INCLUDED */
+
+/*
+ * This file has not been truncated
+ */
@@ -296,6 +296,12 @@ class TcpConnection : virtual public sigc::trackable
      */
     void enableSsl(bool enable);
 
+    /**
+     * @brief   Check if TLS is enabled for this connection
+     * @return  Returns \em true if TLS is enabled
+     */
+    bool sslIsEnabled(void) const { return m_ssl != nullptr; }
+
     /**
      * @brief   Get the peer certificate associated with this connection
      * @return  Returns the X509 certificate associated with the peer
@@ -424,6 +424,14 @@ void TcpServerBase::onConnection(FdWatch *watch)
     return;
   }
   
+    // Refuse the connection if the maximum number of clients is reached
+  if ((m_max_connections > 0) &&
+      (m_tcpConnectionList.size() >= m_max_connections))
+  {
+    ::close(client_sock);
+    return;
+  }
+
     // Force close on exec
   if (fcntl(client_sock, F_SETFD, 1) == -1)
   {
@@ -205,6 +205,19 @@ class TcpServerBase : public sigc::trackable
     void setConnectionThrottling(unsigned bucket_max, float bucket_inc,
                                  int inc_interval_ms);
 
+    /**
+     * @brief   Limit the number of simultaneous connections
+     * @param   max_connections The maximum number of connections (0=no limit)
+     *
+     * Use this function to put a limit on the number of clients that may be
+     * connected at the same time. When the limit has been reached, new
+     * connections will be closed directly after they have been accepted.
+     */
+    void setMaxConnections(unsigned max_connections)
+    {
+      m_max_connections = max_connections;
+    }
+
   protected:
     virtual void createConnection(int sock, const IpAddress& remote_addr,
                                   uint16_t remote_port) = 0;
@@ -231,6 +244,7 @@ class TcpServerBase : public sigc::trackable
     Timer             m_con_throt_timer;
     unsigned          m_con_throt_bucket_max  = 0;
     unsigned          m_con_throt_bucket_inc  = 0;
+    unsigned          m_max_connections       = 0;
 
     void cleanup(void);
     void onConnection(FdWatch *watch);
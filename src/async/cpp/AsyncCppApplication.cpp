@@ -39,12 +39,21 @@
 #include <sys/select.h>
 #include <signal.h>
 #include <unistd.h>
+#include <pthread.h>
+#ifdef __GLIBC__
+#include <execinfo.h>
+#endif
 
 #include <cstdlib>
 #include <cstdio>
 #include <cerrno>
 #include <cassert>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
 
 
 /****************************************************************************
@@ -106,6 +115,7 @@ using namespace Async;
     }                                                                         \
   } while (0)
 
+#define clock_timertodouble(a) ((a)->tv_sec + (a)->tv_nsec / 1000000000.0)
 
 
 
@@ -115,6 +125,150 @@ using namespace Async;
  *
  ****************************************************************************/
 
+/*
+ * The stall detector measure the time spent in each main loop callback. A
+ * watchdog thread check if the currently executing callback has been running
+ * for longer than the threshold. If so, a signal is sent to the main thread
+ * which will print a backtrace from its signal handler so that the blocking
+ * function can be identified.
+ */
+class CppApplication::StallDetector
+{
+  public:
+    StallDetector(unsigned threshold_ms)
+      : m_threshold_ms(threshold_ms), m_main_thread(pthread_self()),
+        m_fd_watch_hist(Metrics::instance().histogram(
+              "async_fd_watch_callback_seconds",
+              "Time spent in file descriptor watch callbacks")),
+        m_timer_hist(Metrics::instance().histogram(
+              "async_timer_callback_seconds",
+              "Time spent in timer callbacks"))
+    {
+#ifdef __GLIBC__
+        // The first call to backtrace may allocate memory so make sure that
+        // it has been done before it is called from the signal handler
+      void* buf[1];
+      (void)backtrace(buf, 1);
+#endif
+      struct sigaction act;
+      act.sa_handler = stallSignalHandler;
+      sigemptyset(&act.sa_mask);
+      act.sa_flags = SA_RESTART;
+      sigaction(STALL_SIGNAL, &act, &m_old_act);
+      m_watchdog = std::thread(&StallDetector::watchdog, this);
+    }
+
+    ~StallDetector(void)
+    {
+      {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stop = true;
+      }
+      m_cond.notify_all();
+      m_watchdog.join();
+      sigaction(STALL_SIGNAL, &m_old_act, NULL);
+    }
+
+    unsigned threshold(void) const { return m_threshold_ms; }
+
+    void begin(void)
+    {
+      clock_gettime(CLOCK_MONOTONIC, &m_begin);
+      m_begin_ms.store(m_begin.tv_sec * 1000 + m_begin.tv_nsec / 1000000,
+                       std::memory_order_release);
+    }
+
+    void endFdWatch(const FdWatch* watch, int fd, FdWatch::FdWatchType type)
+    {
+      const double dur = end();
+      m_fd_watch_hist.observe(dur);
+      if (dur * 1000.0 > m_threshold_ms)
+      {
+        std::cerr << "*** WARNING: Event loop stalled for "
+                  << static_cast<unsigned>(dur * 1000.0) << "ms in "
+                  << ((type == FdWatch::FD_WATCH_RD) ? "read" : "write")
+                  << " watch callback for fd=" << fd
+                  << " (FdWatch " << watch << ")" << std::endl;
+      }
+    }
+
+    void endTimer(const Timer* timer, int timeout_ms, Timer::Type type)
+    {
+      const double dur = end();
+      m_timer_hist.observe(dur);
+      if (dur * 1000.0 > m_threshold_ms)
+      {
+        std::cerr << "*** WARNING: Event loop stalled for "
+                  << static_cast<unsigned>(dur * 1000.0) << "ms in "
+                  << ((type == Timer::TYPE_PERIODIC) ? "periodic" : "one-shot")
+                  << " timer callback with timeout=" << timeout_ms << "ms"
+                  << " (Timer " << timer << ")" << std::endl;
+      }
+    }
+
+  private:
+    static const int STALL_SIGNAL = SIGURG;
+
+    const unsigned          m_threshold_ms;
+    const pthread_t         m_main_thread;
+    Metrics::Histogram&     m_fd_watch_hist;
+    Metrics::Histogram&     m_timer_hist;
+    struct timespec         m_begin;
+    std::atomic<int64_t>    m_begin_ms  {0};
+    std::thread             m_watchdog;
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+    bool                    m_stop      = false;
+    struct sigaction        m_old_act;
+
+    static void stallSignalHandler(int signum)
+    {
+        // Only async-signal-safe functions may be used here
+      static const char msg[] =
+        "*** WARNING: Event loop stall in progress. Main thread backtrace:\n";
+      ssize_t ret = write(STDERR_FILENO, msg, sizeof(msg)-1);
+      (void)ret;
+#ifdef __GLIBC__
+      void* buf[32];
+      int cnt = backtrace(buf, sizeof(buf) / sizeof(*buf));
+      backtrace_symbols_fd(buf, cnt, STDERR_FILENO);
+#endif
+    }
+
+    double end(void)
+    {
+      m_begin_ms.store(0, std::memory_order_release);
+      struct timespec now, diff;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      clock_timersub(&now, &m_begin, &diff);
+      return clock_timertodouble(&diff);
+    }
+
+    void watchdog(void)
+    {
+      int64_t reported_begin_ms = 0;
+      std::unique_lock<std::mutex> lk(m_mutex);
+      while (!m_stop)
+      {
+        m_cond.wait_for(lk,
+            std::chrono::milliseconds(std::max(m_threshold_ms / 2, 1U)));
+        const int64_t begin_ms = m_begin_ms.load(std::memory_order_acquire);
+        if ((begin_ms == 0) || (begin_ms == reported_begin_ms))
+        {
+          continue;
+        }
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const int64_t now_ms = now.tv_sec * 1000 + now.tv_nsec / 1000000;
+        if (now_ms - begin_ms > m_threshold_ms)
+        {
+          reported_begin_ms = begin_ms;
+          pthread_kill(m_main_thread, STALL_SIGNAL);
+        }
+      }
+    }
+};
+
 
 
 /****************************************************************************
@@ -162,7 +316,14 @@ int CppApplication::sighandler_pipe[2];
  *------------------------------------------------------------------------
  */
 CppApplication::CppApplication(void)
-  : do_quit(false), max_desc(0), unix_signal_recv(-1), unix_signal_recv_cnt(0)
+  : do_quit(false), max_desc(0), unix_signal_recv(-1), unix_signal_recv_cnt(0),
+    loop_iteration_hist(Metrics::instance().histogram(
+          "async_event_loop_iteration_seconds",
+          "Time spent handling events in one main loop iteration")),
+    timer_lateness_hist(Metrics::instance().histogram(
+          "async_timer_lateness_seconds",
+          "Time from timer expiry until the timer callback is called")),
+    stall_detector(0), virtual_time(false)
 {
   FD_ZERO(&rd_set);
   FD_ZERO(&wr_set);
@@ -172,10 +333,57 @@ CppApplication::CppApplication(void)
 
 CppApplication::~CppApplication(void)
 {
+  delete stall_detector;
+  stall_detector = 0;
   clearTasks();
 } /* CppApplication::~CppApplication */
 
 
+void CppApplication::setVirtualTime(bool enable)
+{
+  if (enable == virtual_time)
+  {
+    return;
+  }
+  virtual_time = enable;
+  if (enable)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &virtual_start);
+    gettimeofday(&virtual_start_tod, 0);
+    virtual_now = virtual_start;
+  }
+} /* CppApplication::setVirtualTime */
+
+
+void CppApplication::getTimeOfDay(struct timeval& tv) const
+{
+  if (!virtual_time)
+  {
+    gettimeofday(&tv, 0);
+    return;
+  }
+  struct timespec elapsed;
+  clock_timersub(&virtual_now, &virtual_start, &elapsed);
+  struct timeval elapsed_tv;
+  elapsed_tv.tv_sec = elapsed.tv_sec;
+  elapsed_tv.tv_usec = elapsed.tv_nsec / 1000;
+  timeradd(&virtual_start_tod, &elapsed_tv, &tv);
+} /* CppApplication::getTimeOfDay */
+
+
+void CppApplication::getMonotonicTime(struct timespec& ts) const
+{
+  if (virtual_time)
+  {
+    ts = virtual_now;
+  }
+  else
+  {
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+  }
+} /* CppApplication::getMonotonicTime */
+
+
 void CppApplication::exec(void)
 {
   if (pipe(sighandler_pipe) == -1)
@@ -213,7 +421,7 @@ void CppApplication::exec(void)
       if (titer->second != 0)
       {
 	struct timespec ts;
-	clock_gettime(CLOCK_MONOTONIC, &ts);
+	getMonotonicTime(ts);
 	clock_timersub(&titer->first, &ts, &timeout);
 	if (timeout.tv_sec < 0)
 	{
@@ -230,10 +438,19 @@ void CppApplication::exec(void)
       titer = timer_map.begin();
     }
     
+      // On a virtual clock, file descriptors are just polled when there are
+      // timers waiting since time will not pass while blocking
+    struct timespec poll_timeout = {0, 0};
+    struct timespec *select_timeout_ptr = timeout_ptr;
+    if (virtual_time && (timeout_ptr != 0))
+    {
+      select_timeout_ptr = &poll_timeout;
+    }
+
     fd_set local_rd_set = rd_set;
     fd_set local_wr_set = wr_set;
     int dcnt = pselect(max_desc, &local_rd_set, &local_wr_set, NULL,
-	timeout_ptr, NULL);
+	select_timeout_ptr, NULL);
     if (dcnt == -1)
     {
       if ((errno == EINTR) || (errno == EAGAIN))
@@ -246,6 +463,9 @@ void CppApplication::exec(void)
         exit(1);
       }
     }
+
+    struct timespec iter_start;
+    clock_gettime(CLOCK_MONOTONIC, &iter_start);
     
     if ((timeout_ptr != 0)
         && ((dcnt == 0)
@@ -253,7 +473,31 @@ void CppApplication::exec(void)
            )
        )
     {
-      titer->second->expired(titer->second);
+      if (virtual_time && ((timeout_ptr->tv_sec > 0) ||
+                           (timeout_ptr->tv_nsec > 0)))
+      {
+          // Nothing else to do so jump to the timer expiration time
+        virtual_now = titer->first;
+      }
+      struct timespec now, lateness;
+      getMonotonicTime(now);
+      clock_timersub(&now, &titer->first, &lateness);
+      timer_lateness_hist.observe(
+          (lateness.tv_sec < 0) ? 0.0 : clock_timertodouble(&lateness));
+      if (stall_detector != 0)
+      {
+          // The timer may be deleted in the callback so save what we need
+        const Timer* timer = titer->second;
+        const int timeout_ms = timer->timeout();
+        const Timer::Type type = timer->type();
+        stall_detector->begin();
+        titer->second->expired(titer->second);
+        stall_detector->endTimer(timer, timeout_ms, type);
+      }
+      else
+      {
+        titer->second->expired(titer->second);
+      }
       if ((titer->second != 0) &&
 	  (titer->second->type() == Timer::TYPE_PERIODIC))
       {
@@ -274,7 +518,7 @@ void CppApplication::exec(void)
       {
 	if (witer->second != 0)
 	{
-	  witer->second->activity(witer->second);
+	  dispatchFdWatch(witer->second);
 	}
 	else
 	{
@@ -295,7 +539,7 @@ void CppApplication::exec(void)
       {
 	if (witer->second != 0)
 	{
-	  witer->second->activity(witer->second);
+	  dispatchFdWatch(witer->second);
 	}
 	else
 	{
@@ -307,6 +551,11 @@ void CppApplication::exec(void)
     }
     
     assert(dcnt == 0);
+
+    struct timespec iter_end, iter_time;
+    clock_gettime(CLOCK_MONOTONIC, &iter_end);
+    clock_timersub(&iter_end, &iter_start, &iter_time);
+    loop_iteration_hist.observe(clock_timertodouble(&iter_time));
   }
 
   for (UnixSignalMap::const_iterator it = unix_signals.begin();
@@ -332,6 +581,23 @@ void CppApplication::quit(void)
 } /* CppApplication::quit */
 
 
+void CppApplication::setStallThreshold(unsigned threshold_ms)
+{
+  delete stall_detector;
+  stall_detector = 0;
+  if (threshold_ms > 0)
+  {
+    stall_detector = new StallDetector(threshold_ms);
+  }
+} /* CppApplication::setStallThreshold */
+
+
+unsigned CppApplication::stallThreshold(void) const
+{
+  return (stall_detector != 0) ? stall_detector->threshold() : 0;
+} /* CppApplication::stallThreshold */
+
+
 void CppApplication::catchUnixSignal(int signum)
 {
   UnixSignalMap::iterator it = unix_signals.find(signum);
@@ -503,7 +769,7 @@ void CppApplication::delFdWatch(FdWatch *fd_watch)
 void CppApplication::addTimer(Timer *timer)
 {
   struct timespec current;
-  clock_gettime(CLOCK_MONOTONIC, &current);
+  getMonotonicTime(current);
   addTimerP(timer, current);
 } /* CppApplication::addTimer */
 
@@ -560,6 +826,23 @@ void CppApplication::handleUnixSignal(void)
 } /* CppApplication::handleUnixSignal */
 
 
+void CppApplication::dispatchFdWatch(FdWatch *watch)
+{
+  if (stall_detector == 0)
+  {
+    watch->activity(watch);
+    return;
+  }
+
+    // The watch may be deleted in the callback so save what we need
+  const int fd = watch->fd();
+  const FdWatch::FdWatchType type = watch->type();
+  stall_detector->begin();
+  watch->activity(watch);
+  stall_detector->endFdWatch(watch, fd, type);
+} /* CppApplication::dispatchFdWatch */
+
+
 
 /*
  * This file has not been truncated
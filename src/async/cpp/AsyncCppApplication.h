@@ -55,6 +55,7 @@
  ****************************************************************************/
 
 #include <AsyncApplication.h>
+#include <AsyncMetrics.h>
 
 
 /****************************************************************************
@@ -174,6 +175,64 @@ class CppApplication : public Application
      */
     void quit(void);
 
+    /**
+     * @brief   Enable event loop instrumentation and stall detection
+     * @param   threshold_ms The stall threshold in milliseconds, 0=disable
+     *
+     * When enabled, the time spent in each timer and file descriptor watch
+     * callback is measured and recorded in histograms in the global
+     * Async::Metrics registry. If a single callback execute for longer than
+     * the given threshold, a warning is printed with information about the
+     * timer or file descriptor that triggered the callback. A watchdog
+     * thread will also print a backtrace of the main thread while the stall
+     * is in progress, which show which function is blocking the main loop.
+     * When disabled, which is the default, there is close to no overhead.
+     */
+    void setStallThreshold(unsigned threshold_ms);
+
+    /**
+     * @brief   Get the currently set stall threshold
+     * @return  Returns the stall threshold in milliseconds, 0=disabled
+     */
+    unsigned stallThreshold(void) const;
+
+    /**
+     * @brief   Run the application on a virtual clock
+     * @param   enable Set to \em true to use a virtual clock
+     *
+     * When running on a virtual clock, timers do not wait for real time to
+     * pass. If there is no file descriptor activity, the clock is advanced
+     * directly to the expiration time of the next timer. An application
+     * that is driven by timers only, like when audio is read from files and
+     * paced by Async::AudioPacer objects, will then run as fast as the CPU
+     * allow. File descriptors are still watched but they are polled without
+     * blocking as long as there are active timers.
+     *
+     * The virtual clock start at the current time. Use the getTimeOfDay and
+     * getMonotonicTime functions to read it. The virtual clock should be
+     * enabled before any timers are started, normally directly after the
+     * application object has been created.
+     */
+    void setVirtualTime(bool enable);
+
+    /**
+     * @brief   Check if the application run on a virtual clock
+     * @return  Returns \em true if a virtual clock is used
+     */
+    bool virtualTime(void) const override { return virtual_time; }
+
+    /**
+     * @brief   Get the current time of day
+     * @param   tv Where to store the time
+     */
+    void getTimeOfDay(struct timeval& tv) const override;
+
+    /**
+     * @brief   Get the current time of the monotonic clock
+     * @param   ts Where to store the time
+     */
+    void getMonotonicTime(struct timespec& ts) const override;
+
     /**
      * @brief   A signal that is emitted when a monitored UNIX signal is caught
      * @param   signum The signal number that was caught
@@ -199,6 +258,7 @@ class CppApplication : public Application
     typedef std::map<int, FdWatch*>   	      	      	        WatchMap;
     typedef std::multimap<struct timespec, Timer *, lttimespec> TimerMap;
     typedef std::map<int, struct sigaction>                     UnixSignalMap;
+    class StallDetector;
     
     static int          sighandler_pipe[2];
 
@@ -212,6 +272,13 @@ class CppApplication : public Application
     UnixSignalMap       unix_signals;
     int                 unix_signal_recv;
     size_t              unix_signal_recv_cnt;
+    Metrics::Histogram& loop_iteration_hist;
+    Metrics::Histogram& timer_lateness_hist;
+    StallDetector*      stall_detector;
+    bool                virtual_time;
+    struct timespec     virtual_now;
+    struct timespec     virtual_start;
+    struct timeval      virtual_start_tod;
     
     static void unixSignalHandler(int signum);
 
@@ -222,6 +289,7 @@ class CppApplication : public Application
     void delTimer(Timer *timer);    
     DnsLookupWorker *newDnsLookupWorker(const DnsLookup& lookup);
     void handleUnixSignal(void);
+    void dispatchFdWatch(FdWatch *watch);
     
 };  /* class CppApplication */
 
@@ -37,14 +37,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <unistd.h>
 #include <netinet/in.h>
 #include <arpa/nameser.h>
-#include <resolv.h>
 #include <arpa/inet.h>
 #include <errno.h>
 #include <netdb.h>
 
 #include <cassert>
 #include <cstring>
-#include <mutex>
+#include <algorithm>
+#include <limits>
 
 
 /****************************************************************************
@@ -54,6 +54,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncDnsLookup.h>
+#include <AsyncApplication.h>
 
 
 /****************************************************************************
@@ -90,60 +91,6 @@ using namespace Async;
  *
  ****************************************************************************/
 
-namespace {
-#if !(__RES >= 19991006)
-  std::mutex res_mutex;
-#endif
-
-  class Resolver
-  {
-    public:
-      Resolver(void) { m_state.options = RES_DEFAULT; }
-      ~Resolver(void) { close(); }
-#if __RES >= 19991006
-      int init(void)
-      {
-        return res_ninit(&m_state);
-      }
-      int search(const char *dname, int dclass, int type,
-                 unsigned char* answer, int anslen)
-      {
-        return res_nsearch(&m_state, dname, dclass, type, answer, anslen);
-      }
-      void close(void)
-      {
-          // FIXME: Valgrind complain about leaked memory in the resolver
-          //        library when a lookup fails. It seems to be a one time leak
-          //        though so it does not grow with every failed lookup. But
-          //        even so, it seems that res_nclose is not cleaning up
-          //        properly.  Glibc 2.33-18 on Fedora 34.
-        res_nclose(&m_state);
-      }
-#else
-      int init(void)
-      {
-        const std::lock_guard<std::mutex> lock(res_mutex);
-        int rc = res_init();
-        memcpy(&m_state, &_res, sizeof(m_state));
-        return rc;
-      }
-      int search(const char *dname, int dclass, int type,
-                 unsigned char* answer, int anslen)
-      {
-        const std::lock_guard<std::mutex> lock(res_mutex);
-        struct __res_state old_state;
-        memcpy(&old_state, &_res, sizeof(old_state));
-        memcpy(&_res, &m_state, sizeof(m_state));
-        int rc = res_search(dname, dclass, type, answer, anslen);
-        memcpy(&_res, &old_state, sizeof(old_state));
-        return rc;
-      }
-      void close(void) {}
-#endif
-    private:
-      struct __res_state m_state;
-  };
-};
 
 
 /****************************************************************************
@@ -199,10 +146,16 @@ DnsLookupWorker& CppDnsLookupWorker::operator=(DnsLookupWorker&& other_base)
 
   abortLookup();
 
-  m_result = std::move(other.m_result);
-  assert(!other.m_result.valid());
-
+  m_query = std::move(other.m_query);
   m_notifier_watch = std::move(other.m_notifier_watch);
+  m_cached_rrs.swap(other.m_cached_rrs);
+
+    // A pending delivery of a cached result is bound to the other object
+  if (lookupPending() && !m_query)
+  {
+    Application::app().runTask(
+        sigc::mem_fun(*this, &CppDnsLookupWorker::deliverCachedResult));
+  }
 
   return *this;
 } /* CppDnsLookupWorker::operator=(DnsLookupWorker&&) */
@@ -217,41 +170,34 @@ DnsLookupWorker& CppDnsLookupWorker::operator=(DnsLookupWorker&& other_base)
 bool CppDnsLookupWorker::doLookup(void)
 {
     // A lookup is already running
-  if (m_result.valid())
+  if (m_query)
   {
     return true;
   }
 
   setLookupFailed(false);
 
-  int fd[2];
-  if (pipe(fd) != 0)
+    // The result is delivered from the event loop, even on a cache hit, since
+    // the user may not yet have connected to the resultsReady signal.
+  clearCachedRecords();
+  if (CppDnsResolver::instance().cacheLookup(dns().type(), dns().label(),
+                                             m_cached_rrs))
   {
-    printErrno("ERROR: Could not create pipe");
-    setLookupFailed();
-    return false;
+    Application::app().runTask(
+        sigc::mem_fun(*this, &CppDnsLookupWorker::deliverCachedResult));
+    return true;
   }
-  m_notifier_watch.setFd(fd[0], FdWatch::FD_WATCH_RD);
-  m_notifier_watch.setEnabled(true);
-
-  m_ctx = std::unique_ptr<ThreadContext>(new ThreadContext);
-  m_ctx->label = dns().label();
-  m_ctx->type = dns().type();
-  m_ctx->notifier_wr = fd[1];
-  m_ctx->anslen = 0;
-  m_ctx->thread_cerr.clear();
-  m_result = std::async(std::launch::async, workerFunc, std::ref(*m_ctx));
-
-  return true;
 
+  return startQuery();
 } /* CppDnsLookupWorker::doLookup */
 
 
 void CppDnsLookupWorker::abortLookup(void)
 {
-  if (m_result.valid())
+  if (m_query)
   {
-    m_result.get();
+    m_query->aborted = true;
+    m_query.reset();
   }
 
   int fd = m_notifier_watch.fd();
@@ -261,7 +207,8 @@ void CppDnsLookupWorker::abortLookup(void)
     close(fd);
   }
 
-  m_ctx.reset();
+  clearCachedRecords();
+  m_cache_rrs.clear();
 } /* CppDnsLookupWorker::abortLookup */
 
 
@@ -271,118 +218,31 @@ void CppDnsLookupWorker::abortLookup(void)
  *
  ****************************************************************************/
 
-/*
- *----------------------------------------------------------------------------
- * Method:    CppDnsLookupWorker::workerFunc
- * Purpose:   This is the function that do the actual DNS lookup. It is
- *    	      started as a separate thread since res_nsearch is a
- *    	      blocking function.
- * Input:     ctx - A context containing query and result parameters
- * Output:    The answer and anslen variables in the ThreadContext will be
- *            filled in with the lookup result. The context will be returned
- *            from this function.
- * Author:    Tobias Blomberg
- * Created:   2021-07-14
- * Remarks:   
- * Bugs:      
- *----------------------------------------------------------------------------
- */
-void CppDnsLookupWorker::workerFunc(CppDnsLookupWorker::ThreadContext& ctx)
+bool CppDnsLookupWorker::startQuery(void)
 {
-  std::ostream& th_cerr = ctx.thread_cerr;
-
-  int qtype = 0;
-  switch (ctx.type)
+  int fd[2];
+  if (pipe(fd) != 0)
   {
-    case DnsLookup::Type::A:
-    {
-      struct addrinfo hints = {0};
-      hints.ai_family = AF_INET;
-      int ret = getaddrinfo(ctx.label.c_str(), NULL, &hints, &ctx.addrinfo);
-      if (ret != 0)
-      {
-        th_cerr << "*** WARNING[getaddrinfo]: Could not look up host \""
-                << ctx.label << "\": " << gai_strerror(ret) << std::endl;
-      }
-      else if (ctx.addrinfo == nullptr)
-      {
-        th_cerr << "*** WARNING[getaddrinfo]: No address info returned "
-                   "for host \"" << ctx.label << "\"" << std::endl;
-      }
-      break;
-    }
-    case DnsLookup::Type::PTR:
-    {
-      IpAddress ip_addr;
-      size_t arpa_domain_pos = ctx.label.find(".in-addr.arpa");
-      if (arpa_domain_pos != std::string::npos)
-      {
-        ip_addr.setIpFromString(ctx.label.substr(0, arpa_domain_pos));
-        struct in_addr addr = ip_addr.ip4Addr();
-        addr.s_addr = htonl(addr.s_addr);
-        ip_addr.setIp(addr);
-      }
-      else
-      {
-        ip_addr.setIpFromString(ctx.label);
-      }
-      if (!ip_addr.isEmpty())
-      {
-        struct sockaddr_in in_addr = {0};
-        in_addr.sin_family = AF_INET;
-        in_addr.sin_addr = ip_addr.ip4Addr();
-        int ret = getnameinfo(reinterpret_cast<struct sockaddr*>(&in_addr),
-                              sizeof(in_addr),
-                              ctx.host, sizeof(ctx.host),
-                              NULL, 0, NI_NAMEREQD);
-        if (ret != 0)
-        {
-          th_cerr << "*** WARNING[getnameinfo]: Could not look up IP \""
-                  << ctx.label << "\": " << gai_strerror(ret) << std::endl;
-        }
-      }
-      else
-      {
-        th_cerr << "*** WARNING: Failed to parse PTR label \""
-                << ctx.label << "\"" << std::endl;
-      }
-      break;
-    }
-    case DnsLookup::Type::CNAME:
-      qtype = ns_t_cname;
-      break;
-    case DnsLookup::Type::SRV:
-      qtype = ns_t_srv;
-      break;
-    default:
-      assert(0);
+    printErrno("ERROR: Could not create pipe");
+    setLookupFailed();
+    return false;
   }
+  m_notifier_watch.setFd(fd[0], FdWatch::FD_WATCH_RD);
+  m_notifier_watch.setEnabled(true);
 
-  if (qtype != 0)
+  m_query = std::make_shared<CppDnsResolver::Query>();
+  m_query->label = dns().label();
+  m_query->type = dns().type();
+  m_query->notifier_wr = fd[1];
+  if (!CppDnsResolver::instance().submit(m_query))
   {
-    Resolver res;
-    int ret = res.init();
-    if (ret != -1)
-    {
-      const char *dname = ctx.label.c_str();
-      ctx.anslen = res.search(dname, ns_c_in, qtype,
-                              ctx.answer, sizeof(ctx.answer));
-      if (ctx.anslen == -1)
-      {
-        th_cerr << "*** ERROR: Name resolver failure -- res_nsearch: "
-                << hstrerror(h_errno) << std::endl;
-      }
-    }
-    else
-    {
-      th_cerr << "*** ERROR: Name resolver failure -- res_ninit: "
-              << hstrerror(h_errno) << std::endl;
-    }
+    abortLookup();
+    setLookupFailed();
+    return false;
   }
 
-  close(ctx.notifier_wr);
-  ctx.notifier_wr = -1;
-} /* CppDnsLookupWorker::workerFunc */
+  return true;
+} /* CppDnsLookupWorker::startQuery */
 
 
 /*
@@ -407,22 +267,35 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
   close(w->fd());
   w->setFd(-1, FdWatch::FD_WATCH_RD);
 
-  m_result.get();
+  CppDnsResolver::QueryPtr query = std::move(m_query);
+  assert(query);
 
-  const std::string& thread_errstr = m_ctx->thread_cerr.str();
+  const std::string& thread_errstr = query->thread_cerr.str();
   if (!thread_errstr.empty())
   {
     std::cerr << thread_errstr;
     setLookupFailed();
   }
 
-  if (m_ctx->type == DnsResourceRecord::Type::A)
+  parseAnswer(*query);
+  cacheResult(*query);
+  workerDone();
+} /* CppDnsLookupWorker::notificationReceived */
+
+
+/**
+ * @brief   Parse the answer of a finished query into resource records
+ * @param   query The finished query
+ */
+void CppDnsLookupWorker::parseAnswer(const CppDnsResolver::Query& query)
+{
+  if (query.type == DnsResourceRecord::Type::A)
   {
-    if (m_ctx->addrinfo != nullptr)
+    if (query.addrinfo != nullptr)
     {
       struct addrinfo *entry;
       std::vector<IpAddress> the_addresses;
-      for (entry = m_ctx->addrinfo; entry != 0; entry = entry->ai_next)
+      for (entry = query.addrinfo; entry != 0; entry = entry->ai_next)
       {
         IpAddress ip_addr(
             reinterpret_cast<struct sockaddr_in*>(entry->ai_addr)->sin_addr);
@@ -434,38 +307,35 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
             the_addresses.end())
         {
           the_addresses.push_back(ip_addr);
-          addResourceRecord(
-              new DnsResourceRecordA(m_ctx->label, 0, ip_addr));
+          addRecord(
+              new DnsResourceRecordA(query.label, 0, ip_addr));
         }
       }
-      m_ctx.reset();
     }
   }
-  else if (m_ctx->type == DnsResourceRecord::Type::PTR)
+  else if (query.type == DnsResourceRecord::Type::PTR)
   {
-    if (m_ctx->host[0] != '\0')
+    if (query.host[0] != '\0')
     {
-      addResourceRecord(
-          new DnsResourceRecordPTR(m_ctx->label, 0, m_ctx->host));
+      addRecord(
+          new DnsResourceRecordPTR(query.label, 0, query.host));
     }
   }
   else
   {
-    if (m_ctx->anslen == -1)
+    if (query.anslen == -1)
     {
-      workerDone();
       return;
     }
 
     ns_msg msg;
-    int ret = ns_initparse(m_ctx->answer, m_ctx->anslen, &msg);
+    int ret = ns_initparse(query.answer, query.anslen, &msg);
     if (ret == -1)
     {
       std::stringstream ss;
-      ss << "WARNING: ns_initparse failed (anslen=" << m_ctx->anslen << ")";
+      ss << "WARNING: ns_initparse failed (anslen=" << query.anslen << ")";
       printErrno(ss.str());
       setLookupFailed();
-      workerDone();
       return;
     }
 
@@ -503,7 +373,7 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
           struct in_addr in_addr;
           uint32_t ip = ns_get32(cp);
           in_addr.s_addr = ntohl(ip);
-          addResourceRecord(
+          addRecord(
               new DnsResourceRecordA(name, ttl, IpAddress(in_addr)));
           break;
         }
@@ -522,7 +392,7 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
           size_t exp_dn_len = strlen(exp_dn);
           exp_dn[exp_dn_len] = '.';
           exp_dn[exp_dn_len+1] = 0;
-          addResourceRecord(new DnsResourceRecordPTR(name, ttl, exp_dn));
+          addRecord(new DnsResourceRecordPTR(name, ttl, exp_dn));
           break;
         }
 
@@ -540,7 +410,7 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
           size_t exp_dn_len = strlen(exp_dn);
           exp_dn[exp_dn_len] = '.';
           exp_dn[exp_dn_len+1] = 0;
-          addResourceRecord(new DnsResourceRecordCNAME(name, ttl, exp_dn));
+          addRecord(new DnsResourceRecordCNAME(name, ttl, exp_dn));
           break;
         }
 
@@ -564,7 +434,7 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
           size_t exp_dn_len = strlen(exp_dn);
           exp_dn[exp_dn_len] = '.';
           exp_dn[exp_dn_len+1] = 0;
-          addResourceRecord(
+          addRecord(
               new DnsResourceRecordSRV(name, ttl, prio, weight, port, exp_dn));
           break;
         }
@@ -577,8 +447,82 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
       }
     }
   }
+} /* CppDnsLookupWorker::parseAnswer */
+
+
+/**
+ * @brief   Add a record to the result and save a copy for the cache
+ * @param   rr The new resource record
+ */
+void CppDnsLookupWorker::addRecord(DnsResourceRecord* rr)
+{
+  m_cache_rrs.emplace_back(rr->clone());
+  addResourceRecord(rr);
+} /* CppDnsLookupWorker::addRecord */
+
+
+/**
+ * @brief   Store the result of a finished query in the DNS cache
+ * @param   query The finished query
+ *
+ * Authoritative negative answers are cached using the TTL from the SOA
+ * record. Positive answers are cached until the first record expire. The
+ * system host lookup functions do not return a TTL so those answers are
+ * cached for a short fixed time. Answers that contain errors are not cached.
+ */
+void CppDnsLookupWorker::cacheResult(const CppDnsResolver::Query& query)
+{
+  auto& resolver = CppDnsResolver::instance();
+  if (query.negative)
+  {
+    resolver.cacheStore(query.type, query.label, RRList(),
+                        query.negative_ttl);
+  }
+  else if (!lookupFailed() && !m_cache_rrs.empty())
+  {
+    auto ttl = std::numeric_limits<DnsResourceRecord::Ttl>::max();
+    for (const auto& rr : m_cache_rrs)
+    {
+      ttl = std::min(ttl, rr->ttl());
+    }
+    if ((ttl == 0) && ((query.type == DnsLookup::Type::A) ||
+                       (query.type == DnsLookup::Type::PTR)))
+    {
+      ttl = CppDnsResolver::NO_TTL_CACHE_TIME;
+    }
+    resolver.cacheStore(query.type, query.label, std::move(m_cache_rrs), ttl);
+  }
+  m_cache_rrs.clear();
+} /* CppDnsLookupWorker::cacheResult */
+
+
+void CppDnsLookupWorker::deliverCachedResult(void)
+{
+    // The lookup may have been aborted or already delivered
+  if (!lookupPending() || m_query)
+  {
+    clearCachedRecords();
+    return;
+  }
+
+  setLookupFailed(m_cached_rrs.empty());
+  for (auto& rr : m_cached_rrs)
+  {
+    addResourceRecord(rr);
+  }
+  m_cached_rrs.clear();
   workerDone();
-} /* CppDnsLookupWorker::notificationReceived */
+} /* CppDnsLookupWorker::deliverCachedResult */
+
+
+void CppDnsLookupWorker::clearCachedRecords(void)
+{
+  for (auto& rr : m_cached_rrs)
+  {
+    delete rr;
+  }
+  m_cached_rrs.clear();
+} /* CppDnsLookupWorker::clearCachedRecords */
 
 
 void CppDnsLookupWorker::printErrno(const std::string& msg)
@@ -41,12 +41,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <sigc++/sigc++.h>
-#include <arpa/nameser.h>
 
 #include <string>
-#include <sstream>
-#include <future>
-#include <netdb.h>
+#include <vector>
+#include <memory>
 
 
 /****************************************************************************
@@ -65,6 +63,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "../core/AsyncDnsLookupWorker.h"
+#include "AsyncCppDnsResolver.h"
 
 
 
@@ -122,7 +121,8 @@ namespace Async
 
 This is the DNS lookup worker for the Cpp variant of the async environment.
 It is an internal class that should only be used from within the async
-library.
+library. The lookups are executed by the process wide Async::CppDnsResolver
+which also cache the answers.
 */
 class CppDnsLookupWorker : public DnsLookupWorker, public sigc::trackable
 {
@@ -159,33 +159,20 @@ class CppDnsLookupWorker : public DnsLookupWorker, public sigc::trackable
     virtual void abortLookup(void);
 
   private:
-    struct ThreadContext
-    {
-      std::string         label;
-      DnsLookup::Type     type                = DnsLookup::Type::A;
-      int                 notifier_wr         = -1;
-      unsigned char       answer[NS_MAXMSG];
-      int                 anslen              = 0;
-      struct addrinfo*    addrinfo            = nullptr;
-      char                host[NI_MAXHOST]    = {0};
-      std::ostringstream  thread_cerr;
-
-      ~ThreadContext(void)
-      {
-        if (addrinfo != nullptr)
-        {
-          freeaddrinfo(addrinfo);
-          addrinfo = nullptr;
-        }
-      }
-    };
+    using RRList = std::vector<std::unique_ptr<DnsResourceRecord>>;
 
     Async::FdWatch                  m_notifier_watch;
-    std::future<void>               m_result;
-    std::unique_ptr<ThreadContext>  m_ctx;
+    CppDnsResolver::QueryPtr        m_query;
+    std::vector<DnsResourceRecord*> m_cached_rrs;
+    RRList                          m_cache_rrs;
 
-    static void workerFunc(ThreadContext& ctx);
+    bool startQuery(void);
     void notificationReceived(FdWatch *w);
+    void parseAnswer(const CppDnsResolver::Query& query);
+    void addRecord(DnsResourceRecord* rr);
+    void cacheResult(const CppDnsResolver::Query& query);
+    void deliverCachedResult(void);
+    void clearCachedRecords(void);
     void printErrno(const std::string& msg);
 
 };  /* class CppDnsLookupWorker */
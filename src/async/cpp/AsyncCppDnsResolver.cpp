@@ -0,0 +1,637 @@
+/**
+@file	 AsyncCppDnsResolver.cpp
+@brief   A process wide DNS resolver thread with a result cache
+@author  Tobias Blomberg
+@date	 2026-10-18
+
+This file contains the resolver used by the DNS lookup worker in the Cpp
+variant of the async environment. All blocking resolver calls are executed
+in one persistent thread and answers are cached according to their TTL. This
+class should never be used directly.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/nameser.h>
+#include <resolv.h>
+#include <arpa/inet.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <netdb.h>
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <algorithm>
+#include <limits>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncMetrics.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncCppDnsResolver.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+#define RESOLV_CONF "/etc/resolv.conf"
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+struct CppDnsResolver::Shared
+{
+  std::mutex                mutex;
+  std::condition_variable   cond;
+  std::deque<QueryPtr>      queue;
+  bool                      stop            = false;
+  bool                      thread_started  = false;
+};
+
+
+namespace {
+#if !(__RES >= 19991006)
+  std::mutex res_mutex;
+#endif
+
+  class Resolver
+  {
+    public:
+      Resolver(void) { m_state.options = RES_DEFAULT; }
+      ~Resolver(void) { close(); }
+
+        // Initialize the resolver if not done before or if the resolver
+        // configuration file has changed since the last initialization
+      int reinitIfNeeded(void)
+      {
+        struct stat st;
+        struct timespec mtime = {0, 0};
+        if (stat(RESOLV_CONF, &st) == 0)
+        {
+          mtime = st.st_mtim;
+        }
+        if (m_initialized && (mtime.tv_sec == m_conf_mtime.tv_sec) &&
+            (mtime.tv_nsec == m_conf_mtime.tv_nsec))
+        {
+          return 0;
+        }
+        if (m_initialized)
+        {
+          close();
+          memset(&m_state, 0, sizeof(m_state));
+          m_state.options = RES_DEFAULT;
+        }
+        int rc = init();
+        m_initialized = (rc != -1);
+        m_conf_mtime = mtime;
+        return rc;
+      }
+#if __RES >= 19991006
+      int init(void)
+      {
+        return res_ninit(&m_state);
+      }
+      int search(const char *dname, int dclass, int type,
+                 unsigned char* answer, int anslen)
+      {
+        return res_nsearch(&m_state, dname, dclass, type, answer, anslen);
+      }
+      void close(void)
+      {
+          // FIXME: Valgrind complain about leaked memory in the resolver
+          //        library when a lookup fails. It seems to be a one time leak
+          //        though so it does not grow with every failed lookup. But
+          //        even so, it seems that res_nclose is not cleaning up
+          //        properly.  Glibc 2.33-18 on Fedora 34.
+        if (m_initialized)
+        {
+          res_nclose(&m_state);
+        }
+      }
+#else
+      int init(void)
+      {
+        const std::lock_guard<std::mutex> lock(res_mutex);
+        int rc = res_init();
+        memcpy(&m_state, &_res, sizeof(m_state));
+        return rc;
+      }
+      int search(const char *dname, int dclass, int type,
+                 unsigned char* answer, int anslen)
+      {
+        const std::lock_guard<std::mutex> lock(res_mutex);
+        struct __res_state old_state;
+        memcpy(&old_state, &_res, sizeof(old_state));
+        memcpy(&_res, &m_state, sizeof(m_state));
+        int rc = res_search(dname, dclass, type, answer, anslen);
+        memcpy(&_res, &old_state, sizeof(old_state));
+        return rc;
+      }
+      void close(void) {}
+#endif
+    private:
+      struct __res_state  m_state;
+      bool                m_initialized = false;
+      struct timespec     m_conf_mtime  = {0, 0};
+  };
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+static int negativeTtl(const unsigned char* msg, size_t maxlen);
+static Metrics::Counter& cacheCounter(const char* result);
+static Metrics::Gauge& cacheEntriesGauge(void);
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+CppDnsResolver::Query::~Query(void)
+{
+  if (addrinfo != nullptr)
+  {
+    freeaddrinfo(addrinfo);
+    addrinfo = nullptr;
+  }
+  if (notifier_wr >= 0)
+  {
+    ::close(notifier_wr);
+    notifier_wr = -1;
+  }
+} /* CppDnsResolver::Query::~Query */
+
+
+CppDnsResolver& CppDnsResolver::instance(void)
+{
+  static CppDnsResolver resolver;
+  return resolver;
+} /* CppDnsResolver::instance */
+
+
+CppDnsResolver::~CppDnsResolver(void)
+{
+    // The thread is detached and keep its own reference to the shared state
+    // so we do not need to wait for a blocking resolver call to finish.
+  std::lock_guard<std::mutex> lk(m_shared->mutex);
+  m_shared->stop = true;
+  m_shared->cond.notify_all();
+} /* CppDnsResolver::~CppDnsResolver */
+
+
+bool CppDnsResolver::submit(QueryPtr query)
+{
+  std::lock_guard<std::mutex> lk(m_shared->mutex);
+  if (!m_shared->thread_started)
+  {
+    try
+    {
+      std::thread(threadFunc, m_shared).detach();
+    }
+    catch (const std::system_error& e)
+    {
+      std::cerr << "*** ERROR: Could not start the DNS resolver thread: "
+                << e.what() << std::endl;
+      return false;
+    }
+    m_shared->thread_started = true;
+  }
+  m_shared->queue.push_back(query);
+  m_shared->cond.notify_one();
+  return true;
+} /* CppDnsResolver::submit */
+
+
+bool CppDnsResolver::cacheLookup(DnsLookup::Type type, const std::string& label,
+                                 std::vector<DnsResourceRecord*>& rrs)
+{
+  auto it = m_cache.find(CacheKey(type, label));
+  auto now = Clock::now();
+  if ((it == m_cache.end()) || (it->second.expires <= now))
+  {
+    cacheCounter("miss").inc();
+    return false;
+  }
+
+  const CacheEntry& entry = it->second;
+  cacheCounter(entry.rrs.empty() ? "negative_hit" : "hit").inc();
+  auto age = std::chrono::duration_cast<std::chrono::seconds>(
+      now - entry.stored).count();
+  for (const auto& rr : entry.rrs)
+  {
+    DnsResourceRecord* cloned_rr = rr->clone();
+    DnsResourceRecord::Ttl ttl = 0;
+    if (age < rr->ttl())
+    {
+      ttl = rr->ttl() - age;
+    }
+    cloned_rr->setTtl(ttl);
+    rrs.push_back(cloned_rr);
+  }
+  return true;
+} /* CppDnsResolver::cacheLookup */
+
+
+void CppDnsResolver::cacheStore(DnsLookup::Type type, const std::string& label,
+                      std::vector<std::unique_ptr<DnsResourceRecord>>&& rrs,
+                      unsigned ttl)
+{
+  if (ttl == 0)
+  {
+    return;
+  }
+
+  purgeCache();
+  if (m_cache.size() >= MAX_CACHE_ENTRIES)
+  {
+    auto oldest = std::min_element(m_cache.begin(), m_cache.end(),
+        [](const Cache::value_type& a, const Cache::value_type& b)
+        {
+          return a.second.expires < b.second.expires;
+        });
+    m_cache.erase(oldest);
+  }
+
+  CacheEntry& entry = m_cache[CacheKey(type, label)];
+  entry.rrs = std::move(rrs);
+  entry.stored = Clock::now();
+  entry.expires = entry.stored + std::chrono::seconds(ttl);
+  cacheEntriesGauge().set(m_cache.size());
+} /* CppDnsResolver::cacheStore */
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+CppDnsResolver::CppDnsResolver(void)
+  : m_shared(std::make_shared<Shared>())
+{
+} /* CppDnsResolver::CppDnsResolver */
+
+
+void CppDnsResolver::purgeCache(void)
+{
+  auto now = Clock::now();
+  for (auto it = m_cache.begin(); it != m_cache.end(); )
+  {
+    if (it->second.expires <= now)
+    {
+      it = m_cache.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+} /* CppDnsResolver::purgeCache */
+
+
+void CppDnsResolver::threadFunc(std::shared_ptr<Shared> shared)
+{
+  for (;;)
+  {
+    QueryPtr query;
+    {
+      std::unique_lock<std::mutex> lk(shared->mutex);
+      shared->cond.wait(lk,
+          [&]{ return shared->stop || !shared->queue.empty(); });
+      if (shared->stop)
+      {
+        shared->queue.clear();
+        return;
+      }
+      query = shared->queue.front();
+      shared->queue.pop_front();
+    }
+
+    if (!query->aborted)
+    {
+      runQuery(*query);
+    }
+
+      // Notify the main thread that the query is done
+    ::close(query->notifier_wr);
+    query->notifier_wr = -1;
+  }
+} /* CppDnsResolver::threadFunc */
+
+
+/*
+ *----------------------------------------------------------------------------
+ * Method:    CppDnsResolver::runQuery
+ * Purpose:   This is the function that do the actual DNS lookup. It is
+ *    	      called from the resolver thread since the resolver functions
+ *    	      are blocking.
+ * Input:     query - The query parameters
+ * Output:    The answer and anslen variables in the query will be filled in
+ *            with the lookup result. The negative flag will be set if the
+ *            name or data authoritatively does not exist.
+ * Author:    Tobias Blomberg
+ * Created:   2021-07-14
+ * Remarks:
+ * Bugs:
+ *----------------------------------------------------------------------------
+ */
+void CppDnsResolver::runQuery(Query& query)
+{
+  static thread_local Resolver res;
+
+  std::ostream& th_cerr = query.thread_cerr;
+
+  int qtype = 0;
+  switch (query.type)
+  {
+    case DnsLookup::Type::A:
+    {
+      struct addrinfo hints = {0};
+      hints.ai_family = AF_INET;
+      int ret = getaddrinfo(query.label.c_str(), NULL, &hints,
+                            &query.addrinfo);
+      if (ret != 0)
+      {
+        th_cerr << "*** WARNING[getaddrinfo]: Could not look up host \""
+                << query.label << "\": " << gai_strerror(ret) << std::endl;
+        query.negative = (ret == EAI_NONAME);
+      }
+      else if (query.addrinfo == nullptr)
+      {
+        th_cerr << "*** WARNING[getaddrinfo]: No address info returned "
+                   "for host \"" << query.label << "\"" << std::endl;
+      }
+      break;
+    }
+    case DnsLookup::Type::PTR:
+    {
+      IpAddress ip_addr;
+      size_t arpa_domain_pos = query.label.find(".in-addr.arpa");
+      if (arpa_domain_pos != std::string::npos)
+      {
+        ip_addr.setIpFromString(query.label.substr(0, arpa_domain_pos));
+        struct in_addr addr = ip_addr.ip4Addr();
+        addr.s_addr = htonl(addr.s_addr);
+        ip_addr.setIp(addr);
+      }
+      else
+      {
+        ip_addr.setIpFromString(query.label);
+      }
+      if (!ip_addr.isEmpty())
+      {
+        struct sockaddr_in in_addr = {0};
+        in_addr.sin_family = AF_INET;
+        in_addr.sin_addr = ip_addr.ip4Addr();
+        int ret = getnameinfo(reinterpret_cast<struct sockaddr*>(&in_addr),
+                              sizeof(in_addr),
+                              query.host, sizeof(query.host),
+                              NULL, 0, NI_NAMEREQD);
+        if (ret != 0)
+        {
+          th_cerr << "*** WARNING[getnameinfo]: Could not look up IP \""
+                  << query.label << "\": " << gai_strerror(ret) << std::endl;
+          query.negative = (ret == EAI_NONAME);
+        }
+      }
+      else
+      {
+        th_cerr << "*** WARNING: Failed to parse PTR label \""
+                << query.label << "\"" << std::endl;
+      }
+      break;
+    }
+    case DnsLookup::Type::CNAME:
+      qtype = ns_t_cname;
+      break;
+    case DnsLookup::Type::SRV:
+      qtype = ns_t_srv;
+      break;
+    default:
+      assert(0);
+  }
+
+  if (qtype != 0)
+  {
+    int ret = res.reinitIfNeeded();
+    if (ret != -1)
+    {
+        // Clear the header so that we can tell if a response was received
+        // when the search fail
+      memset(query.answer, 0, HFIXEDSZ);
+      const char *dname = query.label.c_str();
+      query.anslen = res.search(dname, ns_c_in, qtype,
+                                query.answer, sizeof(query.answer));
+      if (query.anslen == -1)
+      {
+        int err = h_errno;
+        th_cerr << "*** ERROR: Name resolver failure -- res_nsearch: "
+                << hstrerror(err) << std::endl;
+        if ((err == HOST_NOT_FOUND) || (err == NO_DATA))
+        {
+          query.negative = true;
+          int ttl = negativeTtl(query.answer, sizeof(query.answer));
+          if (ttl >= 0)
+          {
+            query.negative_ttl = std::min<unsigned>(ttl, +MAX_NEGATIVE_TTL);
+          }
+        }
+      }
+    }
+    else
+    {
+      th_cerr << "*** ERROR: Name resolver failure -- res_ninit: "
+              << hstrerror(h_errno) << std::endl;
+    }
+  }
+} /* CppDnsResolver::runQuery */
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+/**
+ * @brief   Find the negative caching TTL in a DNS response
+ * @param   msg     The buffer holding the DNS response
+ * @param   maxlen  The size of the buffer
+ * @return  Returns the TTL in seconds or -1 if it could not be found
+ *
+ * According to RFC 2308 the TTL of a negative answer is the minimum of the
+ * SOA record TTL and the SOA MINIMUM field, where the SOA record is found in
+ * the authority section of the response. The resolver do not return the
+ * response length for failed queries so it is calculated here by walking
+ * through all sections of the message.
+ */
+static int negativeTtl(const unsigned char* msg, size_t maxlen)
+{
+  if ((maxlen < HFIXEDSZ) || ((msg[2] & 0x80) == 0))
+  {
+      // No response received. The QR bit is set in all responses.
+    return -1;
+  }
+
+  const unsigned char* eom = msg + maxlen;
+  const unsigned char* cp = msg + HFIXEDSZ;
+  for (int sect=ns_s_qd; sect<ns_s_max; ++sect)
+  {
+    int cnt = ns_get16(msg + 4 + 2 * sect);
+    int len = ns_skiprr(cp, eom, static_cast<ns_sect>(sect), cnt);
+    if (len < 0)
+    {
+      return -1;
+    }
+    cp += len;
+  }
+
+  ns_msg handle;
+  if (ns_initparse(msg, cp - msg, &handle) == -1)
+  {
+    return -1;
+  }
+  for (int rrnum=0; rrnum<ns_msg_count(handle, ns_s_ns); ++rrnum)
+  {
+    ns_rr rr;
+    if ((ns_parserr(&handle, ns_s_ns, rrnum, &rr) == -1) ||
+        (ns_rr_type(rr) != ns_t_soa))
+    {
+      continue;
+    }
+    const unsigned char* rdata = ns_rr_rdata(rr);
+    const unsigned char* rdata_end = rdata + ns_rr_rdlen(rr);
+    for (int i=0; i<2; ++i) // Skip MNAME and RNAME
+    {
+      int len = dn_skipname(rdata, rdata_end);
+      if (len < 0)
+      {
+        return -1;
+      }
+      rdata += len;
+    }
+    if (rdata_end - rdata < 5 * NS_INT32SZ)
+    {
+      return -1;
+    }
+    uint32_t minimum = ns_get32(rdata + 4 * NS_INT32SZ);
+    return static_cast<int>(std::min(
+          std::min(minimum, static_cast<uint32_t>(ns_rr_ttl(rr))),
+          static_cast<uint32_t>(std::numeric_limits<int>::max())));
+  }
+  return -1;
+} /* negativeTtl */
+
+
+static Metrics::Counter& cacheCounter(const char* result)
+{
+  return Metrics::instance().counter("async_dns_cache_lookups_total",
+      "Number of DNS lookups served from, or missing in, the DNS cache",
+      Metrics::label("result", result));
+} /* cacheCounter */
+
+
+static Metrics::Gauge& cacheEntriesGauge(void)
+{
+  static Metrics::Gauge& gauge = Metrics::instance().gauge(
+      "async_dns_cache_entries", "Number of entries in the DNS cache");
+  return gauge;
+} /* cacheEntriesGauge */
+
+
+
+/*
+ * This file has not been truncated
+ */
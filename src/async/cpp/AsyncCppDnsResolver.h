@@ -0,0 +1,254 @@
+/**
+@file	 AsyncCppDnsResolver.h
+@brief   A process wide DNS resolver thread with a result cache
+@author  Tobias Blomberg
+@date	 2026-10-18
+
+This file contains the resolver used by the DNS lookup worker in the Cpp
+variant of the async environment. All blocking resolver calls are executed
+in one persistent thread and answers are cached according to their TTL. This
+class should never be used directly.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_CPP_DNS_RESOLVER_INCLUDED
+#define ASYNC_CPP_DNS_RESOLVER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <arpa/nameser.h>
+#include <netdb.h>
+
+#include <string>
+#include <sstream>
+#include <memory>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <chrono>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncDnsLookup.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Process wide DNS resolver thread and answer cache
+@author Tobias Blomberg
+@date   2026-10-18
+
+This class run all blocking resolver calls in one persistent thread instead
+of starting a new thread for each lookup. Queries are executed in the order
+they are submitted. When a query is done, the write end of the notification
+pipe in the query is closed so that the main thread get notified through an
+Async::FdWatch.
+
+The class also hold a cache of DNS answers that is shared by all
+Async::DnsLookup objects in the process. Answers are cached for as long as
+their TTL say. Authoritative negative answers, like a non-existent domain,
+are also cached using the SOA minimum TTL (RFC 2308). Answers from the
+system host lookup functions, which do not carry a TTL, are cached for a
+short fixed time. The cache is only accessed from the main thread.
+
+Cache hit and miss counts are available in the Async::Metrics registry.
+*/
+class CppDnsResolver
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+      /// Cache time for answers that do not carry a TTL
+    static constexpr unsigned NO_TTL_CACHE_TIME       = 30;
+      /// Cache time for negative answers without SOA information
+    static constexpr unsigned DEFAULT_NEGATIVE_TTL    = 30;
+      /// The maximum time to cache a negative answer
+    static constexpr unsigned MAX_NEGATIVE_TTL        = 300;
+      /// The maximum number of entries in the cache
+    static constexpr size_t   MAX_CACHE_ENTRIES       = 512;
+
+    /**
+     * @brief   Parameters and result for one query
+     *
+     * The query object is shared between the main thread and the resolver
+     * thread. The main thread must not touch the result members until the
+     * notification pipe has been closed by the resolver thread.
+     */
+    struct Query
+    {
+      std::string         label;
+      DnsLookup::Type     type                = DnsLookup::Type::A;
+      int                 notifier_wr         = -1;
+      std::atomic<bool>   aborted             {false};
+      unsigned char       answer[NS_MAXMSG];
+      int                 anslen              = 0;
+      struct addrinfo*    addrinfo            = nullptr;
+      char                host[NI_MAXHOST]    = {0};
+      bool                negative            = false;
+      unsigned            negative_ttl        = DEFAULT_NEGATIVE_TTL;
+      std::ostringstream  thread_cerr;
+
+      ~Query(void);
+    };
+    using QueryPtr = std::shared_ptr<Query>;
+
+    /**
+     * @brief   Get the process wide resolver instance
+     * @return  Returns the resolver instance
+     */
+    static CppDnsResolver& instance(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~CppDnsResolver(void);
+
+    /**
+     * @brief   Queue a query for execution in the resolver thread
+     * @param   query The query to execute
+     * @return  Returns \em true on success or else \em false
+     */
+    bool submit(QueryPtr query);
+
+    /**
+     * @brief   Look up an answer in the cache
+     * @param   type  The record type
+     * @param   label The label to look up
+     * @param   rrs   Filled in with copies of the cached records
+     * @return  Returns \em true if a valid entry was found
+     *
+     * The TTL of the returned records will be adjusted to the remaining
+     * time to live. The caller take ownership of the returned records. A
+     * valid negative entry is returned as a hit with an empty record list.
+     */
+    bool cacheLookup(DnsLookup::Type type, const std::string& label,
+                     std::vector<DnsResourceRecord*>& rrs);
+
+    /**
+     * @brief   Store an answer in the cache
+     * @param   type  The record type
+     * @param   label The label that was looked up
+     * @param   rrs   The answer records, ownership is transferred
+     * @param   ttl   The time to cache the answer, in seconds
+     *
+     * If the record list is empty, a negative entry is stored.
+     */
+    void cacheStore(DnsLookup::Type type, const std::string& label,
+                    std::vector<std::unique_ptr<DnsResourceRecord>>&& rrs,
+                    unsigned ttl);
+
+  private:
+    struct CacheEntry
+    {
+      std::vector<std::unique_ptr<DnsResourceRecord>> rrs;
+      Clock::time_point                               stored;
+      Clock::time_point                               expires;
+    };
+    using CacheKey = std::pair<DnsLookup::Type, std::string>;
+    using Cache = std::map<CacheKey, CacheEntry>;
+    struct Shared;
+
+    std::shared_ptr<Shared> m_shared;
+    Cache                   m_cache;
+
+    CppDnsResolver(void);
+    CppDnsResolver(const CppDnsResolver&);
+    CppDnsResolver& operator=(const CppDnsResolver&);
+    void purgeCache(void);
+    static void threadFunc(std::shared_ptr<Shared> shared);
+    static void runQuery(Query& query);
+
+};  /* class CppDnsResolver */
+
+
+} /* namespace */
+
+#endif /* ASYNC_CPP_DNS_RESOLVER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -1,4 +1,8 @@
 #include <iostream>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdlib>
 #include <AsyncCppApplication.h>
 #include <AsyncExec.h>
 #include <AsyncTimer.h>
@@ -25,10 +29,82 @@ void handleExit(Exec *exec)
   cout << endl;
 }
 
-int main()
+  // Measure how long it takes to start a subprocess and to get notified
+  // when it exits. Run the demo with a number of megabytes as argument to
+  // inflate the memory usage of the process before starting the benchmark.
+class SpawnBench : public sigc::trackable
+{
+  public:
+    SpawnBench(int runs) : m_runs(runs) {}
+
+    void start(void)
+    {
+      m_cnt = 0;
+      m_spawn_sum = m_spawn_max = m_total_sum = 0.0;
+      runOne();
+    }
+
+    sigc::signal<void()> done;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    int                   m_runs;
+    int                   m_cnt         = 0;
+    std::unique_ptr<Exec> m_exec;
+    Clock::time_point     m_start;
+    double                m_spawn_sum   = 0.0;
+    double                m_spawn_max   = 0.0;
+    double                m_total_sum   = 0.0;
+
+    static double usSince(Clock::time_point start)
+    {
+      return std::chrono::duration<double, std::micro>(
+          Clock::now() - start).count();
+    }
+
+    void runOne(void)
+    {
+      m_exec.reset(new Exec("/bin/true"));
+      m_exec->exited.connect(mem_fun(*this, &SpawnBench::onExited));
+      m_start = Clock::now();
+      m_exec->run();
+      double spawn_us = usSince(m_start);
+      m_spawn_sum += spawn_us;
+      m_spawn_max = std::max(m_spawn_max, spawn_us);
+    }
+
+    void onExited(void)
+    {
+      m_total_sum += usSince(m_start);
+      if (++m_cnt < m_runs)
+      {
+          // The Exec object must not be deleted from within its own signal
+        Application::app().runTask(mem_fun(*this, &SpawnBench::runOne));
+        return;
+      }
+      cout << "Spawn benchmark, " << m_runs << " runs of /bin/true:" << endl;
+      cout << "  run() avg=" << (m_spawn_sum / m_runs) << "us"
+           << " max=" << m_spawn_max << "us" << endl;
+      cout << "  run() to exited avg=" << (m_total_sum / m_runs) << "us"
+           << endl;
+      done();
+    }
+};
+
+int main(int argc, const char *argv[])
 {
   CppApplication app;
 
+    // Optionally make the process big to show that the spawn time does not
+    // depend on the size of the calling process
+  std::vector<char> ballast;
+  if (argc > 1)
+  {
+    ballast.resize(static_cast<size_t>(atoi(argv[1])) * 1024 * 1024, 1);
+    cout << "Allocated " << atoi(argv[1]) << "MB of memory" << endl;
+  }
+
     // Start a "cat" process and then run some text through it. Use the -n
     // option to make cat number the lines
   Exec cat("/bin/cat -n");
@@ -52,10 +128,12 @@ int main()
   kill.setTimeout(1);
   kill.run();
 
-    // Sleep for two seconds then quit application
+    // Sleep for two seconds then run the spawn benchmark and quit
+  SpawnBench bench(200);
+  bench.done.connect(mem_fun(app, &CppApplication::quit));
   Exec sleep("/bin/sleep 2");
   sleep.exited.connect(sigc::bind(sigc::ptr_fun(handleExit), &sleep));
-  sleep.exited.connect(mem_fun(app, &CppApplication::quit));
+  sleep.exited.connect(mem_fun(bench, &SpawnBench::start));
   sleep.run();
 
   app.exec();
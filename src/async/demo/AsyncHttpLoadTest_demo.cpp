@@ -0,0 +1,239 @@
+// A HTTP load test for the Async::HttpServerConnection class.
+//
+// Run without arguments to start both a HTTP server and the load generator
+// in the same process. Give a host and a port to load test another server,
+// e.g. a svxreflector with HTTP_SRV_PORT set. Use "-" as host to use the
+// built in server on the given port.
+//
+//   AsyncHttpLoadTest_demo [host port [path [connections [pipeline
+//                          [seconds [gzip]]]]]]
+//
+// Each connection is kept open and has "pipeline" requests outstanding at
+// all times. A new request is sent as soon as a response has been received.
+//
+
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <AsyncCppApplication.h>
+#include <AsyncTcpClient.h>
+#include <AsyncTcpServer.h>
+#include <AsyncHttpServerConnection.h>
+#include <AsyncTimer.h>
+
+using namespace Async;
+
+struct Stats
+{
+  unsigned long connects  = 0;
+  unsigned long responses = 0;
+  unsigned long errors    = 0;
+  unsigned long long body_bytes = 0;
+};
+
+class LoadClient : public sigc::trackable
+{
+  public:
+    LoadClient(const std::string& host, uint16_t port, const std::string& path,
+               unsigned pipeline, bool gzip, Stats& stats)
+      : m_pipeline(pipeline), m_stats(stats)
+    {
+      std::ostringstream os;
+      os << "GET " << path << " HTTP/1.1\r\n"
+         << "Host: " << host << "\r\n";
+      if (gzip)
+      {
+        os << "Accept-Encoding: gzip\r\n";
+      }
+      os << "\r\n";
+      m_req = os.str();
+      m_con.connected.connect(mem_fun(*this, &LoadClient::onConnected));
+      m_con.disconnected.connect(mem_fun(*this, &LoadClient::onDisconnected));
+      m_con.dataReceived.connect(mem_fun(*this, &LoadClient::onDataReceived));
+      m_con.connect(host, port);
+    }
+
+  private:
+    TcpClient<>   m_con;
+    std::string   m_req;
+    unsigned      m_pipeline;
+    Stats&        m_stats;
+
+    void onConnected(void)
+    {
+      m_stats.connects += 1;
+      std::string reqs;
+      for (unsigned i=0; i<m_pipeline; ++i)
+      {
+        reqs += m_req;
+      }
+      m_con.write(reqs.data(), reqs.size());
+    }
+
+    void onDisconnected(TcpConnection *, TcpClient<>::DisconnectReason reason)
+    {
+      std::cout << "--- Disconnected: "
+                << TcpConnection::disconnectReasonStr(reason) << std::endl;
+      m_stats.errors += 1;
+    }
+
+    int onDataReceived(TcpConnection *, void *buf, int count)
+    {
+      const char *data = static_cast<const char*>(buf);
+      int pos = 0;
+      for (;;)
+      {
+        const char *end = static_cast<const char*>(
+            memmem(data + pos, count - pos, "\r\n\r\n", 4));
+        if (end == nullptr)
+        {
+          break;
+        }
+        size_t header_len = end - (data + pos) + 4;
+        std::string header(data + pos, header_len);
+        size_t content_len = 0;
+        std::istringstream is(header);
+        std::string line;
+        while (std::getline(is, line))
+        {
+          if (strncasecmp(line.c_str(), "Content-length:", 15) == 0)
+          {
+            content_len = strtoul(line.c_str() + 15, nullptr, 10);
+          }
+        }
+        if (header.compare(0, 12, "HTTP/1.1 200") != 0)
+        {
+          m_stats.errors += 1;
+        }
+        if (pos + header_len + content_len > static_cast<size_t>(count))
+        {
+          break;
+        }
+        pos += header_len + content_len;
+        m_stats.responses += 1;
+        m_stats.body_bytes += content_len;
+        m_con.write(m_req.data(), m_req.size());
+      }
+      return pos;
+    }
+};
+
+
+class StatusServer : public sigc::trackable
+{
+  public:
+    StatusServer(const std::string& port) : m_server(port)
+    {
+        // A status document of about the same size as a busy reflector
+      std::ostringstream os;
+      os << "{\"nodes\":{";
+      for (int i=0; i<50; ++i)
+      {
+        os << (i > 0 ? "," : "") << "\"SM0XYZ-" << i << "\":{"
+           << "\"tg\":" << (240 + i % 4) << ","
+           << "\"isTalker\":false,"
+           << "\"monitoredTGs\":[240,241,242],"
+           << "\"sw\":\"SvxLink\",\"swVer\":\"1.9.99\"}";
+      }
+      os << "}}";
+      m_status = std::make_shared<const HttpServerConnection::Content>(
+          os.str());
+      m_server.clientConnected.connect(
+          mem_fun(*this, &StatusServer::onClientConnected));
+    }
+
+  private:
+    TcpServer<HttpServerConnection> m_server;
+    HttpServerConnection::ContentPtr m_status;
+
+    void onClientConnected(HttpServerConnection *con)
+    {
+      con->requestReceived.connect(
+          mem_fun(*this, &StatusServer::onRequestReceived));
+    }
+
+    void onRequestReceived(HttpServerConnection *con,
+                           HttpServerConnection::Request& req)
+    {
+      HttpServerConnection::Response res;
+      if (req.target != "/status")
+      {
+        res.setCode(404);
+        res.setContent("text/plain", "Not found!\n");
+        con->write(res);
+        return;
+      }
+      res.setCode(200);
+      res.setContent("application/json", m_status);
+      res.setSendContent(req.method == "GET");
+      con->write(res);
+    }
+};
+
+
+int main(int argc, char **argv)
+{
+  CppApplication app;
+
+  std::string host("localhost");
+  uint16_t port = 18080;
+  std::string path("/status");
+  unsigned connections = 10;
+  unsigned pipeline = 4;
+  unsigned seconds = 5;
+  bool gzip = false;
+  bool builtin_server = true;
+  if (argc > 2)
+  {
+    builtin_server = (std::string(argv[1]) == "-");
+    if (!builtin_server)
+    {
+      host = argv[1];
+    }
+    port = atoi(argv[2]);
+  }
+  if (argc > 3) path = argv[3];
+  if (argc > 4) connections = atoi(argv[4]);
+  if (argc > 5) pipeline = atoi(argv[5]);
+  if (argc > 6) seconds = atoi(argv[6]);
+  if (argc > 7) gzip = (atoi(argv[7]) != 0);
+
+  std::cout << "--- Load testing http://" << host << ":" << port << path
+            << " using " << connections << " connections with "
+            << pipeline << " pipelined requests each for "
+            << seconds << " seconds" << (gzip ? " (gzip)" : "") << std::endl;
+
+  std::unique_ptr<StatusServer> server;
+  if (builtin_server)
+  {
+    server.reset(new StatusServer(std::to_string(port)));
+  }
+
+  Stats stats;
+  std::vector<std::unique_ptr<LoadClient>> clients;
+  for (unsigned i=0; i<connections; ++i)
+  {
+    clients.emplace_back(
+        new LoadClient(host, port, path, pipeline, gzip, stats));
+  }
+
+  Timer done_timer(1000 * seconds);
+  done_timer.expired.connect([&](Timer*)
+    {
+      std::cout << "--- Connects: " << stats.connects
+                << "  Responses: " << stats.responses
+                << "  Errors: " << stats.errors << std::endl;
+      std::cout << "--- " << (stats.responses / seconds) << " requests/s, "
+                << (stats.body_bytes / seconds / 1024) << " KiB/s of content"
+                << std::endl;
+      Application::app().quit();
+    });
+
+  app.exec();
+
+  return (stats.errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,231 @@
+/**
+@file	 AudioCompressorBench.cpp
+@brief   Benchmark and verify the audio compressor
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+This program run the Async::AudioCompressor class using the limiter settings
+of the local receiver and transmitter and a more moderate compressor setting.
+The output is compared to the per sample log/exp implementation, previously
+used in the class, and the throughput of both implementations are printed.
+The deviation is given as the largest and the RMS difference in applied gain,
+in dB.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+#include <AsyncAudioCompressor.h>
+
+using namespace std;
+using namespace Async;
+
+
+namespace {
+  /*
+   * Make the processSamples function accessible from the benchmark
+   */
+  class Compressor : public AudioCompressor
+  {
+    public:
+      using AudioCompressor::processSamples;
+  };
+
+  /*
+   * The implementation previously used in the Async library
+   */
+  class RefCompressor
+  {
+    public:
+      RefCompressor(void)
+        : threshdB_(0.0), ratio_(1.0), output_gain(1.0), att_(10.0),
+          rel_(100.0), envdB_(DC_OFFSET) {}
+
+      void setThreshold(double thresh_db) { threshdB_ = thresh_db; }
+      void setRatio(double ratio) { ratio_ = ratio; }
+      void setAttack(double attack_ms) { att_.setTc(attack_ms); }
+      void setDecay(double decay_ms) { rel_.setTc(decay_ms); }
+      void setOutputGain(float gain)
+      {
+        output_gain = (gain == 0)
+          ? exp((threshdB_ * ratio_ - threshdB_) * DB_2_LOG)
+          : gain;
+      }
+
+      void processSamples(float *dest, const float *src, int count)
+      {
+        for (int i=0; i<count; ++i)
+        {
+          double rect = fabs(src[i]) + DC_OFFSET;
+          double overdB = log(rect) * LOG_2_DB - threshdB_;
+          if (overdB < 0.0)
+          {
+            overdB = 0.0;
+          }
+          overdB += DC_OFFSET;
+          if (overdB > envdB_)
+          {
+            att_.run(overdB, envdB_);
+          }
+          else
+          {
+            rel_.run(overdB, envdB_);
+          }
+          overdB = envdB_ - DC_OFFSET;
+          double gr = exp(overdB * (ratio_ - 1.0) * DB_2_LOG);
+          dest[i] = output_gain * src[i] * gr;
+        }
+      }
+
+    private:
+      static constexpr double DC_OFFSET = 1.0E-25;
+      static constexpr double LOG_2_DB  = 8.6858896380650365530225783783321;
+      static constexpr double DB_2_LOG  = 0.11512925464970228420089957273422;
+
+      double            threshdB_;
+      double            ratio_;
+      double            output_gain;
+      EnvelopeDetector  att_;
+      EnvelopeDetector  rel_;
+      double            envdB_;
+  };
+
+  const int BLOCK_SIZE  = 256;
+  const int BLOCKS      = 20000;
+
+  template <typename Proc>
+  double run(Proc& proc, const vector<float>& in, vector<float>& out)
+  {
+    auto start = chrono::steady_clock::now();
+    for (int blk = 0; blk < BLOCKS; ++blk)
+    {
+      const int pos = (blk % (in.size() / BLOCK_SIZE)) * BLOCK_SIZE;
+      proc.processSamples(out.data(), in.data() + pos, BLOCK_SIZE);
+    }
+    chrono::duration<double> dur = chrono::steady_clock::now() - start;
+    return dur.count();
+  }
+
+  template <typename Proc>
+  void setup(Proc& proc, double thresh, double ratio, double attack,
+             double decay, float gain)
+  {
+    proc.setThreshold(thresh);
+    proc.setRatio(ratio);
+    proc.setAttack(attack);
+    proc.setDecay(decay);
+    proc.setOutputGain(gain);
+  }
+
+  bool bench(const string& name, double thresh, double ratio, double attack,
+             double decay, float gain)
+  {
+      // Tone bursts of varying level and frequency with some added noise,
+      // roughly resembling speech. One second of audio.
+    mt19937 gen(4711);
+    normal_distribution<float> noise(0.0f, 0.01f);
+    uniform_real_distribution<float> level(0.05f, 2.0f);
+    uniform_real_distribution<float> freq(200.0f, 3000.0f);
+    vector<float> in(INTERNAL_SAMPLE_RATE);
+    float amp = 0.0f;
+    float fq = 0.0f;
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+      if (i % (INTERNAL_SAMPLE_RATE / 20) == 0)
+      {
+        amp = level(gen);
+        fq = freq(gen);
+      }
+      in[i] = amp * sin(2.0 * M_PI * fq * i / INTERNAL_SAMPLE_RATE) +
+              noise(gen);
+    }
+    vector<float> out(in.size()), ref_out(in.size());
+
+      // Compare the applied gain to the reference implementation
+    Compressor proc;
+    RefCompressor ref;
+    setup(proc, thresh, ratio, attack, decay, gain);
+    setup(ref, thresh, ratio, attack, decay, gain);
+    double max_err = 0.0;
+    double sum_sq_err = 0.0;
+    size_t err_cnt = 0;
+    for (size_t pos = 0; pos < in.size(); pos += BLOCK_SIZE)
+    {
+      const int cnt = min(in.size() - pos, static_cast<size_t>(BLOCK_SIZE));
+      proc.processSamples(out.data() + pos, in.data() + pos, cnt);
+      ref.processSamples(ref_out.data() + pos, in.data() + pos, cnt);
+    }
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+      if (fabs(in[i]) > 1e-3f)
+      {
+        const double err = 20.0 * log10(fabs(out[i] / ref_out[i]));
+        max_err = max(max_err, fabs(err));
+        sum_sq_err += err * err;
+        err_cnt += 1;
+      }
+    }
+    const double rms_err = sqrt(sum_sq_err / err_cnt);
+
+    const double ref_time = run(ref, in, out);
+    const double new_time = run(proc, in, out);
+    const double samples = static_cast<double>(BLOCKS) * BLOCK_SIZE;
+    cout << setw(18) << left << name
+         << setw(12) << right << fixed << setprecision(1)
+         << (samples / ref_time / 1e6)
+         << setw(12) << (samples / new_time / 1e6)
+         << setw(9) << setprecision(2) << (ref_time / new_time) << "x"
+         << setw(12) << setprecision(3) << max_err
+         << setw(12) << rms_err
+         << endl;
+    return (max_err < 1.0) && (rms_err < 0.1);
+  }
+};
+
+
+int main(int argc, const char **argv)
+{
+  cout << "Throughput in million samples per second, "
+          "gain error in dB\n\n";
+  cout << setw(18) << left << "Setting"
+       << setw(12) << right << "Old" << setw(12) << "New"
+       << setw(10) << "Speedup" << setw(12) << "Max err" << setw(12)
+       << "RMS err" << endl;
+
+  bool ok = true;
+  ok &= bench("limiter", -6.0, 0.1, 2.0, 20.0, 1.0f);
+  ok &= bench("compressor", -10.0, 0.25, 10.0, 100.0, 0.0f);
+  ok &= bench("fast compressor", -20.0, 0.5, 1.0, 10.0, 0.0f);
+
+  if (!ok)
+  {
+    cout << "*** ERROR: The output differ too much from the reference\n";
+    return 1;
+  }
+
+  return 0;
+}
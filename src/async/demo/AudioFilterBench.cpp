@@ -0,0 +1,179 @@
+/**
+@file	 AudioFilterBench.cpp
+@brief   Benchmark and verify the biquad backend of the audio filter
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+This program run white noise through the filters used in SvxLink, once using
+the fidlib backend and once using the biquad backend of Async::AudioFilter.
+The difference between the two outputs is printed relative to the level of
+the fidlib output, together with the throughput of both backends. The biquad
+backend is also run using a couple of odd block sizes, which must give
+exactly the same output since the pipeline is drained at the end of each
+block.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include <AsyncAudioFilter.h>
+
+using namespace std;
+using namespace Async;
+
+
+namespace {
+  /*
+   * Make the processSamples function accessible from the benchmark
+   */
+  class Filter : public AudioFilter
+  {
+    public:
+      Filter(const string& spec, Backend backend)
+        : AudioFilter(spec, INTERNAL_SAMPLE_RATE, backend) {}
+      using AudioFilter::processSamples;
+  };
+
+  const size_t    BLOCK_SIZE  = 256;
+  const unsigned  RUN_TIME    = 60;
+
+    // The largest allowed difference to the fidlib output, in dB relative
+    // to the level of the fidlib output
+  const double    MAX_ERROR   = -100.0;
+
+  double run(Filter& filter, const vector<float>& in, vector<float>& out,
+             size_t block_size)
+  {
+    auto start = chrono::steady_clock::now();
+    for (size_t pos=0; pos<in.size(); pos+=block_size)
+    {
+      const size_t cnt = min(in.size() - pos, block_size);
+      filter.processSamples(&out[pos], &in[pos], cnt);
+    }
+    chrono::duration<double> dur = chrono::steady_clock::now() - start;
+    return in.size() / dur.count() / 1.0e6;
+  }
+
+  bool bench(const string& spec, const vector<float>& in)
+  {
+    vector<float> fid_out(in.size());
+    vector<float> bq_out(in.size());
+    vector<float> odd_out(in.size());
+
+    Filter fid(spec, AudioFilter::BACKEND_FIDLIB);
+    Filter bq(spec, AudioFilter::BACKEND_BIQUAD);
+    if (bq.backend() != AudioFilter::BACKEND_BIQUAD)
+    {
+      cout << "*** ERROR: Could not convert \"" << spec
+           << "\" to biquad sections\n";
+      return false;
+    }
+    const double fid_rate = run(fid, in, fid_out, BLOCK_SIZE);
+    const double bq_rate = run(bq, in, bq_out, BLOCK_SIZE);
+
+    double sum_sq = 0.0;
+    double sum_sq_err = 0.0;
+    double max_err = 0.0;
+    for (size_t i=0; i<in.size(); ++i)
+    {
+      const double err = bq_out[i] - fid_out[i];
+      sum_sq += static_cast<double>(fid_out[i]) * fid_out[i];
+      sum_sq_err += err * err;
+      max_err = max(max_err, fabs(err));
+    }
+    const double rms = sqrt(sum_sq / in.size());
+    const double err_db = 10.0 * log10(max(sum_sq_err, 1.0e-30) / sum_sq);
+    const double max_err_db = 20.0 * log10(max(max_err, 1.0e-15) / rms);
+
+    bool block_ok = true;
+    const size_t odd_sizes[] = { 1, 7, 37, 1000 };
+    for (size_t block_size : odd_sizes)
+    {
+      bq.reset();
+      run(bq, in, odd_out, block_size);
+      block_ok &= equal(odd_out.begin(), odd_out.end(), bq_out.begin());
+    }
+
+    cout << setw(36) << left << spec
+         << setw(8) << right << fixed << setprecision(1) << fid_rate
+         << setw(8) << bq_rate
+         << setw(10) << err_db
+         << setw(10) << max_err_db
+         << setw(8) << (block_ok ? "yes" : "NO")
+         << endl;
+
+    return block_ok && (max_err_db < MAX_ERROR);
+  }
+};
+
+
+int main(int argc, const char **argv)
+{
+  mt19937 rng(4711);
+  normal_distribution<float> dist(0.0f, 0.3f);
+  vector<float> in(RUN_TIME * INTERNAL_SAMPLE_RATE);
+  for (size_t i=0; i<in.size(); ++i)
+  {
+    in[i] = dist(rng);
+  }
+
+  const vector<string> specs = {
+    "BpCh12/-0.1/300-3500",
+    "BpCh12/-0.1/300-5000",
+    "LpCh9/-0.05/3500",
+    "LpCh9/-0.05/5500 x HpCh12/-0.05/300",
+    "LpCh10/-0.5/4500",
+    "LpBu20/3500",
+    "LpBu3/5500 x HpBu1/3000",
+    "HpBu4/3500",
+    "BpBu4/5000-5500",
+    "BpBu8/5400-6500",
+    "HsBq1/0.05/-36/3500",
+  };
+
+  cout << "Throughput in million samples per second, difference in dB "
+          "relative to the\nfidlib output level\n";
+  cout << setw(36) << left << "Filter"
+       << setw(8) << right << "fidlib"
+       << setw(8) << "biquad"
+       << setw(10) << "RMS diff"
+       << setw(10) << "Max diff"
+       << setw(8) << "Blocks" << endl;
+  bool ok = true;
+  for (const auto& spec : specs)
+  {
+    ok &= bench(spec, in);
+  }
+  if (!ok)
+  {
+    cout << "*** ERROR: The biquad backend differ too much from fidlib\n";
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,283 @@
+/**
+@file	 AudioFsfBench.cpp
+@brief   Benchmark and verify the frequency sampling filter
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+This program run white noise through a couple of frequency sampling filters,
+among them the bandpass filter from the AsyncAudioFsf_demo program and the
+filter used for the out of band AFSK channel. The output of Async::AudioFsf,
+which update all resonators at once, is compared sample by sample to a
+straightforward implementation where each resonator is a separate object that
+is updated one at a time. The number of samples that are not bit exact and
+the largest deviation are printed together with the throughput of both
+implementations.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include <AsyncAudioFsf.h>
+
+using namespace std;
+using namespace Async;
+
+
+namespace {
+  const unsigned SAMPLE_RATE  = INTERNAL_SAMPLE_RATE;
+  const size_t   BLOCK_SIZE   = 256;
+  const unsigned RUN_TIME     = 60;
+
+  struct TestCase
+  {
+    const char*     name;
+    size_t          N;
+    vector<float>   coeff;
+  };
+
+  /**
+   * The frequency sampling filter with one object per resonator, used to
+   * verify the AudioFsf class and to compare the throughput
+   */
+  class Reference
+  {
+    public:
+      Reference(size_t N, const float *coeff, float r=0.99999)
+        : combN(N, r), comb2(2, r)
+      {
+        for (size_t k=0; k<=N/2; ++k)
+        {
+          if (coeff[k] > 0.0f)
+          {
+            resonators.push_back(new Resonator(N, k, r, coeff[k]));
+          }
+        }
+      }
+
+      ~Reference(void)
+      {
+        for (size_t i=0; i<resonators.size(); ++i)
+        {
+          delete resonators[i];
+        }
+      }
+
+      void process(float *dest, const float *src, int count)
+      {
+        for (int i=0; i<count; ++i)
+        {
+          float destN = combN.processSample(src[i]);
+          float dest2 = comb2.processSample(destN);
+          dest[i] = 0.0f;
+          for (size_t j=0; j<resonators.size(); ++j)
+          {
+            dest[i] += resonators[j]->processSample(dest2);
+          }
+        }
+      }
+
+    private:
+      class CombFilter
+      {
+        public:
+          CombFilter(size_t N, float r)
+            : N(N), r_fact(-pow(r, N)), delay(N, 0.0f), pos(0) {}
+
+          float processSample(const float& src)
+          {
+            float dest = src + delay[pos] * r_fact;
+            delay[pos] = src;
+            pos = (pos == N-1) ? 0 : pos + 1;
+            return dest;
+          }
+
+        private:
+          const size_t  N;
+          const float   r_fact;
+          vector<float> delay;
+          size_t        pos;
+      };
+
+      class Resonator
+      {
+        public:
+          Resonator(size_t N, size_t k, float r, float H)
+            : gain(H), coeff1(2.0*r*cos(2.0*M_PI*k/N)), coeff2(-r*r),
+              z1(0.0), z2(0.0)
+          {
+            gain /= N;
+            if ((k == 0) || (k == N/2))
+            {
+              gain /= 2.0;
+            }
+            if (k % 2 == 1)
+            {
+              gain = -gain;
+            }
+          }
+
+          float processSample(const float& src)
+          {
+            float dest = src + z1*coeff1 + z2*coeff2;
+            z2 = z1;
+            z1 = dest;
+            return dest * gain;
+          }
+
+        private:
+          float       gain;
+          const float coeff1;
+          const float coeff2;
+          float       z1;
+          float       z2;
+      };
+
+      CombFilter          combN;
+      CombFilter          comb2;
+      vector<Resonator*>  resonators;
+  };
+
+  template <typename Func>
+  double measure(Func f, size_t sample_cnt)
+  {
+    auto start = chrono::steady_clock::now();
+    f();
+    chrono::duration<double> dur = chrono::steady_clock::now() - start;
+    return sample_cnt / dur.count() / 1.0e6;
+  }
+
+  bool runTest(const TestCase& tc, const vector<float>& input)
+  {
+    const size_t len = input.size();
+    vector<float> ref_out(len);
+    vector<float> fsf_out(len);
+
+    Reference ref(tc.N, tc.coeff.data());
+    double ref_rate = measure([&]()
+      {
+        for (size_t pos=0; pos<len; pos+=BLOCK_SIZE)
+        {
+          ref.process(&ref_out[pos], &input[pos], min(BLOCK_SIZE, len - pos));
+        }
+      }, len);
+
+    AudioFsf fsf(tc.N, tc.coeff.data());
+    double fsf_rate = measure([&]()
+      {
+        for (size_t pos=0; pos<len; pos+=BLOCK_SIZE)
+        {
+          fsf.processBlock(&fsf_out[pos], &input[pos],
+                           min(BLOCK_SIZE, len - pos));
+        }
+      }, len);
+
+    size_t diff_cnt = 0;
+    float max_diff = 0.0f;
+    for (size_t i=0; i<len; ++i)
+    {
+      if (fsf_out[i] != ref_out[i])
+      {
+        ++diff_cnt;
+        max_diff = max(max_diff, fabsf(fsf_out[i] - ref_out[i]));
+      }
+    }
+
+    const size_t res_cnt = count_if(tc.coeff.begin(), tc.coeff.end(),
+                                    [](float H) { return H > 0.0f; });
+    cout << setw(20) << left << tc.name
+         << setw(6) << right << res_cnt
+         << setw(12) << fixed << setprecision(1) << ref_rate
+         << setw(10) << fsf_rate
+         << setw(9) << setprecision(1) << (fsf_rate / ref_rate) << "x"
+         << setw(10) << diff_cnt
+         << setw(12) << scientific << setprecision(1) << max_diff
+         << endl;
+    return max_diff < 1.0e-6f;
+  }
+
+  TestCase makeTestCase(const char *name, size_t N, size_t first,
+                        size_t last, float transition)
+  {
+    TestCase tc = { name, N, vector<float>(N/2+1, 0.0f) };
+    for (size_t k=first; k<=last; ++k)
+    {
+      tc.coeff[k] = 1.0f;
+    }
+    if (first > 0)
+    {
+      tc.coeff[first-1] = transition;
+    }
+    if (last < N/2)
+    {
+      tc.coeff[last+1] = transition;
+    }
+    return tc;
+  }
+};
+
+
+int main(int argc, const char **argv)
+{
+  mt19937 rng(4711);
+  normal_distribution<float> dist(0.0f, 0.3f);
+  vector<float> input(RUN_TIME * SAMPLE_RATE);
+  for (size_t i=0; i<input.size(); ++i)
+  {
+    input[i] = dist(rng);
+  }
+
+  const float T = 0.39811024f;
+  const vector<TestCase> tests = {
+      // The filter in AsyncAudioFsf_demo.cpp
+    makeTestCase("Demo 1000Hz BP", 128, 7, 9, T),
+      // The out of band AFSK filter in LocalRxBase.cpp
+    makeTestCase("AFSK 5500Hz BP", 128, 43, 45, T),
+    makeTestCase("300-3000Hz BP", 128, 3, 24, T),
+    makeTestCase("2000Hz LP", 64, 0, 8, T),
+  };
+
+  cout << "Throughput in million samples per second\n";
+  cout << setw(20) << left << "Filter"
+       << setw(6) << right << "Res"
+       << setw(12) << "Reference"
+       << setw(10) << "AudioFsf"
+       << setw(10) << "Speedup"
+       << setw(10) << "Not exact"
+       << setw(12) << "Max diff" << endl;
+  bool ok = true;
+  for (const auto& tc : tests)
+  {
+    ok &= runTest(tc, input);
+  }
+  if (!ok)
+  {
+    cout << "*** ERROR: The output differ from the reference\n";
+    return 1;
+  }
+
+  return 0;
+}
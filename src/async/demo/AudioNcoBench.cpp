@@ -0,0 +1,200 @@
+/**
+@file	 AudioNcoBench.cpp
+@brief   Benchmark and verify the numerically controlled oscillator
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+This program generate a couple of single tones and DTMF tone pairs using the
+Async::AudioNco class and compare the output to a sine wave calculated in
+double precision. The sink is simulated to accept a random number of samples
+in each block so that the seek function is exercised in the same way as when
+the tone generators handle partial writes. The largest deviation, relative to
+the peak amplitude, is printed in dBc. Since all spurious tones are part of
+the deviation, it is an upper bound for the level of any spurious tone. The
+reference is calculated using the frequency that the 32 bit phase accumulator
+actually produce. That frequency error is printed separately.
+The throughput is compared to the previous per sample sin() implementation.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+#include <AsyncAudioNco.h>
+
+using namespace std;
+using namespace Async;
+
+
+namespace {
+  const unsigned SAMPLE_RATE = INTERNAL_SAMPLE_RATE;
+  const size_t   BLOCK_SIZE = 160;
+
+  struct TestCase
+  {
+    const char*     name;
+    vector<double>  fqs;
+    float           amp;
+  };
+
+  template <typename Func>
+  double measure(Func f, size_t sample_cnt)
+  {
+    auto start = chrono::steady_clock::now();
+    f();
+    chrono::duration<double> dur = chrono::steady_clock::now() - start;
+    return sample_cnt / dur.count() / 1.0e6;
+  }
+
+    // The frequency actually generated by a 32 bit phase accumulator
+  double ncoFq(double fq)
+  {
+    const double scale = 4294967296.0;
+    return llround(fq / SAMPLE_RATE * scale) / scale * SAMPLE_RATE;
+  }
+
+  double reference(const TestCase& tc, unsigned long pos)
+  {
+    double sum = 0.0;
+    for (double tone_fq : tc.fqs)
+    {
+      double fq = ncoFq(tone_fq);
+        // Reduce the phase exactly before multiplying by 2*pi
+      double cycles = fq * pos / SAMPLE_RATE;
+      sum += tc.amp * sin(2.0 * M_PI * (cycles - floor(cycles)));
+    }
+    return sum;
+  }
+
+  bool runTest(const TestCase& tc, float *sink)
+  {
+      // Verify one minute of audio
+    const unsigned long verify_cnt = 60UL * SAMPLE_RATE;
+    AudioNco nco(SAMPLE_RATE);
+    for (double fq : tc.fqs)
+    {
+      nco.addTone(fq, tc.amp);
+    }
+    mt19937 rng(4711);
+    uniform_int_distribution<size_t> accept_dist(0, BLOCK_SIZE);
+    float buf[BLOCK_SIZE];
+    double max_err = 0.0;
+    unsigned long pos = 0;
+    while (pos < verify_cnt)
+    {
+      nco.generate(buf, BLOCK_SIZE);
+      size_t accepted = accept_dist(rng);
+      for (size_t i=0; i<accepted; ++i)
+      {
+        max_err = max(max_err, fabs(buf[i] - reference(tc, pos + i)));
+      }
+      nco.seek(static_cast<long>(accepted) - static_cast<long>(BLOCK_SIZE));
+      pos += accepted;
+    }
+    double peak = tc.amp * tc.fqs.size();
+    double err_dbc = 20.0 * log10(max_err / peak);
+    double fq_err = 0.0;
+    for (double fq : tc.fqs)
+    {
+      fq_err = max(fq_err, fabs(ncoFq(fq) - fq));
+    }
+
+      // Measure the throughput of the NCO
+    const unsigned long bench_cnt = 600UL * SAMPLE_RATE;
+    nco.reset();
+    double nco_rate = measure([&]()
+      {
+        for (unsigned long i=0; i<bench_cnt; i+=BLOCK_SIZE)
+        {
+          nco.generate(sink, BLOCK_SIZE);
+          sink[0] += sink[BLOCK_SIZE - 1];
+        }
+      }, bench_cnt);
+
+      // Measure the throughput of calling sin() for each sample
+    double sin_rate = measure([&]()
+      {
+        for (unsigned long i=0; i<bench_cnt; i+=BLOCK_SIZE)
+        {
+          for (size_t j=0; j<BLOCK_SIZE; ++j)
+          {
+            float sum = 0.0f;
+            for (double fq : tc.fqs)
+            {
+              sum += tc.amp * sin(2 * M_PI * fq * (i + j) / SAMPLE_RATE);
+            }
+            sink[j] = sum;
+          }
+          sink[0] += sink[BLOCK_SIZE - 1];
+        }
+      }, bench_cnt);
+
+    cout << setw(18) << left << tc.name
+         << setw(10) << right << fixed << setprecision(1) << sin_rate
+         << setw(10) << nco_rate
+         << setw(10) << setprecision(1) << (nco_rate / sin_rate) << "x"
+         << setw(12) << setprecision(1) << err_dbc
+         << setw(12) << setprecision(2) << (fq_err * 1.0e6) << endl;
+    return err_dbc < -100.0;
+  }
+};
+
+
+int main(int argc, const char **argv)
+{
+  cout << "Throughput in million samples per second, "
+          "largest deviation in dBc, "
+          "frequency error in micro Hz\n";
+  cout << setw(18) << left << "Tone"
+       << setw(10) << right << "sin()"
+       << setw(10) << "AudioNco"
+       << setw(11) << "Speedup"
+       << setw(12) << "Error"
+       << setw(12) << "Fq err" << endl;
+
+  const vector<TestCase> tests = {
+    {"CTCSS 88.5 Hz",   {88.5},         0.5f},
+    {"1 kHz",           {1000.0},       1.0f},
+    {"1750 Hz",         {1750.0},       1.0f},
+    {"2937 Hz",         {2937.0},       1.0f},
+    {"DTMF 1",          {697, 1209},    0.5f},
+    {"DTMF D",          {941, 1633},    0.5f},
+  };
+
+  vector<float> sink(BLOCK_SIZE);
+  bool ok = true;
+  for (const auto& tc : tests)
+  {
+    ok &= runTest(tc, sink.data());
+  }
+  if (!ok)
+  {
+    cout << "*** ERROR: The output differ too much from the reference\n";
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,207 @@
+/**
+@file	 AfskCorrelatorDemodulator.cpp
+@brief   An AFSK demodulator using quadrature correlators
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AfskCorrelatorDemodulator.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AfskCorrelatorDemodulator::AfskCorrelatorDemodulator(unsigned f0, unsigned f1,
+                                                     unsigned baudrate,
+                                                     unsigned sample_rate)
+  : taps((sample_rate + baudrate / 2) / baudrate)
+{
+    // The reference signals for the correlators. Index 0 and 1 is the
+    // cosine and sine for the lower frequency and index 2 and 3 is the
+    // same for the upper frequency.
+  const unsigned fq[2] = { f0, f1 };
+  for (int f=0; f<2; ++f)
+  {
+    coeff[2*f].resize(taps);
+    coeff[2*f+1].resize(taps);
+    for (unsigned k=0; k<taps; ++k)
+    {
+      const double w = 2.0 * M_PI * fq[f] * k / sample_rate;
+      coeff[2*f][k] = cos(w);
+      coeff[2*f+1][k] = sin(w);
+    }
+  }
+
+    // The buffer start with the samples from the previous block that are
+    // needed to calculate the correlation for the first samples in a block
+  buf.assign(taps - 1, 0.0f);
+} /* AfskCorrelatorDemodulator::AfskCorrelatorDemodulator */
+
+
+AfskCorrelatorDemodulator::~AfskCorrelatorDemodulator(void)
+{
+} /* AfskCorrelatorDemodulator::~AfskCorrelatorDemodulator */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+void AfskCorrelatorDemodulator::processSamples(float *dest, const float *src,
+                                               int count)
+{
+  const unsigned hist = taps - 1;
+  buf.resize(hist + count);
+  memcpy(&buf[hist], src, count * sizeof(*src));
+
+    // The samples are processed in chunks that are small enough for the
+    // accumulators to stay in the cache. For each tap, the innermost loop
+    // run over the samples in the chunk which is what make it vectorizable.
+  for (int pos=0; pos<count; pos+=CHUNK_SIZE)
+  {
+    const int len = min<int>(+CHUNK_SIZE, count - pos);
+    float i0[CHUNK_SIZE], q0[CHUNK_SIZE], i1[CHUNK_SIZE], q1[CHUNK_SIZE];
+    for (int i=0; i<len; ++i)
+    {
+      i0[i] = q0[i] = i1[i] = q1[i] = 0.0f;
+    }
+    for (unsigned k=0; k<taps; ++k)
+    {
+      const float *x = &buf[pos + hist - k];
+      const float c0 = coeff[0][k];
+      const float s0 = coeff[1][k];
+      const float c1 = coeff[2][k];
+      const float s1 = coeff[3][k];
+      for (int i=0; i<len; ++i)
+      {
+        i0[i] += c0 * x[i];
+        q0[i] += s0 * x[i];
+        i1[i] += c1 * x[i];
+        q1[i] += s1 * x[i];
+      }
+    }
+    for (int i=0; i<len; ++i)
+    {
+      const float e0 = i0[i] * i0[i] + q0[i] * q0[i];
+      const float e1 = i1[i] * i1[i] + q1[i] * q1[i];
+      dest[pos + i] = (e1 - e0) / (e1 + e0 + 1.0e-12f);
+    }
+  }
+
+  memmove(&buf[0], &buf[count], hist * sizeof(float));
+  buf.resize(hist);
+} /* AfskCorrelatorDemodulator::processSamples */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
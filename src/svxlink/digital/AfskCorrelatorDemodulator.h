@@ -0,0 +1,177 @@
+/**
+@file	 AfskCorrelatorDemodulator.h
+@brief   An AFSK demodulator using quadrature correlators
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef AFSK_CORRELATOR_DEMODULATOR_INCLUDED
+#define AFSK_CORRELATOR_DEMODULATOR_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioProcessor.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	An AFSK demodulator using quadrature correlators
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-19
+
+This class is an alternative to the AfskDemodulator class. The output is, in
+the same way, a sample stream of high and low values corresponding to the high
+and low AFSK frequencies that is to be fed into a Synchronizer.
+
+The incoming signal is correlated with a cosine and a sine at each of the two
+AFSK frequencies over one symbol period, an integrate-and-dump detector. The
+sum of the squared in-phase and quadrature correlations is the energy of each
+frequency during the last symbol, independent of the phase of the received
+tone. The output is the difference between the energy of the upper and lower
+frequencies divided by the total energy so it does not depend on the signal
+level.
+
+The correlation is calculated for every sample so the integrate-and-dump
+result is available at every phase offset within a symbol. The Synchronizer
+choose the phase offset to slice at and a SlicerBank can be used to slice at a
+couple of phase offsets in parallel. The correlators are implemented as four
+FIR filters, one for each of the reference signals, that are run over a block
+of samples at a time so that the compiler can vectorize them.
+*/
+class AfskCorrelatorDemodulator : public Async::AudioProcessor
+{
+  public:
+    /**
+     * @brief 	Constuctor
+     * @param   f0          Lower audio frequency
+     * @param   f1          Upper audio frequency
+     * @param   baudrate    The baudrate of the datastream
+     * @param   sample_rate The sample rate of the audio stream
+     */
+    AfskCorrelatorDemodulator(unsigned f0, unsigned f1, unsigned baudrate,
+                              unsigned sample_rate=INTERNAL_SAMPLE_RATE);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AfskCorrelatorDemodulator(void);
+
+  protected:
+    /**
+     * @brief Process incoming samples and put them into the output buffer
+     * @param dest  Destination buffer
+     * @param src   Source buffer
+     * @param count Number of samples in the source buffer
+     */
+    virtual void processSamples(float *dest, const float *src, int count);
+
+  private:
+    static const int CHUNK_SIZE = 64;
+
+    std::vector<float>  coeff[4];
+    std::vector<float>  buf;
+    unsigned            taps;
+
+    AfskCorrelatorDemodulator(const AfskCorrelatorDemodulator&);
+    AfskCorrelatorDemodulator& operator=(const AfskCorrelatorDemodulator&);
+
+};  /* class AfskCorrelatorDemodulator */
+
+
+//} /* namespace */
+
+#endif /* AFSK_CORRELATOR_DEMODULATOR_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -151,7 +151,7 @@ namespace {
  *
  ****************************************************************************/
 
-uint16_t fcsCalc(const std::vector<uint8_t> buf)
+uint16_t fcsCalc(const std::vector<uint8_t> &buf)
 {
   uint16_t fcs = PPPINITFCS;
   fcs = pppfcs(fcs, buf.data(), buf.size());
@@ -160,10 +160,16 @@ uint16_t fcsCalc(const std::vector<uint8_t> buf)
 } /* fcsCalc */
 
 
-bool fcsOk(const std::vector<uint8_t> buf)
+bool fcsOk(const std::vector<uint8_t> &buf)
+{
+  return fcsOk(buf.data(), buf.size());
+} /* fcsOk */
+
+
+bool fcsOk(const uint8_t *buf, size_t len)
 {
   uint16_t fcs = PPPINITFCS;
-  fcs = pppfcs(fcs, buf.data(), buf.size());
+  fcs = pppfcs(fcs, buf, len);
   return (fcs == PPPGOODFCS);
 } /* fcsOk */
 
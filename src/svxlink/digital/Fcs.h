@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <stdint.h>
+#include <cstddef>
 #include <vector>
 
 
@@ -107,14 +108,22 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  * @param   buf The buffer containing the data bytes
  * @return  Return the 16 bit frame check sequence
  */
-uint16_t fcsCalc(const std::vector<uint8_t> buf);
+uint16_t fcsCalc(const std::vector<uint8_t> &buf);
 
 /**
  * @brief   Check if the buffer contain a valid data stream
  * @param   buf The buffer containing the data bytes and the transmitted FCS
  * @return  Returns \em true on success or \em false on failure
  * */
-bool fcsOk(const std::vector<uint8_t> buf);
+bool fcsOk(const std::vector<uint8_t> &buf);
+
+/**
+ * @brief   Check if the buffer contain a valid data stream
+ * @param   buf The buffer containing the data bytes and the transmitted FCS
+ * @param   len The number of bytes in the buffer
+ * @return  Returns \em true on success or \em false on failure
+ * */
+bool fcsOk(const uint8_t *buf, size_t len);
 
 
 //} /* namespace */
@@ -75,6 +75,76 @@ using namespace std;
  *
  ****************************************************************************/
 
+namespace {
+  /*
+   * The result of destuffing one received byte. The remaining data bits are
+   * stored in the low bits of the bits member. A bit set in the flags member
+   * mark that the data bit at that position completed a flag. The ones
+   * member is the number of consecutive ones at the end of the byte.
+   */
+  struct Destuffed
+  {
+    uint8_t bits;
+    uint8_t bit_cnt;
+    uint8_t flags;
+    uint8_t ones;
+  };
+
+  /*
+   * Lookup table indexed by the number of consecutive ones received before
+   * a byte and the byte itself. More than six ones is an abort sequence so
+   * the count saturate at seven since it does not matter how long it is.
+   */
+  class DestuffTable
+  {
+    public:
+      DestuffTable(void)
+      {
+        for (unsigned ones_in=0; ones_in<8; ++ones_in)
+        {
+          for (unsigned byte=0; byte<256; ++byte)
+          {
+            Destuffed &d = tab[ones_in][byte];
+            unsigned ones = ones_in;
+            d.bits = d.bit_cnt = d.flags = 0;
+            for (unsigned bit=0; bit<8; ++bit)
+            {
+              if (byte & (1 << bit))
+              {
+                d.bits |= 1 << d.bit_cnt;
+                ones = (ones < 7) ? ones + 1 : 7;
+              }
+              else if (ones == 5)
+              {
+                  // A stuffed zero. Throw it away.
+                ones = 0;
+                continue;
+              }
+              else
+              {
+                if (ones == 6)
+                {
+                  d.flags |= 1 << d.bit_cnt;
+                }
+                ones = 0;
+              }
+              d.bit_cnt += 1;
+            }
+            d.ones = ones;
+          }
+        }
+      }
+
+      const Destuffed& lookup(unsigned ones, uint8_t byte) const
+      {
+        return tab[ones][byte];
+      }
+
+    private:
+      Destuffed tab[8][256];
+  };
+};
+
 
 
 /****************************************************************************
@@ -99,6 +169,10 @@ using namespace std;
  *
  ****************************************************************************/
 
+namespace {
+  const DestuffTable destuff_tab;
+};
+
 
 
 /****************************************************************************
@@ -108,7 +182,7 @@ using namespace std;
  ****************************************************************************/
 
 HdlcDeframer::HdlcDeframer(void)
-  : state(STATE_SYNCHRONIZING), next_byte(0), bit_cnt(0), ones(0)
+  : state(STATE_SYNCHRONIZING), next_bits(0), bit_cnt(0), ones(0)
 {
 } /* HdlcDeframer::HdlcDeframer */
 
@@ -118,114 +192,31 @@ HdlcDeframer::~HdlcDeframer(void)
 } /* HdlcDeframer::~HdlcDeframer */
 
 
-void HdlcDeframer::bitsReceived(vector<bool> &bits)
+void HdlcDeframer::bitsReceived(const vector<uint8_t> &bits)
 {
   for (size_t i=0; i<bits.size(); ++i)
   {
-    bool flag_detected = false;
-
-      // Undo bitstuffing. If we receive a zero and the previous five bits
-      // have been ones, the zero should be thrown away.
-    if (bits[i])
-    {
-      ones += 1;
-    }
-    else
+      // Undo bitstuffing and find flags for a whole byte at a time
+    const Destuffed &d = destuff_tab.lookup(ones, bits[i]);
+    ones = d.ones;
+
+    unsigned data = d.bits;
+    unsigned data_cnt = d.bit_cnt;
+    unsigned flags = d.flags;
+    while (flags != 0)
     {
-      if (ones == 5)
-      {
-        ones = 0;
-        continue;
-      }
-      else if (ones == 6)
+      unsigned flag_pos = 0;
+      while ((flags & (1 << flag_pos)) == 0)
       {
-        flag_detected = true;
+        ++flag_pos;
       }
-      ones = 0;
-    }
-
-    next_byte >>= 1;
-    next_byte |= (bits[i] << 7);
-    switch (state)
-    {
-      case STATE_SYNCHRONIZING:
-        if (next_byte == 0x7e)
-        {
-          state = STATE_FRAME_START_WAIT;
-          bit_cnt = 0;
-        }
-        break;
-
-      case STATE_FRAME_START_WAIT:
-        if (++bit_cnt >= 8)
-        {
-          if (next_byte != 0x7e)
-          {
-            state = STATE_RECEIVING;
-            frame.clear();
-            frame.push_back(next_byte);
-          }
-          //frame.push_back(next_byte);
-          bit_cnt = 0;
-        }
-        else if (next_byte == 0x7e)
-        {
-          bit_cnt = 0;
-          //frame.clear();
-          //frame.push_back(next_byte);
-        }
-        break;
-
-      case STATE_RECEIVING:
-        if (++bit_cnt >= 8)
-        {
-          if (flag_detected)
-          {
-            state = STATE_FRAME_START_WAIT;
-            /*
-            for (size_t i=0; i<frame.size(); ++i)
-            {
-              if (isprint(frame[i]))
-              {
-                cout << setw(2) << setfill(' ') << (char)frame[i];
-              }
-              else
-              {
-                cout << hex << setw(2) << setfill('0')
-                     << (int)frame[i] << " ";
-              }
-            }
-            cout << endl << endl;
-            */
-            if ((frame.size() > 2) && fcsOk(frame))
-            {
-                // Remove CRC from frame
-              frame.pop_back();
-              frame.pop_back();
-              frameReceived(frame);
-            }
-          }
-          else
-          {
-            if(frame.size() < 330)
-            {
-              frame.push_back(next_byte);
-              next_byte = 0;
-            }
-            else
-            {
-              state = STATE_SYNCHRONIZING;
-            }
-          }
-          bit_cnt = 0;
-        }
-        else if (flag_detected)
-        {
-          state = STATE_FRAME_START_WAIT;
-          bit_cnt = 0;
-        }
-        break;
+      addBits(data & ((1 << flag_pos) - 1), flag_pos);
+      flagReceived();
+      data >>= flag_pos + 1;
+      flags >>= flag_pos + 1;
+      data_cnt -= flag_pos + 1;
     }
+    addBits(data, data_cnt);
   }
 } /* HdlcDeframer::bitsReceived */
 
@@ -244,6 +235,65 @@ void HdlcDeframer::bitsReceived(vector<bool> &bits)
  *
  ****************************************************************************/
 
+void HdlcDeframer::addBits(unsigned bits, unsigned cnt)
+{
+  next_bits |= bits << bit_cnt;
+  bit_cnt += cnt;
+  while (bit_cnt >= 8)
+  {
+    byteReceived(next_bits & 0xff);
+    next_bits >>= 8;
+    bit_cnt -= 8;
+  }
+} /* HdlcDeframer::addBits */
+
+
+void HdlcDeframer::byteReceived(uint8_t byte)
+{
+  switch (state)
+  {
+    case STATE_SYNCHRONIZING:
+      break;
+
+    case STATE_FRAME_START_WAIT:
+        // A flag never complete a byte since it reset the bit count so a
+        // 0x7e byte here is a bit stuffed data byte
+      state = STATE_RECEIVING;
+      frame.clear();
+      frame.push_back(byte);
+      break;
+
+    case STATE_RECEIVING:
+      if (frame.size() < MAX_FRAME_SIZE)
+      {
+        frame.push_back(byte);
+      }
+      else
+      {
+        state = STATE_SYNCHRONIZING;
+      }
+      break;
+  }
+} /* HdlcDeframer::byteReceived */
+
+
+void HdlcDeframer::flagReceived(void)
+{
+    // The first seven bits of the flag have been added as data bits. If they
+    // are all that is left, the frame ended on a byte boundary.
+  if ((state == STATE_RECEIVING) && (bit_cnt == 7) &&
+      (frame.size() > 2) && fcsOk(frame))
+  {
+      // Remove CRC from frame
+    frame.pop_back();
+    frame.pop_back();
+    frameReceived(frame);
+  }
+  state = STATE_FRAME_START_WAIT;
+  next_bits = 0;
+  bit_cnt = 0;
+} /* HdlcDeframer::flagReceived */
+
 
 
 /*
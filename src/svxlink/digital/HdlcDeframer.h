@@ -112,6 +112,11 @@ bitstream. An HDLC frame will start and end with one or more flag bytes,
 01111110. The content must be one or more data bytes followed by two CRC bytes
 (Frame Check Sequence). The deframed data bytes will be emitted without the CRC
 bytes.
+
+The bitstream is processed a byte at a time. A lookup table, indexed by the
+number of consecutive ones received so far and the incoming byte, give the
+bits that remain after bit destuffing and the positions of any flags in the
+byte so that no per bit processing is needed.
 */
 class HdlcDeframer : public sigc::trackable
 {
@@ -128,9 +133,12 @@ class HdlcDeframer : public sigc::trackable
 
     /**
      * @brief 	Process bitstream
-     * @param 	bits The bitstream to process
+     * @param 	bits The NRZI decoded bitstream, packed eight bits per byte
+     *
+     * The first received bit should be stored in the least significant bit
+     * of each byte.
      */
-    void bitsReceived(std::vector<bool> &bits);
+    void bitsReceived(const std::vector<uint8_t> &bits);
 
     /**
      * @brief 	Signal that is emitted when a complete frame have been received
@@ -143,14 +151,19 @@ class HdlcDeframer : public sigc::trackable
       STATE_SYNCHRONIZING, STATE_FRAME_START_WAIT, STATE_RECEIVING
     } State;
 
+    static const size_t MAX_FRAME_SIZE = 330;
+
     State                 state;
-    uint8_t               next_byte;
-    uint8_t               bit_cnt;
+    unsigned              next_bits;
+    unsigned              bit_cnt;
     std::vector<uint8_t>  frame;
     unsigned              ones;
 
     HdlcDeframer(const HdlcDeframer&);
     HdlcDeframer& operator=(const HdlcDeframer&);
+    void addBits(unsigned bits, unsigned cnt);
+    void byteReceived(uint8_t byte);
+    void flagReceived(void);
 
 };  /* class HdlcDeframer */
 
@@ -0,0 +1,225 @@
+/**
+@file   SlicerBank.cpp
+@brief  Decode HDLC frames using a number of phase offset slicers
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-19
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "SlicerBank.h"
+#include "Synchronizer.h"
+#include "HdlcDeframer.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+SlicerBank::SlicerBank(unsigned baudrate, unsigned slicer_cnt,
+                       unsigned sample_rate)
+  : baudrate(baudrate), sample_rate(sample_rate), sample_cnt(0)
+{
+  if (slicer_cnt < 1)
+  {
+    slicer_cnt = 1;
+  }
+  else if (slicer_cnt > MAX_SLICERS)
+  {
+    slicer_cnt = MAX_SLICERS;
+  }
+  for (unsigned i=0; i<slicer_cnt; ++i)
+  {
+      // Slicer 0 sample at the symbol center, odd slicers after the center
+      // and even slicers before it
+    float offset = ((i + 1) / 2) * SLICER_SPACING;
+    if (i % 2 == 0)
+    {
+      offset = -offset;
+    }
+    offset = min(max(offset, -0.5f), 0.5f);
+
+    Synchronizer *sync = new Synchronizer(baudrate, sample_rate, offset);
+    HdlcDeframer *deframer = new HdlcDeframer;
+    sync->bitsReceived.connect(
+        mem_fun(*deframer, &HdlcDeframer::bitsReceived));
+    deframer->frameReceived.connect(
+        sigc::bind(mem_fun(*this, &SlicerBank::onFrameReceived), i));
+    syncs.push_back(sync);
+    deframers.push_back(deframer);
+  }
+} /* SlicerBank::SlicerBank */
+
+
+SlicerBank::~SlicerBank(void)
+{
+  for (size_t i=0; i<syncs.size(); ++i)
+  {
+    delete syncs[i];
+    delete deframers[i];
+  }
+} /* SlicerBank::~SlicerBank */
+
+
+int SlicerBank::writeSamples(const float *samples, int count)
+{
+    // Frames are time stamped with the end of the block since the
+    // synchronizers only emit bits once per block
+  sample_cnt += count;
+  while (!recent.empty() && (recent.front().expire <= sample_cnt))
+  {
+    recent.pop_front();
+  }
+
+  for (size_t i=0; i<syncs.size(); ++i)
+  {
+    syncs[i]->writeSamples(samples, count);
+  }
+
+  return count;
+} /* SlicerBank::writeSamples */
+
+
+void SlicerBank::flushSamples(void)
+{
+  sourceAllSamplesFlushed();
+} /* SlicerBank::flushSamples */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void SlicerBank::onFrameReceived(vector<uint8_t>& frame, unsigned slicer)
+{
+  const uint32_t slicer_bit = 1U << slicer;
+  for (deque<RecentFrame>::iterator it=recent.begin(); it!=recent.end(); ++it)
+  {
+    if (((it->slicers & slicer_bit) == 0) && (it->frame == frame))
+    {
+      it->slicers |= slicer_bit;
+      return;
+    }
+  }
+
+    // Remember the frame for half the time it take to transmit it,
+    // including the FCS and a flag. The other slicers will decode it within
+    // a byte or a block of samples, while a retransmission cannot end
+    // earlier than a whole frame later.
+  const uint64_t symbols = 4 * (frame.size() + 3);
+  RecentFrame recent_frame;
+  recent_frame.frame = frame;
+  recent_frame.expire = sample_cnt + symbols * sample_rate / baudrate;
+  recent_frame.slicers = slicer_bit;
+  recent.push_back(recent_frame);
+
+  frameReceived(frame);
+} /* SlicerBank::onFrameReceived */
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,204 @@
+/**
+@file   SlicerBank.h
+@brief  Decode HDLC frames using a number of phase offset slicers
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-19
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef SLICER_BANK_INCLUDED
+#define SLICER_BANK_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+#include <deque>
+#include <stdint.h>
+#include <sigc++/sigc++.h>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioSink.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+class Synchronizer;
+class HdlcDeframer;
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  Decode HDLC frames using a number of phase offset slicers
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-19
+
+This class take the output from an AFSK demodulator and feed it to a number
+of slicers, each one a Synchronizer and an HdlcDeframer. The synchronizers
+sample the symbols at different phase offsets from the symbol center. In
+noise the slicers will make different bit errors so a frame that one of them
+lose may still be decoded by another one.
+
+A frame is normally decoded by more than one slicer. A frame is not emitted
+again if the same frame has already been emitted by another slicer during
+half the time it takes to transmit the frame. A slicer that decode the same
+frame twice always cause it to be emitted twice, since that must be a
+retransmission.
+*/
+class SlicerBank : public Async::AudioSink, public sigc::trackable
+{
+  public:
+    /**
+     * @brief   The maximum number of slicers
+     */
+    static constexpr unsigned MAX_SLICERS = 32;
+
+    /**
+     * @brief   Constuctor
+     * @param   baudrate    The baudrate of the symbol stream
+     * @param   slicer_cnt  The number of slicers to use (1-32)
+     * @param   sample_rate The sample rate of the incoming samples
+     *
+     * The first slicer sample at the symbol center. The rest of them are
+     * spread out evenly on both sides of the center.
+     */
+    SlicerBank(unsigned baudrate, unsigned slicer_cnt,
+               unsigned sample_rate=INTERNAL_SAMPLE_RATE);
+
+    /**
+     * @brief   Destructor
+     */
+    ~SlicerBank(void);
+
+    /**
+     * @brief   Write samples into this audio sink
+     * @param   samples The buffer containing the samples
+     * @param   count The number of samples in the buffer
+     * @return  Returns the number of samples that has been taken care of
+     */
+    int writeSamples(const float *samples, int count);
+
+    /**
+     * @brief   Tell the sink to flush the previously written samples
+     */
+    void flushSamples(void);
+
+    /**
+     * @brief   Signal that is emitted when a complete frame have been received
+     * @param   frame The received frame bytes
+     */
+    sigc::signal<void(std::vector<uint8_t>&)> frameReceived;
+
+  private:
+    struct RecentFrame
+    {
+      std::vector<uint8_t>  frame;
+      uint64_t              expire;
+      uint32_t              slicers;
+    };
+
+      // The distance between the sampling points of the slicers, as a
+      // fraction of a symbol
+    static constexpr float    SLICER_SPACING = 0.15f;
+
+    const unsigned              baudrate;
+    const unsigned              sample_rate;
+    std::vector<Synchronizer*>  syncs;
+    std::vector<HdlcDeframer*>  deframers;
+    std::deque<RecentFrame>     recent;
+    uint64_t                    sample_cnt;
+
+    SlicerBank(const SlicerBank&);
+    SlicerBank& operator=(const SlicerBank&);
+    void onFrameReceived(std::vector<uint8_t>& frame, unsigned slicer);
+
+};  /* class SlicerBank */
+
+
+//} /* namespace */
+
+#endif /* SLICER_BANK_INCLUDED */
+
+
+/*
+ * This file has not been truncated
+ */
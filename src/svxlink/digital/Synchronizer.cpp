@@ -105,10 +105,12 @@ using namespace std;
  *
  ****************************************************************************/
 
-Synchronizer::Synchronizer(unsigned baudrate, unsigned sample_rate)
+Synchronizer::Synchronizer(unsigned baudrate, unsigned sample_rate,
+                           float phase_offset)
   : baudrate(baudrate), sample_rate(sample_rate),
-    shift_pos(sample_rate / 2), pos(0), was_mark(false),
-    last_stored_was_mark(false)
+    shift_pos(sample_rate / 2 - static_cast<int>(phase_offset * sample_rate)),
+    pos(0), marks(0), mark_cnt(0),
+    was_mark(false), last_stored_was_mark(false), err(0)
 {
 } /* Synchronizer::Synchronizer */
 
@@ -141,28 +143,32 @@ int Synchronizer::writeSamples(const float *samples, int len)
     }
     was_mark = is_mark;
 
-      // Extract bit if pos >= sample_rate
+      // Extract bit if pos >= sample_rate. The raw mark/space decisions are
+      // collected until there are eight of them and then the whole byte is
+      // NRZI decoded at once. A bit is a one if there is no transition from
+      // the previous bit.
     if (pos >= sample_rate)
     {
-      bitbuf.push_back(is_mark == last_stored_was_mark);
-      last_stored_was_mark = is_mark;
-      if (bitbuf.size() >= 8)
+      marks |= static_cast<unsigned>(is_mark) << mark_cnt;
+      if (++mark_cnt >= 8)
       {
-        /*
-        for (size_t i=0; i<bitbuf.size(); ++i)
-        {
-          cout << (bitbuf[i] ? '1' : '0');
-        }
-        float err_percent = 100.0 * static_cast<float>(err) / sample_rate;
-        cout << "  " << err << " " << err_percent << "%" << endl;
-        */
-        bitsReceived(bitbuf);
-        bitbuf.clear();
+        const unsigned prev_marks =
+          (marks << 1) | static_cast<unsigned>(last_stored_was_mark);
+        bitbuf.push_back(~(marks ^ prev_marks) & 0xff);
+        last_stored_was_mark = (marks & 0x80);
+        marks = 0;
+        mark_cnt = 0;
       }
       pos -= sample_rate;
     }
   }
 
+  if (!bitbuf.empty())
+  {
+    bitsReceived(bitbuf);
+    bitbuf.clear();
+  }
+
   return len;
 } /* Synchronizer::writeSamples */
 
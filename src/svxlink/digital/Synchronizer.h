@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <vector>
+#include <stdint.h>
 #include <sigc++/sigc++.h>
 
 
@@ -119,8 +120,17 @@ class Synchronizer : public Async::AudioSink, public sigc::trackable
      * @brief 	Constuctor
      * @param   baudrate    The baudrate of the symbol stream
      * @param   sample_rate The sample rate of the incoming samples
+     * @param   phase_offset Where to sample each symbol relative to the
+     *                       symbol center, as a fraction of a symbol
+     *
+     * A positive phase offset move the sampling point towards the end of
+     * the symbol. It should be within -0.5 to 0.5. Synchronizers with
+     * different phase offsets will make different bit errors in noise,
+     * which can be used to decode more frames by running a couple of them
+     * in parallel.
      */
-    Synchronizer(unsigned baudrate, unsigned sample_rate=INTERNAL_SAMPLE_RATE);
+    Synchronizer(unsigned baudrate, unsigned sample_rate=INTERNAL_SAMPLE_RATE,
+                 float phase_offset=0.0f);
 
     /**
      * @brief 	Destructor
@@ -152,19 +162,26 @@ class Synchronizer : public Async::AudioSink, public sigc::trackable
 
     /**
      * @brief   A signal emitted when new bits have been received
-     * @param   A vector of received bits
+     * @param   bits A vector of received bits, packed eight bits per byte
+     *
+     * The bits are NRZI decoded. The first received bit is stored in the
+     * least significant bit of each byte, which is the order that bytes are
+     * transmitted in an HDLC bitstream. The signal is emitted at most once
+     * for each block of samples written and only complete bytes are emitted.
      */
-    sigc::signal<void(std::vector<bool>&)> bitsReceived;
+    sigc::signal<void(const std::vector<uint8_t>&)> bitsReceived;
 
   private:
-    const unsigned    baudrate;
-    const unsigned    sample_rate;
-    const unsigned    shift_pos;
-    unsigned          pos;
-    std::vector<bool> bitbuf;
-    bool              was_mark;
-    bool              last_stored_was_mark;
-    int               err;
+    const unsigned        baudrate;
+    const unsigned        sample_rate;
+    const unsigned        shift_pos;
+    unsigned              pos;
+    std::vector<uint8_t>  bitbuf;
+    unsigned              marks;
+    unsigned              mark_cnt;
+    bool                  was_mark;
+    bool                  last_stored_was_mark;
+    int                   err;
 
     Synchronizer(const Synchronizer&);
     Synchronizer& operator=(const Synchronizer&);
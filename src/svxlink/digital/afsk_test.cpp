@@ -4,11 +4,18 @@
  * sox TNC_Test_Ver-1.1-01.wav -t raw -esigned-integer -c1 -r 16000 - | \
  * valgrind --leak-check=full svxlink/digital/afsk_test
  *
+ * Benchmark the demodulators, the bit synchronizer and the HDLC deframer with:
+ * svxlink/digital/afsk_test bench
+ *
  ******************************************************************************/
 
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
 
 #include <cstdlib>
 #include <cstring>
@@ -25,8 +32,10 @@
 #include <Rx.h>
 
 #include "AfskDemodulator.h"
+#include "AfskCorrelatorDemodulator.h"
 #include "Synchronizer.h"
 #include "HdlcDeframer.h"
+#include "SlicerBank.h"
 #include "AfskModulator.h"
 #include "HdlcFramer.h"
 
@@ -329,6 +338,344 @@ class StdInSourceDev : public StdInSource
 };
 
 
+/*
+ * Create the filter used in front of the demodulator for the SvxLink out of
+ * band AFSK channel
+ */
+static AudioFsf *createOutOfBandFilter(void)
+{
+  const size_t N = 128;
+  float coeff[N/2+1];
+  memset(coeff, 0, sizeof(coeff));
+  coeff[42] = 0.39811024;
+  coeff[43] = 1.0;
+  coeff[44] = 1.0;
+  coeff[45] = 1.0;
+  coeff[46] = 0.39811024;
+  return new AudioFsf(N, coeff);
+} /* createOutOfBandFilter */
+
+
+/*
+ * Generate a number of random frames and the HDLC line bitstream, one bit for
+ * each symbol where true is mark and false is space, for those frames
+ */
+static void generateFrames(size_t frame_cnt, vector<vector<uint8_t> >& frames,
+                           vector<bool>& line_bits)
+{
+  mt19937 rng(4711);
+  uniform_int_distribution<int> len_dist(16, 256);
+  uniform_int_distribution<int> byte_dist(0, 255);
+  frames.resize(frame_cnt);
+  HdlcFramer framer;
+  framer.sendBits.connect([&](const vector<bool>& bits)
+    {
+      line_bits.insert(line_bits.end(), bits.begin(), bits.end());
+    });
+  for (size_t i=0; i<frames.size(); ++i)
+  {
+    frames[i].resize(len_dist(rng));
+    for (size_t j=0; j<frames[i].size(); ++j)
+    {
+      frames[i][j] = byte_dist(rng);
+    }
+    framer.sendBytes(frames[i]);
+  }
+    // Add some idle bits so that the synchronizer emit the last flag
+  line_bits.insert(line_bits.end(), 16, line_bits.back());
+} /* generateFrames */
+
+
+/*
+ * Run the audio through the given demodulator and a bank of slicers. The
+ * number of frames that was decoded correctly is returned, the number of
+ * frames that was emitted more than once is stored in dup_cnt and the time it
+ * took is stored in dur.
+ */
+static size_t decodeAudio(AudioSink *sink, AudioSource *demod,
+                          const vector<float>& audio, unsigned baudrate,
+                          unsigned sample_rate, unsigned slicer_cnt,
+                          const vector<vector<uint8_t> >& frames,
+                          size_t& dup_cnt, double& dur)
+{
+  SlicerBank slicers(baudrate, slicer_cnt, sample_rate);
+  demod->registerSink(&slicers);
+  size_t next = 0;
+  size_t good_cnt = 0;
+  dup_cnt = 0;
+  slicers.frameReceived.connect([&](vector<uint8_t>& frame)
+    {
+      vector<vector<uint8_t> >::const_iterator it =
+        find(frames.begin() + next, frames.end(), frame);
+      if (it != frames.end())
+      {
+        ++good_cnt;
+        next = it - frames.begin() + 1;
+      }
+      else if ((next > 0) && (frame == frames[next-1]))
+      {
+        ++dup_cnt;
+      }
+    });
+
+  const int BLOCK_SIZE = 256;
+  auto start = chrono::steady_clock::now();
+  for (size_t pos=0; pos<audio.size(); pos+=BLOCK_SIZE)
+  {
+    sink->writeSamples(&audio[pos],
+        min(static_cast<size_t>(BLOCK_SIZE), audio.size() - pos));
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  dur = elapsed.count();
+  demod->unregisterSink();
+  return good_cnt;
+} /* decodeAudio */
+
+
+/*
+ * Modulate random HDLC frames, add white noise at a number of signal to noise
+ * ratios and count the number of frames that the AfskDemodulator and the
+ * AfskCorrelatorDemodulator decode correctly, with a single slicer and with a
+ * bank of phase offset slicers. The signal to noise ratio is measured over
+ * the whole audio bandwidth.
+ */
+static int runDemodBench(unsigned f0, unsigned f1, unsigned baudrate,
+                         unsigned sample_rate)
+{
+  const unsigned FRAME_CNT = 100;
+  const float AMPL = 0.5f;
+  const int SNRS[] = { 30, 12, 9, 6, 3, 0, -3 };
+  const unsigned SLICER_CNT = 3;
+
+  vector<vector<uint8_t> > frames;
+  vector<bool> line_bits;
+  generateFrames(FRAME_CNT, frames, line_bits);
+  const size_t sample_cnt =
+    static_cast<uint64_t>(line_bits.size()) * sample_rate / baudrate;
+  vector<float> signal(sample_cnt);
+  double phase = 0.0;
+  for (size_t i=0; i<sample_cnt; ++i)
+  {
+    size_t bitno = static_cast<uint64_t>(i) * baudrate / sample_rate;
+    phase += 2.0 * M_PI * (line_bits[bitno] ? f1 : f0) / sample_rate;
+    signal[i] = AMPL * sin(phase);
+  }
+
+  const bool out_of_band = (f0 == 5415) && (f1 == 5585) && (baudrate == 300);
+  AudioFsf *fsf = out_of_band ? createOutOfBandFilter() : 0;
+
+    // Demodulator 0 is the AfskDemodulator and 1 is the
+    // AfskCorrelatorDemodulator. Decoders 2 and 3 use the same demodulators
+    // with a bank of slicers.
+  const int DECODER_CNT = 4;
+  const char *names[DECODER_CNT] = {
+    "AfskDemodulator", "AfskCorrelatorDemodulator",
+    "AfskDemodulator, slicer bank", "AfskCorrelatorDemodulator, slicer bank"
+  };
+
+  cout << "\nDecoded frames of " << frames.size() << ", " << f0 << "/"
+       << f1 << "Hz " << baudrate << "Bd, " << SLICER_CNT
+       << " slicers in the slicer banks\n";
+  cout << setw(8) << "SNR dB" << setw(10) << "Autocorr" << setw(12)
+       << "Correlator" << setw(12) << "Autocorr+" << setw(14)
+       << "Correlator+" << endl;
+  mt19937 rng(1234);
+  normal_distribution<float> dist(0.0f, 1.0f);
+  double dur[DECODER_CNT] = { 0.0, 0.0, 0.0, 0.0 };
+  size_t total_samples = 0;
+  size_t good_cnt[DECODER_CNT] = { 0, 0, 0, 0 };
+  size_t total_dup_cnt = 0;
+  for (size_t n=0; n<sizeof(SNRS)/sizeof(*SNRS); ++n)
+  {
+    const float noise_ampl = AMPL / sqrtf(2.0f) / powf(10.0f, SNRS[n] / 20.0f);
+    vector<float> audio(signal);
+    for (size_t i=0; i<audio.size(); ++i)
+    {
+      audio[i] += noise_ampl * dist(rng);
+    }
+    total_samples += audio.size();
+
+    size_t cnt[DECODER_CNT];
+    for (int d=0; d<DECODER_CNT; ++d)
+    {
+      AudioSource *demod;
+      AudioSink *demod_sink;
+      if (d % 2 == 0)
+      {
+        AfskDemodulator *afsk_demod =
+          new AfskDemodulator(f0, f1, baudrate, sample_rate);
+        demod = afsk_demod;
+        demod_sink = afsk_demod;
+      }
+      else
+      {
+        AfskCorrelatorDemodulator *corr_demod =
+          new AfskCorrelatorDemodulator(f0, f1, baudrate, sample_rate);
+        demod = corr_demod;
+        demod_sink = corr_demod;
+      }
+      AudioSink *sink = demod_sink;
+      if (fsf != 0)
+      {
+        fsf->registerSink(demod_sink);
+        sink = fsf;
+      }
+      double d_dur = 0.0;
+      size_t dup_cnt = 0;
+      cnt[d] = decodeAudio(sink, demod, audio, baudrate, sample_rate,
+                           (d < 2) ? 1 : SLICER_CNT, frames, dup_cnt, d_dur);
+      if (fsf != 0)
+      {
+        fsf->unregisterSink();
+      }
+      delete demod;
+      dur[d] += d_dur;
+      total_dup_cnt += dup_cnt;
+      if (n == 0)
+      {
+        good_cnt[d] = cnt[d];
+      }
+    }
+    cout << setw(8) << SNRS[n] << setw(10) << cnt[0] << setw(12) << cnt[1]
+         << setw(12) << cnt[2] << setw(14) << cnt[3] << endl;
+  }
+  delete fsf;
+
+  cout << fixed << setprecision(1);
+  for (int d=0; d<DECODER_CNT; ++d)
+  {
+    cout << names[d] << ": " << (total_samples / dur[d] / 1.0e6)
+         << " million samples per second\n";
+  }
+
+  int ret = 0;
+  for (int d=0; d<DECODER_CNT; ++d)
+  {
+    if (good_cnt[d] != frames.size())
+    {
+      cout << "*** ERROR: Frames were lost without noise\n";
+      ret = 1;
+      break;
+    }
+  }
+  if (total_dup_cnt > 0)
+  {
+    cout << "*** ERROR: " << total_dup_cnt << " frames were emitted twice\n";
+    ret = 1;
+  }
+
+  return ret;
+} /* runDemodBench */
+
+
+/*
+ * Generate a number of random HDLC frames and convert the bitstream to a
+ * demodulated signal, a positive value for mark and a negative value for
+ * space. The signal is run through the synchronizer and the deframer a number
+ * of times and the throughput is measured. The deframer is also measured on
+ * its own using the bits that the synchronizer produced.
+ */
+static int runBench(unsigned baudrate, unsigned sample_rate)
+{
+  const unsigned FRAME_CNT = 500;
+  const unsigned PASSES = 20;
+
+  vector<vector<uint8_t> > frames;
+  vector<bool> line_bits;
+  generateFrames(FRAME_CNT, frames, line_bits);
+
+  const size_t sample_cnt =
+    static_cast<uint64_t>(line_bits.size()) * sample_rate / baudrate;
+  vector<float> samples(sample_cnt);
+  for (size_t i=0; i<sample_cnt; ++i)
+  {
+    size_t bitno = static_cast<uint64_t>(i) * baudrate / sample_rate;
+    samples[i] = line_bits[bitno] ? 1.0f : -1.0f;
+  }
+
+  Synchronizer sync(baudrate, sample_rate);
+  HdlcDeframer deframer;
+  vector<uint8_t> sync_bits;
+  sync.bitsReceived.connect([&](const vector<uint8_t>& bits)
+    {
+      deframer.bitsReceived(bits);
+      sync_bits.insert(sync_bits.end(), bits.begin(), bits.end());
+    });
+  size_t frame_cnt = 0;
+  size_t bad_cnt = 0;
+  deframer.frameReceived.connect([&](vector<uint8_t>& frame)
+    {
+      if ((frame_cnt >= frames.size()) || (frame != frames[frame_cnt]))
+      {
+        ++bad_cnt;
+      }
+      ++frame_cnt;
+    });
+
+    // Verify the decoding in the first pass
+  const int BLOCK_SIZE = 256;
+  for (size_t pos=0; pos<samples.size(); pos+=BLOCK_SIZE)
+  {
+    sync.writeSamples(&samples[pos],
+        min(static_cast<size_t>(BLOCK_SIZE), samples.size() - pos));
+  }
+  cout << "Decoded " << frame_cnt << " of " << frames.size() << " frames, "
+       << bad_cnt << " bad\n";
+  if ((frame_cnt != frames.size()) || (bad_cnt != 0))
+  {
+    cout << "*** ERROR: The decoded frames differ from the sent frames\n";
+    return 1;
+  }
+
+  sync.bitsReceived.clear();
+  sync.bitsReceived.connect(mem_fun(deframer, &HdlcDeframer::bitsReceived));
+  auto start = chrono::steady_clock::now();
+  for (unsigned pass=0; pass<PASSES; ++pass)
+  {
+    for (size_t pos=0; pos<samples.size(); pos+=BLOCK_SIZE)
+    {
+      sync.writeSamples(&samples[pos],
+          min(static_cast<size_t>(BLOCK_SIZE), samples.size() - pos));
+    }
+  }
+  chrono::duration<double> sync_dur = chrono::steady_clock::now() - start;
+
+    // Feed the deframer with the bits in chunks of about the same size as
+    // when running at the bench sample rate and block size
+  const size_t chunk = max(1U, BLOCK_SIZE * baudrate / sample_rate / 8);
+  vector<vector<uint8_t> > chunks;
+  for (size_t pos=0; pos<sync_bits.size(); pos+=chunk)
+  {
+    chunks.push_back(vector<uint8_t>(sync_bits.begin() + pos,
+          sync_bits.begin() + min(pos + chunk, sync_bits.size())));
+  }
+  start = chrono::steady_clock::now();
+  for (unsigned pass=0; pass<PASSES; ++pass)
+  {
+    for (size_t i=0; i<chunks.size(); ++i)
+    {
+      deframer.bitsReceived(chunks[i]);
+    }
+  }
+  chrono::duration<double> deframe_dur = chrono::steady_clock::now() - start;
+
+  cout << fixed << setprecision(1)
+       << "Synchronizer and deframer: "
+       << (PASSES * samples.size() / sync_dur.count() / 1.0e6)
+       << " million samples per second\n"
+       << "Deframer: "
+       << (PASSES * 8.0 * sync_bits.size() / deframe_dur.count() / 1.0e6)
+       << " million bits per second\n";
+  if (frame_cnt != (PASSES * 2 + 1) * frames.size())
+  {
+    cout << "*** ERROR: Frames were lost during the benchmark\n";
+    return 1;
+  }
+
+  return 0;
+} /* runBench */
+
+
 int main(int argc, const char **argv)
 {
   // 1200Bd AMPR
@@ -396,6 +743,12 @@ int main(int argc, const char **argv)
 
   unsigned sample_rate = 16000;
 
+  if ((argc > 1) && (string(argv[1]) == "bench"))
+  {
+    return runBench(baudrate, sample_rate) |
+           runDemodBench(f0, f1, baudrate, sample_rate);
+  }
+
   CppApplication app;
 
   AudioIO::setSampleRate(sample_rate);
@@ -416,15 +769,7 @@ int main(int argc, const char **argv)
 
   if ((f0 == 5415) && (f1 == 5585) && (baudrate == 300))
   {
-    const size_t N = 128;
-    float coeff[N/2+1];
-    memset(coeff, 0, sizeof(coeff));
-    coeff[42] = 0.39811024;
-    coeff[43] = 1.0;
-    coeff[44] = 1.0;
-    coeff[45] = 1.0;
-    coeff[46] = 0.39811024;
-    AudioFsf *fsf = new AudioFsf(N, coeff);
+    AudioFsf *fsf = createOutOfBandFilter();
     prev_src->registerSink(fsf, true);
     prev_src = fsf;
   }
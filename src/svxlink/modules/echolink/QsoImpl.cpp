@@ -210,7 +210,7 @@ QsoImpl::QsoImpl(const StationData &station, ModuleEchoLink *module)
 	  
   AudioPacer *msg_pacer = new AudioPacer(INTERNAL_SAMPLE_RATE,
       	      	                         160*4*(INTERNAL_SAMPLE_RATE / 8000),
-					 500);
+					 200);
   msg_handler->registerSink(msg_pacer, true);
   
   output_sel = new AudioSelector;
@@ -238,6 +238,8 @@ QsoImpl::QsoImpl(const StationData &station, ModuleEchoLink *module)
       sigc::bind(mem_fun(*msg_handler, &MsgHandler::playSilence), false));
   event_handler->playTone.connect(
       sigc::bind(mem_fun(*msg_handler, &MsgHandler::playTone), false));
+  event_handler->playCw.connect(
+      sigc::bind(mem_fun(*msg_handler, &MsgHandler::playCw), false));
   event_handler->getConfigValue.connect(
       sigc::mem_fun(*this, &QsoImpl::getConfigValue));
 
@@ -232,7 +232,13 @@ Reflector::Reflector(void)
   : m_srv(0), m_udp_sock(0), m_tg_for_v1_clients(1), m_random_qsy_lo(0),
     m_random_qsy_hi(0), m_random_qsy_tg(0), m_http_server(0), m_cmd_pty(0),
     m_keys_dir("private/"), m_pending_csrs_dir("pending_csrs/"),
-    m_csrs_dir("csrs/"), m_certs_dir("certs/"), m_pki_dir("pki/")
+    m_csrs_dir("csrs/"), m_certs_dir("certs/"), m_pki_dir("pki/"),
+    m_udp_rx_frames(Async::Metrics::instance().counter(
+          "svxreflector_udp_frames_received_total",
+          "Number of UDP frames received from clients")),
+    m_udp_tx_frames(Async::Metrics::instance().counter(
+          "svxreflector_udp_frames_sent_total",
+          "Number of UDP frames sent to clients"))
 {
   TGHandler::instance()->talkerUpdated.connect(
       mem_fun(*this, &Reflector::onTalkerUpdated));
@@ -346,6 +352,10 @@ bool Reflector::initialize(Async::Config &cfg)
         sigc::mem_fun(*this, &Reflector::httpClientConnected));
     m_http_server->clientDisconnected.connect(
         sigc::mem_fun(*this, &Reflector::httpClientDisconnected));
+    unsigned http_srv_max_connections = 32;
+    m_cfg->getValue("GLOBAL", "HTTP_SRV_MAX_CONNECTIONS",
+                    http_srv_max_connections);
+    m_http_server->setMaxConnections(http_srv_max_connections);
   }
 
     // Path for command PTY
@@ -424,6 +434,7 @@ bool Reflector::sendUdpDatagram(ReflectorClient *client,
                    "datagram to " << udp_addr << ":" << udp_port << std::endl;
       return false;
     }
+    m_udp_tx_frames.inc();
     return m_udp_sock->write(udp_addr, udp_port,
                              aadss.str().data(), aadss.str().size(),
                              ss.str().data(), ss.str().size());
@@ -434,6 +445,7 @@ bool Reflector::sendUdpDatagram(ReflectorClient *client,
         client->udpCipherIVCntrNext() & 0xffff);
     ostringstream ss;
     assert(header.pack(ss) && msg.pack(ss));
+    m_udp_tx_frames.inc();
     return m_udp_sock->UdpSocket::write(
         udp_addr, udp_port,
         ss.str().data(), ss.str().size());
@@ -444,14 +456,61 @@ bool Reflector::sendUdpDatagram(ReflectorClient *client,
 void Reflector::broadcastUdpMsg(const ReflectorUdpMsg& msg,
                                 const ReflectorClient::Filter& filter)
 {
+    // The payload is the same for all V3+ clients so pack it once and then
+    // encrypt it for all of them in one batch
+  ReflectorUdpMsg header(msg.type());
+  ostringstream ss;
+  assert(header.pack(ss) && msg.pack(ss));
+  const std::string payload = ss.str();
+
+  std::vector<Async::EncryptedUdpSocket::Datagram> datagrams;
+  datagrams.reserve(m_client_con_map.size());
+  std::vector<std::string> aads;
+  aads.reserve(m_client_con_map.size());
   for (const auto& item : m_client_con_map)
   {
     ReflectorClient *client = item.second;
-    if (filter(client) &&
-        (client->conState() == ReflectorClient::STATE_CONNECTED))
+    if (!filter(client) ||
+        (client->conState() != ReflectorClient::STATE_CONNECTED))
+    {
+      continue;
+    }
+    if (client->protoVer() < ProtoVer(3, 0))
     {
       client->sendUdpMsg(msg);
+      continue;
+    }
+    if (client->remoteUdpPort() == 0)
+    {
+      continue;
+    }
+    client->udpMsgSent();
+
+    Async::EncryptedUdpSocket::Datagram dg;
+    dg.remote_ip = client->remoteUdpHost();
+    dg.remote_port = client->remoteUdpPort();
+    dg.key = client->udpCipherKey();
+    dg.iv = client->udpCipherIV();
+    UdpCipher::AAD aad{client->udpCipherIVCntrNext()};
+    std::ostringstream aadss;
+    if (!aad.pack(aadss))
+    {
+      std::cout << "*** WARNING: Packing associated data failed for UDP "
+                   "datagram to " << dg.remote_ip << ":" << dg.remote_port
+                << std::endl;
+      continue;
     }
+    aads.push_back(aadss.str());
+    dg.aad = aads.back().data();
+    dg.aadlen = aads.back().size();
+    dg.buf = payload.data();
+    dg.count = payload.size();
+    datagrams.push_back(std::move(dg));
+  }
+
+  if (!datagrams.empty())
+  {
+    m_udp_tx_frames.inc(m_udp_sock->writeBatch(datagrams));
   }
 } /* Reflector::broadcastUdpMsg */
 
@@ -864,6 +923,8 @@ void Reflector::clientDisconnectCleanup(Async::FramedTcpConnection *con,
 
   if (!client->callsign().empty())
   {
+    Async::Metrics::instance().remove("svxreflector_client_tx_queue_depth",
+        Async::Metrics::label("callsign", client->callsign()));
     m_status["nodes"].removeMember(client->callsign());
     broadcastMsg(MsgNodeLeft(client->callsign()),
         ReflectorClient::ExceptFilter(client));
@@ -994,6 +1055,7 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
             "from " << addr << ":" << port << endl;
     return;
   }
+  m_udp_rx_frames.inc();
   ReflectorUdpMsgV2 header_v2;
 
   ReflectorClient* client = nullptr;
@@ -1349,6 +1411,12 @@ void Reflector::httpRequestReceived(Async::HttpServerConnection *con,
     return;
   }
 
+  if (req.target == "/metrics")
+  {
+    httpSendMetrics(con, req);
+    return;
+  }
+
   if (req.target != "/status")
   {
     res.setCode(404);
@@ -1366,13 +1434,46 @@ void Reflector::httpRequestReceived(Async::HttpServerConnection *con,
   writer->write(m_status, &os);
   delete writer;
 
-  res.setContent("application/json", os.str());
+    // Reuse the last content object if the status has not changed so that
+    // the cached compressed version of it can be used
+  if ((m_status_content == nullptr) || (m_status_content->data() != os.str()))
+  {
+    m_status_content =
+      std::make_shared<const Async::HttpServerConnection::Content>(os.str());
+  }
+  res.setContent("application/json", m_status_content);
   res.setSendContent(req.method == "GET");
   res.setCode(200);
   con->write(res);
 } /* Reflector::requestReceived */
 
 
+void Reflector::httpSendMetrics(Async::HttpServerConnection *con,
+                                Async::HttpServerConnection::Request& req)
+{
+    // The queue depths are sampled when the metrics are requested
+  for (const auto& item : m_client_con_map)
+  {
+    const ReflectorClient* client = item.second;
+    if (client->callsign().empty())
+    {
+      continue;
+    }
+    Async::Metrics::instance().gauge("svxreflector_client_tx_queue_depth",
+        "Number of frames queued for transmission to a client",
+        Async::Metrics::label("callsign", client->callsign())
+      ).set(item.first->txQueueSize());
+  }
+
+  Async::HttpServerConnection::Response res;
+  res.setContent(Async::Metrics::CONTENT_TYPE,
+                 Async::Metrics::instance().toString());
+  res.setSendContent(req.method == "GET");
+  res.setCode(200);
+  con->write(res);
+} /* Reflector::httpSendMetrics */
+
+
 void Reflector::httpClientConnected(Async::HttpServerConnection *con)
 {
   //std::cout << "### HTTP Client connected: "
@@ -52,6 +52,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncTimer.h>
 #include <AsyncAtTimer.h>
 #include <AsyncHttpServerConnection.h>
+#include <AsyncMetrics.h>
 #include <AsyncExec.h>
 
 
@@ -284,6 +285,9 @@ class Reflector : public sigc::trackable
     std::vector<uint8_t>        m_ca_sig;
     std::string                 m_accept_cert_email;
     Json::Value                 m_status;
+    Async::HttpServerConnection::ContentPtr m_status_content;
+    Async::Metrics::Counter&    m_udp_rx_frames;
+    Async::Metrics::Counter&    m_udp_tx_frames;
 
     Reflector(const Reflector&);
     Reflector& operator=(const Reflector&);
@@ -296,6 +300,8 @@ class Reflector : public sigc::trackable
                          ReflectorClient *new_talker);
     void httpRequestReceived(Async::HttpServerConnection *con,
                              Async::HttpServerConnection::Request& req);
+    void httpSendMetrics(Async::HttpServerConnection *con,
+                         Async::HttpServerConnection::Request& req);
     void httpClientConnected(Async::HttpServerConnection *con);
     void httpClientDisconnected(Async::HttpServerConnection *con,
         Async::HttpServerConnection::DisconnectReason reason);
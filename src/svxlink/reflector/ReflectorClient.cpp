@@ -249,6 +249,11 @@ ReflectorClient::~ReflectorClient(void)
   assert(client_it != client_map.end());
   client_map.erase(client_it);
   client_src_map.erase(m_client_src);
+  if (m_client_src.second != 0)
+  {
+    m_reflector->udpSocket()->forgetPeer(m_client_src.first,
+                                         m_client_src.second);
+  }
   if (!m_callsign.empty())
   {
     client_callsign_map.erase(m_callsign);
@@ -327,7 +332,7 @@ void ReflectorClient::sendUdpMsg(const ReflectorUdpMsg &msg)
     return;
   }
 
-  m_udp_heartbeat_tx_cnt = UDP_HEARTBEAT_TX_CNT_RESET;
+  udpMsgSent();
 
   (void)m_reflector->sendUdpDatagram(this, msg);
 } /* ReflectorClient::sendUdpMsg */
@@ -1096,6 +1101,33 @@ void ReflectorClient::handleStateEvent(std::istream& is)
     sendError("Illegal MsgStateEvent protocol message received");
     return;
   }
+
+  if (msg.name() == "Reflector:rx_jitter_buffer")
+  {
+      // Receive statistics for audio sent from the reflector to the node
+    if (m_status == nullptr)
+    {
+      return;
+    }
+    try
+    {
+      Json::Value rx_jitter_buffer;
+      std::istringstream is(msg.msg());
+      is >> rx_jitter_buffer;
+      if (rx_jitter_buffer.isObject())
+      {
+        (*m_status)["rxJitterBuffer"] = rx_jitter_buffer;
+      }
+    }
+    catch (const Json::Exception& e)
+    {
+      std::cerr << "*** WARNING[" << m_callsign
+                << "]: Failed to parse rx_jitter_buffer JSON object: "
+                << e.what() << std::endl;
+    }
+    return;
+  }
+
   cout << "### ReflectorClient::handleStateEvent:"
        << " src=" << msg.src()
        << " name=" << msg.name()
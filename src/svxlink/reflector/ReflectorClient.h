@@ -410,6 +410,18 @@ class ReflectorClient : public sigc::trackable
      */
     void sendUdpMsg(const ReflectorUdpMsg &msg);
 
+    /**
+     * @brief   Notify the client that a UDP message has been sent to it
+     *
+     * This function is called by the Reflector when it has sent a UDP
+     * message to the client without going through sendUdpMsg, e.g. when
+     * broadcasting a message to many clients in one batch.
+     */
+    void udpMsgSent(void)
+    {
+      m_udp_heartbeat_tx_cnt = UDP_HEARTBEAT_TX_CNT_RESET;
+    }
+
     /**
      * @brief   Block client audio for the specified time
      * @param   The number of seconds to block
@@ -494,7 +506,10 @@ class ReflectorClient : public sigc::trackable
     {
       m_udp_cipher_key = key;
     }
-    std::vector<uint8_t> udpCipherKey(void) const { return m_udp_cipher_key; }
+    const std::vector<uint8_t>& udpCipherKey(void) const
+    {
+      return m_udp_cipher_key;
+    }
 
     void certificateUpdated(Async::SslX509& cert);
 
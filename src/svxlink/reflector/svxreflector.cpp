@@ -364,6 +364,10 @@ int main(int argc, const char *argv[])
   cfg.getValue("GLOBAL", "TIMESTAMP_FORMAT", tstamp_format);
   logwriter.setTimestampFormat(tstamp_format);
 
+  unsigned stall_threshold = 0;
+  cfg.getValue("GLOBAL", "EVENT_LOOP_STALL_THRESHOLD", stall_threshold);
+  app.setStallThreshold(stall_threshold);
+
   cout << PROGRAM_NAME " v" SVXREFLECTOR_VERSION
           " Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX\n\n";
   cout << PROGRAM_NAME " comes with ABSOLUTELY NO WARRANTY. "
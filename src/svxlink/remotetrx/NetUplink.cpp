@@ -787,6 +787,10 @@ void NetUplink::selcallSequenceDetected(std::string sequence)
 
 void NetUplink::writeEncodedSamples(const void *buf, int size)
 {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  sendMsg(MsgAudioTimestamp(now));
+
   //cout << "NetUplink::writeEncodedSamples: size=" << size << endl;
   const char *ptr = reinterpret_cast<const char *>(buf);
   while (size > 0)
@@ -3,7 +3,8 @@
 # This code is used to send morse code messages.
 #
 # This file is sourced by the main event handler file so no manual inclusion
-# is necessary. Use functions CW::setWpm or CW::setCpm to set the CW speed.
+# is necessary. Use functions CW::setWpm or CW::setCpm to set the CW speed
+# and CW::setFarnsworthWpm or CW::setFarnsworthCpm to use Farnsworth timing.
 # Use functions CW::setPitch to set the pitch and CW::setAmplitude to set the
 # amplitude. Then use CW::play to play some text. See documentation for each
 # function below.
@@ -12,12 +13,12 @@
 
 namespace eval CW {
 
-# Timing variables
-variable short_len;
-variable long_len;
-variable char_spacing;
-variable letter_spacing;
-variable word_spacing;
+# The CW speed in characters per minute
+variable cpm;
+
+# The effective CW speed, in characters per minute, when using Farnsworth
+# timing. Zero means that Farnsworth timing is not used.
+variable farnsworth_cpm;
 
 # The pitch of the CW audio
 variable fq;
@@ -25,81 +26,40 @@ variable fq;
 # The amplitude of the CW audio
 variable amplitude;
 
-# Morse code table
-array set letters {
-  "A" ".-"
-  "B" "-..."
-  "C" "-.-."
-  "D" "-.."
-  "E" "."
-  "F" "..-."
-  "G" "--."
-  "H" "...."
-  "I" ".."
-  "J" ".---"
-  "K" "-.-"
-  "L" ".-.."
-  "M" "--"
-  "N" "-."  
-  "O" "---"
-  "P" ".--."
-  "Q" "--.-"
-  "R" ".-."
-  "S" "..."
-  "T" "-"
-  "U" "..-"
-  "V" "...-"
-  "W" ".--"
-  "X" "-..-"
-  "Y" "-.--"
-  "Z" "--.."
-  
-  "0" "-----"
-  "1" ".----"
-  "2" "..---"
-  "3" "...--"
-  "4" "....-"
-  "5" "....."
-  "6" "-...."
-  "7" "--..."
-  "8" "---.."
-  "9" "----."
-  
-  "." ".-.-.-"
-  "," "--..--"
-  "?" "..--.."
-  "/" "-..-."
-  "=" "-...-"
-
-  " " " "
+
+#
+# Set the CW speed in words per minute
+#
+proc setWpm {wpm} {
+  variable cpm [expr 5 * $wpm];
 }
 
 
-# Private function
-proc calculateTimings {} {
-  variable short_len;
-  variable long_len [expr $short_len * 3];
-  variable char_spacing $short_len;
-  variable letter_spacing [expr $short_len * 3];
-  variable word_spacing [expr $short_len * 7];
+#
+# Set the CW speed in characters per minute
+#
+proc setCpm {new_cpm} {
+  variable cpm $new_cpm;
 }
 
 
 #
-# Set the CW speed in words per minute
+# Set the effective CW speed in words per minute when using Farnsworth timing.
+# The characters are sent using the speed set by setWpm or setCpm but the
+# spacing between characters and words is increased to give the effective
+# speed. Set to 0 to disable Farnsworth timing.
 #
-proc setWpm {wpm} {
-  variable short_len [expr 60000 / (50 * $wpm)];
-  calculateTimings;
+proc setFarnsworthWpm {wpm} {
+  variable farnsworth_cpm [expr 5 * $wpm];
 }
 
 
 #
-# Set the CW speed in characters per minute
+# Set the effective CW speed in characters per minute when using Farnsworth
+# timing. Set to 0 to disable Farnsworth timing.
 #
-proc setCpm {cpm} {
-  variable short_len [expr 60000 / (10 * $cpm)];
-  calculateTimings;
+proc setFarnsworthCpm {new_cpm} {
+  variable farnsworth_cpm $new_cpm;
 }
 
 
@@ -136,32 +96,31 @@ proc loadDefaults {{section ""}} {
   setAmplitude [getConfigValue $section CW_AMP -6]
   setCpm [getConfigValue $section CW_CPM \
           [expr 5*[getConfigValue $section CW_WPM 20]]]
+  setFarnsworthCpm [getConfigValue $section CW_FARNSWORTH_CPM \
+                    [expr 5*[getConfigValue $section CW_FARNSWORTH_WPM 0]]]
   setPitch [getConfigValue $section CW_PITCH 800]
-  calculateTimings
 }
 
 
 #
 # Play the given CW text
 #
-#   txt   - The text to send
-#   cpm   - The CW speed in characters per minute
-#   pitch - The CW pitch in Hz
-#   amp   - The CW amplitude in dBFS
-#
-proc play {txt {cpm 0} {pitch 0} {amp -1000000}} {
-  variable short_len;
-  variable long_len;
-  variable char_spacing;
-  variable letter_spacing;
-  variable word_spacing;
+#   txt     - The text to send
+#   new_cpm - The CW speed in characters per minute
+#   pitch   - The CW pitch in Hz
+#   amp     - The CW amplitude in dBFS
+#
+# The whole text is rendered into one message by the playCw command.
+#
+proc play {txt {new_cpm 0} {pitch 0} {amp -1000000}} {
+  variable cpm;
+  variable farnsworth_cpm;
   variable fq;
   variable amplitude;
-  variable letters;
 
   set load_defaults 0
-  if {$cpm > 0} {
-    setCpm $cpm
+  if {$new_cpm > 0} {
+    setCpm $new_cpm
     set load_defaults 1
   }
   if {$pitch > 0} {
@@ -173,28 +132,7 @@ proc play {txt {cpm 0} {pitch 0} {amp -1000000}} {
     set load_defaults 1
   }
 
-  set txt [string toupper $txt];
-  set first_letter 1;
-  foreach letter [split $txt ""] {
-    if {!$first_letter} {
-      playSilence $letter_spacing;
-    }
-    set first_letter 0;
-    set first_char 1;
-    foreach char [split $letters($letter) ""] {
-      if {!$first_char} {
-      	playSilence $char_spacing;
-      }
-      set first_char 0;
-      if {$char == "."} {
-      	playTone $fq $amplitude $short_len;
-      } elseif {$char == "-"} {
-      	playTone $fq $amplitude $long_len;  
-      } elseif {$char == " "} {
-      	playSilence $word_spacing;
-      }
-    }
-  }
+  playCw $txt $cpm $farnsworth_cpm $fq $amplitude
 
   if {$load_defaults} {
     loadDefaults
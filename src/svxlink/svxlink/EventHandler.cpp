@@ -132,7 +132,12 @@ std::string EventHandler::tclSafeCallsign(const std::string& str)
 
 
 EventHandler::EventHandler(const string& event_script, const string& logic_name)
-  : event_script(event_script), logic_name(logic_name), interp(0)
+  : event_script(event_script), logic_name(logic_name), interp(0),
+    event_hist(Async::Metrics::instance().histogram(
+          "svxlink_tcl_event_handler_seconds",
+          "Time spent executing TCL event handlers",
+          Async::Metrics::latencyBuckets(),
+          Async::Metrics::label("logic", logic_name)))
 {
   interp = Tcl_CreateInterp();
   if (interp == 0)
@@ -162,6 +167,7 @@ EventHandler::EventHandler(const string& event_script, const string& logic_name)
   Tcl_CreateCommand(interp, "publishStateEvent", publishStateEventHandler,
                     this, NULL);
   Tcl_CreateCommand(interp, "playDtmf", playDtmfHandler, this, NULL);
+  Tcl_CreateCommand(interp, "playCw", playCwHandler, this, NULL);
   Tcl_CreateCommand(interp, "injectDtmf", injectDtmfHandler, this, NULL);
   Tcl_CreateCommand(interp, "getConfigValue", getConfigValueHandler,
                     this, NULL);
@@ -244,6 +250,7 @@ bool EventHandler::processEvent(const string& event)
     return false;
   }
   
+  Async::Metrics::ScopedTimer event_timer(event_hist);
   bool success = true;
   Tcl_Preserve(interp);
   if (Tcl_Eval(interp, (event + ";").c_str()) != TCL_OK)
@@ -449,6 +456,24 @@ int EventHandler::playDtmfHandler(ClientData cdata, Tcl_Interp *irp,
 } /* EventHandler::playDtmfHandler */
 
 
+int EventHandler::playCwHandler(ClientData cdata, Tcl_Interp *irp,
+                                int argc, const char *argv[])
+{
+  if(argc != 6)
+  {
+    static char msg[] = "Usage: playCw <text> <cpm> <farnsworth cpm> <fq> "
+                        "<amp>";
+    Tcl_SetResult(irp, msg, TCL_STATIC);
+    return TCL_ERROR;
+  }
+  EventHandler *self = static_cast<EventHandler *>(cdata);
+  self->playCw(argv[1], atoi(argv[2]), atoi(argv[3]), atoi(argv[4]),
+               atoi(argv[5]));
+
+  return TCL_OK;
+} /* EventHandler::playCwHandler */
+
+
 int EventHandler::injectDtmfHandler(ClientData cdata, Tcl_Interp *irp,
                                     int argc, const char *argv[])
 {
@@ -48,6 +48,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncMetrics.h>
 
 
 /****************************************************************************
@@ -234,6 +235,17 @@ class EventHandler : public sigc::trackable
      */
     sigc::signal<void(const std::string&, int, int)> playDtmf;
 
+    /**
+     * @brief 	A signal that is emitted when the TCL script want to play
+     *	      	back a CW message
+     * @param 	txt       The text to send
+     * @param 	cpm       The character speed in characters per minute
+     * @param 	fw_cpm    The Farnsworth effective speed or 0 to disable
+     * @param 	fq    	  The pitch of the CW tone
+     * @param 	amp   	  The tone amplitude to use (0-1000)
+     */
+    sigc::signal<void(const std::string&, int, int, int, int)> playCw;
+
     /**
      * @brief 	A signal that is emitted when the TCL script want to start
      *	      	a recording
@@ -293,9 +305,10 @@ class EventHandler : public sigc::trackable
   protected:
 
   private:
-    std::string   event_script;
-    std::string   logic_name;
-    Tcl_Interp *  interp;
+    std::string                 event_script;
+    std::string                 logic_name;
+    Tcl_Interp *                interp;
+    Async::Metrics::Histogram&  event_hist;
 
     static int playFileHandler(ClientData cdata, Tcl_Interp *irp,
       	      	    int argc, const char *argv[]);
@@ -311,6 +324,8 @@ class EventHandler : public sigc::trackable
       	            int argc, const char *argv[]);
     static int playDtmfHandler(ClientData cdata, Tcl_Interp *irp,
                     int argc, const char *argv[]);
+    static int playCwHandler(ClientData cdata, Tcl_Interp *irp,
+                    int argc, const char *argv[]);
     static int injectDtmfHandler(ClientData cdata, Tcl_Interp *irp,
                     int argc, const char *argv[]);
     static int getConfigValueHandler(ClientData cdata, Tcl_Interp *irp,
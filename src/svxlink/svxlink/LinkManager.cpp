@@ -614,6 +614,24 @@ void LinkManager::playDtmf(LogicBase *src_logic, const std::string& digits, int
 } /* LinkManager::playDtmf */
 
 
+void LinkManager::playCw(LogicBase *src_logic, const std::string& txt,
+                         int cpm, int fw_cpm, int fq, int amp)
+{
+  const Async::AudioSelector *selector = sinks[src_logic->name()].selector;
+  const ConMap& con_map = sinks[src_logic->name()].connectors;
+  for (ConMap::const_iterator it = con_map.begin(); it != con_map.end(); ++it)
+  {
+    const std::string& logic_name = it->first;
+    const Async::AudioSource *con = it->second;
+    LogicBase *logic = logic_map.at(logic_name).logic;
+    if ((logic != src_logic) && (selector->autoSelectEnabled(con)))
+    {
+      logic->playCw(txt, cpm, fw_cpm, fq, amp);
+    }
+  }
+} /* LinkManager::playCw */
+
+
 
 /****************************************************************************
  *
@@ -283,6 +283,18 @@ class LinkManager : public sigc::trackable
     void playDtmf(LogicBase *src_logic, const std::string& digits, int amp,
                   int len);
 
+    /**
+     * @brief   Play a CW message
+     * @param   src_logic The initiating logic, which will not play the message
+     * @param   txt The text to send
+     * @param   cpm The character speed in characters per minute
+     * @param   fw_cpm The Farnsworth effective speed or 0 to disable
+     * @param   fq The pitch of the CW tone
+     * @param   amp The tone amplitude in "milliunits", 1000=full strength
+     */
+    void playCw(LogicBase *src_logic, const std::string& txt, int cpm,
+                int fw_cpm, int fq, int amp);
+
   private:
     struct LogicProperties
     {
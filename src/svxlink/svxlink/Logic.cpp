@@ -58,6 +58,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncApplication.h>
 #include <AsyncConfig.h>
 #include <AsyncTimer.h>
 #include <Rx.h>
@@ -86,6 +87,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "EventHandler.h"
 #include "Module.h"
 #include "MsgHandler.h"
+#include "SoundClipCache.h"
 #include "LogicCmds.h"
 #include "Logic.h"
 #include "QsoRecorder.h"
@@ -615,7 +617,7 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
 
     // Pace the audio so that we don't fill up the audio output pipe.
   AudioPacer *msg_pacer = new AudioPacer(INTERNAL_SAMPLE_RATE,
-      	      	      	      	      	 256 * INTERNAL_SAMPLE_RATE / 8000, 0);
+      	      	      	      	      	 128 * INTERNAL_SAMPLE_RATE / 8000, 0);
   prev_tx_src->registerSink(msg_pacer, true);
   tx_audio_mixer->addSource(msg_pacer);
   prev_tx_src = 0;
@@ -631,6 +633,7 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   event_handler->publishStateEvent.connect(
           mem_fun(*this, &Logic::onPublishStateEvent));
   event_handler->playDtmf.connect(mem_fun(*this, &Logic::playDtmf));
+  event_handler->playCw.connect(mem_fun(*this, &Logic::playCw));
   event_handler->injectDtmf.connect(mem_fun(*this, &Logic::injectDtmf));
   event_handler->getConfigValue.connect(
           sigc::mem_fun(*this, &Logic::getConfigValue));
@@ -840,6 +843,20 @@ void Logic::playDtmf(const std::string& digits, int amp, int len)
 } /* Logic::playDtmf */
 
 
+void Logic::playCw(const std::string& txt, int cpm, int fw_cpm, int fq,
+                   int amp)
+{
+  msg_handler->playCw(txt, cpm, fw_cpm, fq, amp, report_events_as_idle);
+
+  if (!msg_handler->isIdle())
+  {
+    updateTxCtcss(true, TX_CTCSS_ANNOUNCEMENT);
+  }
+
+  checkIdle();
+} /* Logic::playCw */
+
+
 void Logic::recordStart(const string& filename, unsigned max_time)
 {
   recordStop();
@@ -1204,11 +1221,29 @@ void Logic::commandPtyCmdReceived(const void *buf, size_t count)
       processEvent(event);
     }
   }
+  else if (cmd == "CLIPCACHE")
+  {
+    std::string subcmd;
+    if (!(ss >> subcmd) || !(ss >> std::ws).eof() ||
+        ((subcmd != "STATS") && (subcmd != "CLEAR")))
+    {
+      std::cerr << "*** ERROR: Invalid PTY command in logic "
+                << name() << ": \"" << cmdline << "\". "
+                << "Usage: CLIPCACHE STATS|CLEAR"
+                << std::endl;
+      return;
+    }
+    if (subcmd == "CLEAR")
+    {
+      SoundClipCache::instance().clear();
+    }
+    SoundClipCache::instance().printStats(std::cout);
+  }
   else
   {
     std::cerr << "*** ERROR: Unknown PTY command in logic "
               << name() << ": \"" << cmdline << "\". "
-              << "Valid commands are: CFG, EVENT"
+              << "Valid commands are: CFG, EVENT, CLIPCACHE"
               << std::endl;
   }
 } /* Logic::commandPtyCmdReceived */
@@ -1675,7 +1710,7 @@ void Logic::sendRgrSound(void)
 void Logic::timeoutNextMinute(void)
 {
   struct timeval tv;
-  gettimeofday(&tv, NULL);
+  Application::app().getTimeOfDay(tv);
   struct tm tm;
   localtime_r(&tv.tv_sec, &tm);
   tm.tm_min += 1;
@@ -1694,7 +1729,7 @@ void Logic::everyMinute(AtTimer *t)
 void Logic::timeoutNextSecond(void)
 {
   struct timeval tv;
-  gettimeofday(&tv, NULL);
+  Application::app().getTimeOfDay(tv);
   struct tm tm;
   localtime_r(&tv.tv_sec, &tm);
   tm.tm_sec += 1;
@@ -1825,7 +1860,7 @@ void Logic::onPublishStateEvent(const string &event_name, const string &msg)
     return;
   }
   struct timeval tv;
-  gettimeofday(&tv, NULL);
+  Application::app().getTimeOfDay(tv);
   stringstream os;
   os << setfill('0');
   os << tv.tv_sec << "." << setw(3) << tv.tv_usec / 1000 << " ";
@@ -173,6 +173,8 @@ class Logic : public LogicBase
     virtual void playSilence(int length);
     virtual void playTone(int fq, int amp, int len);
     virtual void playDtmf(const std::string& digits, int amp, int len);
+    virtual void playCw(const std::string& txt, int cpm, int fw_cpm, int fq,
+                        int amp);
     void recordStart(const std::string& filename, unsigned max_time);
     void recordStop(void);
     void injectDtmf(const std::string& digits, int len);
@@ -253,6 +253,17 @@ class LogicBase : public Async::Plugin, public sigc::trackable
      */
     virtual void playDtmf(const std::string& digits, int amp, int len) {}
 
+    /**
+     * @brief   Play a CW message
+     * @param   txt The text to send
+     * @param   cpm The character speed in characters per minute
+     * @param   fw_cpm The Farnsworth effective speed or 0 to disable
+     * @param   fq The pitch of the CW tone
+     * @param   amp The tone amplitude in "milliunits", 1000=full strength
+     */
+    virtual void playCw(const std::string& txt, int cpm, int fw_cpm, int fq,
+                        int amp) {}
+
     /**
      * @brief   A linked logic has updated its recieved talk group
      * @param   logic The pointer to the remote logic object
@@ -52,6 +52,8 @@ extern "C" {
 #include <cstring>
 #include <fstream>
 #include <cerrno>
+#include <vector>
+#include <algorithm>
 
 
 
@@ -61,6 +63,7 @@ extern "C" {
  *
  ****************************************************************************/
 
+#include <AsyncAudioNco.h>
 
 
 /****************************************************************************
@@ -70,6 +73,7 @@ extern "C" {
  ****************************************************************************/
 
 #include "MsgHandler.h"
+#include "SoundClipCache.h"
 
 
 
@@ -92,6 +96,9 @@ using namespace std;
 //#define WRITE_BLOCK_SIZE    4*160
 #define WRITE_BLOCK_SIZE    256
 
+  // The rise and fall time, in milliseconds, of the CW keying envelope
+#define CW_RISE_TIME        5
+
 
 
 /****************************************************************************
@@ -134,17 +141,18 @@ class ToneQueueItem : public QueueItem
 {
   public:
     ToneQueueItem(int fq, int amp, int len, int sample_rate, bool idle_marked)
-      : QueueItem(idle_marked), fq(fq), amp(amp),
-      	tone_len(sample_rate * len / 1000), pos(0), sample_rate(sample_rate) {}
+      : QueueItem(idle_marked), tone_len(sample_rate * len / 1000), pos(0),
+        nco(sample_rate)
+    {
+      nco.setTone(fq, amp / 1000.0f);
+    }
     int readSamples(float *samples, int len);
     void unreadSamples(int len);
 
   private:
-    int fq;
-    int amp;
-    int tone_len;
-    int pos;
-    int sample_rate;
+    int             tone_len;
+    int             pos;
+    Async::AudioNco nco;
     
 };
 
@@ -153,18 +161,47 @@ class DtmfQueueItem : public QueueItem
   public:
     DtmfQueueItem(int fqh, int fql, int amp, int len, int sample_rate,
                   bool idle_marked)
-      : QueueItem(idle_marked), fqh(fqh), fql(fql), amp(amp),
-        tone_len(sample_rate * len / 1000), pos(0), sample_rate(sample_rate) {}
+      : QueueItem(idle_marked), tone_len(sample_rate * len / 1000), pos(0),
+        nco(sample_rate)
+    {
+      nco.addTone(fqh, amp / 1000.0f);
+      nco.addTone(fql, amp / 1000.0f);
+    }
     int readSamples(float *samples, int len);
     void unreadSamples(int len);
 
   private:
-    int fqh;
-    int fql;
-    int amp;
-    int tone_len;
-    int pos;
-    int sample_rate;
+    int             tone_len;
+    int             pos;
+    Async::AudioNco nco;
+
+};
+
+class CwQueueItem : public QueueItem
+{
+  public:
+    CwQueueItem(const std::string& txt, int cpm, int farnsworth_cpm, int fq,
+                int amp, int sample_rate, bool idle_marked);
+    int readSamples(float *samples, int len);
+    void unreadSamples(int len);
+
+  private:
+    enum ElementType { SILENCE, DOT, DASH };
+    struct Element
+    {
+      ElementType type;
+      int         len;
+    };
+
+    vector<float>   dot;
+    vector<float>   dash;
+    int             rise;
+    vector<Element> elements;
+    size_t          elem_idx;
+    int             elem_pos;
+
+    void renderElement(vector<float>& wave, int len, Async::AudioNco& nco);
+    void addElement(ElementType type, int len=0);
 
 };
 
@@ -184,6 +221,20 @@ class RawFileQueueItem : public QueueItem
     
 };
 
+class ClipQueueItem : public QueueItem
+{
+  public:
+    ClipQueueItem(SoundClipCache::ClipPtr clip, bool idle_marked)
+      : QueueItem(idle_marked), clip(clip), pos(0) {}
+    int readSamples(float *samples, int len);
+    void unreadSamples(int len);
+
+  private:
+    SoundClipCache::ClipPtr clip;
+    size_t                  pos;
+
+};
+
 class GsmFileQueueItem : public QueueItem
 {
   public:
@@ -293,7 +344,12 @@ void MsgHandler::playFile(const string& path, bool idle_marked)
 {
   QueueItem *item = 0;
   const char *ext = strrchr(path.c_str(), '.');
-  if (strcmp(ext, ".gsm") == 0)
+  SoundClipCache::ClipPtr clip = SoundClipCache::instance().get(path);
+  if (clip != nullptr)
+  {
+    item = new ClipQueueItem(clip, idle_marked);
+  }
+  else if (strcmp(ext, ".gsm") == 0)
   {
     item = new GsmFileQueueItem(path, idle_marked);
   }
@@ -356,6 +412,19 @@ void MsgHandler::playDtmf(char digit, int amp, int length, bool idle_marked)
 } /* MsgHandler::playDtmf */
 
 
+void MsgHandler::playCw(const std::string& txt, int cpm, int farnsworth_cpm,
+                        int fq, int amp, bool idle_marked)
+{
+  if ((cpm <= 0) || (fq <= 0))
+  {
+    return;
+  }
+  QueueItem *item = new CwQueueItem(txt, cpm, farnsworth_cpm, fq, amp,
+                                    sample_rate, idle_marked);
+  addItemToQueue(item);
+} /* MsgHandler::playCw */
+
+
 void MsgHandler::clear(void)
 {
   clearP();
@@ -616,6 +685,28 @@ void RawFileQueueItem::unreadSamples(int len)
 
 
 
+/****************************************************************************
+ *
+ * Private member functions for class ClipQueueItem
+ *
+ ****************************************************************************/
+
+int ClipQueueItem::readSamples(float *samples, int len)
+{
+  size_t read_cnt = clip->readSamples(samples, pos, len);
+  pos += read_cnt;
+  return read_cnt;
+} /* ClipQueueItem::readSamples */
+
+
+void ClipQueueItem::unreadSamples(int len)
+{
+  assert(static_cast<size_t>(len) <= pos);
+  pos -= len;
+} /* ClipQueueItem::unreadSamples */
+
+
+
 /****************************************************************************
  *
  * Private member functions for class GsmFileQueueItem
@@ -1039,11 +1130,8 @@ void SilenceQueueItem::unreadSamples(int len)
 int ToneQueueItem::readSamples(float *samples, int len)
 {
   int read_cnt = min(len, tone_len-pos);
-  for (int i=0; i<read_cnt; ++i)
-  {
-    samples[i] = amp / 1000.0 * sin(2 * M_PI * fq * pos / sample_rate);
-    ++pos;
-  }
+  nco.generate(samples, read_cnt);
+  pos += read_cnt;
   
   return read_cnt;
   
@@ -1053,6 +1141,7 @@ int ToneQueueItem::readSamples(float *samples, int len)
 void ToneQueueItem::unreadSamples(int len)
 {
   pos -= len;
+  nco.seek(-len);
 } /* ToneQueueItem::unreadSamples */
 
 
@@ -1066,13 +1155,8 @@ void ToneQueueItem::unreadSamples(int len)
 int DtmfQueueItem::readSamples(float *samples, int len)
 {
   int read_cnt = min(len, tone_len-pos);
-  for (int i=0; i<read_cnt; ++i)
-  {
-    samples[i] = amp / 1000.0 * (
-                sin(2 * M_PI * fqh * pos / sample_rate) +
-                sin(2 * M_PI * fql * pos / sample_rate));
-    ++pos;
-  }
+  nco.generate(samples, read_cnt);
+  pos += read_cnt;
 
   return read_cnt;
 } /* DtmfQueueItem::readSamples */
@@ -1081,10 +1165,189 @@ int DtmfQueueItem::readSamples(float *samples, int len)
 void DtmfQueueItem::unreadSamples(int len)
 {
   pos -= len;
+  nco.seek(-len);
 } /* DtmfQueueItem::unreadSamples */
 
 
 
+/****************************************************************************
+ *
+ * Private member functions for class CwQueueItem
+ *
+ ****************************************************************************/
+
+CwQueueItem::CwQueueItem(const std::string& txt, int cpm, int farnsworth_cpm,
+                         int fq, int amp, int sample_rate, bool idle_marked)
+  : QueueItem(idle_marked), rise(0), elem_idx(0), elem_pos(0)
+{
+  static map<char, string> morse_map;
+  if (morse_map.empty())
+  {
+    morse_map['A'] = ".-";     morse_map['B'] = "-...";
+    morse_map['C'] = "-.-.";   morse_map['D'] = "-..";
+    morse_map['E'] = ".";      morse_map['F'] = "..-.";
+    morse_map['G'] = "--.";    morse_map['H'] = "....";
+    morse_map['I'] = "..";     morse_map['J'] = ".---";
+    morse_map['K'] = "-.-";    morse_map['L'] = ".-..";
+    morse_map['M'] = "--";     morse_map['N'] = "-.";
+    morse_map['O'] = "---";    morse_map['P'] = ".--.";
+    morse_map['Q'] = "--.-";   morse_map['R'] = ".-.";
+    morse_map['S'] = "...";    morse_map['T'] = "-";
+    morse_map['U'] = "..-";    morse_map['V'] = "...-";
+    morse_map['W'] = ".--";    morse_map['X'] = "-..-";
+    morse_map['Y'] = "-.--";   morse_map['Z'] = "--..";
+    morse_map['0'] = "-----";  morse_map['1'] = ".----";
+    morse_map['2'] = "..---";  morse_map['3'] = "...--";
+    morse_map['4'] = "....-";  morse_map['5'] = ".....";
+    morse_map['6'] = "-....";  morse_map['7'] = "--...";
+    morse_map['8'] = "---..";  morse_map['9'] = "----.";
+    morse_map['.'] = ".-.-.-"; morse_map[','] = "--..--";
+    morse_map['?'] = "..--.."; morse_map['/'] = "-..-.";
+    morse_map['='] = "-...-";
+  }
+
+    // A dot is 1.2 seconds divided by the speed in WPM, where one word
+    // ("PARIS") is five characters
+  const int dot_len = max(1, 6 * sample_rate / cpm);
+  int letter_gap = 3 * dot_len;
+  int word_gap = 7 * dot_len;
+  if ((farnsworth_cpm > 0) && (farnsworth_cpm < cpm))
+  {
+      // Farnsworth timing according to the ARRL. Characters are sent at the
+      // character speed but the spaces between characters and words are
+      // stretched to give the lower effective speed.
+    double c = cpm / 5.0;
+    double s = farnsworth_cpm / 5.0;
+    double ta = (60.0 * c - 37.2 * s) / (s * c);
+    letter_gap = lround(3.0 * ta / 19.0 * sample_rate);
+    word_gap = lround(7.0 * ta / 19.0 * sample_rate);
+  }
+
+    // The keying is shaped using a raised cosine to avoid key clicks. The
+    // edges are centered on the nominal start and end of each element so
+    // the fall of an element is played during the following space.
+  rise = min(CW_RISE_TIME * sample_rate / 1000, dot_len / 2);
+  Async::AudioNco nco(sample_rate);
+  nco.setTone(fq, amp / 1000.0f);
+  renderElement(dot, dot_len, nco);
+  renderElement(dash, 3 * dot_len, nco);
+
+  int gap = 0;
+  for (string::size_type i=0; i<txt.size(); ++i)
+  {
+    char ch = toupper(txt[i]);
+    if (ch == ' ')
+    {
+      gap = (gap == letter_gap) ? word_gap : gap + word_gap;
+      continue;
+    }
+    map<char, string>::const_iterator it = morse_map.find(ch);
+    if (it == morse_map.end())
+    {
+      continue;
+    }
+    const string& code = it->second;
+    for (string::size_type j=0; j<code.size(); ++j)
+    {
+      addElement(SILENCE, (j > 0) ? dot_len : gap);
+      addElement((code[j] == '.') ? DOT : DASH);
+    }
+    gap = letter_gap;
+  }
+  if (gap > letter_gap)
+  {
+    addElement(SILENCE, gap);
+  }
+} /* CwQueueItem::CwQueueItem */
+
+
+int CwQueueItem::readSamples(float *samples, int len)
+{
+  int read_cnt = 0;
+  while ((read_cnt < len) && (elem_idx < elements.size()))
+  {
+    const Element& elem = elements[elem_idx];
+    int cnt = min(len - read_cnt, elem.len - elem_pos);
+    if (elem.type == SILENCE)
+    {
+      memset(samples + read_cnt, 0, cnt * sizeof(*samples));
+    }
+    else
+    {
+      const vector<float>& wave = (elem.type == DOT) ? dot : dash;
+      memcpy(samples + read_cnt, &wave[elem_pos], cnt * sizeof(*samples));
+    }
+    read_cnt += cnt;
+    elem_pos += cnt;
+    if (elem_pos == elem.len)
+    {
+      elem_idx += 1;
+      elem_pos = 0;
+    }
+  }
+
+  return read_cnt;
+} /* CwQueueItem::readSamples */
+
+
+void CwQueueItem::unreadSamples(int len)
+{
+  while (len > 0)
+  {
+    if (elem_pos == 0)
+    {
+      assert(elem_idx > 0);
+      elem_idx -= 1;
+      elem_pos = elements[elem_idx].len;
+    }
+    int cnt = min(len, elem_pos);
+    elem_pos -= cnt;
+    len -= cnt;
+  }
+} /* CwQueueItem::unreadSamples */
+
+
+void CwQueueItem::renderElement(vector<float>& wave, int len,
+                                Async::AudioNco& nco)
+{
+  wave.resize(len + rise);
+  nco.reset();
+  nco.generate(&wave[0], wave.size());
+  for (int i=0; i<rise; ++i)
+  {
+    float env = 0.5f * (1.0f - cosf(M_PI * (i + 0.5f) / rise));
+    wave[i] *= env;
+    wave[wave.size() - 1 - i] *= env;
+  }
+} /* CwQueueItem::renderElement */
+
+
+void CwQueueItem::addElement(ElementType type, int len)
+{
+  switch (type)
+  {
+    case DOT:
+      len = dot.size();
+      break;
+    case DASH:
+      len = dash.size();
+      break;
+    case SILENCE:
+      if (!elements.empty() && (elements.back().type != SILENCE))
+      {
+        len -= rise;
+      }
+      break;
+  }
+  if (len > 0)
+  {
+    Element elem = { type, len };
+    elements.push_back(elem);
+  }
+} /* CwQueueItem::addElement */
+
+
+
 /*
  * This file has not been truncated
  */
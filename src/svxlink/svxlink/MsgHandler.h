@@ -179,6 +179,23 @@ class MsgHandler : public sigc::trackable, public Async::AudioSource
      *
      */
     void playDtmf(char digit, int amp, int length, bool idle_marked=false);
+
+    /**
+     * @brief 	Play a CW message
+     * @param 	txt The text to send
+     * @param 	cpm The character speed in characters per minute
+     * @param 	farnsworth_cpm The effective speed, in characters per minute,
+     *                         when using Farnsworth timing or 0 to disable
+     * @param 	fq The pitch of the CW tone
+     * @param 	amp The amplitude of the CW tone (0-1000)
+     * @param   idle_marked Choose if the playback should be idle marked or not
+     *
+     * The whole message is rendered into one queue item. The keying is
+     * shaped with a raised cosine to avoid key clicks. Characters that have
+     * no morse code are ignored.
+     */
+    void playCw(const std::string& txt, int cpm, int farnsworth_cpm, int fq,
+                int amp, bool idle_marked=false);
     
     /**
      * @brief 	Check if a message is beeing written
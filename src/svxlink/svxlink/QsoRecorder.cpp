@@ -142,7 +142,7 @@ namespace {
 QsoRecorder::QsoRecorder(Logic *logic)
   : recorder(0), hard_chunk_limit(0), soft_chunk_limit(0), max_dirsize(0),
     default_active(false), tmo_timer(0), logic(logic), qso_tmo_timer(0),
-    min_samples(0)
+    min_samples(0), file_ext("wav")
 {
   selector = new AudioSelector;
 } /* QsoRecorder::QsoRecorder */
@@ -204,6 +204,21 @@ bool QsoRecorder::initialize(const Config &cfg, const string &name)
 
   cfg.getValue(name, "ENCODER_CMD", encoder_cmd);
 
+  string format;
+  if (cfg.getValue(name, "FORMAT", format))
+  {
+    if ((format == "wav") || (format == "opus"))
+    {
+      file_ext = format;
+    }
+    else
+    {
+      cerr << "*** ERROR: Unknown format \"" << format << "\" specified in "
+           << name << "/FORMAT. Valid formats are: wav, opus\n";
+      return false;
+    }
+  }
+
   logic->idleStateChanged.connect(
       hide(mem_fun(*this, &QsoRecorder::checkTimeoutTimers)));
 
@@ -280,7 +295,7 @@ void QsoRecorder::openFile(void)
     string filename(rec_dir);
     filename += "/.qsorec_";
     filename += logic->name();
-    filename += ".wav";
+    filename += "." + file_ext;
     recorder = new AudioRecorder(filename);
     recorder->setMaxRecordingTime(hard_chunk_limit, soft_chunk_limit);
     recorder->maxRecordingTimeReached.connect(
@@ -301,13 +316,13 @@ void QsoRecorder::closeFile(void)
 {
   if (recorder != 0)
   {
-    string oldpath(rec_dir + "/.qsorec_" + logic->name() + ".wav");
+    string oldpath(rec_dir + "/.qsorec_" + logic->name() + "." + file_ext);
 
-    if (!recorder->closeFile())
+    if (recorder->droppedBlocks() > 0)
     {
-      cerr << "*** ERROR: Failed to close QsoRecorder file \"" << oldpath
-           << "\" in logic " << logic->name() << ": " << recorder->errorMsg()
-           << endl;
+      cerr << "*** WARNING: The QsoRecorder in logic " << logic->name()
+           << " dropped " << recorder->droppedBlocks() << " audio blocks "
+           << "since the disk could not keep up" << endl;
     }
 
     if (recorder->samplesWritten() > min_samples)
@@ -327,46 +342,26 @@ void QsoRecorder::closeFile(void)
       localtime_r(&end_time.tv_sec, &tm);
       strftime(timestamp, sizeof(timestamp), "%Y-%m-%d_%H%M%S", &tm);
       basename += timestamp;
-      string newpath = rec_dir + "/" + basename + ".wav";
+
+        // The writer thread write to an open file descriptor so it is safe
+        // to rename the file before it has been completely written
+      string newpath = rec_dir + "/" + basename + "." + file_ext;
       if (rename(oldpath.c_str(), newpath.c_str()) != 0)
       {
         perror("QsoRecorder rename");
       }
 
-      cout << logic->name() << ": Wrote QSO recorder file "
-           << basename << ".wav\n";
-
-        // Execute external audio file handler (e.g. encoder) if configured
-      if (!encoder_cmd.empty())
+      if (!recorder->closeFile(
+            sigc::bind(mem_fun(*this, &QsoRecorder::fileWritten), basename)))
       {
-        cout << logic->name() << ": Starting encoding for file "
-             << basename << ".wav\n";
-        const char *shell = getenv("SHELL");
-        if (shell == NULL)
-        {
-          shell = "/bin/sh";
-        }
-        FileEncoder *enc = new FileEncoder(shell, basename);
-        enc->appendArgument("-c");
-        string cmdline(encoder_cmd);
-        replace_all(cmdline, "%f", newpath);
-        replace_all(cmdline, "%d", rec_dir);
-        replace_all(cmdline, "%b", basename);
-        replace_all(cmdline, "%n", basename + ".wav");
-        enc->appendArgument(cmdline);
-        enc->stdoutData.connect(
-            mem_fun(*this, &QsoRecorder::handleEncoderPrintouts));
-        enc->stderrData.connect(
-            mem_fun(*this, &QsoRecorder::handleEncoderPrintouts));
-        enc->exited.connect(
-            sigc::bind(mem_fun(*this, &QsoRecorder::encoderExited), enc));
-        enc->nice();
-        enc->setTimeout(60*60); // One hour timeout
-        enc->run();
+        cerr << "*** ERROR: Failed to close QsoRecorder file \"" << newpath
+             << "\" in logic " << logic->name() << ": "
+             << recorder->errorMsg() << endl;
       }
     }
     else
     {
+      recorder->closeFile();
       if (unlink(oldpath.c_str()) != 0)
       {
         perror("QsoRecorder unlink");
@@ -381,6 +376,56 @@ void QsoRecorder::closeFile(void)
 } /* QsoRecorder::closeFile */
 
 
+void QsoRecorder::fileWritten(bool success, std::string basename)
+{
+  if (!success)
+  {
+    cerr << "*** ERROR: Failed to write QsoRecorder file \"" << basename
+         << "." << file_ext << "\" in logic " << logic->name() << endl;
+    return;
+  }
+
+  cout << logic->name() << ": Wrote QSO recorder file "
+       << basename << "." << file_ext << "\n";
+
+    // Execute external audio file handler (e.g. encoder) if configured
+  if (!encoder_cmd.empty())
+  {
+    startEncoder(basename);
+  }
+} /* QsoRecorder::fileWritten */
+
+
+void QsoRecorder::startEncoder(const std::string& basename)
+{
+  string filename = basename + "." + file_ext;
+  cout << logic->name() << ": Starting encoding for file "
+       << filename << "\n";
+  const char *shell = getenv("SHELL");
+  if (shell == NULL)
+  {
+    shell = "/bin/sh";
+  }
+  FileEncoder *enc = new FileEncoder(shell, basename);
+  enc->appendArgument("-c");
+  string cmdline(encoder_cmd);
+  replace_all(cmdline, "%f", rec_dir + "/" + filename);
+  replace_all(cmdline, "%d", rec_dir);
+  replace_all(cmdline, "%b", basename);
+  replace_all(cmdline, "%n", filename);
+  enc->appendArgument(cmdline);
+  enc->stdoutData.connect(
+      mem_fun(*this, &QsoRecorder::handleEncoderPrintouts));
+  enc->stderrData.connect(
+      mem_fun(*this, &QsoRecorder::handleEncoderPrintouts));
+  enc->exited.connect(
+      sigc::bind(mem_fun(*this, &QsoRecorder::encoderExited), enc));
+  enc->nice();
+  enc->setTimeout(60*60); // One hour timeout
+  enc->run();
+} /* QsoRecorder::startEncoder */
+
+
 void QsoRecorder::cleanupDirectory(void)
 {
   if (max_dirsize == 0)
@@ -465,7 +510,7 @@ void QsoRecorder::handleEncoderPrintouts(const char *buf, int cnt)
 void QsoRecorder::encoderExited(QsoRecorder::FileEncoder *enc)
 {
   cout << logic->name() << ": Encoding done for file "
-             << enc->basename << ".wav\n";
+             << enc->basename << "." << file_ext << "\n";
   if (enc->ifExited() && (enc->exitStatus() != 0))
   {
     cerr << "*** ERROR: QSO recorder external audio file handler in logic "
@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <string>
+#include <sigc++/sigc++.h>
 
 
 /****************************************************************************
@@ -115,8 +116,13 @@ class Logic;
 @brief	The QSO recorder is used to write radio traffic to file
 @author Tobias Blomberg / SM0SVX
 @date   2009-06-06
+
+The audio is written to file by a background thread in the AudioRecorder.
+When a chunk is closed, the file is renamed right away but the external
+encoder command is not started until the writer thread has finished writing
+the file.
 */
-class QsoRecorder
+class QsoRecorder : public sigc::trackable
 {
   public:
     /**
@@ -191,12 +197,15 @@ class QsoRecorder
     Async::Timer          *qso_tmo_timer;
     unsigned              min_samples;
     std::string           encoder_cmd;
+    std::string           file_ext;
 
     QsoRecorder(const QsoRecorder&);
     QsoRecorder& operator=(const QsoRecorder&);
     void openNewFile(void);
     void openFile(void);
     void closeFile(void);
+    void fileWritten(bool success, std::string basename);
+    void startEncoder(const std::string& basename);
     void cleanupDirectory(void);
     void timerExpired(void);
     void checkTimeoutTimers(void);
@@ -170,7 +170,8 @@ ReflectorLogic::ReflectorLogic(void)
   : m_msg_type(0), m_udp_sock(0),
     m_logic_con_in(0), m_logic_con_out(0),
     m_reconnect_timer(60000, Timer::TYPE_ONESHOT, false),
-    /*m_next_udp_tx_seq(0),*/ m_next_udp_rx_seq(0),
+    /*m_next_udp_tx_seq(0),*/ m_rx_fifo(0), m_jitter_buffer_delay(0),
+    m_lost_frame_cnt(0), m_concealed_frames(0),
     m_heartbeat_timer(1000, Timer::TYPE_PERIODIC, false), m_dec(0),
     m_flush_timeout_timer(3000, Timer::TYPE_ONESHOT, false),
     m_udp_heartbeat_tx_cnt_reset(DEFAULT_UDP_HEARTBEAT_TX_CNT_RESET),
@@ -195,6 +196,10 @@ ReflectorLogic::ReflectorLogic(void)
       mem_fun(*this, &ReflectorLogic::handleTimerTick));
   m_flush_timeout_timer.expired.connect(
       mem_fun(*this, &ReflectorLogic::flushTimeout));
+  m_udp_jitter_buf.frameReceived.connect(
+      mem_fun(*this, &ReflectorLogic::handleUdpMsg));
+  m_udp_jitter_buf.frameLost.connect(
+      mem_fun(*this, &ReflectorLogic::udpFrameLost));
   timerclear(&m_last_talker_timestamp);
 
   m_tg_select_timer.expired.connect(sigc::hide(
@@ -523,15 +528,19 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
   prev_src = m_dec;
 
     // Create jitter buffer
-  AudioFifo *fifo = new Async::AudioFifo(2*INTERNAL_SAMPLE_RATE);
-  prev_src->registerSink(fifo, true);
-  prev_src = fifo;
-  unsigned jitter_buffer_delay = 0;
-  cfg().getValue(name(), "JITTER_BUFFER_DELAY", jitter_buffer_delay);
-  if (jitter_buffer_delay > 0)
+  m_rx_fifo = new Async::AudioFifo(2*INTERNAL_SAMPLE_RATE);
+  prev_src->registerSink(m_rx_fifo, true);
+  prev_src = m_rx_fifo;
+  cfg().getValue(name(), "JITTER_BUFFER_DELAY", m_jitter_buffer_delay);
+  if (m_jitter_buffer_delay > 0)
   {
-    fifo->setPrebufSamples(jitter_buffer_delay * INTERNAL_SAMPLE_RATE / 1000);
+    m_rx_fifo->setPrebufSamples(
+        m_jitter_buffer_delay * INTERNAL_SAMPLE_RATE / 1000);
   }
+  unsigned jitter_buffer_max_delay = DEFAULT_JITTER_BUFFER_MAX_DELAY;
+  cfg().getValue(name(), "JITTER_BUFFER_MAX_DELAY", jitter_buffer_max_delay);
+  m_udp_jitter_buf.setDelayLimits(m_jitter_buffer_delay,
+                                  jitter_buffer_max_delay);
 
   prev_src->registerSink(m_logic_con_out, true);
   prev_src = 0;
@@ -577,6 +586,8 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
           sigc::mem_fun(*this, &ReflectorLogic::handlePlayTone));
     m_event_handler->playDtmf.connect(
           sigc::mem_fun(*this, &ReflectorLogic::handlePlayDtmf));
+    m_event_handler->playCw.connect(
+          sigc::mem_fun(*this, &ReflectorLogic::handlePlayCw));
   }
   m_event_handler->getConfigValue.connect(
       sigc::mem_fun(*this, &ReflectorLogic::getConfigValue));
@@ -994,7 +1005,9 @@ void ReflectorLogic::onConnected(void)
   m_tcp_heartbeat_rx_cnt = TCP_HEARTBEAT_RX_CNT_RESET;
   m_heartbeat_timer.setEnable(true);
   //m_next_udp_tx_seq = 0;
-  m_next_udp_rx_seq = 0;
+  m_udp_jitter_buf.reset();
+  m_lost_frame_cnt = 0;
+  m_concealed_frames = 0;
   timerclear(&m_last_talker_timestamp);
   //m_con_state = STATE_EXPECT_AUTH_CHALLENGE;
   //m_con.setMaxFrameSize(ReflectorMsg::MAX_SSL_SETUP_FRAME_SIZE);
@@ -1015,7 +1028,7 @@ void ReflectorLogic::onDisconnected(TcpConnection*,
   delete m_udp_sock;
   m_udp_sock = 0;
   //m_next_udp_tx_seq = 0;
-  m_next_udp_rx_seq = 0;
+  m_udp_jitter_buf.reset();
   m_heartbeat_timer.setEnable(false);
   if (m_flush_timeout_timer.isEnabled())
   {
@@ -2122,6 +2135,86 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     return;
   }
 
+    // Put the frames back in sequence. The jitter buffer will call
+    // handleUdpMsg for each frame in order and udpFrameLost for frames
+    // that did not arrive in time.
+  m_udp_jitter_buf.writeFrame(m_aad.iv_cntr, buf, count);
+} /* ReflectorLogic::udpDatagramReceived */
+
+
+void ReflectorLogic::udpFrameLost(UdpJitterBuffer::Seq seq,
+                                  const void *next_buf, int next_count)
+{
+    // Only conceal short losses in the middle of a talk spurt. The lost frame
+    // may also have been a heartbeat or a flush message but that cannot be
+    // known.
+  if (!timerisset(&m_last_talker_timestamp) ||
+      (++m_lost_frame_cnt > MAX_CONCEALED_FRAMES))
+  {
+    return;
+  }
+
+    // Find the audio data in the next frame, if available, so that the
+    // decoder can use any forward error correction data in it
+  MsgUdpAudio next_msg;
+  if (next_buf != nullptr)
+  {
+    stringstream ss;
+    ss.write(reinterpret_cast<const char *>(next_buf), next_count);
+    ReflectorUdpMsg header;
+    if (!header.unpack(ss) || (header.type() != MsgUdpAudio::TYPE) ||
+        !next_msg.unpack(ss))
+    {
+      next_msg.audioData().clear();
+    }
+  }
+  const std::vector<uint8_t>& next_audio = next_msg.audioData();
+  if (m_dec->concealLostFrame(next_audio.empty() ? nullptr : &next_audio[0],
+                              next_audio.size()))
+  {
+    m_concealed_frames += 1;
+  }
+} /* ReflectorLogic::udpFrameLost */
+
+
+void ReflectorLogic::sendRxJitterBufferStatus(void)
+{
+  if (m_udp_jitter_buf.lostFrames() + m_udp_jitter_buf.lateFrames() > 0)
+  {
+    std::cout << name() << ": UDP receive statistics: "
+              << "received=" << m_udp_jitter_buf.receivedFrames()
+              << " reordered=" << m_udp_jitter_buf.reorderedFrames()
+              << " late=" << m_udp_jitter_buf.lateFrames()
+              << " lost=" << m_udp_jitter_buf.lostFrames()
+              << " concealed=" << m_concealed_frames
+              << " jitter=" << std::fixed << std::setprecision(1)
+              << m_udp_jitter_buf.jitter() << "ms"
+              << std::defaultfloat << std::endl;
+  }
+
+  if (!isLoggedIn())
+  {
+    return;
+  }
+
+  Json::Value status(Json::objectValue);
+  status["jitter"] = m_udp_jitter_buf.jitter();
+  status["targetDelay"] = m_udp_jitter_buf.targetDelay();
+  status["received"] = Json::UInt64(m_udp_jitter_buf.receivedFrames());
+  status["reordered"] = Json::UInt64(m_udp_jitter_buf.reorderedFrames());
+  status["late"] = Json::UInt64(m_udp_jitter_buf.lateFrames());
+  status["lost"] = Json::UInt64(m_udp_jitter_buf.lostFrames());
+  status["concealed"] = Json::UInt64(m_concealed_frames);
+  Json::StreamWriterBuilder builder;
+  builder["commentStyle"] = "None";
+  builder["indentation"] = "";
+  sendMsg(MsgStateEvent(name(), "Reflector:rx_jitter_buffer",
+                        Json::writeString(builder, status)));
+} /* ReflectorLogic::sendRxJitterBufferStatus */
+
+
+void ReflectorLogic::handleUdpMsg(const void *buf, int count)
+{
   stringstream ss;
   ss.write(reinterpret_cast<const char *>(buf), count);
 
@@ -2141,24 +2234,7 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
   //  return;
   //}
 
-    // Check sequence number
-  if (m_aad.iv_cntr < m_next_udp_rx_seq) // Frame out of sequence (ignore)
-  {
-    std::cout << name()
-              << ": Dropping out of sequence UDP frame with seq="
-              << m_aad.iv_cntr << std::endl;
-    return;
-  }
-  else if (m_aad.iv_cntr > m_next_udp_rx_seq) // Frame lost
-  {
-    std::cout << name() << ": UDP frame(s) lost. Expected seq="
-              << m_next_udp_rx_seq
-              << " but received " << m_aad.iv_cntr
-              << ". Resetting next expected sequence number to "
-              << (m_aad.iv_cntr + 1) << std::endl;
-  }
-  m_next_udp_rx_seq = m_aad.iv_cntr + 1;
-
+  m_lost_frame_cnt = 0;
   m_udp_heartbeat_rx_cnt = UDP_HEARTBEAT_RX_CNT_RESET;
 
   if ((m_con_state == STATE_EXPECT_UDP_HEARTBEAT) &&
@@ -2204,6 +2280,14 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
       }
       if (!msg.audioData().empty())
       {
+        if (!timerisset(&m_last_talker_timestamp))
+        {
+            // Start of a new talk spurt. Adapt the playout delay to the
+            // currently measured network jitter.
+          unsigned delay = std::max(m_jitter_buffer_delay,
+                                    m_udp_jitter_buf.targetDelay());
+          m_rx_fifo->setPrebufSamples(delay * INTERNAL_SAMPLE_RATE / 1000);
+        }
         gettimeofday(&m_last_talker_timestamp, NULL);
         m_dec->writeEncodedSamples(
             &msg.audioData().front(), msg.audioData().size());
@@ -2214,6 +2298,7 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     case MsgUdpFlushSamples::TYPE:
       m_dec->flushEncodedSamples();
       timerclear(&m_last_talker_timestamp);
+      sendRxJitterBufferStatus();
       break;
 
     case MsgUdpAllSamplesFlushed::TYPE:
@@ -2229,7 +2314,7 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
       //     << header.type() << endl;
       break;
   }
-} /* ReflectorLogic::udpDatagramReceived */
+} /* ReflectorLogic::handleUdpMsg */
 
 void ReflectorLogic::sendUdpMsg(const UdpCipher::AAD& aad,
                                 const ReflectorUdpMsg& msg)
@@ -2713,6 +2798,14 @@ void ReflectorLogic::handlePlayDtmf(const std::string& digit, int amp,
 } /* ReflectorLogic::handlePlayDtmf */
 
 
+void ReflectorLogic::handlePlayCw(const std::string& txt, int cpm, int fw_cpm,
+                                  int fq, int amp)
+{
+  setIdle(false);
+  LinkManager::instance()->playCw(this, txt, cpm, fw_cpm, fq, amp);
+} /* ReflectorLogic::handlePlayCw */
+
+
 bool ReflectorLogic::getConfigValue(const std::string& section,
                                     const std::string& tag,
                                     std::string& value)
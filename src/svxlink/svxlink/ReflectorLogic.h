@@ -61,6 +61,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "LogicBase.h"
+#include "UdpJitterBuffer.h"
 #include "../reflector/ReflectorMsg.h"
 
 
@@ -223,6 +224,8 @@ class ReflectorLogic : public LogicBase
     static const unsigned TCP_HEARTBEAT_RX_CNT_RESET          = 15;
     static const unsigned DEFAULT_TG_SELECT_TIMEOUT           = 30;
     static const int      DEFAULT_TMP_MONITOR_TIMEOUT         = 3600;
+    static const unsigned DEFAULT_JITTER_BUFFER_MAX_DELAY     = 200;
+    static const unsigned MAX_CONCEALED_FRAMES                = 5;
 
     std::string                       m_reflector_host;
     FramedTcpClient                   m_con;
@@ -234,7 +237,11 @@ class ReflectorLogic : public LogicBase
     Async::AudioStreamStateDetector*  m_logic_con_out;
     Async::Timer                      m_reconnect_timer;
     //uint16_t                          m_next_udp_tx_seq;
-    UdpCipher::IVCntr                 m_next_udp_rx_seq;
+    UdpJitterBuffer                   m_udp_jitter_buf;
+    Async::AudioFifo*                 m_rx_fifo;
+    unsigned                          m_jitter_buffer_delay;
+    unsigned                          m_lost_frame_cnt;
+    uint64_t                          m_concealed_frames;
     Async::Timer                      m_heartbeat_timer;
     Async::AudioDecoder*              m_dec;
     Async::Timer                      m_flush_timeout_timer;
@@ -317,6 +324,10 @@ class ReflectorLogic : public LogicBase
                                void *buf, int count);
     void udpDatagramReceived(const Async::IpAddress& addr, uint16_t port,
                              void* aad, void *buf, int count);
+    void handleUdpMsg(const void *buf, int count);
+    void udpFrameLost(UdpJitterBuffer::Seq seq, const void *next_buf,
+                      int next_count);
+    void sendRxJitterBufferStatus(void);
     void sendUdpMsg(const UdpCipher::AAD& aad, const ReflectorUdpMsg& msg);
     void sendUdpMsg(const ReflectorUdpMsg& msg);
     void sendUdpRegisterMsg(void);
@@ -344,6 +355,8 @@ class ReflectorLogic : public LogicBase
     void handlePlaySilence(int duration);
     void handlePlayTone(int fq, int amp, int duration);
     void handlePlayDtmf(const std::string& digit, int amp, int duration);
+    void handlePlayCw(const std::string& txt, int cpm, int fw_cpm, int fq,
+                      int amp);
     bool getConfigValue(const std::string& section, const std::string& tag,
                         std::string& value);
     bool loadClientCertificate(void);
@@ -395,6 +395,8 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
           sigc::mem_fun(*this, &ReflectorLogic::handlePlayTone));
     m_event_handler->playDtmf.connect(
           sigc::mem_fun(*this, &ReflectorLogic::handlePlayDtmf));
+    m_event_handler->playCw.connect(
+          sigc::mem_fun(*this, &ReflectorLogic::handlePlayCw));
   }
   m_event_handler->getConfigValue.connect(
       sigc::mem_fun(*this, &ReflectorLogic::getConfigValue));
@@ -1900,6 +1902,14 @@ void ReflectorLogic::handlePlayDtmf(const std::string& digit, int amp,
 } /* ReflectorLogic::handlePlayDtmf */
 
 
+void ReflectorLogic::handlePlayCw(const std::string& txt, int cpm, int fw_cpm,
+                                  int fq, int amp)
+{
+  setIdle(false);
+  LinkManager::instance()->playCw(this, txt, cpm, fw_cpm, fq, amp);
+} /* ReflectorLogic::handlePlayCw */
+
+
 bool ReflectorLogic::getConfigValue(const std::string& section,
                                     const std::string& tag,
                                     std::string& value)
@@ -49,6 +49,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncApplication.h>
 #include <AsyncTimer.h>
 #include <AsyncConfig.h>
 
@@ -574,7 +575,7 @@ void RepeaterLogic::setUp(bool up, string reason)
   {
     if (reason != "SQL_FLAP_SUP")
     {
-      gettimeofday(&rpt_close_timestamp, NULL);
+      Application::app().getTimeOfDay(rpt_close_timestamp);
     }
     else
     {
@@ -607,7 +608,7 @@ void RepeaterLogic::squelchOpen(bool is_open)
   
   if (is_open)
   {
-    gettimeofday(&sql_up_timestamp, NULL);
+    Application::app().getTimeOfDay(sql_up_timestamp);
   }
 
   if (repeater_is_up)
@@ -619,7 +620,7 @@ void RepeaterLogic::squelchOpen(bool is_open)
     else
     {
       struct timeval now, diff_tv;
-      gettimeofday(&now, NULL);
+      Application::app().getTimeOfDay(now);
       timersub(&now, &sql_up_timestamp, &diff_tv);
       int diff_ms = diff_tv.tv_sec * 1000 + diff_tv.tv_usec / 1000;
 	
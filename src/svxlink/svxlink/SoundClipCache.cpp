@@ -0,0 +1,632 @@
+/**
+@file	 SoundClipCache.cpp
+@brief   A process wide cache of decoded audio clips
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-18
+
+This file contains a cache of decoded audio clips that is shared by the
+message handlers of all logic cores.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+
+extern "C" {
+#include <gsm.h>
+}
+
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncMetrics.h>
+#include <AsyncAudioVectorOps.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "SoundClipCache.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+#define GSM_FRAME_SIZE    33
+#define GSM_FRAME_SAMPLES 160
+
+
+/****************************************************************************
+ *
+ * Static class variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+static std::string fileExtension(const std::string& path)
+{
+  std::string::size_type dot = path.rfind('.');
+  std::string::size_type slash = path.rfind('/');
+  if ((dot == std::string::npos) ||
+      ((slash != std::string::npos) && (dot < slash)))
+  {
+    return "";
+  }
+  return path.substr(dot);
+} /* fileExtension */
+
+
+static bool readAll(int fd, void *buf, size_t len)
+{
+  char *ptr = reinterpret_cast<char*>(buf);
+  while (len > 0)
+  {
+    ssize_t cnt = ::read(fd, ptr, len);
+    if (cnt < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return false;
+    }
+    if (cnt == 0)
+    {
+      return false;
+    }
+    ptr += cnt;
+    len -= cnt;
+  }
+  return true;
+} /* readAll */
+
+
+static uint32_t read32bitValue(const uint8_t *ptr)
+{
+  return ptr[0] + (ptr[1] << 8) + (ptr[2] << 16) +
+         (static_cast<uint32_t>(ptr[3]) << 24);
+} /* read32bitValue */
+
+
+static uint16_t read16bitValue(const uint8_t *ptr)
+{
+  return ptr[0] + (ptr[1] << 8);
+} /* read16bitValue */
+
+
+static Metrics::Counter& lookupCounter(const char* result)
+{
+  return Metrics::instance().counter("svxlink_sound_clip_cache_lookups_total",
+      "Number of sound clips served from, or missing in, the clip cache",
+      Metrics::label("result", result));
+} /* lookupCounter */
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+SoundClipCache::Clip::~Clip(void)
+{
+  if (map_addr != nullptr)
+  {
+    ::munmap(map_addr, map_len);
+  }
+} /* SoundClipCache::Clip::~Clip */
+
+
+size_t SoundClipCache::Clip::readSamples(float *dest, size_t pos,
+                                         size_t count) const
+{
+  if (pos >= sample_cnt)
+  {
+    return 0;
+  }
+  count = std::min(count, sample_cnt - pos);
+  if (pcm != nullptr)
+  {
+    convertS16ToFloat(dest, pcm + pos, 1, count);
+  }
+  else
+  {
+    std::memcpy(dest, samples.data() + pos, count * sizeof(*dest));
+  }
+  return count;
+} /* SoundClipCache::Clip::readSamples */
+
+
+size_t SoundClipCache::Clip::memSize(void) const
+{
+  return sizeof(*this) + map_len + samples.capacity() * sizeof(float);
+} /* SoundClipCache::Clip::memSize */
+
+
+SoundClipCache& SoundClipCache::instance(void)
+{
+  static SoundClipCache cache;
+  return cache;
+} /* SoundClipCache::instance */
+
+
+SoundClipCache::~SoundClipCache(void)
+{
+} /* SoundClipCache::~SoundClipCache */
+
+
+void SoundClipCache::setMaxSize(size_t max_size)
+{
+  this->max_size = max_size;
+  evict(0);
+  updateMetrics();
+} /* SoundClipCache::setMaxSize */
+
+
+SoundClipCache::ClipPtr SoundClipCache::get(const std::string& path)
+{
+  return getClip(path, false);
+} /* SoundClipCache::get */
+
+
+unsigned SoundClipCache::preloadDirectory(const std::string& dir)
+{
+  unsigned cnt = 0;
+  if (isEnabled() && !preloadDir(dir, cnt))
+  {
+    std::cerr << "*** WARNING: The sound clip cache is full. Not all "
+                 "sound clips in \"" << dir << "\" were preloaded."
+              << std::endl;
+  }
+  updateMetrics();
+  return cnt;
+} /* SoundClipCache::preloadDirectory */
+
+
+void SoundClipCache::clear(void)
+{
+  entries.clear();
+  lru.clear();
+  cur_size = 0;
+  updateMetrics();
+} /* SoundClipCache::clear */
+
+
+void SoundClipCache::printStats(std::ostream& os) const
+{
+  uint64_t lookups = hits + misses;
+  os << "Sound clip cache: " << entries.size() << " clips, "
+     << (cur_size / 1024) << "/" << (max_size / 1024) << " kB, "
+     << hits << " hits, " << misses << " misses";
+  if (lookups > 0)
+  {
+    os << " (" << std::fixed << std::setprecision(1)
+       << (100.0 * hits / lookups) << "% hit rate)";
+  }
+  os << ", " << evictions << " evictions" << std::endl;
+} /* SoundClipCache::printStats */
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+SoundClipCache::ClipPtr SoundClipCache::getClip(const std::string& path,
+                                                bool preload)
+{
+  if (!isEnabled())
+  {
+    return nullptr;
+  }
+
+  struct stat st;
+  if ((::stat(path.c_str(), &st) != 0) || !S_ISREG(st.st_mode))
+  {
+    return nullptr;
+  }
+
+  Entries::iterator it = entries.find(path);
+  if (it != entries.end())
+  {
+    Entry& entry = it->second;
+    if ((entry.dev == st.st_dev) && (entry.ino == st.st_ino) &&
+        (entry.size == st.st_size) && (entry.mtime == st.st_mtime))
+    {
+      lru.splice(lru.begin(), lru, entry.lru_it);
+      if (!preload)
+      {
+        ++hits;
+        lookupCounter("hit").inc();
+      }
+      return entry.clip;
+    }
+      // The file has been modified since it was loaded
+    erase(it);
+  }
+
+  if (!preload)
+  {
+    ++misses;
+    lookupCounter("miss").inc();
+  }
+
+  size_t est_size = estimatedSize(path, st.st_size);
+  if (est_size > max_size / MAX_CLIP_SIZE_DIVISOR)
+  {
+    return nullptr;
+  }
+  if (preload && (cur_size + est_size > max_size))
+  {
+    return nullptr;
+  }
+
+  ClipPtr clip = loadClip(path, st.st_size);
+  if (clip == nullptr)
+  {
+    return nullptr;
+  }
+
+  evict(clip->memSize());
+  lru.push_front(path);
+  Entry& entry = entries[path];
+  entry.clip = clip;
+  entry.dev = st.st_dev;
+  entry.ino = st.st_ino;
+  entry.size = st.st_size;
+  entry.mtime = st.st_mtime;
+  entry.lru_it = lru.begin();
+  cur_size += clip->memSize();
+  updateMetrics();
+
+  return clip;
+} /* SoundClipCache::getClip */
+
+
+bool SoundClipCache::preloadDir(const std::string& dir, unsigned& cnt)
+{
+  DIR *dirp = ::opendir(dir.c_str());
+  if (dirp == nullptr)
+  {
+    std::cerr << "*** WARNING: Could not open sound clip directory \""
+              << dir << "\": " << std::strerror(errno) << std::endl;
+    return true;
+  }
+
+  std::vector<std::string> names;
+  struct dirent *dirent;
+  while ((dirent = ::readdir(dirp)) != nullptr)
+  {
+    if (dirent->d_name[0] != '.')
+    {
+      names.push_back(dirent->d_name);
+    }
+  }
+  ::closedir(dirp);
+  std::sort(names.begin(), names.end());
+
+  for (const auto& name : names)
+  {
+    std::string path = dir + "/" + name;
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0)
+    {
+      continue;
+    }
+    if (S_ISDIR(st.st_mode))
+    {
+      if (!preloadDir(path, cnt))
+      {
+        return false;
+      }
+      continue;
+    }
+    const std::string ext = fileExtension(path);
+    if (!S_ISREG(st.st_mode) ||
+        ((ext != ".raw") && (ext != ".gsm") && (ext != ".wav")))
+    {
+      continue;
+    }
+    if (cur_size + estimatedSize(path, st.st_size) > max_size)
+    {
+      return false;
+    }
+    if (getClip(path, true) != nullptr)
+    {
+      ++cnt;
+    }
+  }
+
+  return true;
+} /* SoundClipCache::preloadDir */
+
+
+void SoundClipCache::erase(Entries::iterator it)
+{
+  cur_size -= it->second.clip->memSize();
+  lru.erase(it->second.lru_it);
+  entries.erase(it);
+} /* SoundClipCache::erase */
+
+
+void SoundClipCache::evict(size_t needed)
+{
+  while (!lru.empty() && (cur_size + needed > max_size))
+  {
+    erase(entries.find(lru.back()));
+    ++evictions;
+    Metrics::instance().counter("svxlink_sound_clip_cache_evictions_total",
+        "Number of clips evicted from the sound clip cache").inc();
+  }
+} /* SoundClipCache::evict */
+
+
+void SoundClipCache::updateMetrics(void)
+{
+  static Metrics::Gauge& size_gauge = Metrics::instance().gauge(
+      "svxlink_sound_clip_cache_bytes",
+      "Memory used by the clips in the sound clip cache");
+  static Metrics::Gauge& entries_gauge = Metrics::instance().gauge(
+      "svxlink_sound_clip_cache_entries",
+      "Number of clips in the sound clip cache");
+  size_gauge.set(cur_size);
+  entries_gauge.set(entries.size());
+} /* SoundClipCache::updateMetrics */
+
+
+size_t SoundClipCache::estimatedSize(const std::string& path,
+                                     size_t file_size)
+{
+  if (fileExtension(path) == ".gsm")
+  {
+    return file_size / GSM_FRAME_SIZE * GSM_FRAME_SAMPLES * sizeof(float);
+  }
+  return file_size;
+} /* SoundClipCache::estimatedSize */
+
+
+SoundClipCache::ClipPtr SoundClipCache::loadClip(const std::string& path,
+                                                 size_t file_size)
+{
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+  {
+    return nullptr;
+  }
+
+  ClipPtr clip;
+  const std::string ext = fileExtension(path);
+  if (ext == ".gsm")
+  {
+    clip = loadGsm(fd, file_size);
+  }
+  else if (ext == ".wav")
+  {
+    clip = loadWav(fd, file_size);
+  }
+  else
+  {
+    clip = loadRaw(fd, file_size);
+  }
+  ::close(fd);
+
+  return clip;
+} /* SoundClipCache::loadClip */
+
+
+SoundClipCache::ClipPtr SoundClipCache::loadRaw(int fd, size_t file_size)
+{
+  std::shared_ptr<Clip> clip(new Clip);
+  if (file_size < sizeof(int16_t))
+  {
+    return clip;
+  }
+
+    // Populate the mapping right away so that the file is not read from
+    // disk while the clip is being played
+  void *addr = ::mmap(nullptr, file_size, PROT_READ,
+                      MAP_PRIVATE | MAP_POPULATE, fd, 0);
+  if (addr == MAP_FAILED)
+  {
+    return nullptr;
+  }
+  clip->map_addr = addr;
+  clip->map_len = file_size;
+  clip->pcm = reinterpret_cast<const int16_t*>(addr);
+  clip->sample_cnt = file_size / sizeof(int16_t);
+  return clip;
+} /* SoundClipCache::loadRaw */
+
+
+SoundClipCache::ClipPtr SoundClipCache::loadWav(int fd, size_t file_size)
+{
+    // Only the formats handled by the WAV file player are accepted. Other
+    // files are left for the player to report on.
+  if (file_size < 12)
+  {
+    return nullptr;
+  }
+  void *addr = ::mmap(nullptr, file_size, PROT_READ,
+                      MAP_PRIVATE | MAP_POPULATE, fd, 0);
+  if (addr == MAP_FAILED)
+  {
+    return nullptr;
+  }
+  std::shared_ptr<Clip> clip(new Clip);
+  clip->map_addr = addr;
+  clip->map_len = file_size;
+
+  const uint8_t *base = reinterpret_cast<const uint8_t*>(addr);
+  if ((std::memcmp(base, "RIFF", 4) != 0) ||
+      (std::memcmp(base + 8, "WAVE", 4) != 0))
+  {
+    return nullptr;
+  }
+
+  bool fmt_ok = false;
+  size_t data_pos = 0;
+  size_t data_len = 0;
+  size_t pos = 12;
+  while (pos + 8 <= file_size)
+  {
+    const uint8_t *subchunk = base + pos;
+    size_t subchunk_size = read32bitValue(subchunk + 4);
+    pos += 8;
+    if (subchunk_size > file_size - pos)
+    {
+      return nullptr;
+    }
+    if (std::memcmp(subchunk, "fmt ", 4) == 0)
+    {
+      const uint8_t *fmt = subchunk + 8;
+      fmt_ok = (subchunk_size == 16) &&
+               (read16bitValue(fmt) == 1) &&
+               (read16bitValue(fmt + 2) == 1) &&
+               (read32bitValue(fmt + 4) == INTERNAL_SAMPLE_RATE) &&
+               (read16bitValue(fmt + 14) == 16);
+    }
+    else if (std::memcmp(subchunk, "data", 4) == 0)
+    {
+      data_pos = pos;
+      data_len = subchunk_size;
+    }
+    pos += subchunk_size;
+  }
+  if (!fmt_ok || (data_pos == 0))
+  {
+    return nullptr;
+  }
+
+  clip->sample_cnt = data_len / sizeof(int16_t);
+  if (data_pos % alignof(int16_t) == 0)
+  {
+    clip->pcm = reinterpret_cast<const int16_t*>(base + data_pos);
+  }
+  else
+  {
+      // Unaligned sample data. Convert it and drop the mapping.
+    std::vector<int16_t> pcm(clip->sample_cnt);
+    std::memcpy(pcm.data(), base + data_pos, pcm.size() * sizeof(int16_t));
+    clip->samples.resize(clip->sample_cnt);
+    convertS16ToFloat(clip->samples.data(), pcm.data(), 1, pcm.size());
+    ::munmap(clip->map_addr, clip->map_len);
+    clip->map_addr = nullptr;
+    clip->map_len = 0;
+  }
+  return clip;
+} /* SoundClipCache::loadWav */
+
+
+SoundClipCache::ClipPtr SoundClipCache::loadGsm(int fd, size_t file_size)
+{
+    // A truncated file is left for the player to report on
+  if (file_size % GSM_FRAME_SIZE != 0)
+  {
+    return nullptr;
+  }
+
+  std::vector<uint8_t> data(file_size);
+  if (!readAll(fd, data.data(), data.size()))
+  {
+    return nullptr;
+  }
+
+  std::shared_ptr<Clip> clip(new Clip);
+  size_t frame_cnt = file_size / GSM_FRAME_SIZE;
+  clip->samples.resize(frame_cnt * GSM_FRAME_SAMPLES);
+  gsm decoder = gsm_create();
+  for (size_t i=0; i<frame_cnt; ++i)
+  {
+    gsm_signal buf[GSM_FRAME_SAMPLES];
+    gsm_decode(decoder, &data[i * GSM_FRAME_SIZE], buf);
+    convertS16ToFloat(&clip->samples[i * GSM_FRAME_SAMPLES], buf, 1,
+                      GSM_FRAME_SAMPLES);
+  }
+  gsm_destroy(decoder);
+  clip->sample_cnt = clip->samples.size();
+
+  return clip;
+} /* SoundClipCache::loadGsm */
+
+
+/*
+ * This file has not been truncated
+ */
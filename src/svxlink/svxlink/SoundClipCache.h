@@ -0,0 +1,287 @@
+/**
+@file	 SoundClipCache.h
+@brief   A process wide cache of decoded audio clips
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef SOUND_CLIP_CACHE_INCLUDED
+#define SOUND_CLIP_CACHE_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+#include <ostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+  
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A process wide cache of decoded audio clips
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-18
+
+This class keep recently played audio clips in memory so that the sound files
+do not have to be read and decoded each time they are played. Raw and WAV
+files are memory mapped and GSM files are decoded to float samples when they
+are loaded. The cache is shared by the message handlers of all logic cores.
+
+When the total size of the cached clips exceed the configured maximum, the
+least recently used clips are evicted. A clip that is being played is not
+affected by the eviction since the player hold its own reference to the clip.
+A cached clip is reloaded if the file has been modified on disk.
+
+Clips that are larger than a fraction of the cache size are not cached at all.
+Such clips are better played by streaming them from the file.
+*/
+class SoundClipCache
+{
+  public:
+      /// The default maximum size of the cache in bytes
+    static constexpr size_t DEFAULT_MAX_SIZE = 32 * 1024 * 1024;
+      /// A clip must not be larger than this fraction of the cache size
+    static constexpr size_t MAX_CLIP_SIZE_DIVISOR = 8;
+
+    /**
+     * @brief   A decoded audio clip
+     */
+    class Clip
+    {
+      public:
+        /**
+         * @brief   Destructor
+         */
+        ~Clip(void);
+
+        /**
+         * @brief   Get the length of the clip
+         * @return  Returns the number of samples in the clip
+         */
+        size_t sampleCount(void) const { return sample_cnt; }
+
+        /**
+         * @brief   Read samples from the clip
+         * @param   dest  The buffer to write the samples to
+         * @param   pos   The sample position to start reading at
+         * @param   count The maximum number of samples to read
+         * @return  Returns the number of samples actually read
+         */
+        size_t readSamples(float *dest, size_t pos, size_t count) const;
+
+        /**
+         * @brief   Get the amount of memory used by the clip
+         * @return  Returns the size in bytes
+         */
+        size_t memSize(void) const;
+
+      private:
+        void*               map_addr    = nullptr;
+        size_t              map_len     = 0;
+        const int16_t*      pcm         = nullptr;
+        std::vector<float>  samples;
+        size_t              sample_cnt  = 0;
+
+        Clip(void) {}
+        Clip(const Clip&);
+        Clip& operator=(const Clip&);
+
+        friend class SoundClipCache;
+    };
+    typedef std::shared_ptr<const Clip> ClipPtr;
+
+    /**
+     * @brief   Get the process wide cache instance
+     * @return  Returns the cache instance
+     */
+    static SoundClipCache& instance(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~SoundClipCache(void);
+
+    /**
+     * @brief   Set the maximum size of the cache
+     * @param   max_size The maximum size in bytes, 0 to disable the cache
+     */
+    void setMaxSize(size_t max_size);
+
+    /**
+     * @brief   Check if the cache is enabled
+     * @return  Returns \em true if the cache is enabled
+     */
+    bool isEnabled(void) const { return max_size > 0; }
+
+    /**
+     * @brief   Get a clip from the cache, loading it if necessary
+     * @param   path The path to the sound file
+     * @return  Returns the clip or a null pointer
+     *
+     * A null pointer is returned if the cache is disabled, if the file could
+     * not be loaded or if the file is too large to be cached. The caller
+     * should then fall back to playing the file directly, which will also
+     * report any problem with the file.
+     */
+    ClipPtr get(const std::string& path);
+
+    /**
+     * @brief   Load all sound files in a directory tree into the cache
+     * @param   dir The directory to load files from
+     * @return  Returns the number of loaded clips
+     *
+     * Loading stop when the cache is full so that preloaded clips do not
+     * evict each other.
+     */
+    unsigned preloadDirectory(const std::string& dir);
+
+    /**
+     * @brief   Remove all clips from the cache
+     */
+    void clear(void);
+
+    /**
+     * @brief   Write cache statistics to a stream
+     * @param   os The stream to write to
+     */
+    void printStats(std::ostream& os) const;
+
+  private:
+    struct Entry
+    {
+      ClipPtr                           clip;
+      dev_t                             dev;
+      ino_t                             ino;
+      off_t                             size;
+      time_t                            mtime;
+      std::list<std::string>::iterator  lru_it;
+    };
+    typedef std::map<std::string, Entry> Entries;
+
+    Entries                 entries;
+    std::list<std::string>  lru;
+    size_t                  max_size        = DEFAULT_MAX_SIZE;
+    size_t                  cur_size        = 0;
+    uint64_t                hits            = 0;
+    uint64_t                misses          = 0;
+    uint64_t                evictions       = 0;
+
+    SoundClipCache(void) {}
+    SoundClipCache(const SoundClipCache&);
+    SoundClipCache& operator=(const SoundClipCache&);
+    ClipPtr getClip(const std::string& path, bool preload);
+    bool preloadDir(const std::string& dir, unsigned& cnt);
+    void erase(Entries::iterator it);
+    void evict(size_t needed);
+    void updateMetrics(void);
+    static size_t estimatedSize(const std::string& path, size_t file_size);
+    static ClipPtr loadClip(const std::string& path, size_t file_size);
+    static ClipPtr loadRaw(int fd, size_t file_size);
+    static ClipPtr loadWav(int fd, size_t file_size);
+    static ClipPtr loadGsm(int fd, size_t file_size);
+
+};  /* class SoundClipCache */
+
+
+//} /* namespace */
+
+#endif /* SOUND_CLIP_CACHE_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,317 @@
+/**
+@file	 UdpJitterBuffer.cpp
+@brief   A reordering jitter buffer for sequence numbered UDP frames
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cmath>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "UdpJitterBuffer.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace sigc;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Static class variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+UdpJitterBuffer::UdpJitterBuffer(void)
+  : m_gap_timer(0, Timer::TYPE_ONESHOT, false)
+{
+  m_gap_timer.expired.connect(mem_fun(*this, &UdpJitterBuffer::gapTimeout));
+} /* UdpJitterBuffer::UdpJitterBuffer */
+
+
+UdpJitterBuffer::~UdpJitterBuffer(void)
+{
+} /* UdpJitterBuffer::~UdpJitterBuffer */
+
+
+void UdpJitterBuffer::setDelayLimits(unsigned min_ms, unsigned max_ms)
+{
+  m_min_delay = min_ms;
+  m_max_delay = std::max(min_ms, max_ms);
+} /* UdpJitterBuffer::setDelayLimits */
+
+
+void UdpJitterBuffer::reset(void)
+{
+  m_gap_timer.setEnable(false);
+  m_frames.clear();
+  m_synced = false;
+  m_next_seq = 0;
+  timerclear(&m_last_arrival);
+  m_last_arrival_seq = 0;
+  m_frame_interval = 0.0;
+  m_jitter = 0.0;
+  m_received_frames = 0;
+  m_reordered_frames = 0;
+  m_late_frames = 0;
+  m_lost_frames = 0;
+} /* UdpJitterBuffer::reset */
+
+
+void UdpJitterBuffer::writeFrame(Seq seq, const void *buf, int count)
+{
+  m_received_frames += 1;
+  updateJitter(seq);
+
+  if (!m_synced)
+  {
+    m_synced = true;
+    m_next_seq = seq;
+  }
+
+  if (seq < m_next_seq)
+  {
+    m_late_frames += 1;
+    return;
+  }
+
+    // A large jump in the sequence number is not caused by packet loss.
+    // The sender has probably been restarted so start a new sequence.
+  if (seq - m_next_seq > MAX_SEQ_JUMP)
+  {
+    releaseAll();
+    m_next_seq = seq;
+  }
+
+  if (seq == m_next_seq)
+  {
+    if (!m_frames.empty())
+    {
+      m_reordered_frames += 1;
+    }
+    m_next_seq += 1;
+    frameReceived(buf, count);
+    releaseFrames();
+    return;
+  }
+
+  const uint8_t *ptr = reinterpret_cast<const uint8_t*>(buf);
+  if (!m_frames.emplace(seq, std::vector<uint8_t>(ptr, ptr + count)).second)
+  {
+    m_late_frames += 1;
+    return;
+  }
+
+  if (m_frames.size() > MAX_HELD_FRAMES)
+  {
+    gapTimeout();
+  }
+  else if (!m_gap_timer.isEnabled())
+  {
+    m_gap_timer.setTimeout(targetDelay());
+    m_gap_timer.setEnable(true);
+  }
+} /* UdpJitterBuffer::writeFrame */
+
+
+unsigned UdpJitterBuffer::targetDelay(void) const
+{
+  unsigned delay = static_cast<unsigned>(1000.0 * JITTER_MULTIPLIER * m_jitter);
+  return std::min(std::max(delay, m_min_delay), m_max_delay);
+} /* UdpJitterBuffer::targetDelay */
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void UdpJitterBuffer::updateJitter(Seq seq)
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+    // Only consecutive frames within a talk spurt are used for measuring the
+    // jitter. The frame interval is estimated from the mean inter-arrival
+    // time since the frame length is not known to the receiver.
+  if (timerisset(&m_last_arrival) && (seq == m_last_arrival_seq + 1))
+  {
+    struct timeval diff;
+    timersub(&now, &m_last_arrival, &diff);
+    const double interval = diff.tv_sec + diff.tv_usec / 1000000.0;
+    if (interval < MAX_FRAME_INTERVAL)
+    {
+      if (m_frame_interval == 0.0)
+      {
+        m_frame_interval = interval;
+      }
+      m_frame_interval += (interval - m_frame_interval) / 64.0;
+      const double d = std::fabs(interval - m_frame_interval);
+      m_jitter += (d - m_jitter) / 16.0;
+    }
+  }
+  if (!timerisset(&m_last_arrival) || (seq > m_last_arrival_seq))
+  {
+    m_last_arrival = now;
+    m_last_arrival_seq = seq;
+  }
+} /* UdpJitterBuffer::updateJitter */
+
+
+void UdpJitterBuffer::releaseFrames(void)
+{
+  FrameMap::iterator it = m_frames.begin();
+  while ((it != m_frames.end()) && (it->first == m_next_seq))
+  {
+      // Move the frame out of the map before emitting it since the signal
+      // handler may call back into this object
+    std::vector<uint8_t> frame(std::move(it->second));
+    m_frames.erase(it);
+    m_next_seq += 1;
+    frameReceived(frame.data(), frame.size());
+    it = m_frames.begin();
+  }
+
+  if (m_frames.empty())
+  {
+    m_gap_timer.setEnable(false);
+  }
+  else if (!m_gap_timer.isEnabled())
+  {
+    m_gap_timer.setTimeout(targetDelay());
+    m_gap_timer.setEnable(true);
+  }
+} /* UdpJitterBuffer::releaseFrames */
+
+
+void UdpJitterBuffer::gapTimeout(Async::Timer *t)
+{
+  m_gap_timer.setEnable(false);
+  if (m_frames.empty())
+  {
+    return;
+  }
+
+    // Report all frames up to the first held back frame as lost
+  const Seq first_seq = m_frames.begin()->first;
+  while (m_next_seq < first_seq)
+  {
+    const Seq lost_seq = m_next_seq++;
+    m_lost_frames += 1;
+    if (lost_seq + 1 == first_seq)
+    {
+      const std::vector<uint8_t>& next = m_frames.begin()->second;
+      frameLost(lost_seq, next.data(), next.size());
+    }
+    else
+    {
+      frameLost(lost_seq, nullptr, 0);
+    }
+  }
+
+  releaseFrames();
+} /* UdpJitterBuffer::gapTimeout */
+
+
+void UdpJitterBuffer::releaseAll(void)
+{
+  m_gap_timer.setEnable(false);
+  FrameMap frames;
+  frames.swap(m_frames);
+  for (auto& frame : frames)
+  {
+    frameReceived(frame.second.data(), frame.second.size());
+  }
+} /* UdpJitterBuffer::releaseAll */
+
+
+/*
+ * This file has not been truncated
+ */
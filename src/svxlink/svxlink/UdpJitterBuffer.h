@@ -0,0 +1,264 @@
+/**
+@file	 UdpJitterBuffer.h
+@brief   A reordering jitter buffer for sequence numbered UDP frames
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef UDP_JITTER_BUFFER_INCLUDED
+#define UDP_JITTER_BUFFER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+#include <sys/time.h>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTimer.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+  
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A reordering jitter buffer for sequence numbered UDP frames
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-18
+
+This class put received UDP frames back in sequence number order. Frames that
+arrive in order are passed on immediately. When a gap in the sequence is
+detected, the following frames are held back for a while to give a reordered
+frame a chance to arrive. If the missing frame has not arrived when the
+target delay has passed, it is reported as lost and the held back frames are
+released.
+
+The inter-arrival jitter is measured continuously, using a method similar to
+the one described in RFC 3550, and the target delay is set to a multiple of
+the measured jitter within the configured limits. The target delay can also be
+used to size a playout buffer after the jitter buffer.
+*/
+class UdpJitterBuffer : public sigc::trackable
+{
+  public:
+    typedef uint64_t Seq;
+
+    /**
+     * @brief 	Default constuctor
+     */
+    UdpJitterBuffer(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~UdpJitterBuffer(void);
+
+    /**
+     * @brief   Set the limits for the target delay
+     * @param   min_ms The minimum target delay in milliseconds
+     * @param   max_ms The maximum target delay in milliseconds
+     */
+    void setDelayLimits(unsigned min_ms, unsigned max_ms);
+
+    /**
+     * @brief   Reset the jitter buffer
+     *
+     * All held back frames are thrown away and the next written frame will
+     * start a new sequence. The statistics are cleared.
+     */
+    void reset(void);
+
+    /**
+     * @brief   Write a received frame into the jitter buffer
+     * @param   seq   The sequence number of the frame
+     * @param   buf   The frame data
+     * @param   count The number of bytes in the frame
+     */
+    void writeFrame(Seq seq, const void *buf, int count);
+
+    /**
+     * @brief   Get the current target delay
+     * @return  Returns the target delay in milliseconds
+     */
+    unsigned targetDelay(void) const;
+
+    /**
+     * @brief   Get the measured inter-arrival jitter
+     * @return  Returns the jitter in milliseconds
+     */
+    float jitter(void) const { return 1000.0f * m_jitter; }
+
+    /**
+     * @brief   Get the number of received frames
+     * @return  Returns the number of frames written to the jitter buffer
+     */
+    uint64_t receivedFrames(void) const { return m_received_frames; }
+
+    /**
+     * @brief   Get the number of reordered frames
+     * @return  Returns the number of frames that arrived out of order but in
+     *          time to be put back into sequence
+     */
+    uint64_t reorderedFrames(void) const { return m_reordered_frames; }
+
+    /**
+     * @brief   Get the number of late frames
+     * @return  Returns the number of frames that arrived after they had
+     *          already been reported as lost, or that were duplicates
+     */
+    uint64_t lateFrames(void) const { return m_late_frames; }
+
+    /**
+     * @brief   Get the number of lost frames
+     * @return  Returns the number of frames that never arrived in time
+     */
+    uint64_t lostFrames(void) const { return m_lost_frames; }
+
+    /**
+     * @brief   A signal that is emitted when a frame is ready to be processed
+     * @param   buf   The frame data
+     * @param   count The number of bytes in the frame
+     */
+    sigc::signal<void(const void*, int)> frameReceived;
+
+    /**
+     * @brief   A signal that is emitted when a frame has been lost
+     * @param   seq         The sequence number of the lost frame
+     * @param   next_buf    The frame following the lost one, or nullptr
+     * @param   next_count  The number of bytes in the next frame
+     *
+     * The next frame is only given if it directly follow the lost frame.
+     * It may be used by the receiver for forward error correction. The next
+     * frame will be emitted using the frameReceived signal as usual.
+     */
+    sigc::signal<void(Seq, const void*, int)> frameLost;
+
+  private:
+    typedef std::map<Seq, std::vector<uint8_t> > FrameMap;
+
+    static const size_t     MAX_HELD_FRAMES     = 50;
+    static const Seq        MAX_SEQ_JUMP        = 250;
+    static constexpr double JITTER_MULTIPLIER   = 4.0;
+    static constexpr double MAX_FRAME_INTERVAL  = 0.25;
+
+    Async::Timer    m_gap_timer;
+    FrameMap        m_frames;
+    bool            m_synced              = false;
+    Seq             m_next_seq            = 0;
+    unsigned        m_min_delay           = 0;
+    unsigned        m_max_delay           = 200;
+    struct timeval  m_last_arrival        = {0, 0};
+    Seq             m_last_arrival_seq    = 0;
+    double          m_frame_interval      = 0.0;
+    double          m_jitter              = 0.0;
+    uint64_t        m_received_frames     = 0;
+    uint64_t        m_reordered_frames    = 0;
+    uint64_t        m_late_frames         = 0;
+    uint64_t        m_lost_frames         = 0;
+
+    UdpJitterBuffer(const UdpJitterBuffer&);
+    UdpJitterBuffer& operator=(const UdpJitterBuffer&);
+    void updateJitter(Seq seq);
+    void releaseFrames(void);
+    void gapTimeout(Async::Timer *t=0);
+    void releaseAll(void);
+
+};  /* class UdpJitterBuffer */
+
+
+//} /* namespace */
+
+#endif /* UDP_JITTER_BUFFER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -252,6 +252,7 @@ bool AnnounceLogic::initialize(Async::Config& cfgobj, const string& logic_name)
   event_handler->playSilence.connect(mem_fun(*this, &AnnounceLogic::playSilence));
   event_handler->playTone.connect(mem_fun(*this, &AnnounceLogic::playTone));
   event_handler->playDtmf.connect(mem_fun(*this, &AnnounceLogic::playDtmf));
+  event_handler->playCw.connect(mem_fun(*this, &AnnounceLogic::playCw));
   event_handler->getConfigValue.connect(
           sigc::mem_fun(*this, &AnnounceLogic::getConfigValue));
   event_handler->setVariable("logic_name", name().c_str());
@@ -336,6 +337,13 @@ void AnnounceLogic::playDtmf(const std::string& digits, int amp, int len)
 } /* AnnounceLogic::playDtmf */
 
 
+void AnnounceLogic::playCw(const std::string& txt, int cpm, int fw_cpm,
+                           int fq, int amp)
+{
+  msg_handler->playCw(txt, cpm, fw_cpm, fq, amp, report_events_as_idle);
+} /* AnnounceLogic::playCw */
+
+
 void AnnounceLogic::timeoutNextMinute(void)
 {
   struct timeval tv;
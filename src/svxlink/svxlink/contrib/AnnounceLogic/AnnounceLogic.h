@@ -177,6 +177,7 @@ class AnnounceLogic : public LogicBase
     void playSilence(int length);
     void playTone(int fq, int amp, int len);
     void playDtmf(const std::string& digits, int amp, int len);
+    void playCw(const std::string& txt, int cpm, int fw_cpm, int fq, int amp);
     void timeoutNextMinute(void);
     void everyMinute(Async::AtTimer *t);
     void prenotification(void);
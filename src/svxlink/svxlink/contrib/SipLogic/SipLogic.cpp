@@ -756,6 +756,7 @@ bool SipLogic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   logic_event_handler->playSilence.connect(mem_fun(*this, &SipLogic::playLogicSilence));
   logic_event_handler->playTone.connect(mem_fun(*this, &SipLogic::playLogicTone));
   logic_event_handler->playDtmf.connect(mem_fun(*this, &SipLogic::playLogicDtmf));
+  logic_event_handler->playCw.connect(mem_fun(*this, &SipLogic::playLogicCw));
 
   logic_event_handler->getConfigValue.connect(
       sigc::mem_fun(*this, &SipLogic::getConfigValue));
@@ -801,6 +802,7 @@ bool SipLogic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   sip_event_handler->playSilence.connect(mem_fun(*this, &SipLogic::playSipSilence));
   sip_event_handler->playTone.connect(mem_fun(*this, &SipLogic::playSipTone));
   sip_event_handler->playDtmf.connect(mem_fun(*this, &SipLogic::playSipDtmf));
+  sip_event_handler->playCw.connect(mem_fun(*this, &SipLogic::playSipCw));
   sip_event_handler->processEvent(std::string("namespace eval ")
                                   + name() + "::Logic {}");
 
@@ -1549,6 +1551,13 @@ void SipLogic::playLogicDtmf(const std::string& digits, int amp, int len)
 } /* SipLogic::playLogicDtmf */
 
 
+void SipLogic::playLogicCw(const std::string& txt, int cpm, int fw_cpm,
+                           int fq, int amp)
+{
+  logic_msg_handler->playCw(txt, cpm, fw_cpm, fq, amp, report_events_as_idle);
+} /* SipLogic::playLogicCw */
+
+
 void SipLogic::playSipFile(const string& path)
 {
   sip_msg_handler->playFile(path, report_events_as_idle);
@@ -1577,6 +1586,13 @@ void SipLogic::playSipDtmf(const std::string& digits, int amp, int len)
 } /* SipLogic::playSipDtmf */
 
 
+void SipLogic::playSipCw(const std::string& txt, int cpm, int fw_cpm,
+                         int fq, int amp)
+{
+  sip_msg_handler->playCw(txt, cpm, fw_cpm, fq, amp, report_events_as_idle);
+} /* SipLogic::playSipCw */
+
+
 void SipLogic::unregisterCall(sip::_Call *call)
 {
   for (std::vector<sip::_Call *>::iterator it=calls.begin();
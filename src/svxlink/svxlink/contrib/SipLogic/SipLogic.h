@@ -239,10 +239,14 @@ class SipLogic : public LogicBase
     void playLogicSilence(int length);
     void playLogicTone(int fq, int amp, int len);
     void playLogicDtmf(const std::string& digits, int amp, int len);
+    void playLogicCw(const std::string& txt, int cpm, int fw_cpm, int fq,
+                     int amp);
     void playSipFile(const std::string& path);
     void playSipSilence(int length);
     void playSipTone(int fq, int amp, int len);
     void playSipDtmf(const std::string& digits, int amp, int len);
+    void playSipCw(const std::string& txt, int cpm, int fw_cpm, int fq,
+                   int amp);
     bool getConfigValue(const std::string& section,
                               const std::string& tag,
                               std::string& value);
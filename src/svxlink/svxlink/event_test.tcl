@@ -19,6 +19,11 @@ proc playSilence {milliseconds} {
 }
 
 
+proc playCw {txt cpm fw_cpm fq amp} {
+  puts "playCw($txt, $cpm, $fw_cpm, $fq, $amp);";
+}
+
+
 proc reportActiveModuleState {} {
   puts "reportActiveModuleState;";
 }
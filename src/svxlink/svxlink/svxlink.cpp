@@ -45,6 +45,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iostream>
 #include <algorithm>
 #include <vector>
+#include <climits>
 
 
 /****************************************************************************
@@ -58,6 +59,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncTimer.h>
 #include <AsyncFdWatch.h>
 #include <AsyncAudioIO.h>
+#include <AsyncTcpServer.h>
+#include <AsyncHttpServerConnection.h>
+#include <AsyncMetrics.h>
 #include <LocationInfo.h>
 #include <common.h>
 #include <config.h>
@@ -73,6 +77,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "version/SVXLINK.h"
 #include "Logic.h"
 #include "LinkManager.h"
+#include "SoundClipCache.h"
 
 
 /****************************************************************************
@@ -115,6 +120,9 @@ static void initialize_logics(Config &cfg);
 static void sighup_handler(int signal);
 static void sigterm_handler(int signal);
 static void handle_unix_signal(int signum);
+static void metricsClientConnected(HttpServerConnection *con);
+static void metricsRequestReceived(HttpServerConnection *con,
+                                   HttpServerConnection::Request& req);
 
 
 /****************************************************************************
@@ -139,9 +147,12 @@ namespace {
   int                   daemonize = 0;
   int                   reset = 0;
   int                   quiet = 0;
+  int                   virtual_time = 0;
+  int                   run_time = 0;
   vector<LogicBase*>    logic_vec;
   FdWatch*              stdin_watch = 0;
   LogWriter             logwriter;
+  TcpServer<HttpServerConnection>* metrics_server = nullptr;
 };
 
 
@@ -179,6 +190,11 @@ int main(int argc, char **argv)
 
   parse_arguments(argc, const_cast<const char **>(argv));
 
+  if (virtual_time)
+  {
+    app.setVirtualTime(true);
+  }
+
   if (daemonize && (daemon(1, 0) == -1))
   {
     perror("daemon");
@@ -371,6 +387,10 @@ int main(int argc, char **argv)
   cfg.getValue("GLOBAL", "TIMESTAMP_FORMAT", tstamp_format);
   logwriter.setTimestampFormat(tstamp_format);
 
+  unsigned stall_threshold = 0;
+  cfg.getValue("GLOBAL", "EVENT_LOOP_STALL_THRESHOLD", stall_threshold);
+  app.setStallThreshold(stall_threshold);
+
   cout << PROGRAM_NAME " v" SVXLINK_VERSION
           " Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX\n\n";
   cout << PROGRAM_NAME " comes with ABSOLUTELY NO WARRANTY. "
@@ -420,6 +440,20 @@ int main(int argc, char **argv)
   cfg.getValue("GLOBAL", "CARD_CHANNELS", card_channels);
   AudioIO::setChannels(card_channels);
 
+    // Set up the sound clip cache shared by all logic cores
+  unsigned sound_clip_cache_size =
+    SoundClipCache::DEFAULT_MAX_SIZE / (1024 * 1024);
+  cfg.getValue("GLOBAL", "SOUND_CLIP_CACHE_SIZE", sound_clip_cache_size);
+  SoundClipCache::instance().setMaxSize(
+      static_cast<size_t>(sound_clip_cache_size) * 1024 * 1024);
+  std::vector<std::string> sound_clip_preload;
+  cfg.getValue("GLOBAL", "SOUND_CLIP_PRELOAD", sound_clip_preload, true);
+  for (const auto& dir : sound_clip_preload)
+  {
+    unsigned cnt = SoundClipCache::instance().preloadDirectory(dir);
+    cout << "--- Preloaded " << cnt << " sound clips from " << dir << endl;
+  }
+
     // Init locationinfo
   if (cfg.getValue("GLOBAL", "LOCATION_INFO", value))
   {
@@ -445,6 +479,15 @@ int main(int argc, char **argv)
 
   initialize_logics(cfg);
 
+    // Optionally serve metrics over HTTP for a monitoring system to scrape
+  std::string metrics_http_port;
+  if (cfg.getValue("GLOBAL", "METRICS_HTTP_PORT", metrics_http_port))
+  {
+    metrics_server = new TcpServer<HttpServerConnection>(metrics_http_port);
+    metrics_server->clientConnected.connect(
+        sigc::ptr_fun(&metricsClientConnected));
+  }
+
   if (LinkManager::hasInstance())
   {
     LinkManager::instance()->allLogicsStarted();
@@ -467,10 +510,33 @@ int main(int argc, char **argv)
   {
     std::cout << "NOTICE: Initialization done. Starting main application."
               << std::endl;
+    Timer run_timer(1000 * run_time);
+    run_timer.setEnable(run_time > 0);
+    run_timer.expired.connect([&](Timer*) { app.quit(); });
+    struct timespec start, virtual_start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    app.getMonotonicTime(virtual_start);
     app.exec();
+    if (virtual_time)
+    {
+      struct timespec end, virtual_end;
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      app.getMonotonicTime(virtual_end);
+      double real_secs = (end.tv_sec - start.tv_sec) +
+                         (end.tv_nsec - start.tv_nsec) / 1.0e9;
+      double virtual_secs = (virtual_end.tv_sec - virtual_start.tv_sec) +
+                         (virtual_end.tv_nsec - virtual_start.tv_nsec) / 1.0e9;
+      std::cout << "NOTICE: Ran " << virtual_secs << " seconds of virtual "
+                   "time in " << real_secs << " seconds ("
+                << (virtual_secs / real_secs) << " times real time)"
+                << std::endl;
+    }
     std::cout << "NOTICE: Exiting" << std::endl;
   }
 
+  delete metrics_server;
+  metrics_server = nullptr;
+
   LinkManager::deleteInstance();
   LocationInfo::deleteInstance();
 
@@ -536,6 +602,10 @@ static void parse_arguments(int argc, const char **argv)
 	    "Initialize all hardware to initial state then quit", NULL},
     {"quiet", 0, POPT_ARG_NONE, &quiet, 0,
 	    "Don't print any info messages, just warnings and errors", NULL},
+    {"virtual-time", 0, POPT_ARG_NONE, &virtual_time, 0,
+	    "Run on a virtual clock, as fast as possible", NULL},
+    {"run-time", 0, POPT_ARG_INT, &run_time, 0,
+	    "Quit after the given number of seconds", "<seconds>"},
     {"version", 0, POPT_ARG_NONE, &print_version, 0,
 	    "Print the application version string", NULL},
     {NULL, 0, 0, NULL, 0}
@@ -579,6 +649,14 @@ static void parse_arguments(int argc, const char **argv)
     std::cout << SVXLINK_VERSION << std::endl;
     exit(0);
   }
+
+    /* The run time is given to a timer in milliseconds */
+  if ((run_time < 0) || (run_time > INT_MAX / 1000))
+  {
+    fprintf(stderr, "*** ERROR: The run time must be in the range 0 to %d "
+                    "seconds\n", INT_MAX / 1000);
+    exit(1);
+  }
 } /* parse_arguments */
 
 
@@ -751,6 +829,39 @@ static void handle_unix_signal(int signum)
 } /* handle_unix_signal */
 
 
+static void metricsClientConnected(HttpServerConnection *con)
+{
+  con->requestReceived.connect(sigc::ptr_fun(&metricsRequestReceived));
+} /* metricsClientConnected */
+
+
+static void metricsRequestReceived(HttpServerConnection *con,
+                                   HttpServerConnection::Request& req)
+{
+  HttpServerConnection::Response res;
+  if ((req.method != "GET") && (req.method != "HEAD"))
+  {
+    res.setCode(501);
+    res.setContent("text/plain", req.method + ": Method not implemented\n");
+    con->write(res);
+    return;
+  }
+
+  if (req.target != "/metrics")
+  {
+    res.setCode(404);
+    res.setContent("text/plain", "Not found!\n");
+    con->write(res);
+    return;
+  }
+
+  res.setContent(Metrics::CONTENT_TYPE, Metrics::instance().toString());
+  res.setSendContent(req.method == "GET");
+  res.setCode(200);
+  con->write(res);
+} /* metricsRequestReceived */
+
+
 /*
  * This file has not been truncated
  */
@@ -118,7 +118,7 @@ static map<char, pair<int, int> > tone_map;
 DtmfEncoder::DtmfEncoder(int sampling_rate)
   : sampling_rate(sampling_rate), tone_length(100 * sampling_rate / 1000),
     tone_spacing(50 * sampling_rate / 1000), tone_amp(0.5), low_tone(0),
-    high_tone(0), pos(0), length(0), is_playing(false),
+    high_tone(0), pos(0), length(0), nco(sampling_rate), is_playing(false),
     is_sending_digits(false)
 {
   if (tone_map.empty())
@@ -266,6 +266,7 @@ void DtmfEncoder::playNextDigit(void)
   if (low_tone > 0)
   {
     low_tone = 0;
+    nco.clearTones();
     pos = 0;
     length = tone_spacing;
     is_playing = true;
@@ -294,6 +295,8 @@ void DtmfEncoder::playNextDigit(void)
   
   low_tone = tone_map[digit].first;
   high_tone = tone_map[digit].second;
+  nco.setTone(low_tone, tone_amp);
+  nco.addTone(high_tone, tone_amp);
   pos = 0;
   if (length <= 0)
   {
@@ -314,22 +317,12 @@ void DtmfEncoder::writeAudio(void)
   do
   {
     unsigned count = min(BLOCK_SIZE, length - pos);
-    for (unsigned i=0; i<count; ++i)
-    {
-      if (low_tone > 0)
-      {
-      	block[i] = tone_amp * sin(2 * M_PI * low_tone * pos / sampling_rate) +
-      		   tone_amp * sin(2 * M_PI * high_tone * pos / sampling_rate);
-      }
-      else
-      {
-      	block[i] = 0;
-      }
-      ++pos;
-    }
+    nco.generate(block, count);
+    pos += count;
 
     ret = sinkWriteSamples(block, count);
     pos -= (count - ret);
+    nco.seek(static_cast<long>(ret) - static_cast<long>(count));
   } while ((ret > 0) && (pos < length));
   
   if (pos == length)
@@ -0,0 +1,192 @@
+/**
+@file	 GpioDebouncer.cpp
+@brief   Debounce GPIO input state changes using event timestamps
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "GpioDebouncer.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace sigc;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Static class variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+GpioDebouncer::GpioDebouncer(void)
+  : m_timer(0, Timer::TYPE_ONESHOT, false)
+{
+  m_timer.expired.connect(mem_fun(*this, &GpioDebouncer::commitState));
+} /* GpioDebouncer::GpioDebouncer */
+
+
+GpioDebouncer::~GpioDebouncer(void)
+{
+} /* GpioDebouncer::~GpioDebouncer */
+
+
+void GpioDebouncer::setDebounceTime(unsigned debounce_ms)
+{
+  m_debounce_ms = debounce_ms;
+} /* GpioDebouncer::setDebounceTime */
+
+
+void GpioDebouncer::setState(bool state, const struct timespec& ts)
+{
+  if (state == m_state)
+  {
+      // The input went back to the current state before the debounce time
+      // passed so the pending change was a glitch
+    m_pending = false;
+    m_timer.setEnable(false);
+    return;
+  }
+
+  if (m_pending && (state == m_pending_state))
+  {
+    return;
+  }
+
+  m_pending = true;
+  m_pending_state = state;
+
+    // Calculate how much of the debounce time that is left, taking into
+    // account the time that passed since the edge occurred
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  long long elapsed_us = (now.tv_sec - ts.tv_sec) * 1000000LL +
+                         (now.tv_nsec - ts.tv_nsec) / 1000;
+  long long remaining_us = m_debounce_ms * 1000LL - elapsed_us;
+  if (remaining_us <= 0)
+  {
+    commitState();
+    return;
+  }
+  m_timer.setTimeout((remaining_us + 999) / 1000);
+  m_timer.setEnable(true);
+} /* GpioDebouncer::setState */
+
+
+void GpioDebouncer::setState(bool state)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  setState(state, now);
+} /* GpioDebouncer::setState */
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void GpioDebouncer::commitState(Async::Timer *t)
+{
+  m_timer.setEnable(false);
+  if (!m_pending)
+  {
+    return;
+  }
+  m_pending = false;
+  m_state = m_pending_state;
+  stateChanged(m_state);
+} /* GpioDebouncer::commitState */
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,185 @@
+/**
+@file	 GpioDebouncer.h
+@brief   Debounce GPIO input state changes using event timestamps
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef GPIO_DEBOUNCER_INCLUDED
+#define GPIO_DEBOUNCER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+#include <time.h>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTimer.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+  
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Debounce GPIO input state changes using event timestamps
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-18
+
+This class filters out short glitches on a GPIO input. A new state is only
+accepted when it has been stable for the debounce time. The time is measured
+from the timestamp given with each state change, preferably the kernel
+timestamp of the edge event, so that the time the application took to
+process the event does not affect the timing. All timestamps must be given
+in the CLOCK_MONOTONIC time base.
+*/
+class GpioDebouncer : public sigc::trackable
+{
+  public:
+    /**
+     * @brief 	Default constuctor
+     */
+    GpioDebouncer(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~GpioDebouncer(void);
+
+    /**
+     * @brief   Set the debounce time
+     * @param   debounce_ms The debounce time in milliseconds, 0=no debounce
+     */
+    void setDebounceTime(unsigned debounce_ms);
+
+    /**
+     * @brief   Update the input state
+     * @param   state The new state of the input
+     * @param   ts    The time when the input changed to the new state
+     */
+    void setState(bool state, const struct timespec& ts);
+
+    /**
+     * @brief   Update the input state using the current time as timestamp
+     * @param   state The new state of the input
+     */
+    void setState(bool state);
+
+    /**
+     * @brief   Get the debounced state
+     * @return  Returns the current debounced state
+     */
+    bool state(void) const { return m_state; }
+
+    /**
+     * @brief   A signal that is emitted when the debounced state change
+     * @param   state The new state
+     */
+    sigc::signal<void(bool)> stateChanged;
+
+  private:
+    Async::Timer    m_timer;
+    unsigned        m_debounce_ms     = 0;
+    bool            m_state           = false;
+    bool            m_pending         = false;
+    bool            m_pending_state   = false;
+
+    GpioDebouncer(const GpioDebouncer&);
+    GpioDebouncer& operator=(const GpioDebouncer&);
+    void commitState(Async::Timer *t=0);
+
+};  /* class GpioDebouncer */
+
+
+//} /* namespace */
+
+#endif /* GPIO_DEBOUNCER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
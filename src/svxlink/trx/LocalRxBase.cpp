@@ -80,8 +80,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "multirate_filter_coeff.h"
 #include "Sel5Decoder.h"
 #include "AfskDemodulator.h"
+#include "AfskCorrelatorDemodulator.h"
 #include "Synchronizer.h"
 #include "HdlcDeframer.h"
+#include "SlicerBank.h"
 #include "Tx.h"
 #include "Emphasis.h"
 #include "LADSPAPluginLoader.h"
@@ -445,6 +447,29 @@ bool LocalRxBase::initialize(void)
   squelchOpen.connect(
       sigc::hide(sigc::mem_fun(*this, &LocalRxBase::publishSquelchState)));
 
+    // Select which type of AFSK demodulator to use
+  string afsk_demod = "AUTOCORRELATOR";
+  cfg().getValue(name(), "AFSK_DEMODULATOR", afsk_demod);
+  if ((afsk_demod != "AUTOCORRELATOR") && (afsk_demod != "CORRELATOR"))
+  {
+    cerr << "*** ERROR: Unknown AFSK demodulator type specified in config "
+            "variable " << name() << "/AFSK_DEMODULATOR. Legal values are: "
+            "AUTOCORRELATOR, CORRELATOR\n";
+    return false;
+  }
+  const bool afsk_corr_demod = (afsk_demod == "CORRELATOR");
+
+    // Select how many phase offset slicers to use for AFSK reception
+  unsigned afsk_slicers = 1;
+  cfg().getValue(name(), "AFSK_SLICERS", afsk_slicers);
+  if ((afsk_slicers < 1) || (afsk_slicers > SlicerBank::MAX_SLICERS))
+  {
+    cerr << "*** ERROR: Config variable " << name() << "/AFSK_SLICERS out "
+            "of range (" << afsk_slicers << "). Valid range is 1 to "
+         << SlicerBank::MAX_SLICERS << ".\n";
+    return false;
+  }
+
     // Set up out of band AFSK demodulator if configured
   float voice_gain = 0.0f;
   bool ob_afsk_enable = false;
@@ -474,21 +499,41 @@ bool LocalRxBase::initialize(void)
     fullband_splitter->addSink(fsf, true);
     AudioSource *prev_src = fsf;
 
-    AfskDemodulator *fsk_demod =
-      new AfskDemodulator(fc - shift/2, fc + shift/2, baudrate);
-    //fullband_splitter->addSink(fsk_demod, true);
-    prev_src->registerSink(fsk_demod, true);
-    prev_src = fsk_demod;
+    if (afsk_corr_demod)
+    {
+      AfskCorrelatorDemodulator *fsk_demod =
+        new AfskCorrelatorDemodulator(fc - shift/2, fc + shift/2, baudrate);
+      prev_src->registerSink(fsk_demod, true);
+      prev_src = fsk_demod;
+    }
+    else
+    {
+      AfskDemodulator *fsk_demod =
+        new AfskDemodulator(fc - shift/2, fc + shift/2, baudrate);
+      //fullband_splitter->addSink(fsk_demod, true);
+      prev_src->registerSink(fsk_demod, true);
+      prev_src = fsk_demod;
+    }
 
-    Synchronizer *sync = new Synchronizer(baudrate);
-    prev_src->registerSink(sync, true);
+    if (afsk_slicers > 1)
+    {
+      SlicerBank *slicers = new SlicerBank(baudrate, afsk_slicers);
+      slicers->frameReceived.connect(
+          mem_fun(*this, &LocalRxBase::dataFrameReceived));
+      prev_src->registerSink(slicers, true);
+    }
+    else
+    {
+      Synchronizer *sync = new Synchronizer(baudrate);
+      prev_src->registerSink(sync, true);
+
+      ob_afsk_deframer = new HdlcDeframer;
+      ob_afsk_deframer->frameReceived.connect(
+          mem_fun(*this, &LocalRxBase::dataFrameReceived));
+      sync->bitsReceived.connect(
+          mem_fun(*ob_afsk_deframer, &HdlcDeframer::bitsReceived));
+    }
     prev_src = 0;
-
-    ob_afsk_deframer = new HdlcDeframer;
-    ob_afsk_deframer->frameReceived.connect(
-        mem_fun(*this, &LocalRxBase::dataFrameReceived));
-    sync->bitsReceived.connect(
-        mem_fun(*ob_afsk_deframer, &HdlcDeframer::bitsReceived));
   }
 
   bool ib_afsk_enable = false;
@@ -501,20 +546,41 @@ bool LocalRxBase::initialize(void)
     unsigned baudrate = 1200;
     //cfg().getValue(name(), "IB_AFSK_BAUDRATE", baudrate);
 
-    AfskDemodulator *fsk_demod =
-      new AfskDemodulator(fc - shift/2, fc + shift/2, baudrate);
-    fullband_splitter->addSink(fsk_demod, true);
-    AudioSource *prev_src = fsk_demod;
+    AudioSource *prev_src = 0;
+    if (afsk_corr_demod)
+    {
+      AfskCorrelatorDemodulator *fsk_demod =
+        new AfskCorrelatorDemodulator(fc - shift/2, fc + shift/2, baudrate);
+      fullband_splitter->addSink(fsk_demod, true);
+      prev_src = fsk_demod;
+    }
+    else
+    {
+      AfskDemodulator *fsk_demod =
+        new AfskDemodulator(fc - shift/2, fc + shift/2, baudrate);
+      fullband_splitter->addSink(fsk_demod, true);
+      prev_src = fsk_demod;
+    }
 
-    Synchronizer *sync = new Synchronizer(baudrate);
-    prev_src->registerSink(sync, true);
+    if (afsk_slicers > 1)
+    {
+      SlicerBank *slicers = new SlicerBank(baudrate, afsk_slicers);
+      slicers->frameReceived.connect(
+          mem_fun(*this, &LocalRxBase::dataFrameReceivedIb));
+      prev_src->registerSink(slicers, true);
+    }
+    else
+    {
+      Synchronizer *sync = new Synchronizer(baudrate);
+      prev_src->registerSink(sync, true);
+
+      ib_afsk_deframer = new HdlcDeframer;
+      ib_afsk_deframer->frameReceived.connect(
+          mem_fun(*this, &LocalRxBase::dataFrameReceivedIb));
+      sync->bitsReceived.connect(
+          mem_fun(*ib_afsk_deframer, &HdlcDeframer::bitsReceived));
+    }
     prev_src = 0;
-
-    ib_afsk_deframer = new HdlcDeframer;
-    ib_afsk_deframer->frameReceived.connect(
-        mem_fun(*this, &LocalRxBase::dataFrameReceivedIb));
-    sync->bitsReceived.connect(
-        mem_fun(*ib_afsk_deframer, &HdlcDeframer::bitsReceived));
   }
 
     // Create a new audio splitter to handle tone detectors
@@ -529,6 +595,7 @@ bool LocalRxBase::initialize(void)
 #else
   AudioFilter *voiceband_filter = new AudioFilter("BpCh12/-0.1/300-3500");
 #endif
+  voiceband_filter->setBackend(AudioFilter::BACKEND_BIQUAD);
   prev_src->registerSink(voiceband_filter, true);
   prev_src = voiceband_filter;
 
@@ -645,6 +712,7 @@ bool LocalRxBase::initialize(void)
 #else
   AudioFilter *splatter_filter = new AudioFilter("LpCh9/-0.05/3500");
 #endif
+  splatter_filter->setBackend(AudioFilter::BACKEND_BIQUAD);
   prev_src->registerSink(splatter_filter, true);
   prev_src = splatter_filter;
   
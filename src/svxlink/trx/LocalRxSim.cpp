@@ -30,7 +30,15 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <strings.h>
+
 #include <iostream>
+#include <cstring>
+#include <cerrno>
 
 
 /****************************************************************************
@@ -41,6 +49,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncConfig.h>
 #include <AsyncAudioPacer.h>
+#include <AsyncAudioVectorOps.h>
 
 
 /****************************************************************************
@@ -77,6 +86,187 @@ using namespace Async;
  *
  ****************************************************************************/
 
+/*
+ * An audio source that read 16 bit signed mono samples from a raw or WAV
+ * file. The samples must be in the internal sample rate.
+ */
+class LocalRxSim::FileSource : public Async::AudioSource
+{
+  public:
+    FileSource(void)
+      : fd(-1), data_start(0), data_end(-1), data_pos(0), loop(false),
+        enabled(false), buf_cnt(0), buf_pos(0)
+    {
+    }
+
+    ~FileSource(void)
+    {
+      if (fd >= 0)
+      {
+        ::close(fd);
+      }
+    }
+
+    bool open(const string& filename, bool do_loop)
+    {
+      loop = do_loop;
+      fd = ::open(filename.c_str(), O_RDONLY);
+      if (fd < 0)
+      {
+        cerr << "*** ERROR: Could not open audio file \"" << filename
+             << "\": " << strerror(errno) << endl;
+        return false;
+      }
+      if ((filename.size() > 4) &&
+          (strcasecmp(filename.c_str() + filename.size() - 4, ".wav") == 0) &&
+          !readWavHeader())
+      {
+        cerr << "*** ERROR: The audio file \"" << filename
+             << "\" is not a 16 bit mono WAV file with a sample rate of "
+             << INTERNAL_SAMPLE_RATE << "Hz" << endl;
+        return false;
+      }
+      return true;
+    }
+
+    void enable(bool enable)
+    {
+      enabled = enable;
+      if (enable)
+      {
+        writeSamples();
+      }
+      else
+      {
+        sinkFlushSamples();
+      }
+    }
+
+    void resumeOutput(void)
+    {
+      if (enabled)
+      {
+        writeSamples();
+      }
+    }
+
+    void allSamplesFlushed(void)
+    {
+    }
+
+  private:
+    static const int BLOCK_SIZE = 128;
+
+    int     fd;
+    off_t   data_start;
+    off_t   data_end;
+    off_t   data_pos;
+    bool    loop;
+    bool    enabled;
+    float   buf[BLOCK_SIZE];
+    int     buf_cnt;
+    int     buf_pos;
+
+    static uint32_t le32(const uint8_t *p)
+    {
+      return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    static uint16_t le16(const uint8_t *p)
+    {
+      return p[0] | (p[1] << 8);
+    }
+
+    bool readWavHeader(void)
+    {
+      uint8_t hdr[16];
+      if ((::read(fd, hdr, 12) != 12) || (memcmp(hdr, "RIFF", 4) != 0) ||
+          (memcmp(hdr + 8, "WAVE", 4) != 0))
+      {
+        return false;
+      }
+      bool fmt_ok = false;
+      uint8_t chunk[8];
+      while (::read(fd, chunk, 8) == 8)
+      {
+        uint32_t size = le32(chunk + 4);
+        if (memcmp(chunk, "data", 4) == 0)
+        {
+          data_start = lseek(fd, 0, SEEK_CUR);
+          data_end = data_start + size;
+          data_pos = data_start;
+          return fmt_ok && (data_start != -1);
+        }
+        off_t skip = size + (size & 1);
+        if ((memcmp(chunk, "fmt ", 4) == 0) && (size >= 16))
+        {
+          if (::read(fd, hdr, 16) != 16)
+          {
+            return false;
+          }
+          fmt_ok = (le16(hdr) == 1) && (le16(hdr + 2) == 1) &&
+                   (le32(hdr + 4) == INTERNAL_SAMPLE_RATE) &&
+                   (le16(hdr + 14) == 16);
+          skip -= 16;
+        }
+        if (lseek(fd, skip, SEEK_CUR) == -1)
+        {
+          return false;
+        }
+      }
+      return false;
+    }
+
+      // Read audio data but not past the end of the data chunk of a WAV
+      // file since other chunks may follow it
+    ssize_t readData(int16_t *samples, size_t size)
+    {
+      if ((data_end >= 0) && (data_end - data_pos < off_t(size)))
+      {
+        size = data_end - data_pos;
+      }
+      ssize_t len = (size > 0) ? ::read(fd, samples, size) : 0;
+      if (len > 0)
+      {
+        data_pos += len;
+      }
+      return len;
+    }
+
+    bool readBlock(void)
+    {
+      int16_t samples[BLOCK_SIZE];
+      ssize_t len = readData(samples, sizeof(samples));
+      if ((len <= 0) && loop && (lseek(fd, data_start, SEEK_SET) != -1))
+      {
+        data_pos = data_start;
+        len = readData(samples, sizeof(samples));
+      }
+      buf_cnt = (len > 0) ? len / sizeof(*samples) : 0;
+      buf_pos = 0;
+      convertS16ToFloat(buf, samples, 1, buf_cnt);
+      return buf_cnt > 0;
+    }
+
+    void writeSamples(void)
+    {
+      int written = 0;
+      do
+      {
+        if ((buf_pos == buf_cnt) && !readBlock())
+        {
+          enabled = false;
+          sinkFlushSamples();
+          return;
+        }
+        written = sinkWriteSamples(buf + buf_pos, buf_cnt - buf_pos);
+        buf_pos += written;
+      } while (enabled && (written > 0));
+    }
+};
+
+
+
 
 
 /****************************************************************************
@@ -111,13 +301,14 @@ unsigned int LocalRxSim::next_seed = 0;
  ****************************************************************************/
 
 LocalRxSim::LocalRxSim(Config &cfg, const std::string& name)
-  : LocalRxBase(cfg, name), cfg(cfg), pacer(0)
+  : LocalRxBase(cfg, name), cfg(cfg), file_src(0), pacer(0)
 {
 } /* LocalRxSim::LocalRxSim */
 
 
 LocalRxSim::~LocalRxSim(void)
 {
+  delete file_src;
 } /* LocalRxSim::~LocalRxSim */
 
 
@@ -150,7 +341,24 @@ bool LocalRxSim::initialize(void)
   audio_gen.setPower(sim_tone_pwr_db);
 
   pacer = new Async::AudioPacer(INTERNAL_SAMPLE_RATE, 128, 0);
-  audio_gen.registerSink(pacer, true);
+
+  string audio_file;
+  if (cfg.getValue(name(), "SIM_AUDIO_FILE", audio_file) &&
+      !audio_file.empty())
+  {
+    bool loop = false;
+    cfg.getValue(name(), "SIM_AUDIO_FILE_LOOP", loop);
+    file_src = new FileSource;
+    if (!file_src->open(audio_file, loop))
+    {
+      return false;
+    }
+    file_src->registerSink(pacer, true);
+  }
+  else
+  {
+    audio_gen.registerSink(pacer, true);
+  }
 
   if (!LocalRxBase::initialize())
   {
@@ -171,14 +379,28 @@ bool LocalRxSim::initialize(void)
 
 bool LocalRxSim::audioOpen(void)
 {
-  audio_gen.enable(true);
+  if (file_src != 0)
+  {
+    file_src->enable(true);
+  }
+  else
+  {
+    audio_gen.enable(true);
+  }
   return true;
 } /* LocalRxSim::audioOpen */
 
 
 void LocalRxSim::audioClose(void)
 {
-  audio_gen.enable(false);
+  if (file_src != 0)
+  {
+    file_src->enable(false);
+  }
+  else
+  {
+    audio_gen.enable(false);
+  }
 } /* LocalRxSim::audioClose */
 
 
@@ -173,10 +173,13 @@ class LocalRxSim : public LocalRxBase
     virtual Async::AudioSource *audioSource(void);
     
   private:
+    class FileSource;
+
     static unsigned int next_seed;
 
     Async::Config         &cfg;
     Async::AudioGenerator audio_gen;
+    FileSource            *file_src;
     Async::AudioPacer     *pacer;
 };  /* class LocalRxSim */
 
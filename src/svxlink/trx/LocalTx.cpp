@@ -75,6 +75,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <HdlcFramer.h>
 #include <AfskModulator.h>
 #include <AsyncAudioFsf.h>
+#include <AsyncAudioNco.h>
 
 
 /****************************************************************************
@@ -127,10 +128,9 @@ class SineGenerator : public Async::AudioSource
 {
   public:
     explicit SineGenerator(const string& audio_dev, int channel)
-      : audio_io(audio_dev, channel), pos(0), fq(0.0), level(0.0),
-        sample_rate(0)
+      : audio_io(audio_dev, channel), fq(0.0), level(0.0)
     {
-      sample_rate = audio_io.sampleRate();
+      nco.setSampleRate(audio_io.sampleRate());
       audio_io.registerSource(this);
     }
     
@@ -142,11 +142,13 @@ class SineGenerator : public Async::AudioSource
     void setFq(double tone_fq)
     {
       fq = tone_fq;
+      nco.setTone(fq, level);
     }
     
     void setLevel(float level_db)
     {
       level = powf(10.0f, level_db / 20.0f);
+      nco.setAmplitude(level);
     }
 
     void enable(bool enable)
@@ -160,7 +162,7 @@ class SineGenerator : public Async::AudioSource
       {
       	if (audio_io.open(AudioIO::MODE_WR))
         {
-          pos = 0;
+          nco.reset();
           writeSamples();
         }
       }
@@ -187,22 +189,18 @@ class SineGenerator : public Async::AudioSource
     static const int BLOCK_SIZE = 128;
     
     AudioIO   audio_io;
-    unsigned  pos;
     double    fq;
-    double    level;
-    int       sample_rate;
+    float     level;
+    AudioNco  nco;
     
     void writeSamples(void)
     {
       int written;
       do {
 	float buf[BLOCK_SIZE];
-	for (int i=0; i<BLOCK_SIZE; ++i)
-	{
-      	  buf[i] = level * sin(2 * M_PI * fq * (pos+i) / sample_rate);
-	}
+	nco.generate(buf, BLOCK_SIZE);
 	written = sinkWriteSamples(buf, BLOCK_SIZE);
-	pos += written;
+	nco.seek(written - BLOCK_SIZE);
       } while (written != 0);
     }
     
@@ -667,6 +665,7 @@ bool LocalTx::initialize(void)
         sigc::mem_fun(*fsk_mod_ib, &AfskModulator::sendBits));
 
     AudioPacer *pacer = new AudioPacer(INTERNAL_SAMPLE_RATE, 256, 0);
+    pacer->setClockSource(audio_io);
     fsk_mod_ib->registerSink(pacer);
 
       // Connect the inband AFSK modulator to the main audio selector
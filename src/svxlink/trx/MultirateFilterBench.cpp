@@ -0,0 +1,226 @@
+/**
+@file	 MultirateFilterBench.cpp
+@brief   Benchmark and verify the decimator and interpolator classes
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-18
+
+This program run the Async::AudioDecimator and Async::AudioInterpolator
+classes with each of the coefficient sets in multirate_filter_coeff.h. The
+output is compared to the straight forward delay line shifting
+implementation, previously used in the classes, and the throughput of both
+implementations are printed.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+
+#include <AsyncAudioDecimator.h>
+#include <AsyncAudioInterpolator.h>
+
+#include "multirate_filter_coeff.h"
+
+using namespace std;
+using namespace Async;
+
+
+namespace {
+  /*
+   * Make the processSamples function accessible from the benchmark
+   */
+  class Decimator : public AudioDecimator
+  {
+    public:
+      using AudioDecimator::AudioDecimator;
+      using AudioDecimator::processSamples;
+  };
+
+  class Interpolator : public AudioInterpolator
+  {
+    public:
+      using AudioInterpolator::AudioInterpolator;
+      using AudioInterpolator::processSamples;
+  };
+
+  /*
+   * The implementations previously used in the Async library
+   */
+  class RefDecimator
+  {
+    public:
+      RefDecimator(int M, const float *H, int taps)
+        : factor_M(M), H_size(taps), p_H(H), Z(taps, 0.0f) {}
+
+      void processSamples(float *dest, const float *src, int count)
+      {
+        float *p_Z = Z.data();
+        while (count >= factor_M)
+        {
+          memmove(p_Z + factor_M, p_Z, (H_size - factor_M) * sizeof(float));
+          for (int tap = factor_M - 1; tap >= 0; tap--)
+          {
+            p_Z[tap] = *src++;
+          }
+          count -= factor_M;
+          float sum = 0.0;
+          for (int tap = 0; tap < H_size; tap++)
+          {
+            sum += p_H[tap] * p_Z[tap];
+          }
+          *dest++ = sum;
+        }
+      }
+
+    private:
+      const int           factor_M;
+      const int           H_size;
+      const float         *p_H;
+      std::vector<float>  Z;
+  };
+
+  class RefInterpolator
+  {
+    public:
+      RefInterpolator(int L, const float *H, int taps)
+        : factor_L(L), L_size(taps), p_H(H), Z(taps / L, 0.0f) {}
+
+      void processSamples(float *dest, const float *src, int count)
+      {
+        float *p_Z = Z.data();
+        int num_taps_per_phase = L_size / factor_L;
+        while (count-- > 0)
+        {
+          memmove(p_Z + 1, p_Z, (num_taps_per_phase - 1) * sizeof(float));
+          p_Z[0] = *src++;
+          for (int phase_num = 0; phase_num < factor_L; phase_num++)
+          {
+            const float *p_coeff = p_H + phase_num;
+            float sum = 0.0;
+            for (int tap = 0; tap < num_taps_per_phase; tap++)
+            {
+              sum += *p_coeff * p_Z[tap];
+              p_coeff += factor_L;
+            }
+            *dest++ = sum * factor_L;
+          }
+        }
+      }
+
+    private:
+      const int           factor_L;
+      const int           L_size;
+      const float         *p_H;
+      std::vector<float>  Z;
+  };
+
+  const int BLOCK_SIZE  = 960;
+  const int BLOCKS      = 20000;
+
+  template <typename Proc>
+  double run(Proc& proc, const vector<float>& in, vector<float>& out)
+  {
+    auto start = chrono::steady_clock::now();
+    for (int blk = 0; blk < BLOCKS; ++blk)
+    {
+      proc.processSamples(out.data(), in.data(), in.size());
+    }
+    chrono::duration<double> dur = chrono::steady_clock::now() - start;
+    return dur.count();
+  }
+
+  template <typename Proc, typename RefProc>
+  bool bench(const string& name, int factor, const float *coeff, int taps,
+             bool decimate)
+  {
+    mt19937 gen(4711);
+    uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    vector<float> in(BLOCK_SIZE);
+    for (auto& sample : in)
+    {
+      sample = dist(gen);
+    }
+    const size_t out_size = decimate ? BLOCK_SIZE / factor : BLOCK_SIZE * factor;
+    vector<float> out(out_size), ref_out(out_size);
+
+      // Verify that the output is the same, except for rounding errors
+    Proc proc(factor, coeff, taps);
+    RefProc ref(factor, coeff, taps);
+    float max_err = 0.0f;
+    for (int blk = 0; blk < 10; ++blk)
+    {
+      proc.processSamples(out.data(), in.data(), in.size());
+      ref.processSamples(ref_out.data(), in.data(), in.size());
+      for (size_t i = 0; i < out_size; ++i)
+      {
+        max_err = max(max_err, fabs(out[i] - ref_out[i]));
+      }
+    }
+
+    const double ref_time = run(ref, in, out);
+    const double new_time = run(proc, in, out);
+    const double samples = static_cast<double>(BLOCKS) * BLOCK_SIZE;
+    cout << setw(18) << left << name
+         << setw(4) << right << taps
+         << setw(12) << fixed << setprecision(1) << (samples / ref_time / 1e6)
+         << setw(12) << (samples / new_time / 1e6)
+         << setw(9) << setprecision(2) << (ref_time / new_time) << "x"
+         << setw(12) << scientific << setprecision(1) << max_err
+         << endl;
+    return max_err < 1e-5;
+  }
+};
+
+
+int main(int argc, const char **argv)
+{
+  cout << "Input throughput in million samples per second\n\n";
+  cout << setw(18) << left << "Filter" << setw(4) << right << "Taps"
+       << setw(12) << "Old" << setw(12) << "New" << setw(10) << "Speedup"
+       << setw(12) << "Max error" << endl;
+
+  bool ok = true;
+  ok &= bench<Decimator, RefDecimator>("decim 48->16 wide", 3,
+      coeff_48_16_wide, coeff_48_16_wide_taps, true);
+  ok &= bench<Decimator, RefDecimator>("decim 48->16", 3,
+      coeff_48_16, coeff_48_16_taps, true);
+  ok &= bench<Decimator, RefDecimator>("decim 16->8", 2,
+      coeff_16_8, coeff_16_8_taps, true);
+  ok &= bench<Interpolator, RefInterpolator>("interp 16->48 int", 3,
+      coeff_48_16_int, coeff_48_16_int_taps, false);
+  ok &= bench<Interpolator, RefInterpolator>("interp 16->48", 3,
+      coeff_48_16, coeff_48_16_taps, false);
+  ok &= bench<Interpolator, RefInterpolator>("interp 8->16", 2,
+      coeff_16_8, coeff_16_8_taps, false);
+
+  if (!ok)
+  {
+    cout << "*** ERROR: The output differ too much from the reference\n";
+    return 1;
+  }
+
+  return 0;
+}
@@ -32,7 +32,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <sys/time.h>
+
 #include <iostream>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <cstdlib>
@@ -78,6 +81,11 @@ using namespace NetTrxMsg;
  *
  ****************************************************************************/
 
+  // The range of clock offsets, in microseconds, that is considered to come
+  // from a remote host with a synchronized clock
+#define MIN_SYNCED_CLOCK_OFFSET -100000LL
+#define MAX_SYNCED_CLOCK_OFFSET 10000000LL
+
 
 
 /****************************************************************************
@@ -136,7 +144,8 @@ NetRx::NetRx(Config &cfg, const string& name)
     log_disconnects_once(false), log_disconnect(true),
     last_signal_strength(0.0), last_sql_rx_id(Rx::ID_UNKNOWN),
     unflushed_samples(false), sql_is_open(false), audio_dec(0), fq(0),
-    modulation(Modulation::MOD_UNKNOWN)
+    modulation(Modulation::MOD_UNKNOWN), audio_delay(0.0f),
+    min_clock_offset(0), min_clock_offset_valid(false)
 {
 } /* NetRx::NetRx */
 
@@ -326,6 +335,12 @@ void NetRx::reset(void)
 } /* NetRx::reset */
 
 
+unsigned NetRx::audioDelay(void) const
+{
+  return static_cast<unsigned>(audio_delay + 0.5f);
+} /* NetRx::audioDelay */
+
+
 void NetRx::setFq(unsigned fq)
 {
   this->fq = fq;
@@ -455,6 +470,7 @@ void NetRx::handleMsg(Msg *msg)
         last_sql_activity_info = sql_msg->sqlActivityInfo();
         if (sql_msg->isOpen())
         {
+          min_clock_offset_valid = false;
           setSquelchState(true, last_sql_activity_info);
         }
         else
@@ -528,6 +544,15 @@ void NetRx::handleMsg(Msg *msg)
       break;
     }
 
+    case MsgAudioTimestamp::TYPE:
+    {
+      if (msg->size() == sizeof(MsgAudioTimestamp))
+      {
+        updateAudioDelay(reinterpret_cast<MsgAudioTimestamp*>(msg));
+      }
+      break;
+    }
+
     case MsgSel5::TYPE:
     {
       if (muteState() == Rx::MUTE_NONE)
@@ -586,6 +611,30 @@ void NetRx::publishSquelchState(void)
 } /* NetRx::publishSquelchState */
 
 
+void NetRx::updateAudioDelay(const MsgAudioTimestamp *msg)
+{
+  struct timeval now, sent, diff;
+  gettimeofday(&now, NULL);
+  msg->timestamp(sent);
+  timersub(&now, &sent, &diff);
+  long long offset = diff.tv_sec * 1000000LL + diff.tv_usec;
+  long long delay = offset;
+  if ((offset < MIN_SYNCED_CLOCK_OFFSET) || (offset > MAX_SYNCED_CLOCK_OFFSET))
+  {
+      // The clocks are not synchronized so only measure the delay relative
+      // to the fastest message received since the squelch opened
+    if (!min_clock_offset_valid || (offset < min_clock_offset))
+    {
+      min_clock_offset = offset;
+      min_clock_offset_valid = true;
+    }
+    delay = offset - min_clock_offset;
+  }
+  delay = max(delay, 0LL);
+  audio_delay += (delay / 1000.0f - audio_delay) / 8.0f;
+} /* NetRx::updateAudioDelay */
+
+
 
 /*
  * This file has not been truncated
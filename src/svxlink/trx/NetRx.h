@@ -68,6 +68,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 namespace NetTrxMsg
 {
   class Msg;
+  class MsgAudioTimestamp;
 };
 
 namespace Async
@@ -172,6 +173,16 @@ class NetRx : public Rx
      * @returns Returns the RX ID
      */
     char sqlRxId(void) const { return last_sql_rx_id; }
+
+    /**
+     * @brief   Get the estimated transport delay of the received audio
+     * @return  Returns the delay in milliseconds
+     *
+     * The delay is calculated from the time stamps sent by the remote
+     * receiver. If the clocks are not synchronized, only the variation of
+     * the delay since the squelch opened can be measured.
+     */
+    unsigned audioDelay(void) const;
         
     /**
      * @brief 	Reset the receiver object to its default settings
@@ -215,12 +226,16 @@ class NetRx : public Rx
     unsigned            fq;
     Modulation::Type    modulation;
     std::string         last_sql_activity_info;
+    float               audio_delay;
+    long long           min_clock_offset;
+    bool                min_clock_offset_valid;
 
     void connectionReady(bool is_ready);
     void handleMsg(NetTrxMsg::Msg *msg);
     void sendMsg(NetTrxMsg::Msg *msg);
     void allEncodedSamplesFlushed(void);
     void publishSquelchState(void);
+    void updateAudioDelay(const NetTrxMsg::MsgAudioTimestamp *msg);
 
 };  /* class NetRx */
 
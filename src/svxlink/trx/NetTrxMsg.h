@@ -35,6 +35,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <sys/time.h>
+#include <stdint.h>
+
 #include <cassert>
 #include <cstring>
 #include <iostream>
@@ -429,6 +432,32 @@ class MsgAudio : public Msg
 }; /* MsgAudio */
 
 
+/*
+ * Sent by the remote side just before each MsgAudio. The time stamp is the
+ * time of day when the audio was sent. If the clocks on both sides are
+ * synchronized, e.g. using NTP, the receiving side can calculate the
+ * transport delay of the audio. Older receivers ignore this message.
+ */
+class MsgAudioTimestamp : public Msg
+{
+  public:
+    static const unsigned TYPE = 103;
+    explicit MsgAudioTimestamp(const struct timeval& tv)
+      : Msg(TYPE, sizeof(MsgAudioTimestamp)), m_sec(tv.tv_sec),
+        m_usec(tv.tv_usec) {}
+    void timestamp(struct timeval& tv) const
+    {
+      tv.tv_sec = m_sec;
+      tv.tv_usec = m_usec;
+    }
+
+  private:
+    int64_t   m_sec;
+    uint32_t  m_usec;
+
+}; /* MsgAudioTimestamp */
+
+
 
 /******************************** RX Messages ********************************/
 
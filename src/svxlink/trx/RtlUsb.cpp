@@ -52,6 +52,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncFdWatch.h>
+#include <AsyncMetrics.h>
 
 
 /****************************************************************************
@@ -548,6 +549,10 @@ void RtlUsb::rtlReader(void)
     ssize_t ret = write(sample_pipe[1], buf, n_read);
     if (!do_exit && (ret != n_read))
     {
+      Async::Metrics::instance().counter("svxlink_ddr_dropped_samples_total",
+          "Number of I/Q samples lost between the RTL dongle and the DDR",
+          Async::Metrics::label("device", displayName())
+        ).inc((n_read - std::max(ret, ssize_t(0))) / 2);
       cerr << "*** ERROR: Samples were lost while writing to RTL "
               "sample pipe\n";
       break;
@@ -227,6 +227,16 @@ class Rx : public sigc::trackable, public Async::AudioSource
      * @returns Returns the RX ID
      */
     virtual char sqlRxId(void) const { return ID_UNKNOWN; }
+
+    /**
+     * @brief   Get the estimated transport delay of the received audio
+     * @return  Returns the delay in milliseconds
+     *
+     * The delay is the time it takes for the audio to get from the receiver
+     * hardware to this receiver object, e.g. over a network link. It is used
+     * by the voter to time align audio from different receivers.
+     */
+    virtual unsigned audioDelay(void) const { return 0; }
     
     /**
      * @brief 	Reset the receiver object to its default settings
@@ -146,6 +146,7 @@ bool SigLevDetNoise::initialize(Config &cfg, const string& name,
   {
     filter = new AudioFilter("HpBu4/3500", sample_rate);
   }
+  filter->setBackend(AudioFilter::BACKEND_BIQUAD);
   setHandler(filter);
   sigc_sink = new SigCAudioSink;
   sigc_sink->sigWriteSamples.connect(
@@ -200,24 +201,19 @@ void SigLevDetNoise::setIntegrationTime(int time_ms)
     time_ms = BLOCK_TIME;
   }
   integration_time = time_ms * sample_rate / 1000;
-
-  while (ss_idx.size() > integration_time / block_len)
-  {
-    ss_values.erase(*ss_idx.begin());
-    ss_idx.pop_front();
-  }
+  ss_values.setCapacity(integration_time / block_len);
 } /* SigLevDetNoise::setIntegrationTime */
 
 
 float SigLevDetNoise::lastSiglev(void) const
 {
-  if (ss_idx.empty())
+  if (ss_values.empty())
   {
     return 0.0f;
   }
 
     // Calculate the siglev value
-  float siglev = offset - slope * log10(*ss_idx.back());
+  float siglev = offset - slope * log10(ss_values.back());
 
     // If the siglev value is way above 100 (like 120), it's probably bogus.
     // It's likely that this is caused by a closed squelch on the receiver or
@@ -227,7 +223,7 @@ float SigLevDetNoise::lastSiglev(void) const
     return 0.0f;
   }
 
-  return offset - slope * log10(*ss_idx.back());
+  return offset - slope * log10(ss_values.back());
 
 } /* SigLevDetNoise::lastSiglev */
 
@@ -248,7 +244,7 @@ float SigLevDetNoise::siglevIntegrated(void) const
     // calibration but we'll try to have it hard coded for now.
     // If the BLOCK_TIME is changed, the compensation probably will have to
     // be changed too.
-  float siglev = offset - slope * (log10(*ss_values.begin()) + 0.25);
+  float siglev = offset - slope * (log10(ss_values.min()) + 0.25);
 
     // If the siglev value is way above 100 (like 120), it's probably bogus.
     // It's likely that this is caused by a closed squelch on the receiver or
@@ -268,7 +264,6 @@ void SigLevDetNoise::reset(void)
   filter->reset();
   update_counter = 0;
   ss_values.clear();
-  ss_idx.clear();
   ss_cnt = 0;
   ss = 0.0;
 } /* SigLevDetNoise::reset */
@@ -297,14 +292,7 @@ int SigLevDetNoise::processSamples(float *samples, int count)
     ss += static_cast<double>(sample) * sample;
     if (++ss_cnt >= block_len)
     {
-      SsSetIter it = ss_values.insert(ss);
-      ss_idx.push_back(it);
-      if (ss_idx.size() > integration_time / block_len)
-      {
-        ss_values.erase(*ss_idx.begin());
-        ss_idx.pop_front();
-      }
-
+      ss_values.push(ss);
       ss = 0.0;
       ss_cnt = 0;
     }
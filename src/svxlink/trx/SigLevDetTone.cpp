@@ -199,7 +199,8 @@ bool SigLevDetTone::initialize(Config &cfg, const string& name, int sample_rate)
 
   this->sample_rate = sample_rate;
 
-  filter = new AudioFilter("BpBu8/5400-6500", sample_rate);
+  filter = new AudioFilter("BpBu8/5400-6500", sample_rate,
+                           AudioFilter::BACKEND_BIQUAD);
   setHandler(filter);
 
   SigCAudioSink *sigc_sink = new SigCAudioSink;
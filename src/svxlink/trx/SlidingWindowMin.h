@@ -0,0 +1,265 @@
+/**
+@file	 SlidingWindowMin.h
+@brief   A fixed capacity sliding window minimum tracker
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-18
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef SLIDING_WINDOW_MIN_INCLUDED
+#define SLIDING_WINDOW_MIN_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+  
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A fixed capacity sliding window minimum tracker
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-18
+
+This class keep track of the minimum value of the last N values that have been
+pushed into it. The values are stored in a ring buffer and a monotonic queue,
+also stored in a ring buffer, keep track of the candidates for being the
+minimum value. Pushing a value is done in amortized constant time and reading
+the minimum value is done in constant time.
+
+No memory is allocated when pushing values so the class is suitable for use in
+audio processing paths. Memory is only allocated when the capacity is changed.
+*/
+template <typename T>
+class SlidingWindowMin
+{
+  public:
+    /**
+     * @brief 	Constuctor
+     * @param 	capacity The maximum number of values in the window
+     */
+    explicit SlidingWindowMin(size_t capacity=0)
+    {
+      setCapacity(capacity);
+    }
+
+    /**
+     * @brief   Set the capacity of the window
+     * @param   capacity The maximum number of values in the window
+     *
+     * If the new capacity is smaller than the number of values currently in
+     * the window, the oldest values are thrown away. With a capacity of zero
+     * all pushed values are immediately discarded.
+     */
+    void setCapacity(size_t capacity)
+    {
+      std::vector<T> keep;
+      keep.reserve(std::min(m_count, capacity));
+      for (size_t i=m_count - std::min(m_count, capacity); i<m_count; ++i)
+      {
+        keep.push_back(m_vals[(m_first + i) % m_vals.size()]);
+      }
+      m_vals.assign(capacity, T());
+      m_mins.assign(capacity, 0);
+      clear();
+      for (const auto& val : keep)
+      {
+        push(val);
+      }
+    }
+
+    /**
+     * @brief   Get the capacity of the window
+     * @return  Returns the maximum number of values in the window
+     */
+    size_t capacity(void) const { return m_vals.size(); }
+
+    /**
+     * @brief   Get the number of values currently in the window
+     * @return  Returns the number of values in the window
+     */
+    size_t size(void) const { return m_count; }
+
+    /**
+     * @brief   Check if the window is empty
+     * @return  Returns \em true if there are no values in the window
+     */
+    bool empty(void) const { return m_count == 0; }
+
+    /**
+     * @brief   Remove all values from the window
+     */
+    void clear(void)
+    {
+      m_first = 0;
+      m_count = 0;
+      m_mins_first = 0;
+      m_mins_count = 0;
+    }
+
+    /**
+     * @brief   Push a new value into the window
+     * @param   val The value to add
+     *
+     * If the window is full, the oldest value is removed.
+     */
+    void push(const T& val)
+    {
+      const size_t cap = m_vals.size();
+      if (cap == 0)
+      {
+        return;
+      }
+
+      if (m_count == cap)
+      {
+        if (m_mins[m_mins_first] == m_first)
+        {
+          m_mins_first = (m_mins_first + 1) % cap;
+          --m_mins_count;
+        }
+        m_first = (m_first + 1) % cap;
+        --m_count;
+      }
+
+      const size_t pos = (m_first + m_count) % cap;
+      m_vals[pos] = val;
+      ++m_count;
+
+        // Remove all candidates that can never become the minimum again
+      while ((m_mins_count > 0) &&
+             !(m_vals[m_mins[(m_mins_first + m_mins_count - 1) % cap]] < val))
+      {
+        --m_mins_count;
+      }
+      m_mins[(m_mins_first + m_mins_count) % cap] = pos;
+      ++m_mins_count;
+    }
+
+    /**
+     * @brief   Get the minimum value in the window
+     * @return  Returns the minimum value
+     *
+     * The window must not be empty when calling this function.
+     */
+    const T& min(void) const { return m_vals[m_mins[m_mins_first]]; }
+
+    /**
+     * @brief   Get the most recently pushed value
+     * @return  Returns the newest value in the window
+     *
+     * The window must not be empty when calling this function.
+     */
+    const T& back(void) const
+    {
+      return m_vals[(m_first + m_count - 1) % m_vals.size()];
+    }
+
+  private:
+    std::vector<T>      m_vals;
+    std::vector<size_t> m_mins;
+    size_t              m_first       = 0;
+    size_t              m_count       = 0;
+    size_t              m_mins_first  = 0;
+    size_t              m_mins_count  = 0;
+
+};  /* class SlidingWindowMin */
+
+
+//} /* namespace */
+
+#endif /* SLIDING_WINDOW_MIN_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
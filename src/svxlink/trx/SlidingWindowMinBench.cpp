@@ -0,0 +1,164 @@
+/**
+@file	 SlidingWindowMinBench.cpp
+@brief   Benchmark and verify the SlidingWindowMin class
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-18
+
+This program compare the SlidingWindowMin class with the multiset based
+implementation previously used in SigLevDetNoise. Both the result and the
+execution time are compared.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <set>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+
+#include "SlidingWindowMin.h"
+
+using namespace std;
+
+
+namespace {
+  /*
+   * The implementation previously used in SigLevDetNoise
+   */
+  class MultisetWindowMin
+  {
+    public:
+      explicit MultisetWindowMin(size_t capacity) : capacity(capacity) {}
+
+      void push(double val)
+      {
+        idx.push_back(values.insert(val));
+        if (idx.size() > capacity)
+        {
+          values.erase(*idx.begin());
+          idx.pop_front();
+        }
+      }
+
+      double min(void) const { return *values.begin(); }
+
+    private:
+      typedef std::multiset<double> SsSet;
+      typedef SsSet::const_iterator SsSetIter;
+
+      size_t                capacity;
+      SsSet                 values;
+      std::list<SsSetIter>  idx;
+  };
+
+  const size_t RECEIVERS  = 24;
+  const size_t BLOCKS     = 200000;
+
+  template <typename Window>
+  double run(vector<Window>& windows, const vector<double>& input,
+             double& checksum)
+  {
+    auto start = chrono::steady_clock::now();
+    checksum = 0.0;
+    for (size_t i=0; i<input.size(); ++i)
+    {
+      for (auto& w : windows)
+      {
+        w.push(input[i]);
+        checksum += w.min();
+      }
+    }
+    chrono::duration<double> dur = chrono::steady_clock::now() - start;
+    return dur.count();
+  }
+};
+
+
+int main(int argc, const char **argv)
+{
+    // Window length in blocks. The SigLevDetNoise block length is 25ms so
+    // the default of 40 blocks correspond to an integration time of 1s.
+  size_t capacity = 40;
+  if (argc > 1)
+  {
+    capacity = atoi(argv[1]);
+  }
+
+  mt19937 gen(4711);
+  lognormal_distribution<double> dist(0.0, 2.0);
+  vector<double> input(BLOCKS);
+  for (auto& val : input)
+  {
+    val = dist(gen);
+  }
+
+    // Verify that both implementations give the same result, also when
+    // changing the capacity on the fly
+  MultisetWindowMin ref(capacity);
+  SlidingWindowMin<double> win(capacity / 2);
+  for (size_t i=0; i<capacity; ++i)
+  {
+    win.push(input[i]);
+  }
+  win.setCapacity(capacity);
+  for (size_t i=capacity/2; i<capacity; ++i)
+  {
+    ref.push(input[i]);
+  }
+  for (size_t i=capacity; i<input.size(); ++i)
+  {
+    ref.push(input[i]);
+    win.push(input[i]);
+    if (ref.min() != win.min())
+    {
+      cout << "*** ERROR: Mismatch at block " << i << ": "
+           << ref.min() << " != " << win.min() << endl;
+      exit(1);
+    }
+  }
+  cout << "Verification OK\n";
+
+  vector<MultisetWindowMin> ref_windows(RECEIVERS,
+                                        MultisetWindowMin(capacity));
+  vector<SlidingWindowMin<double> > new_windows(RECEIVERS,
+      SlidingWindowMin<double>(capacity));
+  double ref_sum, new_sum;
+  double ref_time = run(ref_windows, input, ref_sum);
+  double new_time = run(new_windows, input, new_sum);
+
+  const double ops = static_cast<double>(RECEIVERS) * BLOCKS;
+  cout << "Window length:     " << capacity << " blocks\n";
+  cout << "Receivers:         " << RECEIVERS << "\n";
+  cout << "Blocks/receiver:   " << BLOCKS << "\n";
+  cout << "multiset + list:   " << (ref_time * 1e9 / ops) << " ns/block\n";
+  cout << "SlidingWindowMin:  " << (new_time * 1e9 / ops) << " ns/block\n";
+  cout << "Speedup:           " << (ref_time / new_time) << "x\n";
+
+  if (ref_sum != new_sum)
+  {
+    cout << "*** ERROR: Checksum mismatch\n";
+    return 1;
+  }
+
+  return 0;
+}
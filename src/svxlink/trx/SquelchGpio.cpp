@@ -38,6 +38,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/epoll.h>
 
 
 /****************************************************************************
@@ -47,6 +48,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncTimer.h>
+#include <AsyncFdWatch.h>
 
 
 /****************************************************************************
@@ -118,9 +120,11 @@ using namespace Async;
  ****************************************************************************/
 
 SquelchGpio::SquelchGpio(void)
-  : fd(-1), timer(0), active_low(false), gpio_path("/sys/class/gpio")
+  : fd(-1), timer(0), active_low(false), gpio_path("/sys/class/gpio"),
+    epoll_fd(-1), watch(0)
 {
-  
+  debouncer.stateChanged.connect(
+      [this](bool is_active) { setSignalDetected(is_active); });
 } /* SquelchGpio::SquelchGpio */
 
 
@@ -128,6 +132,13 @@ SquelchGpio::~SquelchGpio(void)
 {
   delete timer;
   timer = 0;
+  delete watch;
+  watch = 0;
+  if (epoll_fd >= 0)
+  {
+    close(epoll_fd);
+    epoll_fd = -1;
+  }
   if (fd >= 0)
   {
     close(fd);
@@ -170,12 +181,25 @@ bool SquelchGpio::initialize(Async::Config& cfg, const std::string& rx_name)
     return false;
   }
 
+  unsigned debounce = 0;
+  cfg.getValue(rx_name, "GPIO_SQL_DEBOUNCE", debounce);
+  debouncer.setDebounceTime(debounce);
+
+  bool use_edge_events = true;
+  cfg.getValue(rx_name, "GPIO_SQL_EVENTS", use_edge_events);
+  if (use_edge_events && setupEdgeEvents(rx_name, sql_pin))
+  {
+      // Read the initial state since only changes are reported from now on
+    readGpioValueData();
+    return true;
+  }
+
   timer = new Timer(100, Timer::TYPE_PERIODIC);
   timer->expired.connect(
       hide(mem_fun(*this, &SquelchGpio::readGpioValueData)));
 
   return true;
-}
+} /* SquelchGpio::initialize */
 
 
 
@@ -194,7 +218,10 @@ bool SquelchGpio::initialize(Async::Config& cfg, const std::string& rx_name)
  ****************************************************************************/
 
 /**
- * @brief  Called by a timer to periodically read the state of the GPIO pin
+ * @brief  Read the state of the GPIO pin
+ *
+ * Called on each edge event or, if edge events are not available, by a timer
+ * to periodically poll the state of the GPIO pin.
  *
  * An example of reading a GPIO ports can be found at:
  * http://elinux.org/RPi_Low-level_peripherals#C_.2B_sysfs
@@ -228,12 +255,79 @@ void SquelchGpio::readGpioValueData(void)
     return;
   }
 
-  bool is_active = active_low ^ (value == '1');
-  if (signalDetected() != is_active)
+  debouncer.setState(active_low ^ (value == '1'));
+} /* SquelchGpio::readGpioValueData */
+
+
+/**
+ * @brief  Set up the GPIO pin to report edge events
+ *
+ * The sysfs GPIO interface signals a changed pin value using POLLPRI. Since
+ * an Async::FdWatch only can watch for readability, the value file is added
+ * to an epoll instance which in turn becomes readable when an event is
+ * pending.
+ */
+bool SquelchGpio::setupEdgeEvents(const string& rx_name, const string& sql_pin)
+{
+  stringstream ss;
+  ss << gpio_path << "/" << sql_pin << "/edge";
+  int edge_fd = open(ss.str().c_str(), O_WRONLY);
+  if ((edge_fd < 0) || (write(edge_fd, "both", 4) != 4))
   {
-    setSignalDetected(is_active);
+    cerr << "*** WARNING: Could not enable edge events using " << ss.str()
+         << " for RX " << rx_name << ": " << strerror(errno)
+         << ". Falling back to polling the squelch GPIO pin." << endl;
+    if (edge_fd >= 0)
+    {
+      close(edge_fd);
+    }
+    return false;
   }
-} /* SquelchGpio::readGpioValueData */
+  close(edge_fd);
+
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd < 0)
+  {
+    cerr << "*** WARNING: epoll_create1 failed for RX " << rx_name << ": "
+         << strerror(errno)
+         << ". Falling back to polling the squelch GPIO pin." << endl;
+    return false;
+  }
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLPRI | EPOLLERR;
+  ev.data.fd = fd;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+  {
+    cerr << "*** WARNING: epoll_ctl failed for RX " << rx_name << ": "
+         << strerror(errno)
+         << ". Falling back to polling the squelch GPIO pin." << endl;
+    close(epoll_fd);
+    epoll_fd = -1;
+    return false;
+  }
+
+  watch = new FdWatch(epoll_fd, FdWatch::FD_WATCH_RD);
+  watch->activity.connect(hide(mem_fun(*this, &SquelchGpio::handleEdgeEvent)));
+
+  return true;
+} /* SquelchGpio::setupEdgeEvents */
+
+
+void SquelchGpio::handleEdgeEvent(void)
+{
+  struct epoll_event ev;
+  int cnt = epoll_wait(epoll_fd, &ev, 1, 0);
+  if (cnt < 0)
+  {
+    cerr << "*** WARNING: SquelchGpio::handleEdgeEvent: epoll_wait failed: "
+         << strerror(errno) << endl;
+    return;
+  }
+
+    // Reading the value will also acknowledge the event
+  readGpioValueData();
+} /* SquelchGpio::handleEdgeEvent */
 
 
 
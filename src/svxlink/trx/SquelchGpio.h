@@ -52,6 +52,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "Squelch.h"
+#include "GpioDebouncer.h"
 
 
 /****************************************************************************
@@ -63,6 +64,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 namespace Async
 {
   class Timer;
+  class FdWatch;
 };
 
 
@@ -142,14 +144,20 @@ class SquelchGpio : public Squelch
   protected:
 
   private:
-    int           fd;
-    Async::Timer  *timer;
-    bool          active_low;
-    std::string   gpio_path;
+    int             fd;
+    Async::Timer    *timer;
+    bool            active_low;
+    std::string     gpio_path;
+    int             epoll_fd;
+    Async::FdWatch  *watch;
+    GpioDebouncer   debouncer;
 
     SquelchGpio(const SquelchGpio&);
     SquelchGpio& operator=(const SquelchGpio&);
     void readGpioValueData(void);
+    bool setupEdgeEvents(const std::string& rx_name,
+                         const std::string& sql_pin);
+    void handleEdgeEvent(void);
 
 };  /* class SquelchGpio */
 
@@ -30,9 +30,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <time.h>
+
 #include <cstring>
 #include <cerrno>
 #include <sstream>
+#include <cstdlib>
 
 
 /****************************************************************************
@@ -75,6 +78,40 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#if GPIOD_VERSION_MAJOR < 2
+namespace {
+  int64_t tsToNs(const struct timespec& ts)
+  {
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+  }
+
+  /**
+   * @brief  Convert a libgpiod v1 event timestamp to CLOCK_MONOTONIC
+   *
+   * Kernels before 5.7 timestamp line events using CLOCK_REALTIME while
+   * later kernels use CLOCK_MONOTONIC. Find out which clock the timestamp
+   * is closest to and translate it to the monotonic time base.
+   */
+  struct timespec eventTsToMonotonic(const struct timespec& ts)
+  {
+    struct timespec mono, real;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+    int64_t ev_ns = tsToNs(ts);
+    int64_t mono_ns = tsToNs(mono);
+    int64_t real_ns = tsToNs(real);
+    if (std::llabs(real_ns - ev_ns) < std::llabs(mono_ns - ev_ns))
+    {
+      ev_ns = mono_ns - (real_ns - ev_ns);
+    }
+    struct timespec ret;
+    ret.tv_sec = ev_ns / 1000000000LL;
+    ret.tv_nsec = ev_ns % 1000000000LL;
+    return ret;
+  } /* eventTsToMonotonic */
+};
+#endif
+
 
 
 /****************************************************************************
@@ -108,17 +145,24 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 SquelchGpiod::SquelchGpiod(void)
-  : m_timer(100, Async::Timer::TYPE_PERIODIC)
+  : m_timer(100, Async::Timer::TYPE_PERIODIC, false)
 {
+  m_debouncer.stateChanged.connect(
+      [this](bool is_active) { setSignalDetected(is_active); });
 } /* SquelchGpiod::SquelchGpiod */
 
 
 SquelchGpiod::~SquelchGpiod(void)
 {
   m_timer.setEnable(false);
-  //m_watch.setEnabled(false);
+  m_watch.setEnabled(false);
 
 #if GPIOD_VERSION_MAJOR >= 2
+  if (m_event_buf != nullptr)
+  {
+    gpiod_edge_event_buffer_free(m_event_buf);
+    m_event_buf = nullptr;
+  }
   if (m_request != nullptr)
   {
     gpiod_line_request_release(m_request);
@@ -227,6 +271,13 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
   std::string bias;
   cfg.getValue(rx_name, "SQL_GPIOD_BIAS", bias);
 
+  bool use_events = true;
+  cfg.getValue(rx_name, "SQL_GPIOD_EVENTS", use_events);
+
+  unsigned debounce = 0;
+  cfg.getValue(rx_name, "SQL_GPIOD_DEBOUNCE", debounce);
+  m_debouncer.setDebounceTime(debounce);
+
 #if GPIOD_VERSION_MAJOR >= 2
     // Create line settings
   struct gpiod_line_settings* settings = gpiod_line_settings_new();
@@ -244,6 +295,12 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
     gpiod_line_settings_set_active_low(settings, true);
   }
 
+  if (use_events)
+  {
+    gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+    gpiod_line_settings_set_event_clock(settings, GPIOD_LINE_CLOCK_MONOTONIC);
+  }
+
     // Handle bias settings
   if (!bias.empty())
   {
@@ -305,6 +362,22 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
 
     // Request the line
   m_request = gpiod_chip_request_lines(m_chip, req_config, config);
+  if ((m_request == nullptr) && use_events)
+  {
+    std::cerr << "*** WARNING: Request GPIOD line \"" << line
+              << "\" with edge detection failed for RX \"" << rx_name
+              << "\": " << std::strerror(errno)
+              << ". Falling back to polling the squelch GPIO line."
+              << std::endl;
+    use_events = false;
+    gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_NONE);
+    gpiod_line_config_reset(config);
+    if (gpiod_line_config_add_line_settings(config, &m_line_offset, 1,
+                                            settings) == 0)
+    {
+      m_request = gpiod_chip_request_lines(m_chip, req_config, config);
+    }
+  }
   if (m_request == nullptr)
   {
     std::cerr << "*** ERROR: Request GPIOD line \"" << line
@@ -321,8 +394,20 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
   gpiod_line_config_free(config);
   gpiod_line_settings_free(settings);
 
-    // Set up timer for polling
-  m_timer.expired.connect([=](Async::Timer*) {
+  if (use_events)
+  {
+    m_event_buf = gpiod_edge_event_buffer_new(EVENT_BUF_SIZE);
+    if (m_event_buf == nullptr)
+    {
+      std::cerr << "*** ERROR: Failed to create edge event buffer for RX \""
+                << rx_name << "\"" << std::endl;
+      return false;
+    }
+    m_watch.setFd(gpiod_line_request_get_fd(m_request),
+                  Async::FdWatch::FD_WATCH_RD);
+  }
+
+  auto read_value = [=](void) {
         enum gpiod_line_value val =
           gpiod_line_request_get_value(m_request, m_line_offset);
         if (val == GPIOD_LINE_VALUE_ERROR)
@@ -332,13 +417,15 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
                     << std::strerror(errno) << std::endl;
           return;
         }
-        setSignalDetected(val == GPIOD_LINE_VALUE_ACTIVE);
-      });
+        m_debouncer.setState(val == GPIOD_LINE_VALUE_ACTIVE);
+      };
 #else
     // libgpiod v1
   struct gpiod_line_request_config req_cfg;
   req_cfg.consumer = "SvxLink";
-  req_cfg.request_type = GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+  req_cfg.request_type = use_events
+    ? GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES
+    : GPIOD_LINE_REQUEST_DIRECTION_INPUT;
   req_cfg.flags = 0;
 
   if (active_low)
@@ -380,6 +467,17 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
   }
 
   int ret = gpiod_line_request(m_line, &req_cfg, 0);
+  if ((ret < 0) && use_events)
+  {
+    std::cerr << "*** WARNING: Request GPIOD line \"" << line
+              << "\" with edge detection failed for RX \"" << rx_name
+              << "\": " << std::strerror(errno)
+              << ". Falling back to polling the squelch GPIO line."
+              << std::endl;
+    use_events = false;
+    req_cfg.request_type = GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+    ret = gpiod_line_request(m_line, &req_cfg, 0);
+  }
   if (ret < 0)
   {
     std::cerr << "*** ERROR: Set GPIOD line \"" << line
@@ -388,7 +486,13 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
     return false;
   }
 
-  m_timer.expired.connect([=](Async::Timer*) {
+  if (use_events)
+  {
+    m_watch.setFd(gpiod_line_event_get_fd(m_line),
+                  Async::FdWatch::FD_WATCH_RD);
+  }
+
+  auto read_value = [=](void) {
         int val = gpiod_line_get_value(m_line);
         if (val < 0)
         {
@@ -397,10 +501,25 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
                     << std::strerror(errno) << std::endl;
           return;
         }
-        setSignalDetected(val > 0);
-      });
+        m_debouncer.setState(val > 0);
+      };
 #endif
 
+  if (use_events)
+  {
+    m_watch.activity.connect(
+        sigc::hide(sigc::mem_fun(*this, &SquelchGpiod::readGpioEvents)));
+  }
+  else
+  {
+      // Set up timer for polling
+    m_timer.expired.connect([=](Async::Timer*) { read_value(); });
+    m_timer.setEnable(true);
+  }
+
+    // Read the initial state since only changes are reported by edge events
+  read_value();
+
   return true;
 } /* SquelchGpiod::initialize */
 
@@ -411,30 +530,52 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
  *
  ****************************************************************************/
 
-#if 0
-void SquelchGpiod::readGpioValueData(void)
+/**
+ * @brief  Read pending edge events from the GPIO line
+ *
+ * The kernel timestamp of each event is handed to the debouncer so that the
+ * debounce time is measured from when the edge actually occurred. Edges are
+ * reported in the logical (active low adjusted) domain.
+ */
+void SquelchGpiod::readGpioEvents(void)
 {
-  struct gpiod_line_event event;
-  int ret = gpiod_line_event_read_fd(m_watch.fd(), &event);
-  if (ret < 0)
+#if GPIOD_VERSION_MAJOR >= 2
+  int cnt = gpiod_line_request_read_edge_events(m_request, m_event_buf,
+                                                EVENT_BUF_SIZE);
+  if (cnt < 0)
   {
-    std::cerr << "*** WARNING: SquelchGpiod::readGpioValueData: "
-                 "gpiod_line_event_read failed: "
+    std::cerr << "*** WARNING: SquelchGpiod::readGpioEvents: "
+                 "gpiod_line_request_read_edge_events failed: "
               << std::strerror(errno) << std::endl;
     return;
   }
-
-  int event_type = event.event_type;
-  if (event_type == GPIOD_LINE_EVENT_RISING_EDGE)
+  for (int i=0; i<cnt; ++i)
   {
-    setSignalDetected(true);
+    struct gpiod_edge_event* event =
+      gpiod_edge_event_buffer_get_event(m_event_buf, i);
+    uint64_t ts_ns = gpiod_edge_event_get_timestamp_ns(event);
+    struct timespec ts;
+    ts.tv_sec = ts_ns / 1000000000ULL;
+    ts.tv_nsec = ts_ns % 1000000000ULL;
+    m_debouncer.setState(
+        gpiod_edge_event_get_event_type(event) == GPIOD_EDGE_EVENT_RISING_EDGE,
+        ts);
   }
-  else if (event_type == GPIOD_LINE_EVENT_FALLING_EDGE)
+#else
+  struct gpiod_line_event event;
+  int ret = gpiod_line_event_read_fd(m_watch.fd(), &event);
+  if (ret < 0)
   {
-    setSignalDetected(false);
+    std::cerr << "*** WARNING: SquelchGpiod::readGpioEvents: "
+                 "gpiod_line_event_read_fd failed: "
+              << std::strerror(errno) << std::endl;
+    return;
   }
-} /* SquelchGpiod::readGpioValueData */
+
+  m_debouncer.setState(event.event_type == GPIOD_LINE_EVENT_RISING_EDGE,
+                       eventTsToMonotonic(event.ts));
 #endif
+} /* SquelchGpiod::readGpioEvents */
 
 
 /*
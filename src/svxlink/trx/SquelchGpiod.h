@@ -44,7 +44,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
-//#include <AsyncFdWatch.h>
+#include <AsyncFdWatch.h>
 #include <AsyncTimer.h>
 
 
@@ -55,6 +55,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "Squelch.h"
+#include "GpioDebouncer.h"
 
 
 /****************************************************************************
@@ -111,7 +112,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 @date   2021-08-13
 
 This squelch detector read the squelch indicator signal from a GPIO input pin
-using the gpiod library.
+using the gpiod library. By default the line is requested with edge detection
+enabled so that squelch changes are picked up as soon as the kernel report
+them. If edge events cannot be used, the line is polled every 100ms.
 */
 class SquelchGpiod : public Squelch
 {
@@ -138,17 +141,21 @@ class SquelchGpiod : public Squelch
     bool initialize(Async::Config& cfg, const std::string& rx_name);
 
   private:
-    Async::Timer                m_timer;
-    //Async::FdWatch             m_watch;
-    struct gpiod_chip*          m_chip          = nullptr;
+    static const size_t EVENT_BUF_SIZE = 16;
+
+    Async::Timer                    m_timer;
+    Async::FdWatch                  m_watch;
+    GpioDebouncer                   m_debouncer;
+    struct gpiod_chip*              m_chip          = nullptr;
 #if GPIOD_VERSION_MAJOR >= 2
-    struct gpiod_line_request*  m_request       = nullptr;
-    unsigned int                m_line_offset;
+    struct gpiod_line_request*      m_request       = nullptr;
+    unsigned int                    m_line_offset;
+    struct gpiod_edge_event_buffer* m_event_buf     = nullptr;
 #else
-    struct gpiod_line*          m_line          = nullptr;
+    struct gpiod_line*              m_line          = nullptr;
 #endif
 
-    //void readGpioValueData(void);
+    void readGpioEvents(void);
 
 };  /* class SquelchGpiod */
 
@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cstdlib>
 #include <utility>
 #include <list>
+#include <deque>
 #include <sigc++/bind.h>
 #include <sys/time.h>
 #include <json/json.h>
@@ -56,6 +57,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioFifo.h>
 #include <AsyncAudioSelector.h>
 #include <AsyncAudioValve.h>
+#include <AsyncAudioPassthrough.h>
+#include <AsyncMetrics.h>
 #include <AsyncPty.h>
 #include <AsyncPtyStreamBuf.h>
 
@@ -67,6 +70,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "Voter.h"
+#include "VoterQuality.h"
 
 
 
@@ -88,6 +92,12 @@ using namespace Async;
  *
  ****************************************************************************/
 
+  // The decay per audio block of the peak link delay
+#define LINK_DELAY_DECAY 0.999f
+
+  // The buffer length is extended in steps of this many milliseconds
+#define BUFFER_LENGTH_STEP 50
+
 
 
 /****************************************************************************
@@ -96,6 +106,36 @@ using namespace Async;
  *
  ****************************************************************************/
 
+/**
+ * @brief An audio passthrough that report the samples passed
+ *
+ * When discarding, all samples are reported and then thrown away.
+ */
+class SampleTap : public AudioPassthrough
+{
+  public:
+    void setDiscard(bool discard) { m_discard = discard; }
+    bool isDiscarding(void) const { return m_discard; }
+
+    virtual int writeSamples(const float *samples, int count)
+    {
+      int ret = m_discard
+        ? count
+        : AudioPassthrough::writeSamples(samples, count);
+      if (ret > 0)
+      {
+        samplesPassed(samples, ret);
+      }
+      return ret;
+    }
+
+    sigc::signal<void(const float*, int)> samplesPassed;
+
+  private:
+    bool m_discard {false};
+};
+
+
 /**
  * @brief A class that represents a satellite receiver
  * 
@@ -106,14 +146,35 @@ using namespace Async;
  * its "subscribers".
  * When the receiver close its squelch, the squelch signal is delayed until
  * all audio has been flushed.
+ *
+ * Each block of audio received is time stamped with the time when it was
+ * received by the receiver hardware, as far as it can be estimated using the
+ * transport delay reported by the receiver. The time stamps are used to
+ * time align the audio when switching between receivers. The length of the
+ * delay buffer is extended with the peak transport delay so that receivers
+ * on slow links do not lose audio during the voting delay.
  */
 class Voter::SatRx : public AudioSource, public sigc::trackable
 {
   public:
-    SatRx(Config &cfg, const string &rx_name, int id, int fifo_length_ms)
+    SatRx(Config &cfg, const string &rx_name, int id, int fifo_length_ms,
+          const string &voter_name)
       : rx_id(id), rx(0), fifo(0), sql_open(false), enabled(true),
-        mute_state(Rx::MUTE_ALL), sql_open_delay(0)
+        mute_state(Rx::MUTE_ALL), sql_open_delay(0), quality(0),
+        quality_ch(0), rx_samples(0),
+        fifo_length(fifo_length_ms), link_delay(0.0f),
+        buffer_length_gauge(Metrics::instance().gauge(
+            "svxlink_voter_rx_buffer_length_ms",
+            "The length of the voter delay buffer for a receiver",
+            Metrics::label("voter", voter_name) + "," +
+            Metrics::label("rx", rx_name))),
+        link_delay_gauge(Metrics::instance().gauge(
+            "svxlink_voter_rx_link_delay_ms",
+            "The peak transport delay of the audio from a receiver",
+            Metrics::label("voter", voter_name) + "," +
+            Metrics::label("rx", rx_name)))
     {
+      buffer_length_gauge.set(fifo_length_ms);
       rx = RxFactory::createNamedRx(cfg, rx_name);
       if (rx != 0)
       {
@@ -133,6 +194,11 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
 
 	AudioSource *prev_src = rx;
 
+        tap.samplesPassed.connect(
+                sigc::mem_fun(*this, &SatRx::onSamplesReceived));
+        prev_src->registerSink(&tap);
+        prev_src = &tap;
+
 	if (fifo_length_ms > 0)
 	{
 	  fifo = new AudioFifo(fifo_length_ms * INTERNAL_SAMPLE_RATE / 1000);
@@ -196,7 +262,33 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
       return rx->addToneDetector(fq, bw, thresh, required_duration);
     }
     
-    float signalStrength(void) const { return rx->signalStrength(); }
+    float signalStrength(void) const
+    {
+      return (quality != 0) ? quality->quality(quality_ch)
+                            : rx->signalStrength();
+    }
+
+    /**
+     * @brief   Use the audio quality estimate instead of the signal level
+     * @param   vq The quality estimator to use
+     *
+     * The receiver will not be content muted when the voter mute it since
+     * the audio is needed to estimate the quality. The content is thrown
+     * away here instead.
+     */
+    void setQualityEstimator(VoterQuality *vq)
+    {
+      quality = vq;
+      quality_ch = quality->addChannel();
+    }
+
+    void qualityUpdated(void)
+    {
+      if (sql_open)
+      {
+        signalLevelUpdated(signalStrength(), this);
+      }
+    }
 
     const std::string& squelchActivityInfo(void) const
     {
@@ -255,6 +347,40 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     }
     unsigned sqlOpenDelay(void) const { return sql_open_delay; }
 
+    /**
+     * @brief   Get the receive time of the oldest sample in the buffer
+     * @param   ts Where to store the time
+     * @return  Returns \em true on success or \em false if unknown
+     *
+     * If the buffer is empty, the time of the next sample to be received is
+     * returned.
+     */
+    bool bufferStartTime(struct timespec& ts) const
+    {
+      return rxTime(firstBufferedSample(), ts);
+    }
+
+    /**
+     * @brief   Throw away buffered audio received before the given time
+     * @param   ts The time to align to
+     * @return  Returns the number of samples thrown away
+     */
+    unsigned alignTo(const struct timespec& ts)
+    {
+      struct timespec start;
+      if ((fifo == 0) || !bufferStartTime(start))
+      {
+        return 0;
+      }
+      long long diff = (ts.tv_sec - start.tv_sec) * 1000000000LL +
+                       (ts.tv_nsec - start.tv_nsec);
+      if (diff <= 0)
+      {
+        return 0;
+      }
+      return fifo->skipSamples(diff * INTERNAL_SAMPLE_RATE / 1000000000LL);
+    }
+
     sigc::signal<void(char, int)>     dtmfDigitDetected;
     sigc::signal<void(string)>        selcallSequenceDetected;
     sigc::signal<void(bool, SatRx*)>  squelchOpen;
@@ -272,9 +398,16 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
   private:
     typedef list<pair<char, int> >	DtmfBuf;
     typedef list<string>		SelcallBuf;
+    struct RxTimestamp
+    {
+      uint64_t        sample;
+      struct timespec time;
+    };
+    typedef deque<RxTimestamp>          TimestampBuf;
     
     int		  rx_id;
     Rx		  *rx;
+    SampleTap     tap;
     AudioFifo 	  *fifo;
     AudioValve	  valve;
     DtmfBuf   	  dtmf_buf;
@@ -283,10 +416,108 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     bool          enabled;
     Rx::MuteState mute_state;
     unsigned      sql_open_delay;
+    VoterQuality  *quality;
+    unsigned      quality_ch;
     float         tone_detected   {-1.0};
+    TimestampBuf  timestamps;
+    uint64_t      rx_samples;
+    unsigned      fifo_length;
+    float         link_delay;
+    Metrics::Gauge& buffer_length_gauge;
+    Metrics::Gauge& link_delay_gauge;
+
+    uint64_t firstBufferedSample(void) const
+    {
+      return rx_samples - ((fifo != 0) ? fifo->samplesInFifo(true) : 0);
+    }
+
+    bool rxTime(uint64_t sample, struct timespec& ts) const
+    {
+      if (timestamps.empty())
+      {
+        return false;
+      }
+      TimestampBuf::const_reverse_iterator it = timestamps.rbegin();
+      while ((it->sample > sample) && (next(it) != timestamps.rend()))
+      {
+        ++it;
+      }
+      long long ns = (static_cast<long long>(sample) -
+                      static_cast<long long>(it->sample)) *
+                     1000000000LL / INTERNAL_SAMPLE_RATE;
+      ts.tv_sec = it->time.tv_sec + ns / 1000000000LL;
+      ts.tv_nsec = it->time.tv_nsec + ns % 1000000000LL;
+      normalizeTime(ts);
+      return true;
+    }
+
+    static void normalizeTime(struct timespec& ts)
+    {
+      if (ts.tv_nsec >= 1000000000L)
+      {
+        ts.tv_sec += 1;
+        ts.tv_nsec -= 1000000000L;
+      }
+      else if (ts.tv_nsec < 0)
+      {
+        ts.tv_sec -= 1;
+        ts.tv_nsec += 1000000000L;
+      }
+    }
+
+    void onSamplesReceived(const float *samples, int count)
+    {
+      if (quality != 0)
+      {
+        quality->writeSamples(quality_ch, samples, count);
+      }
+
+        // The first sample in the block was received by the receiver
+        // hardware one block length plus the transport delay ago
+      unsigned delay = rx->audioDelay();
+      long long ns = static_cast<long long>(count) * 1000000000LL /
+                     INTERNAL_SAMPLE_RATE + delay * 1000000LL;
+      RxTimestamp rts;
+      rts.sample = rx_samples;
+      Application::app().getMonotonicTime(rts.time);
+      rts.time.tv_sec -= ns / 1000000000LL;
+      rts.time.tv_nsec -= ns % 1000000000LL;
+      normalizeTime(rts.time);
+      timestamps.push_back(rts);
+      rx_samples += count;
+
+        // Forget time stamps for audio that is not buffered anymore
+      uint64_t first = firstBufferedSample();
+      while ((timestamps.size() > 1) && (timestamps[1].sample <= first))
+      {
+        timestamps.pop_front();
+      }
+
+      link_delay = max(static_cast<float>(delay),
+                       link_delay * LINK_DELAY_DECAY);
+      link_delay_gauge.set(static_cast<int64_t>(link_delay));
+    }
+
+    void updateBufferLength(void)
+    {
+      if (fifo == 0)
+      {
+        return;
+      }
+      unsigned step_cnt = static_cast<unsigned>(
+          ceil(link_delay / BUFFER_LENGTH_STEP));
+      unsigned length = min<unsigned>(fifo_length + step_cnt * BUFFER_LENGTH_STEP,
+                                      +MAX_BUFFER_LENGTH);
+      fifo->setSize(length * INTERNAL_SAMPLE_RATE / 1000);
+      buffer_length_gauge.set(length);
+    }
     
     void onDtmfDigitDetected(char digit, int duration)
     {
+      if (tap.isDiscarding())
+      {
+        return;
+      }
       if (!valve.isOpen())
       {
 	dtmf_buf.push_back(pair<char, int>(digit, duration));
@@ -299,6 +530,10 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     
     void onSelcallSequenceDetected(string sequence)
     {
+      if (tap.isDiscarding())
+      {
+        return;
+      }
       if (!valve.isOpen())
       {
 	selcall_buf.push_back(sequence);
@@ -311,6 +546,10 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
 
     void onToneDetected(float tone)
     {
+      if (tap.isDiscarding())
+      {
+        return;
+      }
       if (!valve.isOpen())
       {
         tone_detected = tone;
@@ -325,6 +564,10 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     {
       if (is_open)
       {
+        if (quality != 0)
+        {
+          quality->resetChannel(quality_ch);
+        }
       	setSquelchOpen(true);
       }
       else
@@ -338,7 +581,7 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     
     void rxSignalLevelUpdated(float siglev)
     {
-      if (sql_open)
+      if (sql_open && (quality == 0))
       {
 	signalLevelUpdated(siglev, this);
       }
@@ -355,9 +598,13 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
 
     void setMuteStateP(Rx::MuteState new_mute_state)
     {
-      rx->setMuteState(new_mute_state);
+      const bool discard =
+        (quality != 0) && (new_mute_state == Rx::MUTE_CONTENT);
+      tap.setDiscard(discard);
+      rx->setMuteState(discard ? Rx::MUTE_NONE : new_mute_state);
       if (new_mute_state != Rx::MUTE_NONE)
       {
+        updateBufferLength();
         if (fifo != 0)
         {
           fifo->clear();
@@ -405,7 +652,20 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
 Voter::Voter(Config &cfg, const std::string& name)
   : Rx(cfg, name), cfg(cfg), m_verbose(true), selector(0),
     sm(Macho::State<Top>(this)), is_processing_event(false), command_pty(0),
-    m_print_sat_squelch(false)
+    m_print_sat_squelch(false), vote_pending(false), vote_start{0, 0},
+    voting_delay_hist(Metrics::instance().histogram(
+          "svxlink_voter_voting_delay_seconds",
+          "Time from squelch open until a receiver has been selected",
+          Metrics::latencyBuckets(), Metrics::label("voter", name))),
+    switch_skip_hist(Metrics::instance().histogram(
+          "svxlink_voter_switch_skipped_seconds",
+          "Audio thrown away to time align receivers on a switch",
+          Metrics::latencyBuckets(), Metrics::label("voter", name))),
+    switch_counter(Metrics::instance().counter(
+          "svxlink_voter_rx_switches_total",
+          "The number of switches between receivers during a transmission",
+          Metrics::label("voter", name))),
+    quality(0)
 {
 } /* Voter::Voter */
 
@@ -429,6 +689,8 @@ Voter::~Voter(void)
     delete *it;
   }
   rxs.clear();
+  delete quality;
+  quality = 0;
 } /* Voter::~Voter */
 
 
@@ -536,6 +798,47 @@ bool Voter::initialize(void)
 
   cfg.getValue(name(), "VERBOSE", m_print_sat_squelch);
 
+  string voting_metric("SIGLEV");
+  cfg.getValue(name(), "VOTING_METRIC", voting_metric);
+  if (voting_metric == "AUDIO")
+  {
+    unsigned interval = DEFAULT_VOTING_METRIC_INTERVAL;
+    cfg.getValue(name(), "VOTING_METRIC_INTERVAL", interval);
+    if ((interval < MIN_VOTING_METRIC_INTERVAL) ||
+        (interval > MAX_VOTING_METRIC_INTERVAL))
+    {
+      cerr << "*** ERROR: Config variable " << name()
+           << "/VOTING_METRIC_INTERVAL out of range (" << interval
+           << "). Valid range is " << MIN_VOTING_METRIC_INTERVAL << " to "
+           << MAX_VOTING_METRIC_INTERVAL << ".\n";
+      return false;
+    }
+      // The quality of a receiver is zero until the first update after the
+      // squelch opened so the vote must not be done before that
+    if (voting_delay < interval)
+    {
+      cerr << "*** ERROR: Config variable " << name()
+           << "/VOTING_DELAY (" << voting_delay << ") must be at least as "
+              "long as " << name() << "/VOTING_METRIC_INTERVAL ("
+           << interval << ") when VOTING_METRIC is set to AUDIO.\n";
+      return false;
+    }
+    quality = new VoterQuality(interval, name());
+    float offset = 0.0f;
+    cfg.getValue(name(), "VOTING_METRIC_OFFSET", offset);
+    quality->setDetectorOffset(offset);
+    float slope = 10.0f;
+    cfg.getValue(name(), "VOTING_METRIC_SLOPE", slope);
+    quality->setDetectorSlope(slope);
+  }
+  else if (voting_metric != "SIGLEV")
+  {
+    cerr << "*** ERROR: Unknown value \"" << voting_metric << "\" for "
+         << "config variable " << name() << "/VOTING_METRIC. Valid values "
+            "are SIGLEV and AUDIO.\n";
+    return false;
+  }
+
   selector = new AudioSelector;
   setHandler(selector);
   
@@ -560,7 +863,12 @@ bool Voter::initialize(void)
     if (!rx_name.empty())
     {
       cout << "\tAdding receiver: " << rx_name << endl;
-      SatRx *srx = new SatRx(cfg, rx_name, rxs.size() + 1, buffer_length);
+      SatRx *srx = new SatRx(cfg, rx_name, rxs.size() + 1, buffer_length,
+                             name());
+      if (quality != 0)
+      {
+        srx->setQualityEstimator(quality);
+      }
       srx->setSqlOpenDelay(sql_open_delay);
       srx->squelchOpen.connect(mem_fun(*this, &Voter::satSquelchOpen));
       srx->signalLevelUpdated.connect(
@@ -587,6 +895,18 @@ bool Voter::initialize(void)
     ++start;
   }
 
+  if (quality != 0)
+  {
+    bool use_thread = false;
+    cfg.getValue(name(), "VOTING_METRIC_THREAD", use_thread);
+    quality->qualityUpdated.connect(
+        mem_fun(*this, &Voter::onQualityUpdated));
+    if (!quality->start(use_thread))
+    {
+      return false;
+    }
+  }
+
   return true;
   
 } /* Voter::initialize */
@@ -738,6 +1058,53 @@ void Voter::resetAll(void)
 } /* Voter::resetAll */
 
 
+void Voter::startVote(void)
+{
+  Application::app().getMonotonicTime(vote_start);
+  vote_pending = true;
+} /* Voter::startVote */
+
+
+void Voter::voteDone(void)
+{
+  if (!vote_pending)
+  {
+    return;
+  }
+  vote_pending = false;
+  struct timespec now;
+  Application::app().getMonotonicTime(now);
+  voting_delay_hist.observe((now.tv_sec - vote_start.tv_sec) +
+                            (now.tv_nsec - vote_start.tv_nsec) / 1.0e9);
+} /* Voter::voteDone */
+
+
+void Voter::alignSrx(SatRx *from_srx, SatRx *to_srx)
+{
+  switch_counter.inc();
+
+    // Throw away the audio in the new receiver buffer that have already been
+    // played from the old receiver so that no audio is repeated
+  struct timespec ts;
+  if (!from_srx->bufferStartTime(ts))
+  {
+    return;
+  }
+  unsigned skipped = to_srx->alignTo(ts);
+  switch_skip_hist.observe(static_cast<double>(skipped) /
+                           INTERNAL_SAMPLE_RATE);
+} /* Voter::alignSrx */
+
+
+void Voter::onQualityUpdated(void)
+{
+  for (list<SatRx *>::iterator it=rxs.begin(); it!=rxs.end(); ++it)
+  {
+    (*it)->qualityUpdated();
+  }
+} /* Voter::onQualityUpdated */
+
+
 void Voter::publishSquelchState(void)
 {
   Json::Value event(Json::arrayValue);
@@ -972,6 +1339,7 @@ void Voter::Idle::satSquelchOpen(SatRx *srx, bool is_open)
   SUPER::satSquelchOpen(srx, is_open);
   if (is_open)
   {
+    voter().startVote();
     if (srx->signalStrength() * hysteresis() > 100.0f)
     {
       setState<ActiveRxSelected>(bestSrx());
@@ -1050,6 +1418,7 @@ void Voter::VotingDelay::timerExpired(void)
 void Voter::ActiveRxSelected::init(SatRx *srx)
 {
   assert(srx != 0);
+  voter().voteDone();
   box().active_srx = srx;
   if (muteState() == MUTE_CONTENT)
   {
@@ -1089,6 +1458,7 @@ char Voter::ActiveRxSelected::sqlRxId(void)
 
 void Voter::ActiveRxSelected::changeActiveSrx(SatRx *srx)
 {
+  voter().alignSrx(activeSrx(), srx);
   voter().selector->selectSource(srx);
   activeSrx()->setMuteState(MUTE_CONTENT);
   box().active_srx = srx;
@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <list>
+#include <time.h>
 
 
 /****************************************************************************
@@ -45,6 +46,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncConfig.h>
+#include <AsyncMetrics.h>
 #include <CppStdCompat.h>
 
 
@@ -71,6 +73,8 @@ namespace Async
   class Pty;
 };
 
+class VoterQuality;
+
 
 /****************************************************************************
  *
@@ -197,6 +201,7 @@ class Voter : public Rx
     static CONSTEXPR unsigned DEFAULT_SQL_CLOSE_REVOTE_DELAY = 500;
     static CONSTEXPR unsigned DEFAULT_REVOTE_INTERVAL        = 1000;
     static CONSTEXPR unsigned DEFAULT_RX_SWITCH_DELAY        = 500;
+    static CONSTEXPR unsigned DEFAULT_VOTING_METRIC_INTERVAL = 100;
     
     static CONSTEXPR unsigned MAX_VOTING_DELAY               = 5000;
     static CONSTEXPR unsigned MAX_BUFFER_LENGTH              = MAX_VOTING_DELAY;
@@ -205,6 +210,8 @@ class Voter : public Rx
     static CONSTEXPR unsigned MIN_REVOTE_INTERVAL            = 100;
     static CONSTEXPR unsigned MAX_REVOTE_INTERVAL            = 60000;
     static CONSTEXPR unsigned MAX_RX_SWITCH_DELAY            = 3000;
+    static CONSTEXPR unsigned MIN_VOTING_METRIC_INTERVAL     = 25;
+    static CONSTEXPR unsigned MAX_VOTING_METRIC_INTERVAL     = 1000;
 
     class SatRx;
 
@@ -419,6 +426,12 @@ class Voter : public Rx
     Async::Pty            *command_pty;
     std::string           command_buf;
     bool                  m_print_sat_squelch;
+    bool                  vote_pending;
+    struct timespec       vote_start;
+    Async::Metrics::Histogram& voting_delay_hist;
+    Async::Metrics::Histogram& switch_skip_hist;
+    Async::Metrics::Counter&   switch_counter;
+    VoterQuality          *quality;
 
     void dispatchEvent(Macho::IEvent<Top> *event);
     void satSquelchOpen(bool is_open, SatRx *rx);
@@ -428,6 +441,10 @@ class Voter : public Rx
     void unmuteAll(void);
     void resetAll(void);
     void publishSquelchState(void);
+    void startVote(void);
+    void voteDone(void);
+    void alignSrx(SatRx *from_srx, SatRx *to_srx);
+    void onQualityUpdated(void);
     SatRx *findBestRx(void) const;
     void onCommandPtyInput(const void *buf, size_t count);
     void handlePtyCommand(const std::string &full_command);
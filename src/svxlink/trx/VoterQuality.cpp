@@ -0,0 +1,595 @@
+/**
+@file	 VoterQuality.cpp
+@brief   Batched audio quality estimation for the receivers of a voter
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <cerrno>
+#include <limits>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "VoterQuality.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // The length of the noise measurement blocks in milliseconds. The same as
+  // the block length used by the NOISE signal level detector.
+#define NOISE_BLOCK_TIME 25
+
+  // The number of channels in the buffer is rounded up to a multiple of this
+  // value so that the processing loop can be vectorized without a remainder
+#define CHANNEL_ALIGN 8
+
+  // The maximum number of channels processed together in one group
+#define MAX_GROUP_SIZE 32
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+VoterQuality::VoterQuality(unsigned interval_ms, const std::string& name)
+  : m_interval_ms(interval_ms), m_channels(0), m_stride(0), m_rows(0),
+    m_block_len(NOISE_BLOCK_TIME * INTERNAL_SAMPLE_RATE / 1000),
+    m_offset(0.0f), m_slope(10.0f), m_work_time(0.0),
+    m_timer(interval_ms, Timer::TYPE_PERIODIC, false), m_use_thread(false),
+    m_work_pending(false), m_busy(false), m_quit(false), m_done_fd(-1),
+    m_process_hist(Metrics::instance().histogram(
+          "svxlink_voter_quality_process_seconds",
+          "Time spent estimating the audio quality of all voter receivers",
+          Metrics::latencyBuckets(), Metrics::label("voter", name))),
+    m_overrun_counter(Metrics::instance().counter(
+          "svxlink_voter_quality_overruns_total",
+          "Audio quality updates skipped since the worker thread was busy",
+          Metrics::label("voter", name)))
+{
+    // The same noise filter as in the NOISE signal level detector,
+    // "BpBu4/5000-5500" or "HpBu4/3500" depending on the sample rate, as
+    // cascaded biquad sections
+  if (INTERNAL_SAMPLE_RATE >= 16000)
+  {
+      // A fourth order Butterworth band pass filter. Each pole of the
+      // analog prototype is transformed to a band pass pole pair, of which
+      // one is kept, and then mapped to the z-plane using the bilinear
+      // transform. Each section is normalized to unity gain at the center
+      // frequency.
+    const double w1 = tan(M_PI * 5000.0 / INTERNAL_SAMPLE_RATE);
+    const double w2 = tan(M_PI * 5500.0 / INTERNAL_SAMPLE_RATE);
+    const double bw = w2 - w1;
+    const double w0sq = w1 * w2;
+    const complex<double> zc = polar(1.0, -2.0 * atan(sqrt(w0sq)));
+    m_sections = 4;
+    for (int s=0; s<m_sections; ++s)
+    {
+      const complex<double> p =
+          polar(1.0, M_PI * (2 * s + 5) / 8.0) * (bw / 2.0);
+      complex<double> sp = p + sqrt(p * p - w0sq);
+      if (sp.imag() < 0.0)
+      {
+        sp = 2.0 * p - sp;
+      }
+      const complex<double> zp = (1.0 + sp) / (1.0 - sp);
+      const double a1 = -2.0 * zp.real();
+      const double a2 = norm(zp);
+      const double g = abs((1.0 + a1 * zc + a2 * zc * zc) / (1.0 - zc * zc));
+      m_b[s][0] = g;
+      m_b[s][1] = 0.0f;
+      m_b[s][2] = -g;
+      m_a[s][0] = a1;
+      m_a[s][1] = a2;
+    }
+  }
+  else
+  {
+      // A fourth order Butterworth high pass filter
+    const float q[2] = { 0.5411961f, 1.3065630f };
+    const float w0 = 2.0f * M_PI * 3500.0f / INTERNAL_SAMPLE_RATE;
+    m_sections = 2;
+    for (int s=0; s<m_sections; ++s)
+    {
+      const float alpha = sinf(w0) / (2.0f * q[s]);
+      const float a0 = 1.0f + alpha;
+      m_b[s][0] = (1.0f + cosf(w0)) / 2.0f / a0;
+      m_b[s][1] = -(1.0f + cosf(w0)) / a0;
+      m_b[s][2] = m_b[s][0];
+      m_a[s][0] = -2.0f * cosf(w0) / a0;
+      m_a[s][1] = (1.0f - alpha) / a0;
+    }
+  }
+
+  m_timer.expired.connect(mem_fun(*this, &VoterQuality::onTimerExpired));
+} /* VoterQuality::VoterQuality */
+
+
+VoterQuality::~VoterQuality(void)
+{
+  if (m_thread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_quit = true;
+    }
+    m_cond.notify_one();
+    m_thread.join();
+  }
+  m_done_watch.setFd(-1, FdWatch::FD_WATCH_RD);
+  if (m_done_fd >= 0)
+  {
+    close(m_done_fd);
+  }
+} /* VoterQuality::~VoterQuality */
+
+
+unsigned VoterQuality::addChannel(void)
+{
+  return m_channels++;
+} /* VoterQuality::addChannel */
+
+
+bool VoterQuality::start(bool use_thread)
+{
+  m_stride = (m_channels + CHANNEL_ALIGN - 1) / CHANNEL_ALIGN * CHANNEL_ALIGN;
+  if (m_stride == 0)
+  {
+    m_stride = CHANNEL_ALIGN;
+  }
+
+    // Make room for two intervals of audio to handle jitter in the arrival
+    // of the audio
+  m_rows = 2 * m_interval_ms * INTERNAL_SAMPLE_RATE / 1000;
+
+  initBatch(m_input);
+  initBatch(m_work);
+  for (int s=0; s<m_sections; ++s)
+  {
+    m_state.x1[s].assign(m_stride, 0.0f);
+    m_state.x2[s].assign(m_stride, 0.0f);
+    m_state.y1[s].assign(m_stride, 0.0f);
+    m_state.y2[s].assign(m_stride, 0.0f);
+  }
+  m_state.noise.assign(m_stride, 0.0f);
+  m_state.noise_cnt.assign(m_stride, 0);
+  m_state.noise_min.assign(m_stride, 0.0f);
+  m_state.voice.assign(m_stride, 0.0f);
+  m_quality.assign(m_stride, 0.0f);
+  m_noise_floor.assign(m_stride, 0.0f);
+  m_snr.assign(m_stride, 0.0f);
+  m_work_quality.assign(m_stride, 0.0f);
+  m_work_noise_floor.assign(m_stride, 0.0f);
+  m_work_snr.assign(m_stride, 0.0f);
+
+  m_use_thread = use_thread;
+  if (m_use_thread)
+  {
+    m_done_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_done_fd < 0)
+    {
+      cerr << "*** ERROR: Could not create eventfd for the voter quality "
+              "worker thread: " << strerror(errno) << endl;
+      return false;
+    }
+    m_done_watch.setFd(m_done_fd, FdWatch::FD_WATCH_RD);
+    m_done_watch.setEnabled(true);
+    m_done_watch.activity.connect(mem_fun(*this, &VoterQuality::onWorkDone));
+    m_thread = std::thread(&VoterQuality::workerThread, this);
+  }
+
+  m_timer.setEnable(true);
+
+  return true;
+} /* VoterQuality::start */
+
+
+void VoterQuality::writeSamples(unsigned ch, const float *samples, int count)
+{
+  if ((ch >= m_channels) || m_input.samples.empty())
+  {
+    return;
+  }
+  int& pos = m_input.count[ch];
+  count = min(count, static_cast<int>(m_rows) - pos);
+  float *dst = &m_input.samples[pos * m_stride + ch];
+  for (int i=0; i<count; ++i)
+  {
+    *dst = samples[i];
+    dst += m_stride;
+  }
+  pos += count;
+} /* VoterQuality::writeSamples */
+
+
+void VoterQuality::resetChannel(unsigned ch)
+{
+  if (ch >= m_channels)
+  {
+    return;
+  }
+  m_input.count[ch] = 0;
+  m_input.reset[ch] = 1.0f;
+  m_quality[ch] = 0.0f;
+  m_noise_floor[ch] = 0.0f;
+  m_snr[ch] = 0.0f;
+} /* VoterQuality::resetChannel */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void VoterQuality::initBatch(Batch& batch)
+{
+  batch.samples.assign(m_rows * m_stride, 0.0f);
+  batch.count.assign(m_stride, 0);
+  batch.reset.assign(m_stride, 0.0f);
+} /* VoterQuality::initBatch */
+
+
+void VoterQuality::onTimerExpired(Timer *t)
+{
+  if (m_busy)
+  {
+      // The worker thread is still processing the previous batch. Keep
+      // collecting audio and try again on the next timer expiration.
+    m_overrun_counter.inc();
+    return;
+  }
+
+  std::swap(m_input, m_work);
+  fill(m_input.count.begin(), m_input.count.end(), 0);
+  fill(m_input.reset.begin(), m_input.reset.end(), 0.0f);
+
+  if (m_use_thread)
+  {
+    m_busy = true;
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_work_pending = true;
+    }
+    m_cond.notify_one();
+  }
+  else
+  {
+    processBatch();
+    publishResult();
+  }
+} /* VoterQuality::onTimerExpired */
+
+
+void VoterQuality::workerThread(void)
+{
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lk(m_mutex);
+      m_cond.wait(lk, [this]{ return m_work_pending || m_quit; });
+      if (m_quit)
+      {
+        return;
+      }
+    }
+
+    processBatch();
+
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_work_pending = false;
+    }
+    uint64_t one = 1;
+    ssize_t ret = ::write(m_done_fd, &one, sizeof(one));
+    (void)ret;
+  }
+} /* VoterQuality::workerThread */
+
+
+void VoterQuality::processBatch(void)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  const unsigned stride = m_stride;
+  const int block_len = m_block_len;
+  const int *cnt = m_work.count.data();
+  const float *reset = m_work.reset.data();
+
+  const int sections = m_sections;
+  float *x1[MAX_SECTIONS], *x2[MAX_SECTIONS];
+  float *y1[MAX_SECTIONS], *y2[MAX_SECTIONS];
+  for (int s=0; s<sections; ++s)
+  {
+    x1[s] = m_state.x1[s].data();
+    x2[s] = m_state.x2[s].data();
+    y1[s] = m_state.y1[s].data();
+    y2[s] = m_state.y2[s].data();
+  }
+  float *noise = m_state.noise.data();
+  int *noise_cnt = m_state.noise_cnt.data();
+  float *noise_min = m_state.noise_min.data();
+  float *voice = m_state.voice.data();
+
+  for (unsigned ch=0; ch<stride; ++ch)
+  {
+    const float keep = 1.0f - reset[ch];
+    for (int s=0; s<sections; ++s)
+    {
+      x1[s][ch] *= keep;
+      x2[s][ch] *= keep;
+      y1[s][ch] *= keep;
+      y2[s][ch] *= keep;
+    }
+    noise[ch] *= keep;
+    noise_cnt[ch] = (reset[ch] != 0.0f) ? 0 : noise_cnt[ch];
+    noise_min[ch] = numeric_limits<float>::max();
+    voice[ch] = 0.0f;
+  }
+
+    // Process the channels in groups, one sample at a time. The state of a
+    // group is copied to local arrays so that the compiler know that they do
+    // not alias and can vectorize the loops over the channels. Samples past
+    // the end of the valid audio for a channel are masked out, using
+    // arithmetic rather than conditional assignments, so that the inner
+    // loops have no branches.
+  for (unsigned g=0; g<stride; g+=MAX_GROUP_SIZE)
+  {
+    const unsigned lanes = min(stride - g, unsigned(MAX_GROUP_SIZE));
+    float gx1[MAX_SECTIONS][MAX_GROUP_SIZE], gx2[MAX_SECTIONS][MAX_GROUP_SIZE];
+    float gy1[MAX_SECTIONS][MAX_GROUP_SIZE], gy2[MAX_SECTIONS][MAX_GROUP_SIZE];
+    float gnoise[MAX_GROUP_SIZE], gnoise_min[MAX_GROUP_SIZE];
+    float gvoice[MAX_GROUP_SIZE], gmask[MAX_GROUP_SIZE], gz[MAX_GROUP_SIZE];
+    int gnoise_cnt[MAX_GROUP_SIZE], gcnt[MAX_GROUP_SIZE];
+    for (unsigned c=0; c<lanes; ++c)
+    {
+      for (int s=0; s<sections; ++s)
+      {
+        gx1[s][c] = x1[s][g+c];
+        gx2[s][c] = x2[s][g+c];
+        gy1[s][c] = y1[s][g+c];
+        gy2[s][c] = y2[s][g+c];
+      }
+      gnoise[c] = noise[g+c];
+      gnoise_cnt[c] = noise_cnt[g+c];
+      gnoise_min[c] = noise_min[g+c];
+      gvoice[c] = voice[g+c];
+      gcnt[c] = cnt[g+c];
+    }
+
+    const int group_rows = *max_element(gcnt, gcnt + lanes);
+    for (int n=0; n<group_rows; ++n)
+    {
+      const float *x = &m_work.samples[n * stride + g];
+      for (unsigned c=0; c<lanes; ++c)
+      {
+        gmask[c] = (n < gcnt[c]);
+        gz[c] = x[c];
+      }
+
+      for (int s=0; s<sections; ++s)
+      {
+        const float b0 = m_b[s][0], b1 = m_b[s][1], b2 = m_b[s][2];
+        const float a0 = m_a[s][0], a1 = m_a[s][1];
+        float *sx1 = gx1[s], *sx2 = gx2[s], *sy1 = gy1[s], *sy2 = gy2[s];
+        for (unsigned c=0; c<lanes; ++c)
+        {
+          const float m = gmask[c];
+          const float in = gz[c];
+          const float y = b0 * in + b1 * sx1[c] + b2 * sx2[c]
+                          - a0 * sy1[c] - a1 * sy2[c];
+          sx2[c] += m * (sx1[c] - sx2[c]);
+          sx1[c] += m * (in - sx1[c]);
+          sy2[c] += m * (sy1[c] - sy2[c]);
+          sy1[c] += m * (y - sy1[c]);
+          gz[c] = y;
+        }
+      }
+
+      for (unsigned c=0; c<lanes; ++c)
+      {
+        const float m = gmask[c];
+        const float z = gz[c];
+        const float v = x[c] - z;
+        gvoice[c] += m * v * v;
+        const float ns = gnoise[c] + m * z * z;
+        const int nc = gnoise_cnt[c] + (n < gcnt[c]);
+        const float full = (nc >= block_len);
+        const float cand = full * ns + (1.0f - full) * gnoise_min[c];
+        gnoise_min[c] = (cand < gnoise_min[c]) ? cand : gnoise_min[c];
+        gnoise[c] = (1.0f - full) * ns;
+        gnoise_cnt[c] = nc * (nc < block_len);
+      }
+    }
+
+    for (unsigned c=0; c<lanes; ++c)
+    {
+      for (int s=0; s<sections; ++s)
+      {
+        x1[s][g+c] = gx1[s][c];
+        x2[s][g+c] = gx2[s][c];
+        y1[s][g+c] = gy1[s][c];
+        y2[s][g+c] = gy2[s][c];
+      }
+      noise[g+c] = gnoise[c];
+      noise_cnt[g+c] = gnoise_cnt[c];
+      noise_min[g+c] = gnoise_min[c];
+      voice[g+c] = gvoice[c];
+    }
+  }
+
+  for (unsigned ch=0; ch<m_channels; ++ch)
+  {
+    if (reset[ch] != 0.0f)
+    {
+      m_work_quality[ch] = 0.0f;
+      m_work_noise_floor[ch] = 0.0f;
+      m_work_snr[ch] = 0.0f;
+    }
+    if (noise_min[ch] == numeric_limits<float>::max())
+    {
+      continue;
+    }
+    const float nmin = max(noise_min[ch], 1.0e-20f);
+    const float noise_pwr = nmin / m_block_len;
+      // Same compensation as in the NOISE signal level detector for the over
+      // estimation caused by using the minimum block power
+    m_work_quality[ch] = m_offset - m_slope * (log10f(nmin) + 0.25f);
+    m_work_noise_floor[ch] = 10.0f * log10f(noise_pwr);
+    const float voice_pwr = voice[ch] / cnt[ch];
+    m_work_snr[ch] = 10.0f * log10f(max(voice_pwr, 1.0e-20f) / noise_pwr);
+  }
+
+  m_work_time = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+} /* VoterQuality::processBatch */
+
+
+void VoterQuality::onWorkDone(FdWatch *w)
+{
+  uint64_t cnt;
+  ssize_t ret = ::read(m_done_fd, &cnt, sizeof(cnt));
+  (void)ret;
+
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_work_pending)
+    {
+      return;
+    }
+  }
+  m_busy = false;
+  publishResult();
+} /* VoterQuality::onWorkDone */
+
+
+void VoterQuality::publishResult(void)
+{
+  m_process_hist.observe(m_work_time);
+  for (unsigned ch=0; ch<m_channels; ++ch)
+  {
+      // Do not overwrite a reset done after the batch was handed over
+    if (m_input.reset[ch] == 0.0f)
+    {
+      m_quality[ch] = m_work_quality[ch];
+      m_noise_floor[ch] = m_work_noise_floor[ch];
+      m_snr[ch] = m_work_snr[ch];
+    }
+  }
+  qualityUpdated();
+} /* VoterQuality::publishResult */
+
+
+
+/*
+ * This file has not been truncated
+ */
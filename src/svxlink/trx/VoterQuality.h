@@ -0,0 +1,303 @@
+/**
+@file	 VoterQuality.h
+@brief   Batched audio quality estimation for the receivers of a voter
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef VOTER_QUALITY_INCLUDED
+#define VOTER_QUALITY_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTimer.h>
+#include <AsyncFdWatch.h>
+#include <AsyncMetrics.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Batched audio quality estimation for the receivers of a voter
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-19
+
+This class estimate the signal quality of a number of receivers from the
+received audio. The audio from all receivers is collected into one buffer,
+one column per receiver, and on a fixed interval all receivers are processed
+in one pass. The inner loop run over the receivers so that the compiler can
+vectorize it, and all receivers get a new quality value at the same instant.
+
+The quality estimate work in the same way as the NOISE signal level detector.
+The audio is filtered using the same filter as that detector, a band pass
+filter at 5000-5500Hz or a high pass filter at 3500Hz when the sample rate is
+8kHz, to get the noise above the voice band. The noise power is summed up in
+25 millisecond blocks. The noise floor is the
+lowest block power during the interval. The quality is calculated from the
+noise floor using an offset and a slope so that it can be calibrated to the
+same scale as the signal level detectors. The ratio between the power of the
+audio outside of the noise filter pass band, which is mostly voice, and the
+noise floor is also calculated.
+
+The processing may optionally be done in a worker thread. The audio that
+arrive during an interval is then processed by the worker thread during the
+next interval and the result is reported to the main thread through an
+eventfd.
+*/
+class VoterQuality : public sigc::trackable
+{
+  public:
+    /**
+     * @brief 	Constuctor
+     * @param 	interval_ms The interval between quality updates
+     * @param 	name        The name used to label the metrics
+     */
+    VoterQuality(unsigned interval_ms, const std::string& name);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~VoterQuality(void);
+
+    /**
+     * @brief   Set the detector offset
+     * @param   offset The offset added to the quality value
+     */
+    void setDetectorOffset(float offset) { m_offset = offset; }
+
+    /**
+     * @brief   Set the detector slope
+     * @param   slope The slope of the quality value per decade of noise
+     */
+    void setDetectorSlope(float slope) { m_slope = slope; }
+
+    /**
+     * @brief   Add a receiver channel
+     * @return  Returns the channel number
+     *
+     * All channels must be added before calling the start function.
+     */
+    unsigned addChannel(void);
+
+    /**
+     * @brief   Start the periodic processing
+     * @param   use_thread Set to \em true to process in a worker thread
+     * @return  Returns \em true on success or else \em false
+     */
+    bool start(bool use_thread);
+
+    /**
+     * @brief   Write samples for a channel
+     * @param   ch      The channel number
+     * @param   samples The samples to write
+     * @param   count   The number of samples to write
+     *
+     * Samples that do not fit in the buffer are thrown away.
+     */
+    void writeSamples(unsigned ch, const float *samples, int count);
+
+    /**
+     * @brief   Restart the estimation for a channel
+     * @param   ch The channel number
+     *
+     * The quality of the channel is set to zero until the next update. This
+     * function should be called when the squelch open for a receiver so that
+     * old measurements are not used.
+     */
+    void resetChannel(unsigned ch);
+
+    /**
+     * @brief   Get the latest quality value for a channel
+     * @param   ch The channel number
+     * @return  Returns the quality value
+     */
+    float quality(unsigned ch) const { return m_quality[ch]; }
+
+    /**
+     * @brief   Get the latest noise floor for a channel
+     * @param   ch The channel number
+     * @return  Returns the noise power in dB relative to full scale
+     */
+    float noiseFloor(unsigned ch) const { return m_noise_floor[ch]; }
+
+    /**
+     * @brief   Get the latest signal to noise ratio for a channel
+     * @param   ch The channel number
+     * @return  Returns the voice band to noise ratio in dB
+     */
+    float snr(unsigned ch) const { return m_snr[ch]; }
+
+    /**
+     * @brief   A signal that is emitted when all channels have been updated
+     */
+    sigc::signal<void()> qualityUpdated;
+
+  protected:
+
+  private:
+    static const int MAX_SECTIONS = 4;
+
+    struct Batch
+    {
+      std::vector<float>  samples;    // rows x stride, one column per channel
+      std::vector<int>    count;      // Number of valid rows per channel
+      std::vector<float>  reset;      // 1.0 if the channel should be reset
+    };
+
+      // Processing state, one element per channel
+    struct State
+    {
+      std::vector<float>  x1[MAX_SECTIONS], x2[MAX_SECTIONS];
+      std::vector<float>  y1[MAX_SECTIONS], y2[MAX_SECTIONS];
+      std::vector<float>  noise;      // Noise power sum for the current block
+      std::vector<int>    noise_cnt;  // Number of samples in the current block
+      std::vector<float>  noise_min;  // Lowest block noise power
+      std::vector<float>  voice;      // Voice band power sum for the interval
+    };
+
+    unsigned                    m_interval_ms;
+    unsigned                    m_channels;
+    unsigned                    m_stride;
+    unsigned                    m_rows;
+    unsigned                    m_block_len;
+    int                         m_sections;
+    float                       m_b[MAX_SECTIONS][3];
+    float                       m_a[MAX_SECTIONS][2];
+    float                       m_offset;
+    float                       m_slope;
+    Batch                       m_input;
+    Batch                       m_work;
+    State                       m_state;
+    std::vector<float>          m_quality;
+    std::vector<float>          m_noise_floor;
+    std::vector<float>          m_snr;
+    std::vector<float>          m_work_quality;
+    std::vector<float>          m_work_noise_floor;
+    std::vector<float>          m_work_snr;
+    double                      m_work_time;
+    Async::Timer                m_timer;
+    bool                        m_use_thread;
+    std::thread                 m_thread;
+    std::mutex                  m_mutex;
+    std::condition_variable     m_cond;
+    bool                        m_work_pending;
+    bool                        m_busy;
+    bool                        m_quit;
+    int                         m_done_fd;
+    Async::FdWatch              m_done_watch;
+    Async::Metrics::Histogram&  m_process_hist;
+    Async::Metrics::Counter&    m_overrun_counter;
+
+    VoterQuality(const VoterQuality&);
+    VoterQuality& operator=(const VoterQuality&);
+    void initBatch(Batch& batch);
+    void onTimerExpired(Async::Timer *t);
+    void workerThread(void);
+    void processBatch(void);
+    void onWorkDone(Async::FdWatch *w);
+    void publishResult(void);
+
+};  /* class VoterQuality */
+
+
+//} /* namespace */
+
+#endif /* VOTER_QUALITY_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,271 @@
+/**
+@file	 VoterQualityBench.cpp
+@brief   Benchmark and verify the batched voter quality estimation
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-19
+
+This program feed sixteen receiver channels with a voice band tone and white
+noise, where the noise level increase with the channel number, to the
+VoterQuality class. The application run on a virtual clock so that a minute of
+audio is processed as fast as possible. The quality values must be ordered by
+noise level and must match the values calculated by a straightforward
+implementation that process one channel at a time. The throughput of the
+batched processing is compared to that implementation. Give the argument
+"thread" to run the batched processing in a worker thread. The worker thread
+cannot keep up with the virtual clock so some updates are skipped and only
+the order of the quality values is verified in that case.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+#include <AsyncCppApplication.h>
+#include <AsyncTimer.h>
+#include <AsyncAudioFilter.h>
+#include <AsyncAudioSink.h>
+#include <AsyncMetrics.h>
+
+#include "VoterQuality.h"
+
+using namespace std;
+using namespace Async;
+
+
+namespace {
+  const unsigned SAMPLE_RATE  = INTERNAL_SAMPLE_RATE;
+  const unsigned CHANNELS     = 16;
+  const unsigned INTERVAL     = 100;
+  const unsigned BLOCK_TIME   = 20;
+  const unsigned BLOCK_SIZE   = BLOCK_TIME * SAMPLE_RATE / 1000;
+  const unsigned RUN_TIME     = 60;
+
+  /**
+   * A channel at a time implementation of the same estimator, using the
+   * same audio filter as the NOISE signal level detector, used to verify the
+   * batched implementation and to compare the throughput
+   */
+  class Reference : public AudioSink
+  {
+    public:
+      Reference(void)
+        : filter((SAMPLE_RATE >= 16000) ? "BpBu4/5000-5500" : "HpBu4/3500",
+                 SAMPLE_RATE)
+      {
+        filter.registerSink(this);
+      }
+
+      float process(const float *samples, int count)
+      {
+        noise_min = numeric_limits<float>::max();
+        filter.writeSamples(samples, count);
+        if (noise_min == numeric_limits<float>::max())
+        {
+          return quality;
+        }
+        quality = -10.0f * (log10f(max(noise_min, 1.0e-20f)) + 0.25f);
+        return quality;
+      }
+
+      int writeSamples(const float *samples, int count)
+      {
+        for (int i=0; i<count; ++i)
+        {
+          noise += samples[i] * samples[i];
+          if (++noise_cnt >= BLOCK_LEN)
+          {
+            noise_min = min(noise_min, noise);
+            noise = 0.0f;
+            noise_cnt = 0;
+          }
+        }
+        return count;
+      }
+
+      void flushSamples(void)
+      {
+        sourceAllSamplesFlushed();
+      }
+
+    private:
+      static const int BLOCK_LEN = 25 * SAMPLE_RATE / 1000;
+      AudioFilter filter;
+      float noise = 0.0f;
+      int   noise_cnt = 0;
+      float noise_min = 0.0f;
+      float quality = 0.0f;
+  };
+
+  void generate(vector<vector<float> >& audio)
+  {
+    mt19937 rng(4711);
+    normal_distribution<float> dist(0.0f, 1.0f);
+    audio.resize(CHANNELS);
+    const size_t len = RUN_TIME * SAMPLE_RATE;
+    for (unsigned ch=0; ch<CHANNELS; ++ch)
+    {
+      const float noise_amp = 0.005f * powf(1.3f, ch);
+      audio[ch].resize(len);
+      for (size_t i=0; i<len; ++i)
+      {
+        audio[ch][i] = 0.3f * sinf(2.0f * M_PI * 1000.0f * i / SAMPLE_RATE) +
+                       noise_amp * dist(rng);
+      }
+    }
+  }
+};
+
+
+int main(int argc, const char **argv)
+{
+  const bool use_thread = (argc > 1) && (string(argv[1]) == "thread");
+
+  vector<vector<float> > audio;
+  generate(audio);
+  const size_t len = audio[0].size();
+
+    // Run the batched implementation on a virtual clock. The audio is
+    // written in blocks in the same way as it would arrive from the
+    // receivers.
+  CppApplication app;
+  app.setVirtualTime(true);
+  VoterQuality vq(INTERVAL, "bench");
+  for (unsigned ch=0; ch<CHANNELS; ++ch)
+  {
+    vq.addChannel();
+  }
+  if (!vq.start(use_thread))
+  {
+    return 1;
+  }
+
+    // The blocks are written half a block off the quality update interval so
+    // that each update process exactly the audio for one interval
+  size_t pos = 0;
+  Timer block_timer(BLOCK_TIME, Timer::TYPE_PERIODIC, false);
+  Timer start_timer(BLOCK_TIME / 2);
+  start_timer.expired.connect([&](Timer*)
+    {
+      block_timer.setEnable(true);
+      block_timer.expired(&block_timer);
+    });
+  block_timer.expired.connect([&](Timer*)
+    {
+      for (unsigned ch=0; ch<CHANNELS; ++ch)
+      {
+        vq.writeSamples(ch, &audio[ch][pos], BLOCK_SIZE);
+      }
+      pos += BLOCK_SIZE;
+      if (pos >= len)
+      {
+        block_timer.setEnable(false);
+      }
+    });
+
+  vector<vector<float> > batched(CHANNELS);
+  unsigned updates = 0;
+  vq.qualityUpdated.connect([&]()
+    {
+      for (unsigned ch=0; ch<CHANNELS; ++ch)
+      {
+        batched[ch].push_back(vq.quality(ch));
+      }
+      if (++updates * INTERVAL >= RUN_TIME * 1000)
+      {
+        Application::app().quit();
+      }
+    });
+
+  app.exec();
+
+    // Run the reference implementation on the same intervals
+  const size_t interval_len = INTERVAL * SAMPLE_RATE / 1000;
+  vector<vector<float> > reference(CHANNELS);
+  auto start = chrono::steady_clock::now();
+  for (unsigned ch=0; ch<CHANNELS; ++ch)
+  {
+    Reference ref;
+    for (size_t i=0; i+interval_len<=len; i+=interval_len)
+    {
+      reference[ch].push_back(ref.process(&audio[ch][i], interval_len));
+    }
+  }
+  chrono::duration<double> ref_dur = chrono::steady_clock::now() - start;
+
+  bool ok = true;
+  cout << setw(8) << "Channel" << setw(10) << "Quality" << setw(12)
+       << "Noise dBFS" << setw(10) << "SNR dB" << setw(12) << "Max diff"
+       << endl;
+  for (unsigned ch=0; ch<CHANNELS; ++ch)
+  {
+    const size_t cnt = min(batched[ch].size(), reference[ch].size());
+    float max_diff = 0.0f;
+    for (size_t i=1; i<cnt; ++i)
+    {
+      max_diff = max(max_diff, fabsf(batched[ch][i] - reference[ch][i]));
+    }
+    cout << setw(8) << ch << fixed << setprecision(1)
+         << setw(10) << vq.quality(ch) << setw(12) << vq.noiseFloor(ch)
+         << setw(10) << vq.snr(ch) << setprecision(3) << setw(12) << max_diff
+         << endl;
+      // In a worker thread, updates are skipped when the thread cannot keep
+      // up with the virtual clock so the intervals do not match the reference
+    ok &= (cnt > 0) && (use_thread || (max_diff < 0.1f));
+    if ((ch > 0) && (vq.quality(ch) >= vq.quality(ch - 1)))
+    {
+      cout << "*** ERROR: The quality is not ordered by noise level\n";
+      ok = false;
+    }
+  }
+
+    // The processing time of the batched implementation is read from the
+    // histogram that it maintain
+  const Metrics::Histogram& hist = Metrics::instance().histogram(
+      "svxlink_voter_quality_process_seconds", "",
+      Metrics::latencyBuckets(), Metrics::label("voter", "bench"));
+  const double batch_samples =
+      static_cast<double>(CHANNELS) * interval_len * hist.count();
+  if (!use_thread)
+  {
+    cout << "Batched: " << setprecision(1)
+         << (batch_samples / hist.sum() / 1.0e6)
+         << " million samples per second\n";
+  }
+  cout << "One channel at a time: " << setprecision(1)
+       << (static_cast<double>(CHANNELS) * len / ref_dur.count() / 1.0e6)
+       << " million samples per second\n";
+
+  if (!ok)
+  {
+    cout << "*** ERROR: The batched implementation differ from the "
+            "reference\n";
+    return 1;
+  }
+
+  return 0;
+}